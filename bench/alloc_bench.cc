@@ -0,0 +1,396 @@
+// 配置器微基准测试: 比较alloc, malloc_alloc, allocator<T>和std::allocator
+// 场景: 固定大小/随机大小, LIFO/FIFO/随机回收顺序, 多线程扩展, 生产者-消费者跨线程回收
+// 每个用例在单独的子进程里运行, 互不影响内存池状态, 峰值RSS也是单个用例的
+// 每行输出一个用例, 列固定, 用例顺序和随机种子固定, 两次运行的结果可以直接diff
+//
+// 用法: bench [--ops N] [--threads N] [--filter 子串]
+//   --ops      每个线程执行的分配+回收次数, 默认1000000
+//   --threads  最大线程数, 按1, 2, 4...翻倍, 默认8
+//   --filter   只运行用例名或配置器名包含该子串的用例
+
+// 基准测试是多线程的, 让alloc使用线程安全的版本
+#define __NODE_ALLOCATOR_THREADS true
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench_allocators.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock;
+
+// 每64次操作计时一次, 计时本身对吞吐量的影响可以忽略
+enum { SAMPLE_MASK = 63 };
+
+struct recorder {
+  std::vector<uint32_t> samples;
+  unsigned tick;
+  recorder() : tick(0) {}
+};
+
+template <class A>
+inline void* timed_allocate(size_t n, recorder& r) {
+  if ((++r.tick & SAMPLE_MASK) != 0) {
+    return A::allocate(n);
+  }
+  bench_clock::time_point t0 = bench_clock::now();
+  void* p = A::allocate(n);
+  bench_clock::time_point t1 = bench_clock::now();
+  r.samples.push_back(
+      (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0)
+          .count());
+  return p;
+}
+
+template <class A>
+inline void timed_deallocate(void* p, size_t n, recorder& r) {
+  if ((++r.tick & SAMPLE_MASK) != 0) {
+    A::deallocate(p, n);
+    return;
+  }
+  bench_clock::time_point t0 = bench_clock::now();
+  A::deallocate(p, n);
+  bench_clock::time_point t1 = bench_clock::now();
+  r.samples.push_back(
+      (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0)
+          .count());
+}
+
+enum size_mix { FIXED_16, FIXED_64, FIXED_256, FIXED_4K, RANDOM_MIX };
+enum free_order { LIFO, FIFO, RANDOM_ORDER };
+
+const char* mix_name(size_mix mix) {
+  static const char* names[] = {"fixed16", "fixed64", "fixed256", "fixed4k",
+                                "random"};
+  return names[mix];
+}
+
+const char* order_name(free_order order) {
+  static const char* names[] = {"lifo", "fifo", "random"};
+  return names[order];
+}
+
+// 随机大小: 80%不超过128字节, 15%不超过4KB, 5%不超过32KB
+std::vector<size_t> make_sizes(size_mix mix, size_t count, unsigned seed) {
+  static const size_t fixed[] = {16, 64, 256, 4096};
+  std::vector<size_t> sizes(count);
+  std::mt19937 rng(seed);
+  for (size_t i = 0; i < count; ++i) {
+    if (mix != RANDOM_MIX) {
+      sizes[i] = fixed[mix];
+      continue;
+    }
+    unsigned r = rng() % 100;
+    size_t limit = r < 80 ? 128 : (r < 95 ? 4096 : 32 * 1024);
+    sizes[i] = 1 + rng() % limit;
+  }
+  return sizes;
+}
+
+// 同时存活的区块数
+enum { LIVE_OBJS = 1000 };
+
+struct bench_config {
+  size_t ops;
+  unsigned max_threads;
+  std::string filter;
+};
+
+// 一个线程的工作: 每轮分配LIVE_OBJS个区块, 再按order回收
+template <class A>
+void churn(size_mix mix, free_order order, size_t ops, unsigned seed,
+           recorder& r) {
+  std::vector<size_t> sizes = make_sizes(mix, LIVE_OBJS * 8, seed);
+  std::vector<size_t> perm(LIVE_OBJS);
+  for (size_t i = 0; i < perm.size(); ++i) {
+    perm[i] = order == LIFO ? LIVE_OBJS - 1 - i : i;
+  }
+  if (order == RANDOM_ORDER) {
+    std::shuffle(perm.begin(), perm.end(), std::mt19937(seed + 1));
+  }
+  std::vector<void*> live(LIVE_OBJS);
+  r.samples.reserve(ops / (SAMPLE_MASK + 1) + 1);
+  size_t base = 0;
+  for (size_t done = 0; done < ops; done += 2 * LIVE_OBJS) {
+    for (size_t i = 0; i < LIVE_OBJS; ++i) {
+      size_t n = sizes[(base + i) % sizes.size()];
+      live[i] = timed_allocate<A>(n, r);
+      *(char*)live[i] = 1;
+    }
+    for (size_t j = 0; j < LIVE_OBJS; ++j) {
+      size_t i = perm[j];
+      timed_deallocate<A>(live[i], sizes[(base + i) % sizes.size()], r);
+    }
+    base += LIVE_OBJS;
+  }
+}
+
+// 单生产者单消费者的环形队列
+struct ring {
+  enum { CAPACITY = 4096 };
+  struct item {
+    void* p;
+    size_t n;
+  };
+  item items[CAPACITY];
+  std::atomic<size_t> head;  // 消费者位置
+  std::atomic<size_t> tail;  // 生产者位置
+  ring() : head(0), tail(0) {}
+  void push(const item& x) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    while (t - head.load(std::memory_order_acquire) == CAPACITY) {
+      std::this_thread::yield();
+    }
+    items[t % CAPACITY] = x;
+    tail.store(t + 1, std::memory_order_release);
+  }
+  item pop() {
+    size_t h = head.load(std::memory_order_relaxed);
+    while (tail.load(std::memory_order_acquire) == h) {
+      std::this_thread::yield();
+    }
+    item x = items[h % CAPACITY];
+    head.store(h + 1, std::memory_order_release);
+    return x;
+  }
+};
+
+template <class A>
+void produce(ring& q, size_mix mix, size_t ops, unsigned seed, recorder& r) {
+  std::vector<size_t> sizes = make_sizes(mix, LIVE_OBJS * 8, seed);
+  r.samples.reserve(ops / (SAMPLE_MASK + 1) + 1);
+  for (size_t i = 0; i < ops; ++i) {
+    ring::item x;
+    x.n = sizes[i % sizes.size()];
+    x.p = timed_allocate<A>(x.n, r);
+    *(char*)x.p = 1;
+    q.push(x);
+  }
+}
+
+template <class A>
+void consume(ring& q, size_t ops, recorder& r) {
+  r.samples.reserve(ops / (SAMPLE_MASK + 1) + 1);
+  for (size_t i = 0; i < ops; ++i) {
+    ring::item x = q.pop();
+    timed_deallocate<A>(x.p, x.n, r);
+  }
+}
+
+struct bench_result {
+  size_t ops;
+  double seconds;
+  std::vector<uint32_t> samples;
+};
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, double q) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t i = (size_t)(q * (sorted.size() - 1));
+  return sorted[i];
+}
+
+long peak_rss_kb() {
+#if defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return 0;
+#endif
+}
+
+void report(const std::string& name, const char* allocator, unsigned threads,
+            bench_result& r) {
+  std::sort(r.samples.begin(), r.samples.end());
+  std::printf("%-28s %-16s %7u %10.2f %8u %8u %8u %12ld\n", name.c_str(),
+              allocator, threads, r.ops / r.seconds / 1e6,
+              percentile(r.samples, 0.5), percentile(r.samples, 0.99),
+              percentile(r.samples, 0.999), peak_rss_kb());
+}
+
+void merge(bench_result& result, std::vector<recorder>& recorders) {
+  for (size_t i = 0; i < recorders.size(); ++i) {
+    result.samples.insert(result.samples.end(), recorders[i].samples.begin(),
+                          recorders[i].samples.end());
+  }
+}
+
+// threads个线程各自独立地分配和回收
+template <class A>
+bench_result run_churn(size_mix mix, free_order order, unsigned threads,
+                       size_t ops) {
+  std::vector<recorder> recorders(threads);
+  std::vector<std::thread> workers;
+  bench_clock::time_point t0 = bench_clock::now();
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.push_back(std::thread(churn<A>, mix, order, ops, 12345 + t,
+                                  std::ref(recorders[t])));
+  }
+  for (size_t t = 0; t < workers.size(); ++t) {
+    workers[t].join();
+  }
+  bench_result result;
+  result.seconds =
+      std::chrono::duration<double>(bench_clock::now() - t0).count();
+  result.ops = (ops + 2 * LIVE_OBJS - 1) / (2 * LIVE_OBJS) * 2 * LIVE_OBJS *
+               threads;
+  merge(result, recorders);
+  return result;
+}
+
+// threads / 2对生产者和消费者, 所有区块都由另一个线程回收
+template <class A>
+bench_result run_producer_consumer(size_mix mix, unsigned threads,
+                                   size_t ops) {
+  unsigned pairs = threads / 2;
+  std::unique_ptr<ring[]> queues(new ring[pairs]);
+  std::vector<recorder> recorders(threads);
+  std::vector<std::thread> workers;
+  bench_clock::time_point t0 = bench_clock::now();
+  for (unsigned i = 0; i < pairs; ++i) {
+    workers.push_back(std::thread(produce<A>, std::ref(queues[i]), mix,
+                                  ops / 2, 12345 + i,
+                                  std::ref(recorders[2 * i])));
+    workers.push_back(std::thread(consume<A>, std::ref(queues[i]), ops / 2,
+                                  std::ref(recorders[2 * i + 1])));
+  }
+  for (size_t t = 0; t < workers.size(); ++t) {
+    workers[t].join();
+  }
+  bench_result result;
+  result.seconds =
+      std::chrono::duration<double>(bench_clock::now() - t0).count();
+  result.ops = ops / 2 * 2 * pairs;
+  merge(result, recorders);
+  return result;
+}
+
+bool selected(const bench_config& config, const std::string& name,
+              const char* allocator) {
+  return config.filter.empty() ||
+         name.find(config.filter) != std::string::npos ||
+         std::string(allocator).find(config.filter) != std::string::npos;
+}
+
+// 在子进程中运行一个用例, 结束后子进程退出, 内存池和RSS都不会带到下一个用例
+template <class Run>
+void isolate(Run run) {
+#if defined(__unix__) || defined(__APPLE__)
+  std::fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    run();
+    std::fflush(stdout);
+    _exit(0);
+  }
+  if (pid > 0) {
+    int status;
+    waitpid(pid, &status, 0);
+    return;
+  }
+#endif
+  run();
+}
+
+template <class A>
+void run_all(const bench_config& config) {
+  static const size_mix mixes[] = {FIXED_16, FIXED_64, FIXED_256, FIXED_4K,
+                                   RANDOM_MIX};
+  static const free_order orders[] = {LIFO, FIFO, RANDOM_ORDER};
+  // 单线程: 各种大小和回收顺序
+  for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); ++m) {
+    for (size_t o = 0; o < sizeof(orders) / sizeof(orders[0]); ++o) {
+      std::string name = std::string("churn/") + mix_name(mixes[m]) + "/" +
+                         order_name(orders[o]);
+      if (!selected(config, name, A::name())) {
+        continue;
+      }
+      size_mix mix = mixes[m];
+      free_order order = orders[o];
+      size_t ops = config.ops;
+      isolate([=]() {
+        bench_result r = run_churn<A>(mix, order, 1, ops);
+        report(name, A::name(), 1, r);
+      });
+    }
+  }
+  // 多线程扩展: 随机大小, 随机回收顺序
+  for (unsigned threads = 1; threads <= config.max_threads; threads *= 2) {
+    std::string name = "scale/random/random";
+    if (!selected(config, name, A::name())) {
+      continue;
+    }
+    size_t ops = config.ops;
+    isolate([=]() {
+      bench_result r = run_churn<A>(RANDOM_MIX, RANDOM_ORDER, threads, ops);
+      report(name, A::name(), threads, r);
+    });
+  }
+  // 跨线程回收
+  for (unsigned threads = 2; threads <= config.max_threads; threads *= 2) {
+    for (size_mix mix : {FIXED_64, RANDOM_MIX}) {
+      std::string name = std::string("producer_consumer/") + mix_name(mix);
+      if (!selected(config, name, A::name())) {
+        continue;
+      }
+      size_t ops = config.ops;
+      isolate([=]() {
+        bench_result r = run_producer_consumer<A>(mix, threads, ops);
+        report(name, A::name(), threads, r);
+      });
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench_config config;
+  config.ops = 1000000;
+  config.max_threads = 8;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    if (flag == "--ops") {
+      config.ops = std::strtoul(argv[i + 1], 0, 10);
+    } else if (flag == "--threads") {
+      config.max_threads = (unsigned)std::strtoul(argv[i + 1], 0, 10);
+    } else if (flag == "--filter") {
+      config.filter = argv[i + 1];
+    } else {
+      std::fprintf(stderr,
+                   "usage: %s [--ops N] [--threads N] [--filter substr]\n",
+                   argv[0]);
+      return 1;
+    }
+  }
+  std::printf("%-28s %-16s %7s %10s %8s %8s %8s %12s\n", "case", "allocator",
+              "threads", "Mops/s", "p50_ns", "p99_ns", "p999_ns",
+              "peak_rss_kb");
+  run_all<pool_bench>(config);
+  run_all<malloc_bench>(config);
+  run_all<allocator_bench>(config);
+  run_all<std_allocator_bench>(config);
+  return 0;
+}
@@ -0,0 +1,237 @@
+// 分配跟踪回放工具: 用MINISTL_ALLOC_TRACE记录下来的真实分配序列驱动各个配置器,
+// 报告回放时间, 峰值占用和碎片率, 用来评估等级划分, refill批量等改动
+//
+// 用法: alloc_replay 跟踪文件 [--inst N] [--filter 配置器名]
+//   --inst    只回放模板参数inst为N的内存池的记录
+//   --filter  只回放名字包含该子串的配置器
+//
+// 各线程的记录按时间排序后在一个线程中依次回放, 地址只用来配对分配和回收,
+// 回放前先把地址换成连续的槽位编号, 计时部分不含查找开销
+// 峰值占用 = 回放期间的峰值RSS - 回放开始前的RSS, 碎片率 = 1 - 峰值存活字节数 / 峰值占用
+// 回放时每个区块的每一页都写一次, 占用的物理内存与真实程序相近
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench/bench_allocators.h"
+#include "include/alloc_trace.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct single_client_bench {
+  static const char* name() { return "single_client_alloc"; }
+  static void* allocate(size_t n) {
+    return ministl::single_client_alloc::allocate(n);
+  }
+  static void deallocate(void* p, size_t n) {
+    ministl::single_client_alloc::deallocate(p, n);
+  }
+};
+
+// 预处理后的一次操作
+struct replay_op {
+  uint32_t slot;
+  uint32_t size;
+  bool allocate;
+};
+
+struct replay_trace {
+  std::vector<replay_op> ops;
+  size_t nslots;
+  size_t peak_live_bytes;
+  size_t unmatched;  // 找不到对应分配的回收, 以及被覆盖的分配
+};
+
+// 按时间排序, 把地址换成槽位编号, 同时算出峰值存活字节数
+void prepare(std::vector<ministl::alloc_trace_event>& events, int inst,
+             replay_trace& trace) {
+  std::stable_sort(events.begin(), events.end(),
+                   [](const ministl::alloc_trace_event& a,
+                      const ministl::alloc_trace_event& b) {
+                     return a.time < b.time;
+                   });
+  std::unordered_map<uint64_t, replay_op> live;
+  size_t live_bytes = 0;
+  trace.nslots = 0;
+  trace.peak_live_bytes = 0;
+  trace.unmatched = 0;
+  for (size_t i = 0; i < events.size(); ++i) {
+    const ministl::alloc_trace_event& e = events[i];
+    if (inst >= 0 && e.inst != inst) {
+      continue;
+    }
+    if (e.op == ministl::alloc_trace_event::ALLOCATE) {
+      replay_op op;
+      op.slot = (uint32_t)trace.nslots++;
+      op.size = e.size == 0 ? 1 : e.size;
+      op.allocate = true;
+      std::pair<std::unordered_map<uint64_t, replay_op>::iterator, bool> r =
+          live.insert(std::make_pair(e.addr, op));
+      if (!r.second) {
+        // 丢失了回收记录, 先回收旧的区块
+        replay_op old = r.first->second;
+        old.allocate = false;
+        trace.ops.push_back(old);
+        live_bytes -= old.size;
+        r.first->second = op;
+        ++trace.unmatched;
+      }
+      trace.ops.push_back(op);
+      live_bytes += op.size;
+      trace.peak_live_bytes = std::max(trace.peak_live_bytes, live_bytes);
+    } else {
+      std::unordered_map<uint64_t, replay_op>::iterator it = live.find(e.addr);
+      if (it == live.end()) {
+        ++trace.unmatched;
+        continue;
+      }
+      replay_op op = it->second;
+      op.allocate = false;
+      trace.ops.push_back(op);
+      live_bytes -= op.size;
+      live.erase(it);
+    }
+  }
+}
+
+long current_rss_kb() {
+#if defined(__linux__)
+  long pages = 0, resident = 0;
+  FILE* f = fopen("/proc/self/statm", "r");
+  if (f != 0) {
+    if (fscanf(f, "%ld %ld", &pages, &resident) != 2) {
+      resident = 0;
+    }
+    fclose(f);
+  }
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+  return 0;
+#endif
+}
+
+long peak_rss_kb() {
+#if defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return 0;
+#endif
+}
+
+template <class A>
+void replay(const replay_trace& trace) {
+  std::vector<void*> slots(trace.nslots);
+  long base_rss = current_rss_kb();
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < trace.ops.size(); ++i) {
+    const replay_op& op = trace.ops[i];
+    if (op.allocate) {
+      char* p = (char*)A::allocate(op.size);
+      // 每页写一个字节, 让区块真正占用物理内存
+      for (size_t off = 0; off < op.size; off += 4096) {
+        p[off] = 1;
+      }
+      slots[op.slot] = p;
+    } else {
+      A::deallocate(slots[op.slot], op.size);
+      slots[op.slot] = 0;
+    }
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - t0)
+                       .count();
+  long footprint = peak_rss_kb() - base_rss;
+  for (size_t i = 0; i < trace.ops.size(); ++i) {
+    const replay_op& op = trace.ops[i];
+    if (op.allocate && slots[op.slot] != 0) {
+      A::deallocate(slots[op.slot], op.size);
+      slots[op.slot] = 0;
+    }
+  }
+  double fragmentation =
+      footprint <= 0 ? 0.0
+                     : 1.0 - (double)trace.peak_live_bytes / 1024 / footprint;
+  std::printf("%-20s %12zu %10.4f %10.2f %14zu %18ld %14.3f\n", A::name(),
+              trace.ops.size(), seconds, trace.ops.size() / seconds / 1e6,
+              trace.peak_live_bytes / 1024, footprint, fragmentation);
+}
+
+// 每个配置器在单独的子进程里回放, 互不影响内存池状态和峰值RSS
+template <class A>
+void run(const replay_trace& trace, const std::string& filter) {
+  if (!filter.empty() &&
+      std::string(A::name()).find(filter) == std::string::npos) {
+    return;
+  }
+#if defined(__unix__) || defined(__APPLE__)
+  std::fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    replay<A>(trace);
+    std::fflush(stdout);
+    _exit(0);
+  }
+  if (pid > 0) {
+    int status;
+    waitpid(pid, &status, 0);
+    return;
+  }
+#endif
+  replay<A>(trace);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s trace-file [--inst N] [--filter name]\n",
+                 argv[0]);
+    return 1;
+  }
+  int inst = -1;
+  std::string filter;
+  for (int i = 2; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    if (flag == "--inst") {
+      inst = std::atoi(argv[i + 1]);
+    } else if (flag == "--filter") {
+      filter = argv[i + 1];
+    }
+  }
+  std::vector<ministl::alloc_trace_event> events;
+  if (!ministl::alloc_trace_read(argv[1], events)) {
+    std::fprintf(stderr, "%s: not a ministl allocation trace\n", argv[1]);
+    return 1;
+  }
+  replay_trace trace;
+  prepare(events, inst, trace);
+  std::vector<ministl::alloc_trace_event>().swap(events);
+  std::printf("# %zu ops, peak live %zu KB, %zu unmatched\n", trace.ops.size(),
+              trace.peak_live_bytes / 1024, trace.unmatched);
+  std::printf("%-20s %12s %10s %10s %14s %18s %14s\n", "allocator", "ops",
+              "seconds", "Mops/s", "peak_live_kb", "peak_footprint_kb",
+              "fragmentation");
+  run<single_client_bench>(trace, filter);
+  run<pool_bench>(trace, filter);
+  run<malloc_bench>(trace, filter);
+  run<allocator_bench>(trace, filter);
+  run<std_allocator_bench>(trace, filter);
+  return 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// 基准测试和回放工具共用的被测配置器, 统一成按字节分配的静态接口
+// 包含本文件之前可以定义__NODE_ALLOCATOR_THREADS为true, 让alloc线程安全
+
+#include <cstddef>
+#include <memory>
+
+#include "include/alloc.h"
+#include "include/allocator.h"
+
+namespace {
+
+struct pool_bench {
+  static const char* name() { return "alloc"; }
+  static void* allocate(size_t n) { return ministl::alloc::allocate(n); }
+  static void deallocate(void* p, size_t n) {
+    ministl::alloc::deallocate(p, n);
+  }
+};
+
+struct malloc_bench {
+  static const char* name() { return "malloc_alloc"; }
+  static void* allocate(size_t n) { return ministl::malloc_alloc::allocate(n); }
+  static void deallocate(void* p, size_t n) {
+    ministl::malloc_alloc::deallocate(p, n);
+  }
+};
+
+struct allocator_bench {
+  static const char* name() { return "allocator<T>"; }
+  static void* allocate(size_t n) {
+    return ministl::allocator<char>().allocate(n);
+  }
+  static void deallocate(void* p, size_t n) {
+    ministl::allocator<char>().deallocate((char*)p, n);
+  }
+};
+
+struct std_allocator_bench {
+  static const char* name() { return "std::allocator"; }
+  static void* allocate(size_t n) { return std::allocator<char>().allocate(n); }
+  static void deallocate(void* p, size_t n) {
+    std::allocator<char>().deallocate((char*)p, n);
+  }
+};
+
+}  // namespace
@@ -0,0 +1,1068 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "algobase.h"
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+#include "uninitialized.h"
+
+namespace ministl {
+
+// 排序算法: sort, stable_sort, partial_sort, nth_element,
+// 以及它们用到的堆算法 make_heap, push_heap, pop_heap, sort_heap
+// 都只接受随机访问迭代器, 由iterator_category分派
+// sort是pattern-defeating quicksort: 小区间插入排序, 三数/九数取中选枢轴,
+// 算术类型用无分支的块划分, 划分极不均衡时打乱若干元素, 次数过多时改用堆排序
+// 整数和浮点数(is_POD_type)用默认比较时, 元素足够多就改用LSD基数排序
+
+enum {
+  __PDQ_INSERTION_SORT_THRESHOLD = 24,  // 小于这个长度用插入排序
+  __PDQ_NINTHER_THRESHOLD = 128,        // 大于这个长度用九数取中
+  __PDQ_PARTIAL_INSERTION_SORT_LIMIT = 8,
+  __PDQ_BLOCK_SIZE = 64,                // 块划分一次收集的元素个数
+  __PDQ_CACHELINE_SIZE = 64,
+  __RADIX_SORT_THRESHOLD = 1024         // 不少于这个长度才用基数排序
+};
+
+// 默认比较
+struct __less {
+  template <class T, class U>
+  bool operator()(const T& x, const U& y) const {
+    return x < y;
+  }
+};
+
+template <class Size>
+inline int __lg(Size n) {
+  int k = 0;
+  for (; n > 1; n >>= 1) {
+    ++k;
+  }
+  return k;
+}
+
+// 堆算法, 与SGI相同: 大根堆, 下标i的子节点是2i+1和2i+2
+
+// 从holeIndex往上找value的位置, 不超过topIndex
+template <class RandomAccessIterator, class Distance, class T, class Compare>
+void __push_heap(RandomAccessIterator first, Distance holeIndex,
+                 Distance topIndex, T value, Compare& comp) {
+  Distance parent = (holeIndex - 1) / 2;
+  while (holeIndex > topIndex && comp(*(first + parent), value)) {
+    *(first + holeIndex) = std::move(*(first + parent));
+    holeIndex = parent;
+    parent = (holeIndex - 1) / 2;
+  }
+  *(first + holeIndex) = std::move(value);
+}
+
+// holeIndex处是空洞, 先一路把较大的子节点上移到叶子, 再从叶子把value推上去
+template <class RandomAccessIterator, class Distance, class T, class Compare>
+void __adjust_heap(RandomAccessIterator first, Distance holeIndex, Distance len,
+                   T value, Compare& comp) {
+  Distance topIndex = holeIndex;
+  Distance secondChild = 2 * holeIndex + 2;
+  while (secondChild < len) {
+    if (comp(*(first + secondChild), *(first + (secondChild - 1)))) {
+      --secondChild;
+    }
+    *(first + holeIndex) = std::move(*(first + secondChild));
+    holeIndex = secondChild;
+    secondChild = 2 * (secondChild + 1);
+  }
+  if (secondChild == len) {
+    *(first + holeIndex) = std::move(*(first + (secondChild - 1)));
+    holeIndex = secondChild - 1;
+  }
+  ministl::__push_heap(first, holeIndex, topIndex, std::move(value), comp);
+}
+
+// 堆顶移到result, result原来的值放进[first, last)这个堆
+template <class RandomAccessIterator, class Compare>
+inline void __pop_heap(RandomAccessIterator first, RandomAccessIterator last,
+                       RandomAccessIterator result, Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  T value = std::move(*result);
+  *result = std::move(*first);
+  ministl::__adjust_heap(first, Distance(0), Distance(last - first), std::move(value),
+                comp);
+}
+
+template <class RandomAccessIterator, class Compare>
+void __make_heap(RandomAccessIterator first, RandomAccessIterator last,
+                 Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  Distance len = last - first;
+  if (len < 2) {
+    return;
+  }
+  for (Distance parent = (len - 2) / 2;; --parent) {
+    T value = std::move(*(first + parent));
+    ministl::__adjust_heap(first, parent, len, std::move(value), comp);
+    if (parent == 0) {
+      return;
+    }
+  }
+}
+
+template <class RandomAccessIterator, class Compare>
+void __sort_heap(RandomAccessIterator first, RandomAccessIterator last,
+                 Compare& comp) {
+  for (; last - first > 1; --last) {
+    ministl::__pop_heap(first, last - 1, last - 1, comp);
+  }
+}
+
+// 新元素已经放在last - 1
+template <class RandomAccessIterator, class Compare>
+inline void push_heap(RandomAccessIterator first, RandomAccessIterator last,
+                      Compare comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  T value = std::move(*(last - 1));
+  ministl::__push_heap(first, Distance((last - first) - 1), Distance(0),
+              std::move(value), comp);
+}
+template <class RandomAccessIterator>
+inline void push_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  ministl::push_heap(first, last, __less());
+}
+
+// 堆顶移到last - 1
+template <class RandomAccessIterator, class Compare>
+inline void pop_heap(RandomAccessIterator first, RandomAccessIterator last,
+                     Compare comp) {
+  if (last - first > 1) {
+    ministl::__pop_heap(first, last - 1, last - 1, comp);
+  }
+}
+template <class RandomAccessIterator>
+inline void pop_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  ministl::pop_heap(first, last, __less());
+}
+
+template <class RandomAccessIterator, class Compare>
+inline void make_heap(RandomAccessIterator first, RandomAccessIterator last,
+                      Compare comp) {
+  ministl::__make_heap(first, last, comp);
+}
+template <class RandomAccessIterator>
+inline void make_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  ministl::make_heap(first, last, __less());
+}
+
+template <class RandomAccessIterator, class Compare>
+inline void sort_heap(RandomAccessIterator first, RandomAccessIterator last,
+                      Compare comp) {
+  ministl::__sort_heap(first, last, comp);
+}
+template <class RandomAccessIterator>
+inline void sort_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  ministl::sort_heap(first, last, __less());
+}
+
+// pdqsort的各个部件
+
+template <class RandomAccessIterator, class Compare>
+void __insertion_sort(RandomAccessIterator first, RandomAccessIterator last,
+                      Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  if (first == last) {
+    return;
+  }
+  for (RandomAccessIterator cur = first + 1; cur != last; ++cur) {
+    RandomAccessIterator sift = cur;
+    RandomAccessIterator sift_1 = cur - 1;
+    // 已经在正确位置上的元素不用移动
+    if (comp(*sift, *sift_1)) {
+      T tmp = std::move(*sift);
+      do {
+        *sift-- = std::move(*sift_1);
+      } while (sift != first && comp(tmp, *--sift_1));
+      *sift = std::move(tmp);
+    }
+  }
+}
+
+// *(first - 1)不大于区间内的任何元素, 可以省掉边界检查
+template <class RandomAccessIterator, class Compare>
+void __unguarded_insertion_sort(RandomAccessIterator first,
+                                RandomAccessIterator last, Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  if (first == last) {
+    return;
+  }
+  for (RandomAccessIterator cur = first + 1; cur != last; ++cur) {
+    RandomAccessIterator sift = cur;
+    RandomAccessIterator sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      T tmp = std::move(*sift);
+      do {
+        *sift-- = std::move(*sift_1);
+      } while (comp(tmp, *--sift_1));
+      *sift = std::move(tmp);
+    }
+  }
+}
+
+// 插入排序, 但移动的元素超过__PDQ_PARTIAL_INSERTION_SORT_LIMIT个就放弃,
+// 返回是否已经排好
+template <class RandomAccessIterator, class Compare>
+bool __partial_insertion_sort(RandomAccessIterator first,
+                              RandomAccessIterator last, Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  if (first == last) {
+    return true;
+  }
+  size_t limit = 0;
+  for (RandomAccessIterator cur = first + 1; cur != last; ++cur) {
+    RandomAccessIterator sift = cur;
+    RandomAccessIterator sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      T tmp = std::move(*sift);
+      do {
+        *sift-- = std::move(*sift_1);
+      } while (sift != first && comp(tmp, *--sift_1));
+      *sift = std::move(tmp);
+      limit += cur - sift;
+    }
+    if (limit > (size_t)__PDQ_PARTIAL_INSERTION_SORT_LIMIT) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class RandomAccessIterator, class Compare>
+inline void __sort2(RandomAccessIterator a, RandomAccessIterator b,
+                    Compare& comp) {
+  if (comp(*b, *a)) {
+    ministl::iter_swap(a, b);
+  }
+}
+
+// 排好后*a <= *b <= *c
+template <class RandomAccessIterator, class Compare>
+inline void __sort3(RandomAccessIterator a, RandomAccessIterator b,
+                    RandomAccessIterator c, Compare& comp) {
+  ministl::__sort2(a, b, comp);
+  ministl::__sort2(b, c, comp);
+  ministl::__sort2(a, b, comp);
+}
+
+// 把中位数(长区间用九数取中)放到*first, 并保证区间内有不小于它的元素在后面
+template <class RandomAccessIterator, class Compare>
+inline void __choose_pivot(RandomAccessIterator first,
+                           RandomAccessIterator last, Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  Distance size = last - first;
+  Distance s2 = size / 2;
+  if (size > (Distance)__PDQ_NINTHER_THRESHOLD) {
+    ministl::__sort3(first, first + s2, last - 1, comp);
+    ministl::__sort3(first + 1, first + (s2 - 1), last - 2, comp);
+    ministl::__sort3(first + 2, first + (s2 + 1), last - 3, comp);
+    ministl::__sort3(first + (s2 - 1), first + s2, first + (s2 + 1), comp);
+    ministl::iter_swap(first, first + s2);
+  } else {
+    ministl::__sort3(first + s2, first, last - 1, comp);
+  }
+}
+
+// 交换块划分收集到的num对位置, 两边个数相同时逐对交换,
+// 否则用一个临时值循环移动, 每个元素只移动一次
+template <class RandomAccessIterator>
+inline void __swap_offsets(RandomAccessIterator first,
+                           RandomAccessIterator last,
+                           unsigned char* offsets_l, unsigned char* offsets_r,
+                           size_t num, bool use_swaps) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  if (use_swaps) {
+    for (size_t i = 0; i < num; ++i) {
+      ministl::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+    }
+  } else if (num > 0) {
+    RandomAccessIterator l = first + offsets_l[0];
+    RandomAccessIterator r = last - offsets_r[0];
+    T tmp(std::move(*l));
+    *l = std::move(*r);
+    for (size_t i = 1; i < num; ++i) {
+      l = first + offsets_l[i];
+      *r = std::move(*l);
+      r = last - offsets_r[i];
+      *l = std::move(*r);
+    }
+    *r = std::move(tmp);
+  }
+}
+
+// 以*first为枢轴划分, 小于枢轴的在左边, 不小于的在右边, 返回枢轴的位置,
+// 以及区间是否本来就已经划分好. 调用前要用__choose_pivot选好枢轴
+// 无分支版本: 两端各取一块, 比较结果只用来累加下标, 再成对交换放错边的元素
+template <class RandomAccessIterator, class Compare>
+std::pair<RandomAccessIterator, bool> __partition_right_branchless(
+    RandomAccessIterator begin, RandomAccessIterator end, Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  T pivot(std::move(*begin));
+  RandomAccessIterator first = begin;
+  RandomAccessIterator last = end;
+  // 找到第一个不小于枢轴的元素, 取中保证它存在
+  while (comp(*++first, pivot)) {
+  }
+  // 找到最后一个小于枢轴的元素, first前面没有元素时要检查边界
+  if (first - 1 == begin) {
+    while (first < last && !comp(*--last, pivot)) {
+    }
+  } else {
+    while (!comp(*--last, pivot)) {
+    }
+  }
+  bool already_partitioned = first >= last;
+  if (!already_partitioned) {
+    ministl::iter_swap(first, last);
+    ++first;
+    // 偏移量数组按缓存行对齐
+    unsigned char offsets_l_storage[__PDQ_BLOCK_SIZE + __PDQ_CACHELINE_SIZE];
+    unsigned char offsets_r_storage[__PDQ_BLOCK_SIZE + __PDQ_CACHELINE_SIZE];
+    unsigned char* offsets_l =
+        (unsigned char*)(((uintptr_t)offsets_l_storage + __PDQ_CACHELINE_SIZE -
+                          1) &
+                         ~(uintptr_t)(__PDQ_CACHELINE_SIZE - 1));
+    unsigned char* offsets_r =
+        (unsigned char*)(((uintptr_t)offsets_r_storage + __PDQ_CACHELINE_SIZE -
+                          1) &
+                         ~(uintptr_t)(__PDQ_CACHELINE_SIZE - 1));
+    RandomAccessIterator offsets_l_base = first;
+    RandomAccessIterator offsets_r_base = last;
+    size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+    while (first < last) {
+      // 决定这一轮两边各看多少个元素
+      size_t num_unknown = last - first;
+      size_t left_split =
+          num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+      size_t right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+      // 收集放错边的元素的偏移量
+      if (left_split >= (size_t)__PDQ_BLOCK_SIZE) {
+        for (size_t i = 0; i < (size_t)__PDQ_BLOCK_SIZE;) {
+          for (int k = 0; k < 8; ++k) {
+            offsets_l[num_l] = (unsigned char)i++;
+            num_l += !comp(*first, pivot);
+            ++first;
+          }
+        }
+      } else {
+        for (size_t i = 0; i < left_split;) {
+          offsets_l[num_l] = (unsigned char)i++;
+          num_l += !comp(*first, pivot);
+          ++first;
+        }
+      }
+      if (right_split >= (size_t)__PDQ_BLOCK_SIZE) {
+        for (size_t i = 0; i < (size_t)__PDQ_BLOCK_SIZE;) {
+          for (int k = 0; k < 8; ++k) {
+            offsets_r[num_r] = (unsigned char)++i;
+            num_r += comp(*--last, pivot);
+          }
+        }
+      } else {
+        for (size_t i = 0; i < right_split;) {
+          offsets_r[num_r] = (unsigned char)++i;
+          num_r += comp(*--last, pivot);
+        }
+      }
+      // 成对交换, 用完的一边重新开始收集
+      size_t num = num_l < num_r ? num_l : num_r;
+      ministl::__swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l,
+                     offsets_r + start_r, num, num_l == num_r);
+      num_l -= num;
+      num_r -= num;
+      start_l += num;
+      start_r += num;
+      if (num_l == 0) {
+        start_l = 0;
+        offsets_l_base = first;
+      }
+      if (num_r == 0) {
+        start_r = 0;
+        offsets_r_base = last;
+      }
+    }
+    // 剩下的一边还有放错的元素, 逐个换到中间
+    if (num_l) {
+      offsets_l += start_l;
+      while (num_l--) {
+        ministl::iter_swap(offsets_l_base + offsets_l[num_l], --last);
+      }
+      first = last;
+    }
+    if (num_r) {
+      offsets_r += start_r;
+      while (num_r--) {
+        ministl::iter_swap(offsets_r_base - offsets_r[num_r], first);
+        ++first;
+      }
+      last = first;
+    }
+  }
+  RandomAccessIterator pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return std::make_pair(pivot_pos, already_partitioned);
+}
+
+// 与上面相同, 一般的比较函数用普通的Hoare划分
+template <class RandomAccessIterator, class Compare>
+std::pair<RandomAccessIterator, bool> __partition_right(
+    RandomAccessIterator begin, RandomAccessIterator end, Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  T pivot(std::move(*begin));
+  RandomAccessIterator first = begin;
+  RandomAccessIterator last = end;
+  while (comp(*++first, pivot)) {
+  }
+  if (first - 1 == begin) {
+    while (first < last && !comp(*--last, pivot)) {
+    }
+  } else {
+    while (!comp(*--last, pivot)) {
+    }
+  }
+  bool already_partitioned = first >= last;
+  while (first < last) {
+    ministl::iter_swap(first, last);
+    while (comp(*++first, pivot)) {
+    }
+    while (!comp(*--last, pivot)) {
+    }
+  }
+  RandomAccessIterator pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return std::make_pair(pivot_pos, already_partitioned);
+}
+
+// 与枢轴相等的元素放在左边, 大于枢轴的放在右边, 返回枢轴的位置
+// 用于枢轴等于左边界外那个元素的情况: 左边全都相等, 不用再排
+template <class RandomAccessIterator, class Compare>
+RandomAccessIterator __partition_left(RandomAccessIterator begin,
+                                      RandomAccessIterator end,
+                                      Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  T pivot(std::move(*begin));
+  RandomAccessIterator first = begin;
+  RandomAccessIterator last = end;
+  while (comp(pivot, *--last)) {
+  }
+  if (last + 1 == end) {
+    while (first < last && !comp(pivot, *++first)) {
+    }
+  } else {
+    while (!comp(pivot, *++first)) {
+    }
+  }
+  while (first < last) {
+    ministl::iter_swap(first, last);
+    while (comp(pivot, *--last)) {
+    }
+    while (!comp(pivot, *++first)) {
+    }
+  }
+  RandomAccessIterator pivot_pos = last;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return pivot_pos;
+}
+
+template <class RandomAccessIterator, class Compare>
+inline std::pair<RandomAccessIterator, bool> __partition_right_aux(
+    RandomAccessIterator first, RandomAccessIterator last, Compare& comp,
+    _true_type) {
+  return ministl::__partition_right_branchless(first, last, comp);
+}
+template <class RandomAccessIterator, class Compare>
+inline std::pair<RandomAccessIterator, bool> __partition_right_aux(
+    RandomAccessIterator first, RandomAccessIterator last, Compare& comp,
+    _false_type) {
+  return ministl::__partition_right(first, last, comp);
+}
+
+// 比较很便宜时才值得用无分支划分: 算术类型和默认比较
+template <class T, class Compare>
+struct __pdq_branchless {
+  typedef _false_type type;
+};
+template <class T>
+struct __pdq_branchless<T, __less> {
+  typedef typename std::conditional<std::is_arithmetic<T>::value, _true_type,
+                                    _false_type>::type type;
+};
+
+// bad_allowed是还允许出现的不均衡划分次数, leftmost表示区间左边没有元素
+template <class RandomAccessIterator, class Compare, class Branchless>
+void __pdqsort_loop(RandomAccessIterator begin, RandomAccessIterator end,
+                    Compare& comp, int bad_allowed, bool leftmost,
+                    Branchless branchless) {
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  for (;;) {
+    Distance size = end - begin;
+    if (size < (Distance)__PDQ_INSERTION_SORT_THRESHOLD) {
+      if (leftmost) {
+        ministl::__insertion_sort(begin, end, comp);
+      } else {
+        ministl::__unguarded_insertion_sort(begin, end, comp);
+      }
+      return;
+    }
+    ministl::__choose_pivot(begin, end, comp);
+    // *(begin - 1)是上一次划分的枢轴, 区间内没有比它小的元素;
+    // 枢轴与它相等时把相等的元素都划到左边, 左边就不用再排了
+    if (!leftmost && !comp(*(begin - 1), *begin)) {
+      begin = ministl::__partition_left(begin, end, comp) + 1;
+      continue;
+    }
+    std::pair<RandomAccessIterator, bool> part =
+        ministl::__partition_right_aux(begin, end, comp, branchless);
+    RandomAccessIterator pivot_pos = part.first;
+    Distance l_size = pivot_pos - begin;
+    Distance r_size = end - (pivot_pos + 1);
+    if (l_size < size / 8 || r_size < size / 8) {
+      // 划分极不均衡: 次数太多就改用堆排序, 否则交换几个元素打破输入的模式
+      if (--bad_allowed == 0) {
+        ministl::__make_heap(begin, end, comp);
+        ministl::__sort_heap(begin, end, comp);
+        return;
+      }
+      if (l_size >= (Distance)__PDQ_INSERTION_SORT_THRESHOLD) {
+        ministl::iter_swap(begin, begin + l_size / 4);
+        ministl::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+        if (l_size > (Distance)__PDQ_NINTHER_THRESHOLD) {
+          ministl::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+          ministl::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+          ministl::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+          ministl::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+      }
+      if (r_size >= (Distance)__PDQ_INSERTION_SORT_THRESHOLD) {
+        ministl::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        ministl::iter_swap(end - 1, end - r_size / 4);
+        if (r_size > (Distance)__PDQ_NINTHER_THRESHOLD) {
+          ministl::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+          ministl::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+          ministl::iter_swap(end - 2, end - (1 + r_size / 4));
+          ministl::iter_swap(end - 3, end - (2 + r_size / 4));
+        }
+      }
+    } else if (part.second &&
+               ministl::__partial_insertion_sort(begin, pivot_pos, comp) &&
+               ministl::__partial_insertion_sort(pivot_pos + 1, end, comp)) {
+      // 划分均衡且本来就划分好了, 很可能已经有序, 试一试插入排序
+      return;
+    }
+    // 左边递归, 右边循环
+    ministl::__pdqsort_loop(begin, pivot_pos, comp, bad_allowed, leftmost, branchless);
+    begin = pivot_pos + 1;
+    leftmost = false;
+  }
+}
+
+template <class RandomAccessIterator, class Compare>
+inline void __pdqsort(RandomAccessIterator first, RandomAccessIterator last,
+                      Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  if (last - first < 2) {
+    return;
+  }
+  ministl::__pdqsort_loop(first, last, comp, ministl::__lg(last - first), true,
+                 typename __pdq_branchless<T, Compare>::type());
+}
+
+// LSD基数排序: 把元素映射成无符号整数, 顺序与<相同, 每次按一个字节分配
+
+template <size_t N>
+struct __radix_uint;
+template <>
+struct __radix_uint<1> {
+  typedef uint8_t type;
+};
+template <>
+struct __radix_uint<2> {
+  typedef uint16_t type;
+};
+template <>
+struct __radix_uint<4> {
+  typedef uint32_t type;
+};
+template <>
+struct __radix_uint<8> {
+  typedef uint64_t type;
+};
+
+// 无符号整数原样使用, 有符号整数翻转符号位,
+// 浮点数为负时翻转所有位, 否则翻转符号位
+template <class T, bool Floating = std::is_floating_point<T>::value,
+          bool Signed = std::is_signed<T>::value>
+struct __radix_key {
+  typedef typename __radix_uint<sizeof(T)>::type type;
+  static type get(T x) {
+    type u;
+    memcpy(&u, &x, sizeof(T));
+    return u;
+  }
+};
+template <class T>
+struct __radix_key<T, false, true> {
+  typedef typename __radix_uint<sizeof(T)>::type type;
+  static type get(T x) {
+    type u;
+    memcpy(&u, &x, sizeof(T));
+    return type(u ^ (type(1) << (8 * sizeof(T) - 1)));
+  }
+};
+template <class T>
+struct __radix_key<T, true, true> {
+  typedef typename __radix_uint<sizeof(T)>::type type;
+  static type get(T x) {
+    type u;
+    memcpy(&u, &x, sizeof(T));
+    const type sign = type(1) << (8 * sizeof(T) - 1);
+    return (u & sign) ? type(~u) : type(u | sign);
+  }
+};
+
+// 可以基数排序的类型: is_POD_type的整数和浮点数, 且不超过8字节
+template <class T>
+struct __radix_sortable {
+  typedef typename std::conditional<
+      std::is_same<typename type_traits<T>::is_POD_type, _true_type>::value &&
+          (std::is_integral<T>::value || std::is_floating_point<T>::value) &&
+          sizeof(T) <= 8,
+      _true_type, _false_type>::type type;
+};
+
+// 一遍统计出每个字节的直方图, 所有元素这个字节都相同时跳过这一遍;
+// 在[first, last)和buf之间来回分配, 最后结果不在[first, last)时复制回去
+template <class T>
+void __radix_sort_ptr(T* first, T* last, T* buf) {
+  typedef __radix_key<T> key;
+  typedef typename key::type U;
+  enum { BYTES = sizeof(T) };
+  const size_t n = last - first;
+  size_t count[BYTES][256];
+  memset(count, 0, sizeof(count));
+  for (T* p = first; p != last; ++p) {
+    U k = key::get(*p);
+    for (int b = 0; b < BYTES; ++b) {
+      ++count[b][(k >> (8 * b)) & 0xff];
+    }
+  }
+  T* src = first;
+  T* dst = buf;
+  U k0 = key::get(*first);
+  for (int b = 0; b < BYTES; ++b) {
+    size_t* c = count[b];
+    if (c[(k0 >> (8 * b)) & 0xff] == n) {
+      continue;
+    }
+    size_t sum = 0;
+    for (int i = 0; i < 256; ++i) {
+      size_t t = c[i];
+      c[i] = sum;
+      sum += t;
+    }
+    for (T* p = src; p != src + n; ++p) {
+      T x = *p;
+      dst[c[(key::get(x) >> (8 * b)) & 0xff]++] = x;
+    }
+    T* tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+  if (src != first) {
+    memcpy(first, src, n * sizeof(T));
+  }
+}
+
+// 缓冲区至少有__RADIX_SORT_THRESHOLD个元素, 直接用malloc;
+// 并行排序的工作线程也会走到这里, 不能用单线程的alloc
+template <class T>
+inline void __radix_sort(T* first, T* last) {
+  size_t n = last - first;
+  T* buf = simple_alloc<T, malloc_alloc>::allocate(n);
+  ministl::__radix_sort_ptr(first, last, buf);
+  simple_alloc<T, malloc_alloc>::deallocate(buf, n);
+}
+
+// 不是原生指针时先复制到缓冲区里排
+template <class RandomAccessIterator>
+void __radix_sort(RandomAccessIterator first, RandomAccessIterator last) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  size_t n = last - first;
+  T* buf = simple_alloc<T, malloc_alloc>::allocate(2 * n);
+  ministl::copy(first, last, buf);
+  ministl::__radix_sort_ptr(buf, buf + n, buf + n);
+  ministl::copy(buf, buf + n, first);
+  simple_alloc<T, malloc_alloc>::deallocate(buf, 2 * n);
+}
+
+template <class RandomAccessIterator, class Compare>
+inline void __sort(RandomAccessIterator first, RandomAccessIterator last,
+                   Compare& comp, random_access_iterator_tag) {
+  ministl::__pdqsort(first, last, comp);
+}
+
+template <class RandomAccessIterator>
+inline void __sort_default(RandomAccessIterator first,
+                           RandomAccessIterator last, _false_type) {
+  __less comp;
+  ministl::__sort(first, last, comp, iterator_category(first));
+}
+template <class RandomAccessIterator>
+inline void __sort_default(RandomAccessIterator first,
+                           RandomAccessIterator last, _true_type) {
+  if (last - first < (ptrdiff_t)__RADIX_SORT_THRESHOLD) {
+    ministl::__sort_default(first, last, _false_type());
+  } else {
+    ministl::__radix_sort(first, last);
+  }
+}
+
+// 不稳定排序
+template <class RandomAccessIterator>
+inline void sort(RandomAccessIterator first, RandomAccessIterator last) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  ministl::__sort_default(first, last, typename __radix_sortable<T>::type());
+}
+template <class RandomAccessIterator, class Compare>
+inline void sort(RandomAccessIterator first, RandomAccessIterator last,
+                 Compare comp) {
+  ministl::__sort(first, last, comp, iterator_category(first));
+}
+
+// 稳定排序: 有缓冲区时自底向上归并, 元素先移到缓冲区, 之后在两边来回归并;
+// 配置不到缓冲区时原地归并, O(nlog^2n)
+
+enum { __STABLE_SORT_CHUNK = 7 };  // 先用插入排序排好的小段长度
+
+template <class InputIterator1, class InputIterator2, class OutputIterator,
+          class Compare>
+OutputIterator __move_merge(InputIterator1 first1, InputIterator1 last1,
+                            InputIterator2 first2, InputIterator2 last2,
+                            OutputIterator result, Compare& comp) {
+  for (; first1 != last1 && first2 != last2; ++result) {
+    if (comp(*first2, *first1)) {
+      *result = std::move(*first2);
+      ++first2;
+    } else {
+      *result = std::move(*first1);
+      ++first1;
+    }
+  }
+  result = ministl::move(first1, last1, result);
+  return ministl::move(first2, last2, result);
+}
+
+// [first, last)中每step个一段, 两两归并到result
+template <class RandomAccessIterator1, class RandomAccessIterator2,
+          class Distance, class Compare>
+void __merge_sort_loop(RandomAccessIterator1 first, RandomAccessIterator1 last,
+                       RandomAccessIterator2 result, Distance step,
+                       Compare& comp) {
+  Distance two_step = 2 * step;
+  while (last - first >= two_step) {
+    result = ministl::__move_merge(first, first + step, first + step, first + two_step,
+                          result, comp);
+    first += two_step;
+  }
+  step = (last - first) < step ? Distance(last - first) : step;
+  ministl::__move_merge(first, first + step, first + step, last, result, comp);
+}
+
+template <class RandomAccessIterator, class T, class Compare>
+void __merge_sort_with_buffer(RandomAccessIterator first,
+                              RandomAccessIterator last, T* buffer,
+                              Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  Distance len = last - first;
+  Distance step = __STABLE_SORT_CHUNK;
+  for (RandomAccessIterator i = first; last - i > step; i += step) {
+    ministl::__insertion_sort(i, i + step, comp);
+  }
+  ministl::__insertion_sort(first + (len - (len - 1) % step - 1), last, comp);
+  T* buffer_last = buffer + len;
+  // 每一轮两趟: 区间 -> 缓冲区 -> 区间
+  while (step < len) {
+    ministl::__merge_sort_loop(first, last, buffer, step, comp);
+    step *= 2;
+    ministl::__merge_sort_loop(buffer, buffer_last, first, step, comp);
+    step *= 2;
+  }
+}
+
+template <class BidirectionalIterator>
+void __reverse(BidirectionalIterator first, BidirectionalIterator last) {
+  while (first != last && first != --last) {
+    ministl::iter_swap(first, last);
+    ++first;
+  }
+}
+
+// 交换[first, middle)和[middle, last), 返回原来的*first现在的位置
+template <class RandomAccessIterator>
+RandomAccessIterator __rotate(RandomAccessIterator first,
+                              RandomAccessIterator middle,
+                              RandomAccessIterator last) {
+  ministl::__reverse(first, middle);
+  ministl::__reverse(middle, last);
+  ministl::__reverse(first, last);
+  return first + (last - middle);
+}
+
+template <class RandomAccessIterator, class T, class Compare>
+RandomAccessIterator __lower_bound(RandomAccessIterator first,
+                                   RandomAccessIterator last, const T& value,
+                                   Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  Distance len = last - first;
+  while (len > 0) {
+    Distance half = len / 2;
+    RandomAccessIterator middle = first + half;
+    if (comp(*middle, value)) {
+      first = middle + 1;
+      len = len - half - 1;
+    } else {
+      len = half;
+    }
+  }
+  return first;
+}
+
+template <class RandomAccessIterator, class T, class Compare>
+RandomAccessIterator __upper_bound(RandomAccessIterator first,
+                                   RandomAccessIterator last, const T& value,
+                                   Compare& comp) {
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  Distance len = last - first;
+  while (len > 0) {
+    Distance half = len / 2;
+    RandomAccessIterator middle = first + half;
+    if (comp(value, *middle)) {
+      len = half;
+    } else {
+      first = middle + 1;
+      len = len - half - 1;
+    }
+  }
+  return first;
+}
+
+// 没有缓冲区时归并两段: 较长一段对半分, 在另一段中二分找到对应位置, 旋转后递归
+template <class RandomAccessIterator, class Distance, class Compare>
+void __merge_without_buffer(RandomAccessIterator first,
+                            RandomAccessIterator middle,
+                            RandomAccessIterator last, Distance len1,
+                            Distance len2, Compare& comp) {
+  if (len1 == 0 || len2 == 0) {
+    return;
+  }
+  if (len1 + len2 == 2) {
+    if (comp(*middle, *first)) {
+      ministl::iter_swap(first, middle);
+    }
+    return;
+  }
+  RandomAccessIterator first_cut = first;
+  RandomAccessIterator second_cut = middle;
+  Distance len11 = 0;
+  Distance len22 = 0;
+  if (len1 > len2) {
+    len11 = len1 / 2;
+    first_cut = first + len11;
+    second_cut = ministl::__lower_bound(middle, last, *first_cut, comp);
+    len22 = second_cut - middle;
+  } else {
+    len22 = len2 / 2;
+    second_cut = middle + len22;
+    first_cut = ministl::__upper_bound(first, middle, *second_cut, comp);
+    len11 = first_cut - first;
+  }
+  RandomAccessIterator new_middle = ministl::__rotate(first_cut, middle, second_cut);
+  ministl::__merge_without_buffer(first, first_cut, new_middle, len11, len22, comp);
+  ministl::__merge_without_buffer(new_middle, second_cut, last, len1 - len11,
+                         len2 - len22, comp);
+}
+
+template <class RandomAccessIterator, class Compare>
+void __inplace_stable_sort(RandomAccessIterator first,
+                           RandomAccessIterator last, Compare& comp) {
+  if (last - first < 15) {
+    ministl::__insertion_sort(first, last, comp);
+    return;
+  }
+  RandomAccessIterator middle = first + (last - first) / 2;
+  ministl::__inplace_stable_sort(first, middle, comp);
+  ministl::__inplace_stable_sort(middle, last, comp);
+  ministl::__merge_without_buffer(first, middle, last, middle - first, last - middle,
+                         comp);
+}
+
+template <class RandomAccessIterator, class Compare>
+void __stable_sort(RandomAccessIterator first, RandomAccessIterator last,
+                   Compare& comp, random_access_iterator_tag) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  typedef simple_alloc<T, alloc> buffer_allocator;
+  size_t n = last - first;
+  if (n < 15) {
+    ministl::__insertion_sort(first, last, comp);
+    return;
+  }
+  T* buffer;
+  try {
+    buffer = buffer_allocator::allocate(n);
+  } catch (const std::bad_alloc&) {
+    ministl::__inplace_stable_sort(first, last, comp);
+    return;
+  }
+  // 先排好小段再移进缓冲区, 缓冲区中的元素之后由移动赋值覆盖
+  T* buffer_last = buffer;
+  try {
+    buffer_last = ministl::uninitialized_move(first, last, buffer);
+    ministl::move(buffer, buffer_last, first);
+    ministl::__merge_sort_with_buffer(first, last, buffer, comp);
+  } catch (...) {
+    destroy(buffer, buffer_last);
+    buffer_allocator::deallocate(buffer, n);
+    throw;
+  }
+  destroy(buffer, buffer_last);
+  buffer_allocator::deallocate(buffer, n);
+}
+
+template <class RandomAccessIterator>
+inline void __stable_sort_default(RandomAccessIterator first,
+                                  RandomAccessIterator last, _false_type) {
+  __less comp;
+  ministl::__stable_sort(first, last, comp, iterator_category(first));
+}
+// 整数相等就无法区分, 基数排序本身也是稳定的
+template <class RandomAccessIterator>
+inline void __stable_sort_default(RandomAccessIterator first,
+                                  RandomAccessIterator last, _true_type) {
+  if (last - first < (ptrdiff_t)__RADIX_SORT_THRESHOLD) {
+    ministl::__stable_sort_default(first, last, _false_type());
+  } else {
+    ministl::__radix_sort(first, last);
+  }
+}
+
+// 稳定排序, 相等的元素保持原来的相对顺序
+template <class RandomAccessIterator>
+inline void stable_sort(RandomAccessIterator first,
+                        RandomAccessIterator last) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  typedef typename std::conditional<std::is_integral<T>::value,
+                                    typename __radix_sortable<T>::type,
+                                    _false_type>::type radix;
+  ministl::__stable_sort_default(first, last, radix());
+}
+template <class RandomAccessIterator, class Compare>
+inline void stable_sort(RandomAccessIterator first, RandomAccessIterator last,
+                        Compare comp) {
+  ministl::__stable_sort(first, last, comp, iterator_category(first));
+}
+
+// 用[first, middle)建堆, 后面比堆顶小的元素换进来, 最后对堆排序
+template <class RandomAccessIterator, class Compare>
+void __partial_sort(RandomAccessIterator first, RandomAccessIterator middle,
+                    RandomAccessIterator last, Compare& comp,
+                    random_access_iterator_tag) {
+  if (first == middle) {
+    return;
+  }
+  ministl::__make_heap(first, middle, comp);
+  for (RandomAccessIterator i = middle; i < last; ++i) {
+    if (comp(*i, *first)) {
+      ministl::__pop_heap(first, middle, i, comp);
+    }
+  }
+  ministl::__sort_heap(first, middle, comp);
+}
+
+// 把最小的middle - first个元素按顺序放在[first, middle), 其余元素顺序不定
+template <class RandomAccessIterator>
+inline void partial_sort(RandomAccessIterator first,
+                         RandomAccessIterator middle,
+                         RandomAccessIterator last) {
+  __less comp;
+  ministl::__partial_sort(first, middle, last, comp, iterator_category(first));
+}
+template <class RandomAccessIterator, class Compare>
+inline void partial_sort(RandomAccessIterator first,
+                         RandomAccessIterator middle,
+                         RandomAccessIterator last, Compare comp) {
+  ministl::__partial_sort(first, middle, last, comp, iterator_category(first));
+}
+
+// 快速选择, 枢轴和划分与pdqsort相同, 不均衡的划分太多时改用堆选择
+template <class RandomAccessIterator, class Compare>
+void __nth_element(RandomAccessIterator first, RandomAccessIterator nth,
+                   RandomAccessIterator last, Compare& comp,
+                   random_access_iterator_tag) {
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  if (nth == last) {
+    return;
+  }
+  int bad_allowed = ministl::__lg(last - first);
+  while (last - first > (Distance)__PDQ_INSERTION_SORT_THRESHOLD) {
+    Distance size = last - first;
+    ministl::__choose_pivot(first, last, comp);
+    RandomAccessIterator pivot_pos = ministl::__partition_right(first, last, comp).first;
+    if (pivot_pos == nth) {
+      return;
+    }
+    Distance l_size = pivot_pos - first;
+    if ((l_size < size / 8 || size - l_size - 1 < size / 8) &&
+        --bad_allowed == 0) {
+      ministl::__partial_sort(first, nth + 1, last, comp, random_access_iterator_tag());
+      return;
+    }
+    if (nth < pivot_pos) {
+      last = pivot_pos;
+    } else {
+      first = pivot_pos + 1;
+    }
+  }
+  ministl::__insertion_sort(first, last, comp);
+}
+
+// 重排后*nth就是排好序时该在那里的元素, 前面的都不大于它, 后面的都不小于它
+template <class RandomAccessIterator>
+inline void nth_element(RandomAccessIterator first, RandomAccessIterator nth,
+                        RandomAccessIterator last) {
+  __less comp;
+  ministl::__nth_element(first, nth, last, comp, iterator_category(first));
+}
+template <class RandomAccessIterator, class Compare>
+inline void nth_element(RandomAccessIterator first, RandomAccessIterator nth,
+                        RandomAccessIterator last, Compare comp) {
+  ministl::__nth_element(first, nth, last, comp, iterator_category(first));
+}
+
+}  // namespace ministl
@@ -0,0 +1,961 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "iterator.h"
+#include "simd.h"
+#include "type_traits.h"
+
+namespace ministl {
+
+// 基本算法: copy, copy_backward, move, move_backward, fill, fill_n, for_each,
+// transform, find, count, min_element, max_element, equal,
+// lexicographical_compare, iter_swap
+// 与std中的同名算法接口相同, 在std的迭代器上调用时要写成ministl::copy, 避免ADL的歧义
+
+// 分段迭代器: deque这样由若干段连续内存拼成的容器, 迭代器每走一步都要检查是否到了段尾
+// segmented_iterator_traits把这种迭代器拆成 段迭代器 + 段内的原生指针,
+// 上面的算法逐段处理, 每一段都是原生指针上的循环, POD类型再退化成memmove/memset
+// 容器特化这个模板, 提供:
+//   segment_iterator, local_iterator
+//   segment(it), local(it), begin(seg), end(seg), compose(seg, local)
+// compose得到的迭代器要规范化: local是段尾时指向下一段的开头
+template <class Iterator>
+struct segmented_iterator_traits {
+  typedef _false_type is_segmented_iterator;
+};
+
+template <class Iterator>
+struct __is_random_access
+    : std::is_convertible<typename iterator_traits<Iterator>::iterator_category,
+                          random_access_iterator_tag> {};
+
+// 类类型的连续迭代器换成原生指针, 交给原生指针上的memmove和向量化版本;
+// 其他迭代器(包括原生指针)原样返回. __rewrap把得到的指针换回原来的迭代器类型
+template <class Iterator>
+struct __is_contiguous_class
+    : std::integral_constant<bool, is_contiguous<Iterator>::value &&
+                                       !std::is_pointer<Iterator>::value> {};
+
+template <class Iterator>
+inline Iterator __unwrap_aux(Iterator it, std::false_type) {
+  return it;
+}
+
+template <class Iterator>
+inline auto __unwrap_aux(Iterator it, std::true_type)
+    -> decltype(it.operator->()) {
+  return it.operator->();
+}
+
+template <class Iterator>
+inline auto __unwrap(Iterator it)
+    -> decltype(__unwrap_aux(it, __is_contiguous_class<Iterator>())) {
+  return __unwrap_aux(it, __is_contiguous_class<Iterator>());
+}
+
+template <class Iterator, class Pointer>
+inline Iterator __rewrap_aux(Iterator, Pointer p, std::false_type) {
+  return p;
+}
+
+template <class Iterator, class Pointer>
+inline Iterator __rewrap_aux(Iterator orig, Pointer p, std::true_type) {
+  return orig + (p - orig.operator->());
+}
+
+template <class Iterator, class Pointer>
+inline Iterator __rewrap(Iterator orig, Pointer p) {
+  return __rewrap_aux(orig, p, __is_contiguous_class<Iterator>());
+}
+
+// 每个字节都是0的对象, 可以用memset(0)填充
+template <class T>
+inline bool is_zero_bytes(const T& x) {
+  static const unsigned char zero[sizeof(T)] = {};
+  return memcmp(&x, zero, sizeof(T)) == 0;
+}
+
+// copy和move只有赋值方式不同, Move为true时移动赋值
+template <bool Move>
+struct __copy_move {
+  template <class OutputIterator, class InputIterator>
+  static void assign(OutputIterator out, InputIterator in) {
+    *out = *in;
+  }
+};
+
+template <>
+struct __copy_move<true> {
+  template <class OutputIterator, class InputIterator>
+  static void assign(OutputIterator out, InputIterator in) {
+    *out = std::move(*in);
+  }
+};
+
+// 不分段的区间: 逐个赋值, 原生指针上赋值是trivial的类型用memmove
+template <bool Move, class InputIterator, class OutputIterator>
+inline OutputIterator copy_leaf(InputIterator first, InputIterator last,
+                                OutputIterator result) {
+  for (; first != last; ++first, ++result) {
+    __copy_move<Move>::assign(result, first);
+  }
+  return result;
+}
+
+template <bool Move, class InputPointer, class T>
+inline T* copy_ptr(InputPointer first, InputPointer last, T* result,
+                   _true_type) {
+  size_t n = last - first;
+  if (n != 0) {
+    memmove((void*)result, first, n * sizeof(T));
+  }
+  return result + n;
+}
+
+template <bool Move, class InputPointer, class T>
+inline T* copy_ptr(InputPointer first, InputPointer last, T* result,
+                   _false_type) {
+  for (; first != last; ++first, ++result) {
+    __copy_move<Move>::assign(result, first);
+  }
+  return result;
+}
+
+template <bool Move, class T>
+inline T* copy_leaf(const T* first, const T* last, T* result) {
+  return copy_ptr<Move>(
+      first, last, result,
+      typename type_traits<T>::has_trivial_assignment_operator());
+}
+
+template <bool Move, class T>
+inline T* copy_leaf(T* first, T* last, T* result) {
+  return copy_ptr<Move>(
+      first, last, result,
+      typename type_traits<T>::has_trivial_assignment_operator());
+}
+
+// 输出分段: 每次写满一段, 输入可以随机访问时整段交给copy_leaf
+template <bool Move, class InputIterator, class OutputIterator>
+inline OutputIterator copy_out(InputIterator first, InputIterator last,
+                               OutputIterator result, _false_type) {
+  return __rewrap(result, copy_leaf<Move>(__unwrap(first), __unwrap(last),
+                                          __unwrap(result)));
+}
+
+template <bool Move, class InputIterator, class OutputIterator>
+OutputIterator copy_out_aux(InputIterator first, InputIterator last,
+                            OutputIterator result, std::true_type) {
+  typedef segmented_iterator_traits<OutputIterator> traits;
+  typename traits::segment_iterator seg = traits::segment(result);
+  typename traits::local_iterator out = traits::local(result);
+  while (first != last) {
+    if (out == traits::end(seg)) {
+      ++seg;
+      out = traits::begin(seg);
+    }
+    ptrdiff_t n = last - first;
+    ptrdiff_t room = traits::end(seg) - out;
+    if (n > room) {
+      n = room;
+    }
+    out = copy_leaf<Move>(first, first + n, out);
+    first += n;
+  }
+  return traits::compose(seg, out);
+}
+
+template <bool Move, class InputIterator, class OutputIterator>
+OutputIterator copy_out_aux(InputIterator first, InputIterator last,
+                            OutputIterator result, std::false_type) {
+  typedef segmented_iterator_traits<OutputIterator> traits;
+  typename traits::segment_iterator seg = traits::segment(result);
+  typename traits::local_iterator out = traits::local(result);
+  while (first != last) {
+    if (out == traits::end(seg)) {
+      ++seg;
+      out = traits::begin(seg);
+    }
+    typename traits::local_iterator e = traits::end(seg);
+    for (; first != last && out != e; ++first, ++out) {
+      __copy_move<Move>::assign(out, first);
+    }
+  }
+  return traits::compose(seg, out);
+}
+
+template <bool Move, class InputIterator, class OutputIterator>
+inline OutputIterator copy_out(InputIterator first, InputIterator last,
+                               OutputIterator result, _true_type) {
+  return copy_out_aux<Move>(first, last, result,
+                            __is_random_access<InputIterator>());
+}
+
+// 输入分段: 逐段交给copy_out
+template <bool Move, class InputIterator, class OutputIterator>
+inline OutputIterator copy_in(InputIterator first, InputIterator last,
+                              OutputIterator result, _false_type) {
+  return copy_out<Move>(first, last, result,
+                        typename segmented_iterator_traits<
+                            OutputIterator>::is_segmented_iterator());
+}
+
+template <bool Move, class InputIterator, class OutputIterator>
+OutputIterator copy_in(InputIterator first, InputIterator last,
+                       OutputIterator result, _true_type) {
+  typedef segmented_iterator_traits<InputIterator> traits;
+  typedef typename segmented_iterator_traits<
+      OutputIterator>::is_segmented_iterator out_segmented;
+  typename traits::segment_iterator sfirst = traits::segment(first);
+  typename traits::segment_iterator slast = traits::segment(last);
+  if (sfirst == slast) {
+    return copy_out<Move>(traits::local(first), traits::local(last), result,
+                          out_segmented());
+  }
+  result = copy_out<Move>(traits::local(first), traits::end(sfirst), result,
+                          out_segmented());
+  for (++sfirst; sfirst != slast; ++sfirst) {
+    result = copy_out<Move>(traits::begin(sfirst), traits::end(sfirst),
+                            result, out_segmented());
+  }
+  return copy_out<Move>(traits::begin(slast), traits::local(last), result,
+                        out_segmented());
+}
+
+// copy: 把[first, last)赋值到从result开始的区间, 返回结尾
+template <class InputIterator, class OutputIterator>
+inline OutputIterator copy(InputIterator first, InputIterator last,
+                           OutputIterator result) {
+  return copy_in<false>(first, last, result,
+                        typename segmented_iterator_traits<
+                            InputIterator>::is_segmented_iterator());
+}
+
+// move: 与copy相同, 但以移动赋值代替复制赋值
+template <class InputIterator, class OutputIterator>
+inline OutputIterator move(InputIterator first, InputIterator last,
+                           OutputIterator result) {
+  return copy_in<true>(first, last, result,
+                       typename segmented_iterator_traits<
+                           InputIterator>::is_segmented_iterator());
+}
+
+// 经过move_iterator的copy就是move, 底层迭代器仍然按分段和memmove的路径处理
+template <class Iterator, class OutputIterator>
+inline OutputIterator copy(move_iterator<Iterator> first,
+                           move_iterator<Iterator> last,
+                           OutputIterator result) {
+  return ministl::move(first.base(), last.base(), result);
+}
+
+// 从后往前, 结构与上面相同
+template <bool Move, class BidirectionalIterator1,
+          class BidirectionalIterator2>
+inline BidirectionalIterator2 copy_backward_leaf(BidirectionalIterator1 first,
+                                                 BidirectionalIterator1 last,
+                                                 BidirectionalIterator2 result) {
+  while (first != last) {
+    __copy_move<Move>::assign(--result, --last);
+  }
+  return result;
+}
+
+template <bool Move, class InputPointer, class T>
+inline T* copy_backward_ptr(InputPointer first, InputPointer last, T* result,
+                            _true_type) {
+  size_t n = last - first;
+  if (n != 0) {
+    memmove((void*)(result - n), first, n * sizeof(T));
+  }
+  return result - n;
+}
+
+template <bool Move, class InputPointer, class T>
+inline T* copy_backward_ptr(InputPointer first, InputPointer last, T* result,
+                            _false_type) {
+  while (first != last) {
+    __copy_move<Move>::assign(--result, --last);
+  }
+  return result;
+}
+
+template <bool Move, class T>
+inline T* copy_backward_leaf(const T* first, const T* last, T* result) {
+  return copy_backward_ptr<Move>(
+      first, last, result,
+      typename type_traits<T>::has_trivial_assignment_operator());
+}
+
+template <bool Move, class T>
+inline T* copy_backward_leaf(T* first, T* last, T* result) {
+  return copy_backward_ptr<Move>(
+      first, last, result,
+      typename type_traits<T>::has_trivial_assignment_operator());
+}
+
+template <bool Move, class BidirectionalIterator1,
+          class BidirectionalIterator2>
+inline BidirectionalIterator2 copy_backward_out(BidirectionalIterator1 first,
+                                                BidirectionalIterator1 last,
+                                                BidirectionalIterator2 result,
+                                                _false_type) {
+  return __rewrap(result,
+                  copy_backward_leaf<Move>(__unwrap(first), __unwrap(last),
+                                           __unwrap(result)));
+}
+
+template <bool Move, class BidirectionalIterator1,
+          class BidirectionalIterator2>
+BidirectionalIterator2 copy_backward_out_aux(BidirectionalIterator1 first,
+                                             BidirectionalIterator1 last,
+                                             BidirectionalIterator2 result,
+                                             std::true_type) {
+  typedef segmented_iterator_traits<BidirectionalIterator2> traits;
+  typename traits::segment_iterator seg = traits::segment(result);
+  typename traits::local_iterator out = traits::local(result);
+  while (first != last) {
+    if (out == traits::begin(seg)) {
+      --seg;
+      out = traits::end(seg);
+    }
+    ptrdiff_t n = last - first;
+    ptrdiff_t room = out - traits::begin(seg);
+    if (n > room) {
+      n = room;
+    }
+    out = copy_backward_leaf<Move>(last - n, last, out);
+    last -= n;
+  }
+  return traits::compose(seg, out);
+}
+
+template <bool Move, class BidirectionalIterator1,
+          class BidirectionalIterator2>
+BidirectionalIterator2 copy_backward_out_aux(BidirectionalIterator1 first,
+                                             BidirectionalIterator1 last,
+                                             BidirectionalIterator2 result,
+                                             std::false_type) {
+  typedef segmented_iterator_traits<BidirectionalIterator2> traits;
+  typename traits::segment_iterator seg = traits::segment(result);
+  typename traits::local_iterator out = traits::local(result);
+  while (first != last) {
+    if (out == traits::begin(seg)) {
+      --seg;
+      out = traits::end(seg);
+    }
+    typename traits::local_iterator b = traits::begin(seg);
+    while (first != last && out != b) {
+      __copy_move<Move>::assign(--out, --last);
+    }
+  }
+  return traits::compose(seg, out);
+}
+
+template <bool Move, class BidirectionalIterator1,
+          class BidirectionalIterator2>
+inline BidirectionalIterator2 copy_backward_out(BidirectionalIterator1 first,
+                                                BidirectionalIterator1 last,
+                                                BidirectionalIterator2 result,
+                                                _true_type) {
+  return copy_backward_out_aux<Move>(
+      first, last, result, __is_random_access<BidirectionalIterator1>());
+}
+
+template <bool Move, class BidirectionalIterator1,
+          class BidirectionalIterator2>
+inline BidirectionalIterator2 copy_backward_in(BidirectionalIterator1 first,
+                                               BidirectionalIterator1 last,
+                                               BidirectionalIterator2 result,
+                                               _false_type) {
+  return copy_backward_out<Move>(
+      first, last, result,
+      typename segmented_iterator_traits<
+          BidirectionalIterator2>::is_segmented_iterator());
+}
+
+template <bool Move, class BidirectionalIterator1,
+          class BidirectionalIterator2>
+BidirectionalIterator2 copy_backward_in(BidirectionalIterator1 first,
+                                        BidirectionalIterator1 last,
+                                        BidirectionalIterator2 result,
+                                        _true_type) {
+  typedef segmented_iterator_traits<BidirectionalIterator1> traits;
+  typedef typename segmented_iterator_traits<
+      BidirectionalIterator2>::is_segmented_iterator out_segmented;
+  typename traits::segment_iterator sfirst = traits::segment(first);
+  typename traits::segment_iterator slast = traits::segment(last);
+  if (sfirst == slast) {
+    return copy_backward_out<Move>(traits::local(first), traits::local(last),
+                                   result, out_segmented());
+  }
+  result = copy_backward_out<Move>(traits::begin(slast), traits::local(last),
+                                   result, out_segmented());
+  for (--slast; slast != sfirst; --slast) {
+    result = copy_backward_out<Move>(traits::begin(slast), traits::end(slast),
+                                     result, out_segmented());
+  }
+  return copy_backward_out<Move>(traits::local(first), traits::end(sfirst),
+                                 result, out_segmented());
+}
+
+// copy_backward: 把[first, last)从后往前赋值到以result结尾的区间, 返回开头
+template <class BidirectionalIterator1, class BidirectionalIterator2>
+inline BidirectionalIterator2 copy_backward(BidirectionalIterator1 first,
+                                            BidirectionalIterator1 last,
+                                            BidirectionalIterator2 result) {
+  return copy_backward_in<false>(
+      first, last, result,
+      typename segmented_iterator_traits<
+          BidirectionalIterator1>::is_segmented_iterator());
+}
+
+template <class BidirectionalIterator1, class BidirectionalIterator2>
+inline BidirectionalIterator2 move_backward(BidirectionalIterator1 first,
+                                            BidirectionalIterator1 last,
+                                            BidirectionalIterator2 result) {
+  return copy_backward_in<true>(
+      first, last, result,
+      typename segmented_iterator_traits<
+          BidirectionalIterator1>::is_segmented_iterator());
+}
+
+template <class Iterator, class BidirectionalIterator2>
+inline BidirectionalIterator2 copy_backward(move_iterator<Iterator> first,
+                                            move_iterator<Iterator> last,
+                                            BidirectionalIterator2 result) {
+  return ministl::move_backward(first.base(), last.base(), result);
+}
+
+// fill: 不分段的区间逐个赋值, 原生指针上的POD类型单字节或全0时用memset,
+// 其他算术类型用向量化的__simd_fill
+template <class ForwardIterator, class T>
+inline void fill_leaf(ForwardIterator first, ForwardIterator last,
+                      const T& x) {
+  for (; first != last; ++first) {
+    *first = x;
+  }
+}
+
+template <class T>
+inline void fill_pod(T* first, T* last, const T& x, _true_type) {
+  __simd_fill(first, last, x);
+}
+
+template <class T>
+inline void fill_pod(T* first, T* last, const T& x, _false_type) {
+  for (; first != last; ++first) {
+    *first = x;
+  }
+}
+
+template <class T>
+inline void fill_ptr(T* first, T* last, const T& x, _true_type) {
+  // 空区间的指针可能是空指针, 不能交给memset
+  if (first == last) {
+    return;
+  }
+  if (sizeof(T) == 1) {
+    memset(first, *(const unsigned char*)&x, last - first);
+  } else if (is_zero_bytes(x)) {
+    memset(first, 0, (last - first) * sizeof(T));
+  } else {
+    fill_pod(first, last, x, typename __simd_eligible<T>::type());
+  }
+}
+
+template <class T>
+inline void fill_ptr(T* first, T* last, const T& x, _false_type) {
+  for (; first != last; ++first) {
+    *first = x;
+  }
+}
+
+template <class T, class U>
+inline void fill_leaf(T* first, T* last, const U& x) {
+  const T value(x);
+  fill_ptr(first, last, value, typename type_traits<T>::is_POD_type());
+}
+
+template <class ForwardIterator, class T>
+inline void fill_aux(ForwardIterator first, ForwardIterator last, const T& x,
+                     _false_type) {
+  fill_leaf(__unwrap(first), __unwrap(last), x);
+}
+
+template <class ForwardIterator, class T>
+void fill_aux(ForwardIterator first, ForwardIterator last, const T& x,
+              _true_type) {
+  typedef segmented_iterator_traits<ForwardIterator> traits;
+  typename traits::segment_iterator sfirst = traits::segment(first);
+  typename traits::segment_iterator slast = traits::segment(last);
+  if (sfirst == slast) {
+    fill_leaf(traits::local(first), traits::local(last), x);
+    return;
+  }
+  fill_leaf(traits::local(first), traits::end(sfirst), x);
+  for (++sfirst; sfirst != slast; ++sfirst) {
+    fill_leaf(traits::begin(sfirst), traits::end(sfirst), x);
+  }
+  fill_leaf(traits::begin(slast), traits::local(last), x);
+}
+
+// fill: 把[first, last)都赋值为x
+template <class ForwardIterator, class T>
+inline void fill(ForwardIterator first, ForwardIterator last, const T& x) {
+  fill_aux(first, last, x,
+           typename segmented_iterator_traits<
+               ForwardIterator>::is_segmented_iterator());
+}
+
+template <class OutputIterator, class Size, class T>
+inline OutputIterator fill_n_aux(OutputIterator first, Size n, const T& x,
+                                 _false_type) {
+  for (; n > 0; --n, ++first) {
+    *first = x;
+  }
+  return first;
+}
+
+template <class T, class Size, class U>
+inline T* fill_n_aux(T* first, Size n, const U& x, _false_type) {
+  if (n <= 0) {
+    return first;
+  }
+  fill_leaf(first, first + n, x);
+  return first + n;
+}
+
+template <class OutputIterator, class Size, class T>
+OutputIterator fill_n_aux(OutputIterator first, Size n, const T& x,
+                          _true_type) {
+  typedef segmented_iterator_traits<OutputIterator> traits;
+  typename traits::segment_iterator seg = traits::segment(first);
+  typename traits::local_iterator out = traits::local(first);
+  while (n > 0) {
+    if (out == traits::end(seg)) {
+      ++seg;
+      out = traits::begin(seg);
+    }
+    Size m = (Size)(traits::end(seg) - out);
+    if (m > n) {
+      m = n;
+    }
+    fill_leaf(out, out + m, x);
+    out += m;
+    n -= m;
+  }
+  return traits::compose(seg, out);
+}
+
+// fill_n: 从first开始的n个元素赋值为x, 返回结尾
+template <class OutputIterator, class Size, class T>
+inline OutputIterator fill_n(OutputIterator first, Size n, const T& x) {
+  return fill_n_aux(first, n, x,
+                    typename segmented_iterator_traits<
+                        OutputIterator>::is_segmented_iterator());
+}
+
+// 逐段调用时f以引用传递, lambda不能赋值
+template <class InputIterator, class Function>
+inline void for_each_leaf(InputIterator first, InputIterator last,
+                          Function& f) {
+  for (; first != last; ++first) {
+    f(*first);
+  }
+}
+
+template <class InputIterator, class Function>
+inline void for_each_aux(InputIterator first, InputIterator last, Function& f,
+                         _false_type) {
+  for_each_leaf(first, last, f);
+}
+
+template <class InputIterator, class Function>
+void for_each_aux(InputIterator first, InputIterator last, Function& f,
+                  _true_type) {
+  typedef segmented_iterator_traits<InputIterator> traits;
+  typename traits::segment_iterator sfirst = traits::segment(first);
+  typename traits::segment_iterator slast = traits::segment(last);
+  if (sfirst == slast) {
+    for_each_leaf(traits::local(first), traits::local(last), f);
+    return;
+  }
+  for_each_leaf(traits::local(first), traits::end(sfirst), f);
+  for (++sfirst; sfirst != slast; ++sfirst) {
+    for_each_leaf(traits::begin(sfirst), traits::end(sfirst), f);
+  }
+  for_each_leaf(traits::begin(slast), traits::local(last), f);
+}
+
+// for_each: 对[first, last)中的每个元素调用f, 返回f
+template <class InputIterator, class Function>
+inline Function for_each(InputIterator first, InputIterator last, Function f) {
+  for_each_aux(first, last, f,
+               typename segmented_iterator_traits<
+                   InputIterator>::is_segmented_iterator());
+  return f;
+}
+
+// 交换两个迭代器所指的元素, 元素类型有自己的swap时用它的
+template <class ForwardIterator1, class ForwardIterator2>
+inline void iter_swap(ForwardIterator1 a, ForwardIterator2 b) {
+  using std::swap;
+  swap(*a, *b);
+}
+
+// transform: 把op(*i)(或op(*i, *j))依次赋值到从result开始的区间, 返回结尾
+template <class InputIterator, class OutputIterator, class UnaryOperation>
+OutputIterator transform(InputIterator first, InputIterator last,
+                         OutputIterator result, UnaryOperation op) {
+  for (; first != last; ++first, ++result) {
+    *result = op(*first);
+  }
+  return result;
+}
+
+template <class InputIterator1, class InputIterator2, class OutputIterator,
+          class BinaryOperation>
+OutputIterator transform(InputIterator1 first1, InputIterator1 last1,
+                         InputIterator2 first2, OutputIterator result,
+                         BinaryOperation op) {
+  for (; first1 != last1; ++first1, ++first2, ++result) {
+    *result = op(*first1, *first2);
+  }
+  return result;
+}
+
+// 原生指针上的元素类型和value: 可以向量化的类型, value是同一类型,
+// 或者都是整数(转换成元素类型后不变时才按元素类型比较)
+template <class T, class U>
+struct __simd_value {
+  typedef typename std::remove_cv<T>::type V;
+  typedef typename std::conditional<
+      std::is_same<typename __simd_eligible<V>::type, _true_type>::value &&
+          (std::is_same<V, U>::value ||
+           (std::is_integral<V>::value && std::is_integral<U>::value)),
+      _true_type, _false_type>::type type;
+};
+
+// 整数之间按通常的算术转换比较, 结果与内建的==相同,
+// 显式转换成公共类型, 有符号和无符号比较时不产生警告
+template <class T, class U>
+inline bool __equal_value(const T& x, const U& y) {
+  typedef typename std::common_type<T, U>::type C;
+  return static_cast<C>(x) == static_cast<C>(y);
+}
+
+// find: 返回[first, last)中第一个等于value的位置, 没有时返回last
+template <class InputIterator, class T>
+inline InputIterator find_leaf(InputIterator first, InputIterator last,
+                               const T& value) {
+  for (; first != last; ++first) {
+    if (*first == value) {
+      return first;
+    }
+  }
+  return last;
+}
+
+template <class T, class U>
+inline T* find_ptr(T* first, T* last, const U& value, _false_type) {
+  for (; first != last; ++first) {
+    if (*first == value) {
+      return first;
+    }
+  }
+  return last;
+}
+
+template <class T, class U>
+inline T* find_ptr(T* first, T* last, const U& value, _true_type) {
+  typedef typename std::remove_cv<T>::type V;
+  const V v = static_cast<V>(value);
+  if (static_cast<U>(v) != value) {
+    while (first != last && !__equal_value(*first, value)) {
+      ++first;
+    }
+    return first;
+  }
+  return const_cast<T*>(__simd_find<V>(first, last, v));
+}
+
+template <class T, class U>
+inline T* find_leaf(T* first, T* last, const U& value) {
+  return find_ptr(first, last, value, typename __simd_value<T, U>::type());
+}
+
+template <class InputIterator, class T>
+inline InputIterator find_aux(InputIterator first, InputIterator last,
+                              const T& value, _false_type) {
+  return __rewrap(first, find_leaf(__unwrap(first), __unwrap(last), value));
+}
+
+template <class InputIterator, class T>
+InputIterator find_aux(InputIterator first, InputIterator last, const T& value,
+                       _true_type) {
+  typedef segmented_iterator_traits<InputIterator> traits;
+  typename traits::segment_iterator sfirst = traits::segment(first);
+  typename traits::segment_iterator slast = traits::segment(last);
+  if (sfirst == slast) {
+    return traits::compose(
+        sfirst, find_leaf(traits::local(first), traits::local(last), value));
+  }
+  typename traits::local_iterator p =
+      find_leaf(traits::local(first), traits::end(sfirst), value);
+  if (p != traits::end(sfirst)) {
+    return traits::compose(sfirst, p);
+  }
+  for (++sfirst; sfirst != slast; ++sfirst) {
+    p = find_leaf(traits::begin(sfirst), traits::end(sfirst), value);
+    if (p != traits::end(sfirst)) {
+      return traits::compose(sfirst, p);
+    }
+  }
+  return traits::compose(
+      slast, find_leaf(traits::begin(slast), traits::local(last), value));
+}
+
+template <class InputIterator, class T>
+inline InputIterator find(InputIterator first, InputIterator last,
+                          const T& value) {
+  return find_aux(first, last, value,
+                  typename segmented_iterator_traits<
+                      InputIterator>::is_segmented_iterator());
+}
+
+// count: [first, last)中等于value的元素个数
+template <class InputIterator, class T>
+inline typename iterator_traits<InputIterator>::difference_type count_leaf(
+    InputIterator first, InputIterator last, const T& value) {
+  typename iterator_traits<InputIterator>::difference_type n = 0;
+  for (; first != last; ++first) {
+    if (*first == value) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+template <class T, class U>
+inline ptrdiff_t count_ptr(T* first, T* last, const U& value, _false_type) {
+  ptrdiff_t n = 0;
+  for (; first != last; ++first) {
+    if (*first == value) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+template <class T, class U>
+inline ptrdiff_t count_ptr(T* first, T* last, const U& value, _true_type) {
+  typedef typename std::remove_cv<T>::type V;
+  const V v = static_cast<V>(value);
+  if (static_cast<U>(v) != value) {
+    ptrdiff_t n = 0;
+    for (; first != last; ++first) {
+      n += __equal_value(*first, value);
+    }
+    return n;
+  }
+  return (ptrdiff_t)__simd_count<V>(first, last, v);
+}
+
+template <class T, class U>
+inline ptrdiff_t count_leaf(T* first, T* last, const U& value) {
+  return count_ptr(first, last, value, typename __simd_value<T, U>::type());
+}
+
+template <class InputIterator, class T>
+inline typename iterator_traits<InputIterator>::difference_type count_aux(
+    InputIterator first, InputIterator last, const T& value, _false_type) {
+  return count_leaf(__unwrap(first), __unwrap(last), value);
+}
+
+template <class InputIterator, class T>
+typename iterator_traits<InputIterator>::difference_type count_aux(
+    InputIterator first, InputIterator last, const T& value, _true_type) {
+  typedef segmented_iterator_traits<InputIterator> traits;
+  typename traits::segment_iterator sfirst = traits::segment(first);
+  typename traits::segment_iterator slast = traits::segment(last);
+  if (sfirst == slast) {
+    return count_leaf(traits::local(first), traits::local(last), value);
+  }
+  typename iterator_traits<InputIterator>::difference_type n =
+      count_leaf(traits::local(first), traits::end(sfirst), value);
+  for (++sfirst; sfirst != slast; ++sfirst) {
+    n += count_leaf(traits::begin(sfirst), traits::end(sfirst), value);
+  }
+  return n + count_leaf(traits::begin(slast), traits::local(last), value);
+}
+
+template <class InputIterator, class T>
+inline typename iterator_traits<InputIterator>::difference_type count(
+    InputIterator first, InputIterator last, const T& value) {
+  return count_aux(first, last, value,
+                   typename segmented_iterator_traits<
+                       InputIterator>::is_segmented_iterator());
+}
+
+// min_element, max_element: 第一个最小(最大)元素的位置, 区间为空时返回last
+template <class ForwardIterator>
+inline ForwardIterator min_element_leaf(ForwardIterator first,
+                                        ForwardIterator last) {
+  if (first == last) {
+    return last;
+  }
+  ForwardIterator result = first;
+  while (++first != last) {
+    if (*first < *result) {
+      result = first;
+    }
+  }
+  return result;
+}
+
+template <class T>
+inline T* min_element_ptr(T* first, T* last, _false_type) {
+  return min_element_leaf<T*>(first, last);
+}
+
+template <class T>
+inline T* min_element_ptr(T* first, T* last, _true_type) {
+  typedef typename std::remove_cv<T>::type V;
+  return const_cast<T*>(__simd_min_element<V>(first, last));
+}
+
+template <class T>
+inline T* min_element_leaf(T* first, T* last) {
+  return min_element_ptr(first, last, typename __simd_eligible<T>::type());
+}
+
+template <class ForwardIterator>
+inline ForwardIterator min_element(ForwardIterator first,
+                                   ForwardIterator last) {
+  return __rewrap(first, min_element_leaf(__unwrap(first), __unwrap(last)));
+}
+
+template <class ForwardIterator, class Compare>
+ForwardIterator min_element(ForwardIterator first, ForwardIterator last,
+                            Compare comp) {
+  if (first == last) {
+    return last;
+  }
+  ForwardIterator result = first;
+  while (++first != last) {
+    if (comp(*first, *result)) {
+      result = first;
+    }
+  }
+  return result;
+}
+
+template <class ForwardIterator>
+inline ForwardIterator max_element_leaf(ForwardIterator first,
+                                        ForwardIterator last) {
+  if (first == last) {
+    return last;
+  }
+  ForwardIterator result = first;
+  while (++first != last) {
+    if (*result < *first) {
+      result = first;
+    }
+  }
+  return result;
+}
+
+template <class T>
+inline T* max_element_ptr(T* first, T* last, _false_type) {
+  return max_element_leaf<T*>(first, last);
+}
+
+template <class T>
+inline T* max_element_ptr(T* first, T* last, _true_type) {
+  typedef typename std::remove_cv<T>::type V;
+  return const_cast<T*>(__simd_max_element<V>(first, last));
+}
+
+template <class T>
+inline T* max_element_leaf(T* first, T* last) {
+  return max_element_ptr(first, last, typename __simd_eligible<T>::type());
+}
+
+template <class ForwardIterator>
+inline ForwardIterator max_element(ForwardIterator first,
+                                   ForwardIterator last) {
+  return __rewrap(first, max_element_leaf(__unwrap(first), __unwrap(last)));
+}
+
+template <class ForwardIterator, class Compare>
+ForwardIterator max_element(ForwardIterator first, ForwardIterator last,
+                            Compare comp) {
+  if (first == last) {
+    return last;
+  }
+  ForwardIterator result = first;
+  while (++first != last) {
+    if (comp(*result, *first)) {
+      result = first;
+    }
+  }
+  return result;
+}
+
+// equal: 两个原生指针指向同一种可以向量化的类型时整块比较
+template <class InputIterator1, class InputIterator2>
+inline bool equal_leaf(InputIterator1 first1, InputIterator1 last1,
+                       InputIterator2 first2) {
+  for (; first1 != last1; ++first1, ++first2) {
+    if (!(*first1 == *first2)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class T, class U>
+inline bool equal_ptr(T* first1, T* last1, U* first2, _false_type) {
+  return equal_leaf<T*, U*>(first1, last1, first2);
+}
+
+template <class T, class U>
+inline bool equal_ptr(T* first1, T* last1, U* first2, _true_type) {
+  typedef typename std::remove_cv<T>::type V;
+  return __simd_equal<V>(first1, last1, first2);
+}
+
+template <class T, class U>
+inline bool equal_leaf(T* first1, T* last1, U* first2) {
+  typedef typename std::remove_cv<T>::type V;
+  typedef typename std::conditional<
+      std::is_same<V, typename std::remove_cv<U>::type>::value,
+      typename __simd_eligible<V>::type, _false_type>::type simd;
+  return equal_ptr(first1, last1, first2, simd());
+}
+
+template <class InputIterator1, class InputIterator2>
+inline bool equal(InputIterator1 first1, InputIterator1 last1,
+                  InputIterator2 first2) {
+  return equal_leaf(__unwrap(first1), __unwrap(last1), __unwrap(first2));
+}
+
+template <class InputIterator1, class InputIterator2>
+bool lexicographical_compare(InputIterator1 first1, InputIterator1 last1,
+                             InputIterator2 first2, InputIterator2 last2) {
+  for (; first1 != last1 && first2 != last2; ++first1, ++first2) {
+    if (*first1 < *first2) {
+      return true;
+    }
+    if (*first2 < *first1) {
+      return false;
+    }
+  }
+  return first1 == last1 && first2 != last2;
+}
+
+}  // namespace ministl
@@ -1,26 +1,120 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "alloc_stats.h"
+#include "alloc_trace.h"
+#include "type_traits.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
 
 namespace ministl {
 
+enum { __ALIGN = 8 };  //设置对齐要求. 对齐为8字节, 没有8字节自动补齐
+
+// Alloc有没有allocate_batch/deallocate_batch
+template <class Alloc, class = void>
+struct __has_allocate_batch : false_type {};
+template <class Alloc>
+struct __has_allocate_batch<Alloc, decltype((void)Alloc::allocate_batch(0, 0))>
+    : true_type {};
+
 // 定义符合STL规格的配置器接口,
 // 不管是一级配置器还是二级配置器都是使用这个接口进行分配的
+// T的对齐要求超过__ALIGN时, 自动改用Alloc带对齐参数的allocate/deallocate
 template <class T, class Alloc>
 class simple_alloc {
+ private:
+  typedef intergral_constant<bool, (alignof(T) > (size_t)__ALIGN)> over_aligned;
+  static void* allocate_aux(size_t bytes, false_type) {
+    return Alloc::allocate(bytes);
+  }
+  static void* allocate_aux(size_t bytes, true_type) {
+    return Alloc::allocate(bytes, alignof(T));
+  }
+  static void deallocate_aux(T* p, size_t bytes, false_type) {
+    Alloc::deallocate(p, bytes);
+  }
+  static void deallocate_aux(T* p, size_t bytes, true_type) {
+    Alloc::deallocate(p, bytes, alignof(T));
+  }
+  typedef intergral_constant<bool, __has_allocate_batch<Alloc>::value &&
+                                       !over_aligned::value>
+      batched;
+  static void* allocate_batch_aux(size_t n, true_type) {
+    return Alloc::allocate_batch(sizeof(T), (int)n);
+  }
+  static void* allocate_batch_aux(size_t n, false_type) {
+    void* result = 0;
+    try {
+      for (; n > 0; --n) {
+        void* p = allocate_aux(sizeof(T), over_aligned());
+        *(void**)p = result;
+        result = p;
+      }
+    } catch (...) {
+      deallocate_batch_aux(result, false_type());
+      throw;
+    }
+    return result;
+  }
+  static void deallocate_batch_aux(void* first, true_type) {
+    Alloc::deallocate_batch(first, sizeof(T));
+  }
+  static void deallocate_batch_aux(void* first, false_type) {
+    while (first != 0) {
+      void* next = *(void**)first;
+      deallocate_aux((T*)first, sizeof(T), over_aligned());
+      first = next;
+    }
+  }
+
  public:
   static T* allocate(size_t n) {
-    return (0 == n) ? 0 : (T*)Alloc::allocate(n * sizeof(T));
+    return (0 == n) ? 0 : (T*)allocate_aux(n * sizeof(T), over_aligned());
+  }
+  static T* allocate(void) {
+    return (T*)allocate_aux(sizeof(T), over_aligned());
   }
-  static T* allocate(void) { return (T*)Alloc::allocate(sizeof(T)); }
   static void deallocate(T* p, size_t n) {
     if (0 != n) {
-      Alloc::deallocate(p, n * sizeof(T));
+      deallocate_aux(p, n * sizeof(T), over_aligned());
+    }
+  }
+  static void deallocate(T* p) { deallocate_aux(p, sizeof(T), over_aligned()); }
+  // 一次配置n个T, 每块的第一个字指向下一块, 最后一块指向0;
+  // Alloc提供allocate_batch时整批配置, 否则逐个配置. T至少要有一个指针大
+  static void* allocate_batch(size_t n) {
+    return (0 == n) ? 0 : allocate_batch_aux(n, batched());
+  }
+  static void deallocate_batch(void* first) {
+    deallocate_batch_aux(first, batched());
+  }
+  // 显式指定对齐, align必须是2的幂, 回收时要传入相同的n和align
+  static T* allocate(size_t n, size_t align) {
+    return (0 == n) ? 0 : (T*)Alloc::allocate(n * sizeof(T), align);
+  }
+  static void deallocate(T* p, size_t n, size_t align) {
+    if (0 != n) {
+      Alloc::deallocate(p, n * sizeof(T), align);
     }
   }
-  static void deallocate(T* p) { Alloc::deallocate(p, sizeof(T)); }
+  // 把old_n个T的空间改成new_n个, 内容按字节搬移, 只能用于可以按字节搬移的T
+  // 且alignof(T)不超过__ALIGN, old_n和new_n都要大于0
+  static T* reallocate(T* p, size_t old_n, size_t new_n) {
+    return (T*)Alloc::reallocate(p, old_n * sizeof(T), new_n * sizeof(T));
+  }
 };
 
 // 一级配置器类 __malloc_alloc_template
@@ -30,7 +124,19 @@ class __malloc_alloc_template {
   // 这里private里面的函数都是在内存不足的时候进行调用的
   static void* oom_malloc(size_t);          // 分配不足
   static void* oom_realloc(void*, size_t);  // 重新分配不足
+  static void* oom_memalign(size_t, size_t);  // 对齐分配不足
   static void (*__malloc_alloc_oom_handler)();
+  static void* aligned_malloc(size_t n, size_t align) {
+    void* result = 0;
+#if defined(__unix__) || defined(__APPLE__)
+    if (posix_memalign(&result, align, n) != 0) {
+      result = 0;
+    }
+#else
+    result = aligned_alloc(align, (n + align - 1) & ~(align - 1));
+#endif
+    return result;
+  }
 
  public:
   // 在分配和再次分配中, 都会检查内存不足,
@@ -43,6 +149,15 @@ class __malloc_alloc_template {
     return result;
   }
   static void deallocate(void* p, size_t) { free(p); }
+  // 按align对齐分配, align必须是2的幂且不小于sizeof(void*)
+  static void* allocate(size_t n, size_t align) {
+    void* result = aligned_malloc(n, align);
+    if (result == 0) {
+      return oom_memalign(n, align);
+    }
+    return result;
+  }
+  static void deallocate(void* p, size_t, size_t) { free(p); }
   static void* reallocate(void* p, size_t, size_t new_sz) {
     void* result = realloc(p, new_sz);
     if (result == 0) {
@@ -56,6 +171,7 @@ class __malloc_alloc_template {
     __malloc_alloc_oom_handler = f;
     return (old);
   }
+  static void (*get_malloc_handler())() { return __malloc_alloc_oom_handler; }
 };
 // 内存不足设置的处理例程, 默认设置的是0,
 // 表示没有设置处理例程,这个处理例程是由用户手动设置的
@@ -98,95 +214,829 @@ void* __malloc_alloc_template<inst>::oom_realloc(void* p, size_t n) {
     }
   }
 }
+template <int inst>
+void* __malloc_alloc_template<inst>::oom_memalign(size_t n, size_t align) {
+  void (*my_malloc_handler)();
+  void* result;
+  for (;;) {
+    my_malloc_handler = __malloc_alloc_oom_handler;
+    if (my_malloc_handler == 0) {
+      std::cerr << "out of memory" << std::endl;
+      std::exit(1);
+    }
+    (*my_malloc_handler)();
+    result = aligned_malloc(n, align);
+    if (result) {
+      return (result);
+    }
+  }
+}
 // 默认将malloc_alloc设为0;
 typedef __malloc_alloc_template<0> malloc_alloc;
 
-enum { __ALIGN = 8 };  //设置对齐要求. 对齐为8字节, 没有8字节自动补齐
-enum { __MAX_BYTES = 128 };  //二级分配器最大分配的内存大小
-// 链表个数, 分别代表8, 16, 32....字节的链表
-enum { __NFREELISTS = __MAX_BYTES / __ALIGN };
+enum { __PAGE_SIZE = 4096 };
+
+// 内存池向系统要内存的策略(page source), 接口都是静态函数:
+//   allocate(bytes)       返回按页对齐的bytes字节, 失败返回0
+//   deallocate(p, bytes)  归还allocate得到的内存, bytes与申请时相同
+//   decommit(p, bytes)    归还[p, p + bytes)的物理页, 地址仍然有效, 再次访问时读到0
+// 默认的malloc_page_source直接用posix_memalign, 基于mmap的实现见page_source.h
+struct malloc_page_source {
+  static void* allocate(size_t bytes) {
+    void* result = 0;
+#if defined(__unix__) || defined(__APPLE__)
+    if (posix_memalign(&result, __PAGE_SIZE, bytes) != 0) {
+      result = 0;
+    }
+#else
+    result = aligned_alloc(__PAGE_SIZE, bytes);
+#endif
+    return result;
+  }
+  static void deallocate(void* p, size_t) { free(p); }
+  static void decommit(void* p, size_t bytes) {
+#if defined(__unix__) || defined(__APPLE__)
+    madvise(p, bytes, MADV_DONTNEED);
+#endif
+  }
+};
+
+// 不小于这个大小的区块不经过malloc, 直接向系统mmap
+enum { __MMAP_THRESHOLD = 256 * 1024 };
+
+// 大区块配置器, 接口与malloc_alloc相同
+// 每个区块单独mmap, reallocate用mremap扩展或搬移页表, 不复制数据
+// 没有mmap/mremap的平台退回malloc_alloc
+struct __mmap_alloc {
+  static size_t map_size(size_t n) {
+    return (n + __PAGE_SIZE - 1) & ~((size_t)__PAGE_SIZE - 1);
+  }
+  // 失败时像第一级配置器一样反复调用用户的处理例程
+  static void oom() {
+    void (*my_malloc_handler)() = malloc_alloc::get_malloc_handler();
+    if (my_malloc_handler == 0) {
+      std::cerr << "out of memory" << std::endl;
+      std::exit(1);
+    }
+    (*my_malloc_handler)();
+  }
+  static void* allocate(size_t n) {
+#if defined(__unix__) || defined(__APPLE__)
+    for (;;) {
+      void* result = mmap(0, map_size(n), PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (result != MAP_FAILED) {
+        return result;
+      }
+      oom();
+    }
+#else
+    return malloc_alloc::allocate(n);
+#endif
+  }
+  static void deallocate(void* p, size_t n) {
+#if defined(__unix__) || defined(__APPLE__)
+    munmap(p, map_size(n));
+#else
+    malloc_alloc::deallocate(p, n);
+#endif
+  }
+  static void* reallocate(void* p, size_t old_sz, size_t new_sz) {
+#if defined(__linux__)
+    if (map_size(old_sz) == map_size(new_sz)) {
+      return p;
+    }
+    for (;;) {
+      void* result =
+          mremap(p, map_size(old_sz), map_size(new_sz), MREMAP_MAYMOVE);
+      if (result != MAP_FAILED) {
+        return result;
+      }
+      oom();
+    }
+#elif defined(__unix__) || defined(__APPLE__)
+    if (map_size(old_sz) == map_size(new_sz)) {
+      return p;
+    }
+    void* result = allocate(new_sz);
+    memcpy(result, p, old_sz < new_sz ? old_sz : new_sz);
+    deallocate(p, old_sz);
+    return result;
+#else
+    return malloc_alloc::reallocate(p, old_sz, new_sz);
+#endif
+  }
+};
+
+enum { __MAX_BYTES = 32 * 1024 };  //二级分配器最大分配的内存大小
+enum { __SMALL_BYTES = 128 };  // 不超过这个大小的区块由chunk_alloc切分
+// 小区块的链表个数, 分别代表8, 16, 24....128字节的链表
+enum { __NSMALLLISTS = __SMALL_BYTES / __ALIGN };
+// 128字节到32KB之间每翻一倍分成8个等级, 共翻8倍
+enum { __CLASSES_PER_DOUBLING = 8 };
+enum { __NFREELISTS = __NSMALLLISTS + 8 * __CLASSES_PER_DOUBLING };
+// 大区块所在的slab从这么大的内存块中按页切出
+enum { __SLAB_CHUNK_BYTES = 1024 * 1024 };
+// 多线程版本中, 线程缓存与中心池之间每次整批搬运的最多区块数
+enum { __CACHE_BATCH = 20 };
+
+// 区块大小到free-list下标的映射表, 编译期生成
+// 128字节以内按8字节递增, 共16个等级(与原来的free-list一一对应);
+// 128字节以上每翻一倍均分8个等级(144, 160...256, 288...), 内部碎片不超过12.5%
+// 这些等级的区块从按页对齐的slab中切出
+// 每个等级的区块都按其大小的最低位(即自然对齐, 最多一页)对齐, 例如48字节对齐到16,
+// 64/192/320字节对齐到64, 带对齐参数的分配据此选择等级
+struct __size_class_map {
+  // 不超过1024字节时按(bytes + 7) / 8查表, 否则按(bytes + 127) / 128查表
+  unsigned char small_index[1024 / 8 + 1];
+  unsigned char large_index[__MAX_BYTES / 128 + 1];
+  unsigned int class_size[__NFREELISTS];
+  unsigned int class_align[__NFREELISTS];
+  // 每个slab的字节数, 小区块为0
+  unsigned int slab_bytes[__NFREELISTS];
+  // 线程缓存每次搬运的区块数, 大区块适当减少, 免得缓存占用过多内存
+  unsigned char batch_objs[__NFREELISTS];
+
+  constexpr __size_class_map()
+      : small_index(),
+        large_index(),
+        class_size(),
+        class_align(),
+        slab_bytes(),
+        batch_objs() {
+    for (int i = 0; i < __NFREELISTS; ++i) {
+      unsigned int size = (i + 1) * __ALIGN;
+      if (i >= __NSMALLLISTS) {
+        unsigned int lower = __SMALL_BYTES
+                             << ((i - __NSMALLLISTS) / __CLASSES_PER_DOUBLING);
+        unsigned int step = lower / __CLASSES_PER_DOUBLING;
+        size = lower + ((i - __NSMALLLISTS) % __CLASSES_PER_DOUBLING + 1) * step;
+        // slab至少放8个区块, 至少16KB
+        unsigned int bytes = size * 8 > 16 * 1024 ? size * 8 : 16 * 1024;
+        slab_bytes[i] = (bytes + __PAGE_SIZE - 1) & ~(__PAGE_SIZE - 1);
+      }
+      class_size[i] = size;
+      class_align[i] = (size & (~size + 1)) > (unsigned int)__PAGE_SIZE
+                           ? (unsigned int)__PAGE_SIZE
+                           : (size & (~size + 1));
+      unsigned int batch = 64 * 1024 / size;
+      batch_objs[i] = batch > (unsigned int)__CACHE_BATCH
+                          ? (unsigned int)__CACHE_BATCH
+                          : (batch < 2 ? 2 : batch);
+    }
+    int c = 0;
+    for (unsigned int b = 0; b <= 1024 / 8; ++b) {
+      while (class_size[c] < b * 8) ++c;
+      small_index[b] = c;
+    }
+    c = 0;
+    for (unsigned int b = 0; b <= __MAX_BYTES / 128; ++b) {
+      while (class_size[c] < b * 128) ++c;
+      large_index[b] = c;
+    }
+  }
+};
+
+inline const __size_class_map& __size_classes() {
+  static constexpr __size_class_map map{};
+  return map;
+}
+
+// 带版本号的无锁栈(Treiber stack), Node需要有一个std::atomic<Node*> next成员
+// 栈顶指针和版本号打包在一个64位整数里: 64位平台上用户态地址只用低48位,
+// 高16位放版本号; 32位平台上高32位放版本号. 每次修改栈顶版本号加1, 避免ABA问题
+// 节点内存必须是类型稳定的(不会还给系统), 因为pop可能读到刚被别人弹出的节点
+template <class Node>
+class __tagged_stack {
+ private:
+  enum { TAG_SHIFT = sizeof(void*) == 8 ? 48 : 32 };
+  std::atomic<uint64_t> head;
+
+  static Node* get_ptr(uint64_t v) {
+    return (Node*)(uintptr_t)(v & ((uint64_t(1) << TAG_SHIFT) - 1));
+  }
+  static uint64_t next_tag(uint64_t v, Node* p) {
+    return (((v >> TAG_SHIFT) + 1) << TAG_SHIFT) | (uint64_t)(uintptr_t)p;
+  }
+
+ public:
+  constexpr __tagged_stack() : head(0) {}
+  void push(Node* p) {
+    uint64_t old = head.load(std::memory_order_relaxed);
+    do {
+      p->next.store(get_ptr(old), std::memory_order_relaxed);
+    } while (!head.compare_exchange_weak(old, next_tag(old, p),
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
+  }
+  Node* pop() {
+    uint64_t old = head.load(std::memory_order_acquire);
+    for (;;) {
+      Node* p = get_ptr(old);
+      if (p == 0) {
+        return 0;
+      }
+      Node* next = p->next.load(std::memory_order_relaxed);
+      if (head.compare_exchange_weak(old, next_tag(old, next),
+                                     std::memory_order_acquire,
+                                     std::memory_order_acquire)) {
+        return p;
+      }
+    }
+  }
+  // 一次取走整个栈, 返回原栈顶, 后续节点沿next串起来
+  Node* pop_all() {
+    uint64_t old = head.load(std::memory_order_relaxed);
+    while (get_ptr(old) != 0 &&
+           !head.compare_exchange_weak(old, next_tag(old, 0),
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+    }
+    return get_ptr(old);
+  }
+};
 
 //二级配置器类 __default_alloc_template
-template <bool threads, int inst>
+// PageSource决定内存池向系统要内存的方式, 默认用malloc, 见page_source.h
+template <bool threads, int inst, class PageSource = malloc_page_source>
 class __default_alloc_template {
  private:
   union obj {
     union obj* list_link;
     char data[1];
   };
-  //向上取整(8进制)
-  static size_t ROUND_UP(size_t bytes) {
-    return (((bytes) + __ALIGN - 1) & ~(__ALIGN - 1));
-  }
-  // 16个free-lists
-  static obj* volatile free_list[__NFREELISTS];
   //根据区块大小，选择free-list
   static size_t FREELIST_INDEX(size_t bytes) {
-    return (((bytes) + __ALIGN - 1) / __ALIGN - 1);
+    return bytes <= 1024 ? __size_classes().small_index[(bytes + 7) >> 3]
+                         : __size_classes().large_index[(bytes + 127) >> 7];
   }
+  //向上取整到所在等级的区块大小
+  static size_t ROUND_UP(size_t bytes) {
+    return __size_classes().class_size[FREELIST_INDEX(bytes)];
+  }
+  //向上取整到align的倍数, align必须是2的幂
+  static size_t ALIGN_UP(size_t bytes, size_t align) {
+    return (bytes + align - 1) & ~(align - 1);
+  }
+  // 每个等级一个free-list
+  static obj* volatile free_list[__NFREELISTS];
   // 返回一个大小为n的对象，并可能加入大小为n的其他区块到free-list
   static void* refill(size_t n);
   // 配置一块空间，可以容纳nobjs个大小为size的区块
   // 如果配置nobjs个区块不便，nobjs可能会降低
   static char* chunk_alloc(size_t size, int& nobjs);
+  // 把[p, p + bytes)切成若干区块挂到free-list上, 每块都满足所在等级的对齐
+  static void give_back(char* p, size_t bytes);
+  // 能满足align对齐的最小等级, 没有时返回__NFREELISTS
+  static size_t ALIGNED_INDEX(size_t bytes, size_t align) {
+    if (bytes > (size_t)__MAX_BYTES || align > (size_t)__PAGE_SIZE) {
+      return __NFREELISTS;
+    }
+    size_t index = FREELIST_INDEX(ALIGN_UP(bytes, align));
+    while (index < __NFREELISTS && __size_classes().class_align[index] < align) {
+      ++index;
+    }
+    return index;
+  }
+  // 从PageSource要来的大块内存中切出一个按页对齐的slab
+  static char* slab_alloc(size_t bytes);
 
   static char* start_free;
   static char* end_free;
   static size_t heap_size;
+  // 正在切分slab的大块内存, 切剩的页不够一个slab时就另申请一块
+  static char* slab_start;
+  static char* slab_end;
 
- public:
-  // n一定要大于0
-  static void* allocate(size_t n) {
+  // 内存池拥有的每一块内存: chunk_alloc向系统要的内存块, 以及切出来的每个slab
+  // 按起始地址排序, trim时据此统计每一块里还有多少字节在使用
+  struct chunk_record {
+    char* begin;
+    size_t size;
+    int index;          // slab所属free-list的下标, chunk_alloc的内存块为-1
+    bool idle;          // slab的页已经还给系统, 等待同一等级重新使用
+    size_t live_bytes;  // 上次trim时统计的使用中的字节数
+    size_t free_bytes;  // trim时的临时统计
+  };
+  static chunk_record* chunks;
+  static size_t nchunks;
+  static size_t chunk_capacity;
+  static void add_chunk(char* begin, size_t size, int index);
+  static chunk_record* find_chunk(const void* p);
+  // 超过__MAX_BYTES的区块: 不小于__MMAP_THRESHOLD的单独mmap, 其余交给第一级配置器
+  static void* large_allocate(size_t n) {
+    counters.on_large_allocate(n);
+    return n >= (size_t)__MMAP_THRESHOLD ? __mmap_alloc::allocate(n)
+                                         : malloc_alloc::allocate(n);
+  }
+  static void large_deallocate(void* p, size_t n) {
+    counters.on_large_deallocate(n);
+    if (n >= (size_t)__MMAP_THRESHOLD) {
+      __mmap_alloc::deallocate(p, n);
+    } else {
+      malloc_alloc::deallocate(p, n);
+    }
+  }
+  // 向PageSource要内存, 失败时像第一级配置器一样反复调用用户的处理例程
+  static char* page_alloc(size_t bytes);
+  // MINISTL_ALLOC_STATS关闭时是空类
+  static __alloc_counters<MINISTL_ALLOC_STATS != 0, __NFREELISTS> counters;
+  // MINISTL_ALLOC_TRACE关闭时所有函数都是空的
+  typedef __alloc_tracer<MINISTL_ALLOC_TRACE != 0> tracer;
+  // 后台定期trim的线程
+  static std::thread* trim_thread;
+  static std::condition_variable trim_cond;
+  static bool trim_stop;
+
+  // threads为true时分三层:
+  // 1. 每个线程私有的free-list缓存, 分配和回收不加锁也没有原子操作
+  // 2. 无锁的中心池central_list, 线程缓存和它之间以整批(batch)为单位交换区块;
+  //    remote_free接收线程缓存已经销毁之后的零散回收, 入队只要一次CAS
+  // 3. 原来的free_list/start_free/end_free/heap_size, 只在需要向chunk_alloc
+  //    要内存时访问, 由central_mutex保护
+  static std::mutex central_mutex;
+  // 仿照SGI的_Lock, 只在threads为true时真正加锁
+  class lock {
+   public:
+    lock() {
+      if (threads) central_mutex.lock();
+    }
+    ~lock() {
+      if (threads) central_mutex.unlock();
+    }
+  };
+
+  // 中心池里的一批区块. 描述符从不还给系统, 满足__tagged_stack对节点的要求
+  struct batch {
+    std::atomic<batch*> next;
+    obj* first;  // 这一批区块用list_link串起来, 以0结尾
+    int nobjs;
+  };
+  enum { BATCHES_PER_BLOCK = 64 };
+  static __tagged_stack<batch> central_list[__NFREELISTS];
+  static std::atomic<obj*> remote_free[__NFREELISTS];
+  // 空闲的batch描述符
+  static __tagged_stack<batch> free_batches;
+  static batch* new_batch();
+
+  // 线程私有的free-list缓存
+  // 缓存空了就从中心池整批取, 积压太多就整批还回中心池, 线程退出时全部归还
+  struct thread_cache {
+    obj* free_list[__NFREELISTS];
+    int count[__NFREELISTS];
+    bool destroyed;  // 线程退出后仍可能有析构函数在回收内存
+    thread_cache() : free_list(), count(), destroyed(false) {}
+    ~thread_cache() {
+      release_cache(*this);
+      destroyed = true;
+    }
+  };
+  static thread_cache& local_cache() {
+    static thread_local thread_cache cache;
+    return cache;
+  }
+  // 线程缓存为空时, 从中心池取回一批区块, 返回其中一个给调用者
+  static void* cache_refill(thread_cache& cache, size_t n);
+  // 把线程缓存某个free-list上前nobjs个区块还给中心池
+  static void cache_drain(thread_cache& cache, size_t index, int nobjs);
+  // 线程退出时, 把缓存中所有区块还给中心池
+  static void release_cache(thread_cache& cache);
+  // 把以0结尾的一串区块挂回free-list(多线程版本挂回线程缓存), 不计数
+  static void free_chain(obj* first, size_t index);
+
+  static void* cache_allocate(size_t n) {
+    thread_cache& cache = local_cache();
+    size_t index = FREELIST_INDEX(n);
+    obj* result = cache.free_list[index];
+    if (result == 0) {
+      counters.on_miss(index);
+      return cache_refill(cache, n);
+    }
+    counters.on_hit(index, 1);
+    cache.free_list[index] = result->list_link;
+    --cache.count[index];
+    return (result);
+  }
+  static void cache_deallocate(void* p, size_t n) {
+    thread_cache& cache = local_cache();
+    size_t index = FREELIST_INDEX(n);
+    obj* q = (obj*)p;
+    q->list_link = cache.free_list[index];
+    cache.free_list[index] = q;
+    int batch = __size_classes().batch_objs[index];
+    if (++cache.count[index] > 2 * batch || cache.destroyed) {
+      cache_drain(cache, index, cache.destroyed ? cache.count[index] : batch);
+    }
+  }
+
+  // n决定等级, requested是调用者请求的字节数, 只用于统计
+  static void* allocate_aux(size_t n, size_t requested) {
     obj* volatile* my_free_list;
     obj* result;
-    //大于128b就第一级空间配置器
+    //大于32KB就第一级空间配置器
     if (n > (size_t)__MAX_BYTES) {
-      return (malloc_alloc::allocate(n));
+      return (large_allocate(n));
     }
-    my_free_list = free_list + FREELIST_INDEX(n);
+    size_t index = FREELIST_INDEX(n);
+    counters.on_allocate(index, __size_classes().class_size[index], requested);
+    if (threads) {
+      return cache_allocate(n);
+    }
+    my_free_list = free_list + index;
     result = *my_free_list;
     if (result == 0) {
       //没找到可用的free list，重新填充free-list
+      counters.on_miss(index);
       void* r = refill(ROUND_UP(n));
       return r;
     }
     // 调整free-list
+    counters.on_hit(index, 1);
     *my_free_list = result->list_link;
     return (result);
   }
-  // p指针不能为0
-  static void deallocate(void* p, size_t n) {
+  static void deallocate_aux(void* p, size_t n, size_t requested) {
     obj* q = (obj*)p;
     obj* volatile* my_free_list;
     if (n > (size_t)__MAX_BYTES) {
-      malloc_alloc::deallocate(p, n);
+      large_deallocate(p, n);
+      return;
+    }
+    size_t index = FREELIST_INDEX(n);
+    counters.on_deallocate(index, __size_classes().class_size[index],
+                           requested);
+    if (threads) {
+      cache_deallocate(p, n);
       return;
     }
-    my_free_list = free_list + FREELIST_INDEX(n);
+    my_free_list = free_list + index;
     q->list_link = *my_free_list;
     *my_free_list = q;
   }
+
+ public:
+  // n一定要大于0
+  static void* allocate(size_t n) {
+    void* result = allocate_aux(n, n);
+    tracer::on_allocate(inst, result, n);
+    return (result);
+  }
+  // p指针不能为0
+  static void deallocate(void* p, size_t n) {
+    tracer::on_deallocate(inst, p, n);
+    deallocate_aux(p, n, n);
+  }
+  // 一次配置count个大小为n的区块, 用每个区块的第一个字串成以0结尾的链表返回;
+  // 先从free-list整段摘下, 不够的部分一次chunk_alloc切出来, 而不是逐个refill
+  static void* allocate_batch(size_t n, int count);
+  // 归还allocate_batch形式的链表, 链表上每个区块的大小都是n
+  static void deallocate_batch(void* first, size_t n);
+  // 新旧大小在同一个等级时原地返回p; 新旧都是mmap得到的大区块时用mremap, 不复制数据;
+  // 都在第一级配置器中时用realloc; 其余情况重新分配后memcpy
   static void* reallocate(void* p, size_t old_sz, size_t new_sz);
+
+  // 按align对齐分配, align必须是2的幂; 不超过一页的对齐由内存池中对齐合适的等级提供,
+  // 区块大小是align的倍数, 所以按缓存行对齐的对象之间不会有伪共享
+  static void* allocate(size_t n, size_t align) {
+    if (align <= (size_t)__ALIGN) {
+      return allocate(n);
+    }
+    size_t index = ALIGNED_INDEX(n, align);
+    if (index == __NFREELISTS) {
+      counters.on_large_allocate(n);
+      void* result = malloc_alloc::allocate(n, align);
+      tracer::on_allocate(inst, result, n);
+      return result;
+    }
+    // 按对齐的等级取区块, 统计和跟踪记录的仍是请求的n
+    void* result = allocate_aux(__size_classes().class_size[index], n);
+    tracer::on_allocate(inst, result, n);
+    return (result);
+  }
+  // n和align必须与分配时相同
+  static void deallocate(void* p, size_t n, size_t align) {
+    if (align <= (size_t)__ALIGN) {
+      deallocate(p, n);
+      return;
+    }
+    size_t index = ALIGNED_INDEX(n, align);
+    if (index == __NFREELISTS) {
+      tracer::on_deallocate(inst, p, n);
+      counters.on_large_deallocate(n);
+      malloc_alloc::deallocate(p, n, align);
+      return;
+    }
+    tracer::on_deallocate(inst, p, n);
+    deallocate_aux(p, __size_classes().class_size[index], n);
+  }
+
+  // 把完全空闲的内存还给系统, 返回归还的字节数:
+  // chunk_alloc的内存块直接free, slab用madvise(MADV_DONTNEED)释放物理页
+  // 多线程版本中调用线程自己的缓存会先归还, 其他线程缓存里的区块视为仍在使用
+  static size_t trim();
+  // 启动/停止后台线程, 每隔interval_ms毫秒trim一次, 只能用于多线程版本
+  static void start_background_trim(unsigned interval_ms);
+  static void stop_background_trim();
+
+  // 取一份统计快照, 逐等级的计数只在定义了MINISTL_ALLOC_STATS时才有
+  static alloc_stats get_stats();
 };
 // 设置初始值
-template <bool threads, int inst>
-char* __default_alloc_template<threads, inst>::start_free = 0;
-template <bool threads, int inst>
-char* __default_alloc_template<threads, inst>::end_free = 0;
-template <bool threads, int inst>
-size_t __default_alloc_template<threads, inst>::heap_size = 0;
-template <bool threads, int inst>
-typename __default_alloc_template<threads, inst>::
-    obj* volatile __default_alloc_template<threads,
-                                           inst>::free_list[__NFREELISTS] = {
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-};
+template <bool threads, int inst, class PageSource>
+char* __default_alloc_template<threads, inst, PageSource>::start_free = 0;
+template <bool threads, int inst, class PageSource>
+char* __default_alloc_template<threads, inst, PageSource>::end_free = 0;
+template <bool threads, int inst, class PageSource>
+size_t __default_alloc_template<threads, inst, PageSource>::heap_size = 0;
+template <bool threads, int inst, class PageSource>
+char* __default_alloc_template<threads, inst, PageSource>::slab_start = 0;
+template <bool threads, int inst, class PageSource>
+char* __default_alloc_template<threads, inst, PageSource>::slab_end = 0;
+template <bool threads, int inst, class PageSource>
+typename __default_alloc_template<threads, inst, PageSource>::
+    obj* volatile __default_alloc_template<threads, inst,
+                                           PageSource>::free_list[__NFREELISTS] =
+        {};
+template <bool threads, int inst, class PageSource>
+typename __default_alloc_template<threads, inst, PageSource>::chunk_record*
+    __default_alloc_template<threads, inst, PageSource>::chunks = 0;
+template <bool threads, int inst, class PageSource>
+size_t __default_alloc_template<threads, inst, PageSource>::nchunks = 0;
+template <bool threads, int inst, class PageSource>
+size_t __default_alloc_template<threads, inst, PageSource>::chunk_capacity = 0;
+template <bool threads, int inst, class PageSource>
+__alloc_counters<MINISTL_ALLOC_STATS != 0, __NFREELISTS>
+    __default_alloc_template<threads, inst, PageSource>::counters;
+template <bool threads, int inst, class PageSource>
+std::thread* __default_alloc_template<threads, inst, PageSource>::trim_thread = 0;
+template <bool threads, int inst, class PageSource>
+std::condition_variable __default_alloc_template<threads, inst, PageSource>::trim_cond;
+template <bool threads, int inst, class PageSource>
+bool __default_alloc_template<threads, inst, PageSource>::trim_stop = false;
+template <bool threads, int inst, class PageSource>
+std::mutex __default_alloc_template<threads, inst, PageSource>::central_mutex;
+template <bool threads, int inst, class PageSource>
+__tagged_stack<typename __default_alloc_template<threads, inst, PageSource>::batch>
+    __default_alloc_template<threads, inst, PageSource>::central_list[__NFREELISTS];
+template <bool threads, int inst, class PageSource>
+std::atomic<typename __default_alloc_template<threads, inst, PageSource>::obj*>
+    __default_alloc_template<threads, inst, PageSource>::remote_free[__NFREELISTS];
+template <bool threads, int inst, class PageSource>
+__tagged_stack<typename __default_alloc_template<threads, inst, PageSource>::batch>
+    __default_alloc_template<threads, inst, PageSource>::free_batches;
+
+template <bool threads, int inst, class PageSource>
+typename __default_alloc_template<threads, inst, PageSource>::batch*
+__default_alloc_template<threads, inst, PageSource>::new_batch() {
+  batch* result = free_batches.pop();
+  if (result != 0) {
+    return (result);
+  }
+  // 描述符用完了, 一次申请一整块, 这些内存永远不会释放
+  result = (batch*)malloc_alloc::allocate(BATCHES_PER_BLOCK * sizeof(batch));
+  for (int i = 1; i < BATCHES_PER_BLOCK; ++i) {
+    free_batches.push(new (result + i) batch());
+  }
+  return new (result) batch();
+}
+
+template <bool threads, int inst, class PageSource>
+void* __default_alloc_template<threads, inst, PageSource>::cache_refill(
+    thread_cache& cache, size_t n) {
+  size_t index = FREELIST_INDEX(n);
+  obj* result;
+  int nobjs = 0;
+  if (batch* b = central_list[index].pop()) {
+    // 中心池有现成的一批
+    result = b->first;
+    nobjs = b->nobjs;
+    free_batches.push(b);
+  } else if ((result = remote_free[index].exchange(
+                  0, std::memory_order_acquire)) != 0) {
+    // 取走别的线程零散归还的全部区块
+    for (obj* p = result; p != 0; p = p->list_link) {
+      ++nobjs;
+    }
+  } else {
+    // 都没有, 加锁走原来的refill/chunk_alloc, 多出来的区块先挂在free_list上
+    lock lock_instance;
+    obj* volatile* my_free_list = free_list + index;
+    if (*my_free_list == 0) {
+      obj* q = (obj*)refill(ROUND_UP(n));
+      q->list_link = *my_free_list;
+      *my_free_list = q;
+    }
+    // 一个slab的区块可能远多于一批, 只取一批
+    int batch = __size_classes().batch_objs[index];
+    obj* last = result = *my_free_list;
+    for (nobjs = 1; nobjs < batch && last->list_link != 0; ++nobjs) {
+      last = last->list_link;
+    }
+    *my_free_list = last->list_link;
+    last->list_link = 0;
+  }
+  // 第一个区块给调用者, 其余放进线程缓存(此时缓存的这个free-list一定为空)
+  if (--nobjs > 0) {
+    cache.free_list[index] = result->list_link;
+    cache.count[index] = nobjs;
+    // 线程已经退出, 不再往缓存里放东西
+    if (cache.destroyed) {
+      cache_drain(cache, index, nobjs);
+    }
+  }
+  return (result);
+}
 
-template <bool threads, int inst>
-void* __default_alloc_template<threads, inst>::refill(size_t n) {
+template <bool threads, int inst, class PageSource>
+void __default_alloc_template<threads, inst, PageSource>::cache_drain(thread_cache& cache,
+                                                          size_t index,
+                                                          int nobjs) {
+  // 先在线程缓存里把要归还的一段摘下来
+  obj* first = cache.free_list[index];
+  obj* last = first;
+  for (int i = 1; i < nobjs; ++i) {
+    last = last->list_link;
+  }
+  cache.free_list[index] = last->list_link;
+  cache.count[index] -= nobjs;
+  last->list_link = 0;
+  if (cache.destroyed) {
+    // 线程缓存已经销毁, 直接挂到remote_free上
+    obj* head = remote_free[index].load(std::memory_order_relaxed);
+    do {
+      last->list_link = head;
+    } while (!remote_free[index].compare_exchange_weak(
+        head, first, std::memory_order_release, std::memory_order_relaxed));
+    return;
+  }
+  batch* b = new_batch();
+  b->first = first;
+  b->nobjs = nobjs;
+  central_list[index].push(b);
+}
+
+template <bool threads, int inst, class PageSource>
+void __default_alloc_template<threads, inst, PageSource>::release_cache(
+    thread_cache& cache) {
+  for (size_t i = 0; i < __NFREELISTS; ++i) {
+    if (cache.count[i] > 0) {
+      cache_drain(cache, i, cache.count[i]);
+    }
+  }
+}
+
+template <bool threads, int inst, class PageSource>
+void __default_alloc_template<threads, inst, PageSource>::free_chain(obj* first,
+                                                         size_t index) {
+  obj* last = first;
+  int nobjs = 1;
+  for (; last->list_link != 0; ++nobjs) {
+    last = last->list_link;
+  }
+  if (!threads) {
+    last->list_link = free_list[index];
+    free_list[index] = first;
+    return;
+  }
+  thread_cache& cache = local_cache();
+  last->list_link = cache.free_list[index];
+  cache.free_list[index] = first;
+  cache.count[index] += nobjs;
+  if (cache.destroyed) {
+    cache_drain(cache, index, cache.count[index]);
+    return;
+  }
+  int batch = __size_classes().batch_objs[index];
+  while (cache.count[index] > 2 * batch) {
+    cache_drain(cache, index, batch);
+  }
+}
+
+template <bool threads, int inst, class PageSource>
+void* __default_alloc_template<threads, inst, PageSource>::allocate_batch(
+    size_t n, int count) {
+  obj* result = 0;
+  if (n > (size_t)__MAX_BYTES) {
+    for (int i = 0; i < count; ++i) {
+      obj* q = (obj*)allocate(n);
+      q->list_link = result;
+      result = q;
+    }
+    return (result);
+  }
+  size_t index = FREELIST_INDEX(n);
+  size_t size = __size_classes().class_size[index];
+  obj** tail = &result;
+  int got = 0;
+  try {
+    while (got < count) {
+      obj** my_free_list =
+          threads ? &local_cache().free_list[index] : (obj**)(free_list + index);
+      if (*my_free_list != 0) {
+        // 整段摘下free-list上现成的区块
+        obj* last = *my_free_list;
+        int nobjs = 1;
+        for (; got + nobjs < count && last->list_link != 0; ++nobjs) {
+          last = last->list_link;
+        }
+        *tail = *my_free_list;
+        *my_free_list = last->list_link;
+        tail = &last->list_link;
+        got += nobjs;
+        counters.on_hit(index, nobjs);
+        if (threads) {
+          local_cache().count[index] -= nobjs;
+        }
+        continue;
+      }
+      counters.on_miss(index);
+      if (threads || __size_classes().slab_bytes[index] != 0) {
+        // 线程缓存一次从中心池取一批, slab等级一次切一整个slab,
+        // 多出来的区块都留在free-list上, 下一轮整段摘下
+        obj* q = (obj*)(threads ? cache_refill(local_cache(), size) : refill(size));
+        *tail = q;
+        tail = &q->list_link;
+        ++got;
+        continue;
+      }
+      // 剩下的区块一次向chunk_alloc要, 得到的是一段连续内存
+      int nobjs = count - got < 1024 ? count - got : 1024;
+      char* chunk = chunk_alloc(size, nobjs);
+      counters.on_refill(index, nobjs);
+      counters.on_heap(heap_size);
+      for (int i = 0; i < nobjs; ++i) {
+        obj* q = (obj*)(chunk + i * size);
+        *tail = q;
+        tail = &q->list_link;
+      }
+      got += nobjs;
+    }
+  } catch (...) {
+    *tail = 0;
+    if (result != 0) {
+      free_chain(result, index);
+    }
+    throw;
+  }
+  *tail = 0;
+  for (obj* p = result; p != 0; p = p->list_link) {
+    counters.on_allocate(index, size, n);
+    tracer::on_allocate(inst, p, n);
+  }
+  return (result);
+}
+
+template <bool threads, int inst, class PageSource>
+void __default_alloc_template<threads, inst, PageSource>::deallocate_batch(
+    void* first, size_t n) {
+  if (first == 0) {
+    return;
+  }
+  if (n > (size_t)__MAX_BYTES) {
+    for (obj* p = (obj*)first; p != 0;) {
+      obj* next = p->list_link;
+      deallocate(p, n);
+      p = next;
+    }
+    return;
+  }
+  size_t index = FREELIST_INDEX(n);
+  size_t size = __size_classes().class_size[index];
+  for (obj* p = (obj*)first; p != 0; p = p->list_link) {
+    tracer::on_deallocate(inst, p, n);
+    counters.on_deallocate(index, size, n);
+  }
+  free_chain((obj*)first, index);
+}
+
+template <bool threads, int inst, class PageSource>
+void* __default_alloc_template<threads, inst, PageSource>::refill(size_t n) {
   int nobjs = 20;
-  // 调用chunk_alloc，尝试取得nobjs个区块作为free-list的新节点
-  char* chunk = chunk_alloc(n, nobjs);
+  char* chunk;
+  size_t slab_bytes = __size_classes().slab_bytes[FREELIST_INDEX(n)];
+  if (slab_bytes == 0) {
+    // 调用chunk_alloc，尝试取得nobjs个区块作为free-list的新节点
+    chunk = chunk_alloc(n, nobjs);
+  } else {
+    // 大区块整个slab切成一个free-list, 优先重新启用同一等级的空闲slab
+    int index = (int)FREELIST_INDEX(n);
+    chunk = 0;
+    for (size_t i = 0; i < nchunks; ++i) {
+      if (chunks[i].idle && chunks[i].index == index) {
+        chunks[i].idle = false;
+        chunk = chunks[i].begin;
+        heap_size += slab_bytes;
+        break;
+      }
+    }
+    if (chunk == 0) {
+      chunk = slab_alloc(slab_bytes);
+      add_chunk(chunk, slab_bytes, index);
+    }
+    nobjs = (int)(slab_bytes / n);
+  }
+  counters.on_refill(FREELIST_INDEX(n), nobjs);
+  counters.on_heap(heap_size);
   obj* volatile* my_free_list;
   obj* result;
   obj *current_obj, *next_obj;
@@ -214,11 +1064,18 @@ void* __default_alloc_template<threads, inst>::refill(size_t n) {
   return (result);
 }
 
-template <bool threads, int inst>
-char* __default_alloc_template<threads, inst>::chunk_alloc(size_t size,
+template <bool threads, int inst, class PageSource>
+char* __default_alloc_template<threads, inst, PageSource>::chunk_alloc(size_t size,
                                                            int& nobjs) {
   char* result;
   size_t total_bytes = size * nobjs;
+  // 按区块的自然对齐切分, 为对齐跳过的部分挂回free-list
+  size_t align = __size_classes().class_align[FREELIST_INDEX(size)];
+  char* aligned = (char*)ALIGN_UP((size_t)start_free, align);
+  if (aligned != start_free && aligned < end_free) {
+    give_back(start_free, aligned - start_free);
+    start_free = aligned;
+  }
   size_t bytes_left = end_free - start_free;
   if (bytes_left >= total_bytes) {
     //内存完全满足剩余空间需求量
@@ -234,42 +1091,319 @@ char* __default_alloc_template<threads, inst>::chunk_alloc(size_t size,
     return (result);
   } else {
     //内存池剩余空间连一块大小都无法提供。 heapsize清0操作
-    size_t bytes_to_get = 2 * total_bytes + ROUND_UP(heap_size >> 4);
+    //向PageSource要的内存都是整页, 多出来的部分留在内存池里
+    size_t bytes_to_get = ALIGN_UP(
+        2 * total_bytes + ALIGN_UP(heap_size >> 4, __ALIGN), __PAGE_SIZE);
     if (bytes_left > 0) {
-      //尝试内存池剩余的大小还能不能利用
-      //先寻找free list
-      obj* volatile* my_free_list = free_list + FREELIST_INDEX(bytes_left);
-      //调整free list 利用剩余空间
-      ((obj*)start_free)->list_link = *my_free_list;
-      *my_free_list = (obj*)start_free;
+      //尝试内存池剩余的大小还能不能利用, 按对齐切开挂到free list上
+      give_back(start_free, bytes_left);
     }
     //配置堆空间
-    start_free = (char*)malloc(bytes_to_get);
+    start_free = (char*)PageSource::allocate(bytes_to_get);
     if (0 == start_free) {
       //堆空间不足，分配失败
       int i;
       obj *volatile *my_free_list, *p;
 
-      for (i = size; i <= __MAX_BYTES; i += __ALIGN) {
+      for (i = size; i <= __SMALL_BYTES; i += __ALIGN) {
         my_free_list = free_list + FREELIST_INDEX(i);
         p = *my_free_list;
         if (0 != p) {
           *my_free_list = p->list_link;
+          counters.on_release(FREELIST_INDEX(i), 1);
           start_free = (char*)p;
           end_free = start_free + i;
           return (chunk_alloc(size, nobjs));
         }
       }
       end_free = 0;  //如果都没内存了
-      start_free = (char*)malloc_alloc::allocate(bytes_to_get);
+      start_free = page_alloc(bytes_to_get);
     }
     heap_size += bytes_to_get;
     end_free = start_free + bytes_to_get;
+    add_chunk(start_free, bytes_to_get, -1);
     return (chunk_alloc(size, nobjs));
   }
   return nullptr;
 }
-// 默认用第二级空间配置器
-typedef __default_alloc_template<false, 0> alloc;
+
+template <bool threads, int inst, class PageSource>
+char* __default_alloc_template<threads, inst, PageSource>::slab_alloc(size_t bytes) {
+  if ((size_t)(slab_end - slab_start) < bytes) {
+    // 切剩的页只占虚拟地址, 没有碰过就不占物理内存
+    size_t bytes_to_get =
+        bytes > __SLAB_CHUNK_BYTES ? bytes : (size_t)__SLAB_CHUNK_BYTES;
+    slab_start = page_alloc(bytes_to_get);
+    heap_size += bytes_to_get;
+    slab_end = slab_start + bytes_to_get;
+  }
+  char* result = slab_start;
+  slab_start += bytes;
+  return (result);
+}
+
+template <bool threads, int inst, class PageSource>
+void* __default_alloc_template<threads, inst, PageSource>::reallocate(
+    void* p, size_t old_sz, size_t new_sz) {
+  if (old_sz > (size_t)__MAX_BYTES && new_sz > (size_t)__MAX_BYTES) {
+    bool old_mapped = old_sz >= (size_t)__MMAP_THRESHOLD;
+    bool new_mapped = new_sz >= (size_t)__MMAP_THRESHOLD;
+    if (old_mapped == new_mapped) {
+      tracer::on_deallocate(inst, p, old_sz);
+      counters.on_large_deallocate(old_sz);
+      counters.on_large_allocate(new_sz);
+      void* result = old_mapped ? __mmap_alloc::reallocate(p, old_sz, new_sz)
+                                : malloc_alloc::reallocate(p, old_sz, new_sz);
+      tracer::on_allocate(inst, result, new_sz);
+      return (result);
+    }
+  } else if (old_sz <= (size_t)__MAX_BYTES && new_sz <= (size_t)__MAX_BYTES &&
+             FREELIST_INDEX(old_sz) == FREELIST_INDEX(new_sz)) {
+    if (old_sz != new_sz) {
+      size_t index = FREELIST_INDEX(old_sz);
+      size_t size = __size_classes().class_size[index];
+      counters.on_deallocate(index, size, old_sz);
+      counters.on_allocate(index, size, new_sz);
+      tracer::on_deallocate(inst, p, old_sz);
+      tracer::on_allocate(inst, p, new_sz);
+    }
+    return (p);
+  }
+  void* result = allocate(new_sz);
+  memcpy(result, p, old_sz < new_sz ? old_sz : new_sz);
+  deallocate(p, old_sz);
+  return (result);
+}
+
+template <bool threads, int inst, class PageSource>
+void __default_alloc_template<threads, inst, PageSource>::give_back(
+    char* p, size_t bytes) {
+  const __size_class_map& map = __size_classes();
+  while (bytes >= (size_t)__ALIGN) {
+    size_t index =
+        FREELIST_INDEX(bytes < (size_t)__SMALL_BYTES ? bytes : (size_t)__SMALL_BYTES);
+    while (index > 0 && ((size_t)p & (map.class_align[index] - 1)) != 0) {
+      --index;
+    }
+    obj* q = (obj*)p;
+    q->list_link = free_list[index];
+    free_list[index] = q;
+    counters.on_carve(index, 1);
+    p += map.class_size[index];
+    bytes -= map.class_size[index];
+  }
+}
+
+template <bool threads, int inst, class PageSource>
+char* __default_alloc_template<threads, inst, PageSource>::page_alloc(
+    size_t bytes) {
+  for (;;) {
+    char* result = (char*)PageSource::allocate(bytes);
+    if (result != 0) {
+      return (result);
+    }
+    void (*my_malloc_handler)() = malloc_alloc::get_malloc_handler();
+    if (my_malloc_handler == 0) {
+      std::cerr << "out of memory" << std::endl;
+      std::exit(1);
+    }
+    (*my_malloc_handler)();
+  }
+}
+
+template <bool threads, int inst, class PageSource>
+void __default_alloc_template<threads, inst, PageSource>::add_chunk(char* begin,
+                                                        size_t size,
+                                                        int index) {
+  if (nchunks == chunk_capacity) {
+    size_t old_sz = chunk_capacity * sizeof(chunk_record);
+    chunk_capacity = chunk_capacity == 0 ? 64 : 2 * chunk_capacity;
+    chunks = (chunk_record*)malloc_alloc::reallocate(
+        chunks, old_sz, chunk_capacity * sizeof(chunk_record));
+  }
+  // 保持按起始地址有序, 内存块的数量不多, 直接挪动即可
+  size_t pos = nchunks;
+  while (pos > 0 && chunks[pos - 1].begin > begin) {
+    --pos;
+  }
+  memmove(chunks + pos + 1, chunks + pos,
+          (nchunks - pos) * sizeof(chunk_record));
+  chunk_record record = {begin, size, index, false, 0, 0};
+  chunks[pos] = record;
+  ++nchunks;
+}
+
+template <bool threads, int inst, class PageSource>
+typename __default_alloc_template<threads, inst, PageSource>::chunk_record*
+__default_alloc_template<threads, inst, PageSource>::find_chunk(const void* p) {
+  // 二分查找起始地址不大于p的最后一块
+  size_t lo = 0, hi = nchunks;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (chunks[mid].begin <= (const char*)p) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return chunks + lo - 1;
+}
+
+template <bool threads, int inst, class PageSource>
+size_t __default_alloc_template<threads, inst, PageSource>::trim() {
+  if (threads) {
+    release_cache(local_cache());
+  }
+  lock lock_instance;
+  const __size_class_map& map = __size_classes();
+  // 多线程版本先把中心池里的区块都收集到free_list上
+  if (threads) {
+    for (size_t i = 0; i < __NFREELISTS; ++i) {
+      batch* b = central_list[i].pop_all();
+      while (b != 0) {
+        batch* next = b->next.load(std::memory_order_relaxed);
+        obj* last = b->first;
+        while (last->list_link != 0) {
+          last = last->list_link;
+        }
+        last->list_link = free_list[i];
+        free_list[i] = b->first;
+        free_batches.push(b);
+        b = next;
+      }
+      obj* q = remote_free[i].exchange(0, std::memory_order_acquire);
+      while (q != 0) {
+        obj* next = q->list_link;
+        q->list_link = free_list[i];
+        free_list[i] = q;
+        q = next;
+      }
+    }
+  }
+  // 统计每一块内存中空闲的字节数
+  // slab末尾不够一个区块的零头永远不会分配出去, 也算作空闲
+  for (size_t c = 0; c < nchunks; ++c) {
+    int index = chunks[c].index;
+    chunks[c].free_bytes =
+        index < 0 ? 0 : chunks[c].size % map.class_size[index];
+  }
+  for (size_t i = 0; i < __NFREELISTS; ++i) {
+    for (obj* q = free_list[i]; q != 0; q = q->list_link) {
+      find_chunk(q)->free_bytes += map.class_size[i];
+    }
+  }
+  if (start_free != end_free) {
+    find_chunk(start_free)->free_bytes += end_free - start_free;
+  }
+  for (size_t c = 0; c < nchunks; ++c) {
+    chunks[c].live_bytes =
+        chunks[c].idle ? 0 : chunks[c].size - chunks[c].free_bytes;
+  }
+  // 从free-list上摘掉完全空闲的内存块里的区块
+  for (size_t i = 0; i < __NFREELISTS; ++i) {
+    obj* volatile* link = free_list + i;
+    size_t removed = 0;
+    while (*link != 0) {
+      chunk_record* c = find_chunk(*link);
+      if (!c->idle && c->live_bytes == 0) {
+        *link = (*link)->list_link;
+        ++removed;
+      } else {
+        link = &(*link)->list_link;
+      }
+    }
+    counters.on_release(i, removed);
+  }
+  if (start_free != end_free && find_chunk(start_free)->live_bytes == 0) {
+    start_free = end_free = 0;
+  }
+  // 归还并整理记录
+  size_t released = 0;
+  size_t kept = 0;
+  for (size_t c = 0; c < nchunks; ++c) {
+    chunk_record& record = chunks[c];
+    if (!record.idle && record.live_bytes == 0) {
+      released += record.size;
+      if (record.index < 0) {
+        PageSource::deallocate(record.begin, record.size);
+        continue;
+      }
+      PageSource::decommit(record.begin, record.size);
+      record.idle = true;
+    }
+    chunks[kept++] = record;
+  }
+  nchunks = kept;
+  heap_size -= released;
+  return (released);
+}
+
+template <bool threads, int inst, class PageSource>
+alloc_stats __default_alloc_template<threads, inst, PageSource>::get_stats() {
+  const __size_class_map& map = __size_classes();
+  alloc_stats s = alloc_stats();
+  s.enabled = MINISTL_ALLOC_STATS != 0;
+  s.classes.resize(__NFREELISTS);
+  for (size_t i = 0; i < __NFREELISTS; ++i) {
+    s.classes[i].size = map.class_size[i];
+  }
+  counters.fill(s, map.class_size);
+  lock lock_instance;
+  s.heap_size = heap_size;
+  if (s.peak_heap_size < heap_size) {
+    s.peak_heap_size = heap_size;
+  }
+  s.nchunks = nchunks;
+  for (size_t c = 0; c < nchunks; ++c) {
+    s.idle_slabs += chunks[c].idle;
+  }
+  return (s);
+}
+
+template <bool threads, int inst, class PageSource>
+void __default_alloc_template<threads, inst, PageSource>::start_background_trim(
+    unsigned interval_ms) {
+  static_assert(threads, "background trim needs the threaded allocator");
+  std::lock_guard<std::mutex> guard(central_mutex);
+  if (trim_thread != 0) {
+    return;
+  }
+  trim_stop = false;
+  trim_thread = new std::thread([interval_ms]() {
+    std::unique_lock<std::mutex> guard(central_mutex);
+    while (!trim_cond.wait_for(guard, std::chrono::milliseconds(interval_ms),
+                               []() { return trim_stop; })) {
+      // trim自己会加锁
+      guard.unlock();
+      trim();
+      guard.lock();
+    }
+  });
+}
+
+template <bool threads, int inst, class PageSource>
+void __default_alloc_template<threads, inst, PageSource>::stop_background_trim() {
+  std::thread* t;
+  {
+    std::lock_guard<std::mutex> guard(central_mutex);
+    t = trim_thread;
+    trim_thread = 0;
+    trim_stop = true;
+  }
+  if (t != 0) {
+    trim_cond.notify_all();
+    t->join();
+    delete t;
+  }
+}
+// 默认用第二级空间配置器, 多线程程序可以预先定义__NODE_ALLOCATOR_THREADS为true
+#ifndef __NODE_ALLOCATOR_THREADS
+#define __NODE_ALLOCATOR_THREADS false
+#endif
+typedef __default_alloc_template<__NODE_ALLOCATOR_THREADS, 0> alloc;
+// 不论如何配置都只给单线程使用的版本
+typedef __default_alloc_template<false, 0> single_client_alloc;
+// 不论如何配置都可以被多个线程同时使用的版本
+typedef __default_alloc_template<true, 0> multithreaded_alloc;
 
 }  // namespace ministl
\ No newline at end of file
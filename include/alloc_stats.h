@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// 定义MINISTL_ALLOC_STATS为1打开内存池统计, 默认关闭, 关闭时所有统计代码都是空函数
+#ifndef MINISTL_ALLOC_STATS
+#define MINISTL_ALLOC_STATS 0
+#endif
+
+namespace ministl {
+
+// 一个等级(free-list)的统计
+struct alloc_class_stats {
+  size_t size;         // 区块大小
+  uint64_t allocs;     // 分配次数
+  uint64_t frees;      // 回收次数
+  uint64_t hits;       // 直接从free-list(或线程缓存)取到区块的次数
+  uint64_t misses;     // free-list为空, 需要向中心池或refill要区块的次数
+  uint64_t refills;    // refill切分新区块的次数
+  size_t in_use_objs;  // 使用中的区块数
+  size_t cached_objs;  // 已切分出来, 空闲在各级free-list上的区块数
+};
+
+// 内存池某一时刻的统计快照
+struct alloc_stats {
+  bool enabled;  // 编译时是否打开了统计, 为false时只有heap_size和内存块数有效
+  std::vector<alloc_class_stats> classes;
+  size_t heap_size;          // 内存池当前持有的系统内存
+  size_t peak_heap_size;     // heap_size的最高水位
+  size_t in_use_bytes;       // 按区块大小计算的使用中字节数
+  size_t peak_in_use_bytes;  // in_use_bytes的最高水位
+  size_t requested_bytes;    // 调用者实际请求的字节数
+  size_t cached_bytes;       // 空闲在各级free-list上的字节数
+  size_t nchunks;            // 内存池记录的内存块(含slab)数量
+  size_t idle_slabs;         // 物理页已归还、等待重新使用的slab数量
+  uint64_t large_allocs;     // 超过__MAX_BYTES, 交给第一级配置器的分配次数
+  uint64_t large_frees;
+  size_t large_in_use_bytes;
+
+  // 内部碎片: 区块向上取整浪费的比例
+  double internal_fragmentation() const {
+    return in_use_bytes == 0 ? 0.0
+                             : 1.0 - (double)requested_bytes / in_use_bytes;
+  }
+  // 外部碎片: 持有的系统内存中没有被使用的比例
+  double external_fragmentation() const {
+    return heap_size == 0 ? 0.0 : 1.0 - (double)in_use_bytes / heap_size;
+  }
+
+  // 便于阅读的文本格式, 只列出有过活动的等级
+  void dump(std::ostream& os) const {
+    os << "heap_size " << heap_size << " (peak " << peak_heap_size << ")\n"
+       << "in_use_bytes " << in_use_bytes << " (peak " << peak_in_use_bytes
+       << ")\n"
+       << "requested_bytes " << requested_bytes << "\n"
+       << "cached_bytes " << cached_bytes << "\n"
+       << "chunks " << nchunks << " (idle slabs " << idle_slabs << ")\n"
+       << "large allocs " << large_allocs << " frees " << large_frees
+       << " in_use_bytes " << large_in_use_bytes << "\n";
+    if (!enabled) {
+      os << "(counters disabled, define MINISTL_ALLOC_STATS=1)\n";
+      return;
+    }
+    os << "fragmentation internal " << internal_fragmentation() << " external "
+       << external_fragmentation() << "\n";
+    os << "size allocs frees hits misses refills in_use cached\n";
+    for (size_t i = 0; i < classes.size(); ++i) {
+      const alloc_class_stats& c = classes[i];
+      if (c.allocs == 0 && c.cached_objs == 0) {
+        continue;
+      }
+      os << c.size << ' ' << c.allocs << ' ' << c.frees << ' ' << c.hits
+         << ' ' << c.misses << ' ' << c.refills << ' ' << c.in_use_objs << ' '
+         << c.cached_objs << '\n';
+    }
+  }
+
+  // JSON格式, 便于监控系统采集
+  void dump_json(std::ostream& os) const {
+    os << "{\"enabled\":" << (enabled ? "true" : "false")
+       << ",\"heap_size\":" << heap_size
+       << ",\"peak_heap_size\":" << peak_heap_size
+       << ",\"in_use_bytes\":" << in_use_bytes
+       << ",\"peak_in_use_bytes\":" << peak_in_use_bytes
+       << ",\"requested_bytes\":" << requested_bytes
+       << ",\"cached_bytes\":" << cached_bytes << ",\"nchunks\":" << nchunks
+       << ",\"idle_slabs\":" << idle_slabs
+       << ",\"large_allocs\":" << large_allocs
+       << ",\"large_frees\":" << large_frees
+       << ",\"large_in_use_bytes\":" << large_in_use_bytes
+       << ",\"internal_fragmentation\":" << internal_fragmentation()
+       << ",\"external_fragmentation\":" << external_fragmentation()
+       << ",\"classes\":[";
+    for (size_t i = 0; i < classes.size(); ++i) {
+      const alloc_class_stats& c = classes[i];
+      os << (i == 0 ? "" : ",") << "{\"size\":" << c.size
+         << ",\"allocs\":" << c.allocs << ",\"frees\":" << c.frees
+         << ",\"hits\":" << c.hits << ",\"misses\":" << c.misses
+         << ",\"refills\":" << c.refills << ",\"in_use\":" << c.in_use_objs
+         << ",\"cached\":" << c.cached_objs << "}";
+    }
+    os << "]}\n";
+  }
+};
+
+// 内存池内部使用的计数器, 关闭统计时是空类, 所有函数都是空的
+template <bool enabled, size_t NCLASSES>
+struct __alloc_counters {
+  void on_allocate(size_t, size_t, size_t) {}
+  void on_deallocate(size_t, size_t, size_t) {}
+  void on_hit(size_t, size_t) {}
+  void on_miss(size_t) {}
+  void on_refill(size_t, size_t) {}
+  void on_carve(size_t, size_t) {}
+  void on_release(size_t, size_t) {}
+  void on_heap(size_t) {}
+  void on_large_allocate(size_t) {}
+  void on_large_deallocate(size_t) {}
+  void fill(alloc_stats&, const unsigned int*) const {}
+};
+
+// 打开统计时用relaxed原子计数, 各线程共享计数器会有一定的争用
+template <size_t NCLASSES>
+struct __alloc_counters<true, NCLASSES> {
+  std::atomic<uint64_t> allocs[NCLASSES];
+  std::atomic<uint64_t> frees[NCLASSES];
+  std::atomic<uint64_t> hits[NCLASSES];
+  std::atomic<uint64_t> misses[NCLASSES];
+  std::atomic<uint64_t> refills[NCLASSES];
+  std::atomic<uint64_t> carved[NCLASSES];  // 切分出来且尚未trim掉的区块数
+  std::atomic<size_t> in_use_bytes;
+  std::atomic<size_t> peak_in_use_bytes;
+  std::atomic<size_t> requested_bytes;
+  std::atomic<size_t> peak_heap_size;
+  std::atomic<uint64_t> large_allocs;
+  std::atomic<uint64_t> large_frees;
+  std::atomic<size_t> large_in_use_bytes;
+
+  static void raise(std::atomic<size_t>& peak, size_t value) {
+    size_t old = peak.load(std::memory_order_relaxed);
+    while (old < value && !peak.compare_exchange_weak(
+                              old, value, std::memory_order_relaxed)) {
+    }
+  }
+  // index为free-list下标, size为区块大小, n为请求的字节数
+  void on_allocate(size_t index, size_t size, size_t n) {
+    allocs[index].fetch_add(1, std::memory_order_relaxed);
+    requested_bytes.fetch_add(n, std::memory_order_relaxed);
+    raise(peak_in_use_bytes,
+          in_use_bytes.fetch_add(size, std::memory_order_relaxed) + size);
+  }
+  void on_deallocate(size_t index, size_t size, size_t n) {
+    frees[index].fetch_add(1, std::memory_order_relaxed);
+    requested_bytes.fetch_sub(n, std::memory_order_relaxed);
+    in_use_bytes.fetch_sub(size, std::memory_order_relaxed);
+  }
+  // 直接从free-list(或线程缓存)取到nobjs个区块, allocate_batch一次可以取一串
+  void on_hit(size_t index, size_t nobjs) {
+    hits[index].fetch_add(nobjs, std::memory_order_relaxed);
+  }
+  void on_miss(size_t index) {
+    misses[index].fetch_add(1, std::memory_order_relaxed);
+  }
+  void on_refill(size_t index, size_t nobjs) {
+    refills[index].fetch_add(1, std::memory_order_relaxed);
+    carved[index].fetch_add(nobjs, std::memory_order_relaxed);
+  }
+  // chunk_alloc把剩余的零头切成nobjs个区块挂到free-list上
+  void on_carve(size_t index, size_t nobjs) {
+    carved[index].fetch_add(nobjs, std::memory_order_relaxed);
+  }
+  // trim把nobjs个空闲区块连同所在内存一起还给了系统
+  void on_release(size_t index, size_t nobjs) {
+    carved[index].fetch_sub(nobjs, std::memory_order_relaxed);
+  }
+  void on_heap(size_t heap_size) { raise(peak_heap_size, heap_size); }
+  void on_large_allocate(size_t n) {
+    large_allocs.fetch_add(1, std::memory_order_relaxed);
+    large_in_use_bytes.fetch_add(n, std::memory_order_relaxed);
+  }
+  void on_large_deallocate(size_t n) {
+    large_frees.fetch_add(1, std::memory_order_relaxed);
+    large_in_use_bytes.fetch_sub(n, std::memory_order_relaxed);
+  }
+
+  void fill(alloc_stats& s, const unsigned int* class_size) const {
+    s.cached_bytes = 0;
+    for (size_t i = 0; i < NCLASSES; ++i) {
+      alloc_class_stats& c = s.classes[i];
+      c.allocs = allocs[i].load(std::memory_order_relaxed);
+      c.frees = frees[i].load(std::memory_order_relaxed);
+      c.misses = misses[i].load(std::memory_order_relaxed);
+      c.hits = hits[i].load(std::memory_order_relaxed);
+      c.refills = refills[i].load(std::memory_order_relaxed);
+      c.in_use_objs = c.allocs - c.frees;
+      c.cached_objs = carved[i].load(std::memory_order_relaxed) - c.in_use_objs;
+      s.cached_bytes += c.cached_objs * class_size[i];
+    }
+    s.in_use_bytes = in_use_bytes.load(std::memory_order_relaxed);
+    s.peak_in_use_bytes = peak_in_use_bytes.load(std::memory_order_relaxed);
+    s.requested_bytes = requested_bytes.load(std::memory_order_relaxed);
+    s.peak_heap_size = peak_heap_size.load(std::memory_order_relaxed);
+    s.large_allocs = large_allocs.load(std::memory_order_relaxed);
+    s.large_frees = large_frees.load(std::memory_order_relaxed);
+    s.large_in_use_bytes = large_in_use_bytes.load(std::memory_order_relaxed);
+  }
+};
+
+}  // namespace ministl
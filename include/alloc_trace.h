@@ -0,0 +1,210 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+// 定义MINISTL_ALLOC_TRACE为1编入内存池的分配跟踪, 默认关闭, 关闭时所有跟踪代码都是空函数
+// 编入之后, 设置环境变量MINISTL_ALLOC_TRACE_FILE或调用alloc_trace_open才真正开始记录
+// 记录先写进每个线程私有的缓冲区, 满了才加锁整批写入文件, 线程退出时写出剩余的部分
+// 文件格式: 一个alloc_trace_header, 之后是连续的alloc_trace_event
+// 同一个文件中各线程的记录按批交错, 回放时需要按time排序, 见bench/alloc_replay.cc
+#ifndef MINISTL_ALLOC_TRACE
+#define MINISTL_ALLOC_TRACE 0
+#endif
+
+namespace ministl {
+
+struct alloc_trace_header {
+  char magic[8];  // "MSTLTRC"
+  uint32_t version;
+  uint32_t event_size;
+};
+
+// 一次分配或回收, 24字节
+struct alloc_trace_event {
+  enum { ALLOCATE = 0, DEALLOCATE = 1 };
+  uint64_t time;    // steady_clock的纳秒数
+  uint64_t addr;    // 区块地址, 回放时用来配对分配和回收
+  uint32_t size;    // 请求的字节数
+  uint16_t thread;  // 线程编号, 按第一次记录的先后从0开始
+  uint8_t op;
+  uint8_t inst;  // 内存池模板参数inst的低8位
+};
+
+static_assert(sizeof(alloc_trace_event) == 24, "compact trace event");
+
+// 所有线程共享的跟踪文件
+class __alloc_trace_file {
+ public:
+  enum { UNKNOWN = 0, ON = 1, OFF = 2 };
+
+  static __alloc_trace_file& instance() {
+    static __alloc_trace_file file;
+    return file;
+  }
+  // 第一次记录时检查环境变量
+  bool active() {
+    int s = state.load(std::memory_order_acquire);
+    if (s == UNKNOWN) {
+      const char* path = std::getenv("MINISTL_ALLOC_TRACE_FILE");
+      if (path == 0 || !open(path)) {
+        int expected = UNKNOWN;
+        state.compare_exchange_strong(expected, OFF);
+      }
+      s = state.load(std::memory_order_acquire);
+    }
+    return s == ON;
+  }
+  bool open(const char* path) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (file != 0) {
+      fclose(file);
+    }
+    file = fopen(path, "wb");
+    if (file == 0) {
+      return false;
+    }
+    alloc_trace_header header;
+    memcpy(header.magic, "MSTLTRC", 8);
+    header.version = 1;
+    header.event_size = sizeof(alloc_trace_event);
+    fwrite(&header, sizeof(header), 1, file);
+    state.store(ON, std::memory_order_release);
+    return true;
+  }
+  void close() {
+    std::lock_guard<std::mutex> guard(mutex);
+    state.store(OFF, std::memory_order_release);
+    if (file != 0) {
+      fclose(file);
+      file = 0;
+    }
+  }
+  void write(const alloc_trace_event* events, size_t n) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (file != 0) {
+      fwrite(events, sizeof(alloc_trace_event), n, file);
+    }
+  }
+  uint16_t next_thread() {
+    return (uint16_t)threads.fetch_add(1, std::memory_order_relaxed);
+  }
+  ~__alloc_trace_file() { close(); }
+
+ private:
+  std::mutex mutex;
+  FILE* file;
+  std::atomic<int> state;
+  std::atomic<unsigned> threads;
+  __alloc_trace_file() : file(0), state(UNKNOWN), threads(0) {}
+};
+
+// 线程私有的记录缓冲区
+struct __alloc_trace_buffer {
+  enum { CAPACITY = 1024 };
+  alloc_trace_event events[CAPACITY];
+  size_t count;
+  uint16_t thread;
+  bool destroyed;  // 线程退出后仍可能有析构函数在回收内存, 此时直接写文件
+
+  __alloc_trace_buffer()
+      : count(0),
+        thread(__alloc_trace_file::instance().next_thread()),
+        destroyed(false) {}
+  ~__alloc_trace_buffer() {
+    flush();
+    destroyed = true;
+  }
+  void flush() {
+    if (count != 0) {
+      __alloc_trace_file::instance().write(events, count);
+      count = 0;
+    }
+  }
+  static __alloc_trace_buffer& local() {
+    static thread_local __alloc_trace_buffer buffer;
+    return buffer;
+  }
+};
+
+inline void __alloc_trace_record(int op, int inst, const void* p, size_t n) {
+  __alloc_trace_file& file = __alloc_trace_file::instance();
+  if (!file.active()) {
+    return;
+  }
+  __alloc_trace_buffer& buffer = __alloc_trace_buffer::local();
+  alloc_trace_event e;
+  e.time = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+               .count();
+  e.addr = (uint64_t)(uintptr_t)p;
+  e.size = (uint32_t)n;
+  e.thread = buffer.thread;
+  e.op = (uint8_t)op;
+  e.inst = (uint8_t)inst;
+  if (buffer.destroyed) {
+    file.write(&e, 1);
+    return;
+  }
+  buffer.events[buffer.count++] = e;
+  if (buffer.count == __alloc_trace_buffer::CAPACITY) {
+    buffer.flush();
+  }
+}
+
+// 开始把记录写到path, 覆盖MINISTL_ALLOC_TRACE_FILE
+inline bool alloc_trace_open(const char* path) {
+  return __alloc_trace_file::instance().open(path);
+}
+// 写出调用线程缓冲区中的记录
+inline void alloc_trace_flush() { __alloc_trace_buffer::local().flush(); }
+// 写出调用线程的记录并关闭文件, 其他线程缓冲区中尚未写出的记录会被丢弃
+inline void alloc_trace_close() {
+  alloc_trace_flush();
+  __alloc_trace_file::instance().close();
+}
+
+// 读入整个跟踪文件, 格式不对时返回false
+inline bool alloc_trace_read(const char* path,
+                             std::vector<alloc_trace_event>& events) {
+  FILE* file = fopen(path, "rb");
+  if (file == 0) {
+    return false;
+  }
+  alloc_trace_header header;
+  bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+            memcmp(header.magic, "MSTLTRC", 8) == 0 &&
+            header.event_size == sizeof(alloc_trace_event);
+  alloc_trace_event e;
+  while (ok && fread(&e, sizeof(e), 1, file) == 1) {
+    events.push_back(e);
+  }
+  fclose(file);
+  return ok;
+}
+
+// 内存池内部使用的跟踪接口, 关闭跟踪时所有函数都是空的
+template <bool enabled>
+struct __alloc_tracer {
+  static void on_allocate(int, const void*, size_t) {}
+  static void on_deallocate(int, const void*, size_t) {}
+};
+
+template <>
+struct __alloc_tracer<true> {
+  static void on_allocate(int inst, const void* p, size_t n) {
+    __alloc_trace_record(alloc_trace_event::ALLOCATE, inst, p, n);
+  }
+  static void on_deallocate(int inst, const void* p, size_t n) {
+    __alloc_trace_record(alloc_trace_event::DEALLOCATE, inst, p, n);
+  }
+};
+
+}  // namespace ministl
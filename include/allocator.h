@@ -1,33 +1,54 @@
 #pragma once
 
-#include <climits>
 #include <cstddef>
-#include <cstdlib>
-#include <iostream>
 #include <new>
+#include <type_traits>
+#include <utility>
+
+#include "alloc.h"
 
 namespace ministl {
 
+// 放得进内存池的请求交给内存池, 其余的直接用operator new(失败时抛出bad_alloc)
+// alignof(T)超过__ALIGN的类型交给内存池带对齐参数的版本
+// allocator可能被多个线程同时使用(和operator new一样), 所以用加锁的
+// multithreaded_alloc, 而不是默认只给单线程用的alloc
+// size * sizeof(T)溢出(或size为负)时抛出bad_array_new_length, 不能回绕成一个小区块
 template <class T>
 inline T* _allocate(ptrdiff_t size, T*) {
-  std::set_new_handler(0);
-  T* tmp = (T*)(::operator new((size_t)(size * sizeof(T))));
-  if (tmp == 0) {
-    std::cerr << "out of memory!" << std::endl;
-    std::exit(1);
+  if ((size_t)size > size_t(-1) / sizeof(T)) {
+    throw std::bad_array_new_length();
+  }
+  size_t bytes = (size_t)size * sizeof(T);
+  if (alignof(T) > (size_t)__ALIGN) {
+    return (T*)multithreaded_alloc::allocate(bytes, alignof(T));
   }
-  return tmp;
+  if (bytes <= (size_t)__MAX_BYTES) {
+    return (T*)multithreaded_alloc::allocate(bytes);
+  }
+  return (T*)(::operator new(bytes));
 }
 
+// 必须和_allocate时的size一致, 才能找回同一个free-list
 template <class T>
-inline void _deallocate(T* buffer) {
+inline void _deallocate(T* buffer, ptrdiff_t size) {
+  size_t bytes = (size_t)size * sizeof(T);
+  if (alignof(T) > (size_t)__ALIGN) {
+    multithreaded_alloc::deallocate(buffer, bytes, alignof(T));
+    return;
+  }
+  if (bytes <= (size_t)__MAX_BYTES) {
+    multithreaded_alloc::deallocate(buffer, bytes);
+    return;
+  }
   ::operator delete(buffer);
 }
 
 // 这里的construct调用的是placement new, 在一个已经获得的内存里建立一个对象
-template <class T1, class T2>
-inline void _construct(T1* p, const T2& value) {
-  new (p) T1(value);
+// 参数原样转发给构造函数, 右值会调用移动构造
+template <class T1, class... Args>
+inline void _construct(T1* p, Args&&... args) {
+  new ((void*)p) T1(std::forward<Args>(args)...);
 }
 
 template <class T>
@@ -35,6 +56,8 @@ inline void _destroy(T* ptr) {
   ptr->~T();
 }
 
+// 符合C++11要求的allocator, 可以直接用于标准容器(经由std::allocator_traits)
+// 没有状态, 任意两个实例都相等
 template <class T>
 class allocator {
  public:
@@ -45,21 +68,56 @@ class allocator {
   typedef const T& const_reference;
   typedef size_t size_type;
   typedef ptrdiff_t difference_type;
+  // 这几个类型会被标准库拿去做标签分派, 所以用std的true_type/false_type
+  typedef std::false_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::false_type propagate_on_container_swap;
+  typedef std::true_type is_always_equal;
 
   template <class U>
   struct rebind {
     typedef allocator<U> other;
   };
 
+  allocator() noexcept {}
+  allocator(const allocator&) noexcept {}
+  template <class U>
+  allocator(const allocator<U>&) noexcept {}
+
+  // 内存池和operator new都无从利用hint, 与std::allocator一样忽略它
   pointer allocate(size_type n, const void* hint = 0) {
-    return _allocate((difference_type)n, (pointer)0);
+    (void)hint;
+    return n == 0 ? 0 : _allocate((difference_type)n, (pointer)0);
+  }
+  void deallocate(pointer ptr, size_type n) {
+    if (ptr != 0) {
+      _deallocate(ptr, (difference_type)n);
+    }
   }
-  void deallocate(pointer ptr) { _deallocate(ptr); }
-  void construct(pointer ptr, const_reference value) { _construct(ptr, value); }
-  void destroy(pointer ptr) { _destroy(ptr); }
-  pointer address(reference x) { return (pointer)&x; }
-  const_pointer const_adress(const_reference x) { return (const_pointer)&x; }
-  size_type max_size() const { return size_type(UINT_MAX / sizeof(T)); }
+  template <class U, class... Args>
+  void construct(U* ptr, Args&&... args) {
+    _construct(ptr, std::forward<Args>(args)...);
+  }
+  template <class U>
+  void destroy(U* ptr) {
+    _destroy(ptr);
+  }
+  pointer address(reference x) const { return (pointer)&x; }
+  const_pointer address(const_reference x) const { return (const_pointer)&x; }
+  const_pointer const_adress(const_reference x) const {
+    return (const_pointer)&x;
+  }
+  size_type max_size() const { return size_type(-1) / sizeof(T); }
 };
 
-}  // namespace ministl
\ No newline at end of file
+template <class T, class U>
+inline bool operator==(const allocator<T>&, const allocator<U>&) {
+  return true;
+}
+
+template <class T, class U>
+inline bool operator!=(const allocator<T>&, const allocator<U>&) {
+  return false;
+}
+
+}  // namespace ministl
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "alloc.h"
+
+namespace ministl {
+
+// 区域(arena)配置器: 在一串不断变大的内存块中顺序(bump pointer)分配,
+// 单个对象的回收几乎什么都不做, 用完之后用release()/reset()一次性全部释放
+// 适合"分配一大批短命对象, 然后整体丢弃"的场景, 例如一次请求的处理过程
+// 可以提供一块调用者自己的初始缓冲区(例如栈上的数组), 用完了才向系统要内存块
+class arena {
+ private:
+  // 每个内存块开头的头部, 内存块用next串成链表, 最新的在最前面
+  struct block {
+    block* next;
+    size_t size;
+  };
+  enum { HEADER_SIZE = (sizeof(block) + __ALIGN - 1) & ~(__ALIGN - 1) };
+  enum { MAX_BLOCK_SIZE = 1024 * 1024 };
+
+  char* cur;
+  char* end;
+  block* blocks;
+  char* initial;  // 调用者提供的缓冲区, 不归arena释放
+  size_t initial_size;
+  size_t first_block_size;
+  size_t next_block_size;  // 每次加倍, 最多MAX_BLOCK_SIZE
+  size_t used;             // 已分配出去的字节数
+
+  static size_t ALIGN_UP(size_t bytes, size_t align) {
+    return (bytes + align - 1) & ~(align - 1);
+  }
+  // 当前内存块放不下时, 申请一个能放下n字节的新内存块
+  void* allocate_slow(size_t n, size_t align) {
+    size_t size = next_block_size;
+    if (next_block_size < MAX_BLOCK_SIZE) {
+      next_block_size *= 2;
+    }
+    if (size < HEADER_SIZE + n + align) {
+      size = HEADER_SIZE + n + align;
+    }
+    block* b = (block*)malloc_alloc::allocate(size);
+    b->next = blocks;
+    b->size = size;
+    blocks = b;
+    cur = (char*)b + HEADER_SIZE;
+    end = (char*)b + size;
+    return allocate(n, align);
+  }
+
+ public:
+  explicit arena(size_t block_size = 4096)
+      : cur(0),
+        end(0),
+        blocks(0),
+        initial(0),
+        initial_size(0),
+        first_block_size(block_size),
+        next_block_size(block_size),
+        used(0) {}
+  // buffer由调用者提供, 生命周期要比arena长
+  arena(void* buffer, size_t size, size_t block_size = 4096)
+      : cur((char*)buffer),
+        end((char*)buffer + size),
+        blocks(0),
+        initial((char*)buffer),
+        initial_size(size),
+        first_block_size(block_size),
+        next_block_size(block_size),
+        used(0) {}
+  ~arena() { release(); }
+
+  void* allocate(size_t n, size_t align = __ALIGN) {
+    char* result = (char*)ALIGN_UP((size_t)cur, align);
+    if (result + n > end) {
+      return allocate_slow(n, align);
+    }
+    cur = result + ALIGN_UP(n, __ALIGN);
+    used += n;
+    return result;
+  }
+  // 只有最近一次分配的对象才能真正收回空间, 其余的等release/reset
+  // 不是本arena分配的p(例如arena_alloc换了绑定之后才回收)不做任何事, 计数不会下溢
+  void deallocate(void* p, size_t n) {
+    if ((char*)p + ALIGN_UP(n, __ALIGN) == cur) {
+      cur = (char*)p;
+    } else if (!owns(p)) {
+      return;
+    }
+    used -= n;
+  }
+  // p是否在本arena的初始缓冲区或某个内存块中, O(内存块数)
+  bool owns(const void* p) const {
+    const char* q = (const char*)p;
+    if (q >= initial && q < initial + initial_size) {
+      return true;
+    }
+    for (block* b = blocks; b != 0; b = b->next) {
+      if (q >= (char*)b + HEADER_SIZE && q < (char*)b + b->size) {
+        return true;
+      }
+    }
+    return false;
+  }
+  // 释放所有内存块, 回到只有初始缓冲区的状态, O(内存块数)
+  void release() {
+    while (blocks != 0) {
+      block* next = blocks->next;
+      malloc_alloc::deallocate(blocks, blocks->size);
+      blocks = next;
+    }
+    cur = initial;
+    end = initial + initial_size;
+    next_block_size = first_block_size;
+    used = 0;
+  }
+  // 丢弃所有对象, 但保留最近(也是最大)的内存块继续使用, O(内存块数)
+  void reset() {
+    if (blocks == 0) {
+      release();
+      return;
+    }
+    block* keep = blocks;
+    blocks = blocks->next;
+    release();
+    keep->next = 0;
+    blocks = keep;
+    cur = (char*)keep + HEADER_SIZE;
+    end = (char*)keep + keep->size;
+  }
+  // 已分配出去(还没有回收)的字节数
+  size_t bytes_used() const { return used; }
+  // 向系统要的内存块的总字节数, 不含初始缓冲区
+  size_t bytes_reserved() const {
+    size_t total = 0;
+    for (block* b = blocks; b != 0; b = b->next) {
+      total += b->size;
+    }
+    return total;
+  }
+
+ private:
+  arena(const arena&);
+  arena& operator=(const arena&);
+};
+
+// 符合simple_alloc要求的静态接口, 从当前线程绑定的arena上分配
+// 用scope把一个arena绑定到当前线程, 没有绑定时使用每个线程自己的默认arena
+// 回收也交给当前绑定的arena, 绑定已经换掉时回收被忽略, 空间等原来的arena整体释放
+template <int inst>
+class __arena_alloc_template {
+ private:
+  static arena*& bound() {
+    static thread_local arena* current = 0;
+    return current;
+  }
+
+ public:
+  static arena& current() {
+    arena* a = bound();
+    if (a == 0) {
+      static thread_local arena default_arena;
+      a = &default_arena;
+    }
+    return *a;
+  }
+  static void* allocate(size_t n) { return current().allocate(n); }
+  static void deallocate(void* p, size_t n) { current().deallocate(p, n); }
+  static void* allocate(size_t n, size_t align) {
+    return current().allocate(n,
+                              align < (size_t)__ALIGN ? (size_t)__ALIGN : align);
+  }
+  static void deallocate(void* p, size_t n, size_t) {
+    current().deallocate(p, n);
+  }
+  static void* reallocate(void* p, size_t old_sz, size_t new_sz) {
+    if (new_sz <= old_sz) {
+      return p;
+    }
+    void* result = allocate(new_sz);
+    memcpy(result, p, old_sz);
+    deallocate(p, old_sz);
+    return result;
+  }
+  static void release() { current().release(); }
+  static void reset() { current().reset(); }
+
+  // 在作用域内把a绑定到当前线程, 离开时恢复原来的绑定
+  class scope {
+   public:
+    explicit scope(arena& a) : old(bound()) { bound() = &a; }
+    ~scope() { bound() = old; }
+
+   private:
+    arena* old;
+    scope(const scope&);
+    scope& operator=(const scope&);
+  };
+};
+
+typedef __arena_alloc_template<0> arena_alloc;
+
+// 绑定到某个arena实例上的allocator, 接口与allocator<T>相同,
+// 也可以作为标准容器的分配器
+template <class T>
+class arena_allocator {
+ public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template <class U>
+  struct rebind {
+    typedef arena_allocator<U> other;
+  };
+
+  explicit arena_allocator(arena& a) : a(&a) {}
+  template <class U>
+  arena_allocator(const arena_allocator<U>& other) : a(&other.get_arena()) {}
+
+  pointer allocate(size_type n, const void* = 0) {
+    size_t align = alignof(T) > (size_t)__ALIGN ? alignof(T) : (size_t)__ALIGN;
+    return (pointer)a->allocate(n * sizeof(T), align);
+  }
+  void deallocate(pointer p, size_type n) { a->deallocate(p, n * sizeof(T)); }
+  // 完美转发参数, 右值和只能移动的类型不会被复制
+  template <class U, class... Args>
+  void construct(U* p, Args&&... args) {
+    new ((void*)p) U(std::forward<Args>(args)...);
+  }
+  template <class U>
+  void destroy(U* p) {
+    p->~U();
+  }
+  size_type max_size() const { return size_type(-1) / sizeof(T); }
+  arena& get_arena() const { return *a; }
+
+ private:
+  arena* a;
+};
+
+template <class T, class U>
+inline bool operator==(const arena_allocator<T>& lhs,
+                       const arena_allocator<U>& rhs) {
+  return &lhs.get_arena() == &rhs.get_arena();
+}
+
+template <class T, class U>
+inline bool operator!=(const arena_allocator<T>& lhs,
+                       const arena_allocator<U>& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace ministl
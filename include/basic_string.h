@@ -0,0 +1,953 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <functional>
+#include <initializer_list>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "alloc.h"
+#include "iterator.h"
+#include "type_traits.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MINISTL_STRING_SSE2 1
+#else
+#define MINISTL_STRING_SSE2 0
+#endif
+
+namespace ministl {
+
+// 字符串用到的字符操作, 一般的字符类型逐个处理
+template <class CharT>
+struct __char_traits {
+  static size_t length(const CharT* s) {
+    size_t n = 0;
+    while (s[n] != CharT()) {
+      ++n;
+    }
+    return n;
+  }
+  static int compare(const CharT* s1, const CharT* s2, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      if (s1[i] < s2[i]) {
+        return -1;
+      }
+      if (s2[i] < s1[i]) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+  static const CharT* find(const CharT* s, size_t n, CharT c) {
+    for (; n > 0; --n, ++s) {
+      if (*s == c) {
+        return s;
+      }
+    }
+    return 0;
+  }
+  // [s, s + n)中第一次出现[p, p + m)的位置, 1 <= m <= n
+  static const CharT* search(const CharT* s, size_t n, const CharT* p,
+                             size_t m) {
+    const CharT* end = s + (n - m + 1);
+    while ((s = find(s, end - s, p[0])) != 0) {
+      if (compare(s + 1, p + 1, m - 1) == 0) {
+        return s;
+      }
+      if (++s == end) {
+        break;
+      }
+    }
+    return 0;
+  }
+  static void copy(CharT* d, const CharT* s, size_t n) {
+    if (n != 0) {
+      memcpy(d, s, n * sizeof(CharT));
+    }
+  }
+  static void move(CharT* d, const CharT* s, size_t n) {
+    if (n != 0) {
+      memmove(d, s, n * sizeof(CharT));
+    }
+  }
+  static void assign(CharT* d, size_t n, CharT c) {
+    for (; n > 0; --n, ++d) {
+      *d = c;
+    }
+  }
+};
+
+// char直接用libc中向量化的strlen/memcmp/memchr/memset,
+// 子串查找用SSE2一次检查16个起点的首尾字符, 只有首尾都相同的位置才比较中间部分
+template <>
+struct __char_traits<char> {
+  static size_t length(const char* s) { return strlen(s); }
+  static int compare(const char* s1, const char* s2, size_t n) {
+    return n == 0 ? 0 : memcmp(s1, s2, n);
+  }
+  static const char* find(const char* s, size_t n, char c) {
+    return n == 0 ? 0 : (const char*)memchr(s, c, n);
+  }
+  static const char* search(const char* s, size_t n, const char* p,
+                            size_t m) {
+    if (m == 1) {
+      return find(s, n, p[0]);
+    }
+#if MINISTL_STRING_SSE2
+    const __m128i first = _mm_set1_epi8(p[0]);
+    const __m128i last = _mm_set1_epi8(p[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+      __m128i block_first = _mm_loadu_si128((const __m128i*)(s + i));
+      __m128i block_last = _mm_loadu_si128((const __m128i*)(s + i + m - 1));
+      unsigned mask = (unsigned)_mm_movemask_epi8(
+          _mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                        _mm_cmpeq_epi8(last, block_last)));
+      for (size_t j = 0; mask != 0; ++j, mask >>= 1) {
+        if ((mask & 1) && compare(s + i + j + 1, p + 1, m - 2) == 0) {
+          return s + i + j;
+        }
+      }
+    }
+    // 剩下不满16个起点的部分
+    s += i;
+    n -= i;
+#endif
+    const char* end = s + (n - m + 1);
+    while ((s = find(s, end - s, p[0])) != 0) {
+      if (memcmp(s + 1, p + 1, m - 1) == 0) {
+        return s;
+      }
+      if (++s == end) {
+        break;
+      }
+    }
+    return 0;
+  }
+  static void copy(char* d, const char* s, size_t n) {
+    if (n != 0) {
+      memcpy(d, s, n);
+    }
+  }
+  static void move(char* d, const char* s, size_t n) {
+    if (n != 0) {
+      memmove(d, s, n);
+    }
+  }
+  static void assign(char* d, size_t n, char c) {
+    if (n != 0) {
+      memset(d, c, n);
+    }
+  }
+};
+
+template <>
+struct __char_traits<wchar_t> {
+  static size_t length(const wchar_t* s) { return wcslen(s); }
+  static int compare(const wchar_t* s1, const wchar_t* s2, size_t n) {
+    return n == 0 ? 0 : wmemcmp(s1, s2, n);
+  }
+  static const wchar_t* find(const wchar_t* s, size_t n, wchar_t c) {
+    return n == 0 ? 0 : wmemchr(s, c, n);
+  }
+  static const wchar_t* search(const wchar_t* s, size_t n, const wchar_t* p,
+                               size_t m) {
+    const wchar_t* end = s + (n - m + 1);
+    while ((s = find(s, end - s, p[0])) != 0) {
+      if (compare(s + 1, p + 1, m - 1) == 0) {
+        return s;
+      }
+      if (++s == end) {
+        break;
+      }
+    }
+    return 0;
+  }
+  static void copy(wchar_t* d, const wchar_t* s, size_t n) {
+    if (n != 0) {
+      wmemcpy(d, s, n);
+    }
+  }
+  static void move(wchar_t* d, const wchar_t* s, size_t n) {
+    if (n != 0) {
+      wmemmove(d, s, n);
+    }
+  }
+  static void assign(wchar_t* d, size_t n, wchar_t c) {
+    if (n != 0) {
+      wmemset(d, c, n);
+    }
+  }
+};
+
+// 字符串: 不超过LOCAL_CAPACITY个字符时放在对象内部的缓冲区里(短字符串优化),
+// 不配置任何内存; 更长的放在simple_alloc<CharT, Alloc>配置的堆缓冲区里,
+// 容量至少翻倍, 在堆上追加时用Alloc::reallocate, 同一等级内原地扩展.
+// 字符必须是可以按字节复制的类型, Alloc必须提供reallocate. 总是以CharT()结尾
+template <class CharT, class Alloc = alloc>
+class basic_string {
+ public:
+  typedef CharT value_type;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef value_type* iterator;
+  typedef const value_type* const_iterator;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef ministl::reverse_iterator<iterator, CharT> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator, CharT, const CharT&>
+      const_reverse_iterator;
+
+  static const size_type npos = size_type(-1);
+
+ protected:
+  typedef __char_traits<CharT> traits;
+  typedef simple_alloc<CharT, Alloc> data_allocator;
+  // 对象内部的缓冲区占16字节, char时可以放15个字符
+  enum { LOCAL_CAPACITY = 16 / sizeof(CharT) - 1 };
+
+  CharT* start;  // 指向local_buf或堆缓冲区
+  size_type len;
+  union {
+    size_type cap;  // 在堆上时的容量, 不含结尾的CharT()
+    CharT local_buf[LOCAL_CAPACITY + 1];
+  };
+
+  bool is_local() const { return start == local_buf; }
+  void set_length(size_type n) {
+    len = n;
+    start[n] = CharT();
+  }
+  static CharT* allocate(size_type n) { return data_allocator::allocate(n + 1); }
+  void dispose() {
+    if (!is_local()) {
+      data_allocator::deallocate(start, cap + 1);
+    }
+  }
+  void check_length(size_type n1, size_type n2, const char* s) const {
+    if (max_size() - (len - n1) < n2) {
+      throw std::length_error(s);
+    }
+  }
+  size_type check_pos(size_type pos, const char* s) const {
+    if (pos > len) {
+      throw std::out_of_range(s);
+    }
+    return pos;
+  }
+  // pos之后最多n个字符
+  size_type limit(size_type pos, size_type n) const {
+    return n < len - pos ? n : len - pos;
+  }
+  // 至少放得下n个字符时新的容量: 至少翻倍
+  size_type next_capacity(size_type n) const {
+    size_type c = capacity();
+    if (n < 2 * c) {
+      n = 2 * c;
+    }
+    return n > max_size() ? max_size() : n;
+  }
+  bool disjunct(const CharT* s) const {
+    return s < start || start + len < s;
+  }
+  // 把容量改成new_cap, new_cap不小于len
+  void reallocate_storage(size_type new_cap) {
+    if (new_cap <= (size_type)LOCAL_CAPACITY) {
+      if (!is_local()) {
+        CharT* old = start;
+        size_type old_cap = cap;
+        traits::copy(local_buf, old, len + 1);
+        data_allocator::deallocate(old, old_cap + 1);
+        start = local_buf;
+      }
+      return;
+    }
+    if (is_local()) {
+      CharT* p = allocate(new_cap);
+      traits::copy(p, local_buf, len + 1);
+      start = p;
+    } else {
+      start = data_allocator::reallocate(start, cap + 1, new_cap + 1);
+    }
+    cap = new_cap;
+  }
+  // 把[pos, pos + n1)换成[s, s + n2), 插入, 删除和追加都由这里完成
+  basic_string& replace_aux(size_type pos, size_type n1, const CharT* s,
+                            size_type n2) {
+    check_length(n1, n2, "basic_string::replace");
+    if (!disjunct(s) && n2 != 0) {
+      // s是本字符串的一部分, 先复制出来
+      basic_string tmp(s, n2);
+      return replace_aux(pos, n1, tmp.start, n2);
+    }
+    size_type new_len = len - n1 + n2;
+    size_type tail = len - pos - n1;
+    if (new_len <= capacity()) {
+      CharT* p = start + pos;
+      if (tail != 0 && n1 != n2) {
+        traits::move(p + n2, p + n1, tail);
+      }
+      traits::copy(p, s, n2);
+    } else if (tail == 0 && !is_local()) {
+      // 在堆上追加
+      reallocate_storage(next_capacity(new_len));
+      traits::copy(start + pos, s, n2);
+    } else {
+      size_type new_cap = next_capacity(new_len);
+      CharT* r = allocate(new_cap);
+      traits::copy(r, start, pos);
+      traits::copy(r + pos, s, n2);
+      traits::copy(r + pos + n2, start + pos + n1, tail);
+      dispose();
+      start = r;
+      cap = new_cap;
+    }
+    set_length(new_len);
+    return *this;
+  }
+  // 把[pos, pos + n1)换成n2个c
+  basic_string& replace_fill(size_type pos, size_type n1, size_type n2,
+                             CharT c) {
+    check_length(n1, n2, "basic_string::replace");
+    size_type new_len = len - n1 + n2;
+    size_type tail = len - pos - n1;
+    if (new_len <= capacity()) {
+      if (tail != 0 && n1 != n2) {
+        traits::move(start + pos + n2, start + pos + n1, tail);
+      }
+    } else if (tail == 0 && !is_local()) {
+      reallocate_storage(next_capacity(new_len));
+    } else {
+      size_type new_cap = next_capacity(new_len);
+      CharT* r = allocate(new_cap);
+      traits::copy(r, start, pos);
+      traits::copy(r + pos + n2, start + pos + n1, tail);
+      dispose();
+      start = r;
+      cap = new_cap;
+    }
+    traits::assign(start + pos, n2, c);
+    set_length(new_len);
+    return *this;
+  }
+  void initialize(const CharT* s, size_type n) {
+    start = local_buf;
+    if (n > (size_type)LOCAL_CAPACITY) {
+      start = allocate(n);
+      cap = n;
+    }
+    traits::copy(start, s, n);
+    set_length(n);
+  }
+  template <class Integer>
+  void range_initialize(Integer n, Integer c, std::true_type) {
+    start = local_buf;
+    set_length(0);
+    replace_fill(0, 0, (size_type)n, (CharT)c);
+  }
+  template <class InputIterator>
+  void range_initialize(InputIterator first, InputIterator last,
+                        std::false_type) {
+    range_initialize_aux(first, last, iterator_category(first));
+  }
+  template <class InputIterator>
+  void range_initialize_aux(InputIterator first, InputIterator last,
+                            input_iterator_tag) {
+    start = local_buf;
+    set_length(0);
+    try {
+      for (; first != last; ++first) {
+        push_back(*first);
+      }
+    } catch (...) {
+      dispose();
+      throw;
+    }
+  }
+  template <class ForwardIterator>
+  void range_initialize_aux(ForwardIterator first, ForwardIterator last,
+                            forward_iterator_tag) {
+    size_type n = (size_type)ministl::distance(first, last);
+    start = local_buf;
+    if (n > (size_type)LOCAL_CAPACITY) {
+      start = allocate(n);
+      cap = n;
+    }
+    for (CharT* p = start; first != last; ++first, ++p) {
+      *p = *first;
+    }
+    set_length(n);
+  }
+  // 公共部分用traits::compare一次比较, 相同时短的在前
+  static int compare_aux(const CharT* s1, size_type n1, const CharT* s2,
+                         size_type n2) {
+    int r = traits::compare(s1, s2, n1 < n2 ? n1 : n2);
+    if (r != 0) {
+      return r;
+    }
+    return n1 < n2 ? -1 : (n1 > n2 ? 1 : 0);
+  }
+
+ public:
+  basic_string() : start(local_buf) { set_length(0); }
+  basic_string(const CharT* s) { initialize(s, traits::length(s)); }
+  basic_string(const CharT* s, size_type n) { initialize(s, n); }
+  basic_string(size_type n, CharT c) : start(local_buf) {
+    set_length(0);
+    replace_fill(0, 0, n, c);
+  }
+  basic_string(const basic_string& x, size_type pos, size_type n = npos) {
+    x.check_pos(pos, "basic_string::basic_string");
+    initialize(x.start + pos, x.limit(pos, n));
+  }
+  template <class InputIterator>
+  basic_string(InputIterator first, InputIterator last) {
+    range_initialize(first, last, std::is_integral<InputIterator>());
+  }
+  basic_string(std::initializer_list<CharT> il) {
+    initialize(il.begin(), il.size());
+  }
+  basic_string(const basic_string& x) { initialize(x.start, x.len); }
+  // 被移走的字符串为空, 仍然可以使用
+  basic_string(basic_string&& x) noexcept {
+    if (x.is_local()) {
+      start = local_buf;
+      traits::copy(local_buf, x.local_buf, x.len + 1);
+    } else {
+      start = x.start;
+      cap = x.cap;
+      x.start = x.local_buf;
+    }
+    len = x.len;
+    x.set_length(0);
+  }
+  ~basic_string() { dispose(); }
+
+  basic_string& operator=(const basic_string& x) {
+    if (&x != this) {
+      assign(x.start, x.len);
+    }
+    return *this;
+  }
+  basic_string& operator=(basic_string&& x) noexcept {
+    if (&x == this) {
+      return *this;
+    }
+    if (x.is_local()) {
+      // 短字符串复制到自己的缓冲区, 必定放得下
+      traits::copy(start, x.start, x.len);
+      set_length(x.len);
+    } else {
+      dispose();
+      start = x.start;
+      cap = x.cap;
+      len = x.len;
+      x.start = x.local_buf;
+    }
+    x.set_length(0);
+    return *this;
+  }
+  basic_string& operator=(const CharT* s) { return assign(s); }
+  basic_string& operator=(CharT c) { return assign(size_type(1), c); }
+  basic_string& operator=(std::initializer_list<CharT> il) {
+    return assign(il.begin(), il.size());
+  }
+
+  basic_string& assign(const basic_string& x) { return *this = x; }
+  basic_string& assign(basic_string&& x) { return *this = std::move(x); }
+  basic_string& assign(const basic_string& x, size_type pos,
+                       size_type n = npos) {
+    x.check_pos(pos, "basic_string::assign");
+    return assign(x.start + pos, x.limit(pos, n));
+  }
+  basic_string& assign(const CharT* s, size_type n) {
+    return replace_aux(0, len, s, n);
+  }
+  basic_string& assign(const CharT* s) {
+    return assign(s, traits::length(s));
+  }
+  basic_string& assign(size_type n, CharT c) {
+    return replace_fill(0, len, n, c);
+  }
+  template <class InputIterator>
+  basic_string& assign(InputIterator first, InputIterator last) {
+    basic_string tmp(first, last);
+    return *this = std::move(tmp);
+  }
+  basic_string& assign(std::initializer_list<CharT> il) {
+    return assign(il.begin(), il.size());
+  }
+
+  iterator begin() { return start; }
+  const_iterator begin() const { return start; }
+  const_iterator cbegin() const { return start; }
+  iterator end() { return start + len; }
+  const_iterator end() const { return start + len; }
+  const_iterator cend() const { return start + len; }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  size_type size() const { return len; }
+  size_type length() const { return len; }
+  size_type max_size() const { return (size_type(-1) / sizeof(CharT) - 1) / 2; }
+  size_type capacity() const {
+    return is_local() ? (size_type)LOCAL_CAPACITY : cap;
+  }
+  bool empty() const { return len == 0; }
+  void reserve(size_type n) {
+    if (n > max_size()) {
+      throw std::length_error("basic_string::reserve");
+    }
+    if (n > capacity()) {
+      reallocate_storage(n);
+    }
+  }
+  void shrink_to_fit() {
+    if (!is_local() && len < cap) {
+      reallocate_storage(len);
+    }
+  }
+  void clear() { set_length(0); }
+  void resize(size_type n, CharT c) {
+    if (n > len) {
+      append(n - len, c);
+    } else {
+      set_length(n);
+    }
+  }
+  void resize(size_type n) { resize(n, CharT()); }
+
+  reference operator[](size_type n) { return start[n]; }
+  const_reference operator[](size_type n) const { return start[n]; }
+  reference at(size_type n) {
+    if (n >= len) {
+      throw std::out_of_range("basic_string::at");
+    }
+    return start[n];
+  }
+  const_reference at(size_type n) const {
+    if (n >= len) {
+      throw std::out_of_range("basic_string::at");
+    }
+    return start[n];
+  }
+  reference front() { return start[0]; }
+  const_reference front() const { return start[0]; }
+  reference back() { return start[len - 1]; }
+  const_reference back() const { return start[len - 1]; }
+  const CharT* data() const { return start; }
+  CharT* data() { return start; }
+  const CharT* c_str() const { return start; }
+
+  // 放得下时直接复制到尾部
+  basic_string& append(const CharT* s, size_type n) {
+    if (n <= capacity() - len) {
+      traits::copy(start + len, s, n);
+      set_length(len + n);
+      return *this;
+    }
+    return replace_aux(len, 0, s, n);
+  }
+  basic_string& append(const basic_string& x) {
+    return append(x.start, x.len);
+  }
+  basic_string& append(const basic_string& x, size_type pos,
+                       size_type n = npos) {
+    x.check_pos(pos, "basic_string::append");
+    return append(x.start + pos, x.limit(pos, n));
+  }
+  basic_string& append(const CharT* s) { return append(s, traits::length(s)); }
+  basic_string& append(size_type n, CharT c) {
+    return replace_fill(len, 0, n, c);
+  }
+  template <class InputIterator>
+  basic_string& append(InputIterator first, InputIterator last) {
+    basic_string tmp(first, last);
+    return append(tmp.start, tmp.len);
+  }
+  basic_string& append(std::initializer_list<CharT> il) {
+    return append(il.begin(), il.size());
+  }
+  basic_string& operator+=(const basic_string& x) { return append(x); }
+  basic_string& operator+=(const CharT* s) { return append(s); }
+  basic_string& operator+=(CharT c) {
+    push_back(c);
+    return *this;
+  }
+  basic_string& operator+=(std::initializer_list<CharT> il) {
+    return append(il);
+  }
+  void push_back(CharT c) {
+    if (len == capacity()) {
+      reallocate_storage(next_capacity(len + 1));
+    }
+    start[len] = c;
+    set_length(len + 1);
+  }
+  void pop_back() { set_length(len - 1); }
+
+  basic_string& insert(size_type pos, const CharT* s, size_type n) {
+    return replace_aux(check_pos(pos, "basic_string::insert"), 0, s, n);
+  }
+  basic_string& insert(size_type pos, const CharT* s) {
+    return insert(pos, s, traits::length(s));
+  }
+  basic_string& insert(size_type pos, const basic_string& x) {
+    return insert(pos, x.start, x.len);
+  }
+  basic_string& insert(size_type pos, size_type n, CharT c) {
+    return replace_fill(check_pos(pos, "basic_string::insert"), 0, n, c);
+  }
+  iterator insert(const_iterator p, CharT c) {
+    size_type pos = p - start;
+    replace_fill(pos, 0, 1, c);
+    return start + pos;
+  }
+  iterator insert(const_iterator p, size_type n, CharT c) {
+    size_type pos = p - start;
+    replace_fill(pos, 0, n, c);
+    return start + pos;
+  }
+
+  basic_string& erase(size_type pos = 0, size_type n = npos) {
+    check_pos(pos, "basic_string::erase");
+    size_type n1 = limit(pos, n);
+    traits::move(start + pos, start + pos + n1, len - pos - n1);
+    set_length(len - n1);
+    return *this;
+  }
+  iterator erase(const_iterator p) {
+    size_type pos = p - start;
+    erase(pos, 1);
+    return start + pos;
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    size_type pos = first - start;
+    erase(pos, last - first);
+    return start + pos;
+  }
+
+  basic_string& replace(size_type pos, size_type n1, const CharT* s,
+                        size_type n2) {
+    check_pos(pos, "basic_string::replace");
+    return replace_aux(pos, limit(pos, n1), s, n2);
+  }
+  basic_string& replace(size_type pos, size_type n1, const CharT* s) {
+    return replace(pos, n1, s, traits::length(s));
+  }
+  basic_string& replace(size_type pos, size_type n1, const basic_string& x) {
+    return replace(pos, n1, x.start, x.len);
+  }
+  basic_string& replace(size_type pos, size_type n1, size_type n2, CharT c) {
+    check_pos(pos, "basic_string::replace");
+    return replace_fill(pos, limit(pos, n1), n2, c);
+  }
+
+  basic_string substr(size_type pos = 0, size_type n = npos) const {
+    return basic_string(*this, pos, n);
+  }
+  size_type copy(CharT* s, size_type n, size_type pos = 0) const {
+    check_pos(pos, "basic_string::copy");
+    n = limit(pos, n);
+    traits::copy(s, start + pos, n);
+    return n;
+  }
+  void swap(basic_string& x) {
+    if (&x != this) {
+      basic_string tmp(std::move(x));
+      x = std::move(*this);
+      *this = std::move(tmp);
+    }
+  }
+
+  size_type find(const CharT* s, size_type pos, size_type n) const {
+    if (n == 0) {
+      return pos <= len ? pos : npos;
+    }
+    if (pos >= len || n > len - pos) {
+      return npos;
+    }
+    const CharT* r = traits::search(start + pos, len - pos, s, n);
+    return r ? size_type(r - start) : npos;
+  }
+  size_type find(const basic_string& x, size_type pos = 0) const {
+    return find(x.start, pos, x.len);
+  }
+  size_type find(const CharT* s, size_type pos = 0) const {
+    return find(s, pos, traits::length(s));
+  }
+  size_type find(CharT c, size_type pos = 0) const {
+    if (pos >= len) {
+      return npos;
+    }
+    const CharT* r = traits::find(start + pos, len - pos, c);
+    return r ? size_type(r - start) : npos;
+  }
+  size_type rfind(const CharT* s, size_type pos, size_type n) const {
+    if (n > len) {
+      return npos;
+    }
+    pos = pos < len - n ? pos : len - n;
+    for (const CharT* p = start + pos;; --p) {
+      if (traits::compare(p, s, n) == 0) {
+        return p - start;
+      }
+      if (p == start) {
+        return npos;
+      }
+    }
+  }
+  size_type rfind(const basic_string& x, size_type pos = npos) const {
+    return rfind(x.start, pos, x.len);
+  }
+  size_type rfind(const CharT* s, size_type pos = npos) const {
+    return rfind(s, pos, traits::length(s));
+  }
+  size_type rfind(CharT c, size_type pos = npos) const {
+    return rfind(&c, pos, 1);
+  }
+  size_type find_first_of(const CharT* s, size_type pos, size_type n) const {
+    for (; pos < len; ++pos) {
+      if (traits::find(s, n, start[pos])) {
+        return pos;
+      }
+    }
+    return npos;
+  }
+  size_type find_first_of(const basic_string& x, size_type pos = 0) const {
+    return find_first_of(x.start, pos, x.len);
+  }
+  size_type find_first_of(const CharT* s, size_type pos = 0) const {
+    return find_first_of(s, pos, traits::length(s));
+  }
+  size_type find_first_of(CharT c, size_type pos = 0) const {
+    return find(c, pos);
+  }
+  size_type find_last_of(const CharT* s, size_type pos, size_type n) const {
+    if (len == 0) {
+      return npos;
+    }
+    for (pos = pos < len - 1 ? pos : len - 1;; --pos) {
+      if (traits::find(s, n, start[pos])) {
+        return pos;
+      }
+      if (pos == 0) {
+        return npos;
+      }
+    }
+  }
+  size_type find_last_of(const basic_string& x, size_type pos = npos) const {
+    return find_last_of(x.start, pos, x.len);
+  }
+  size_type find_last_of(const CharT* s, size_type pos = npos) const {
+    return find_last_of(s, pos, traits::length(s));
+  }
+  size_type find_last_of(CharT c, size_type pos = npos) const {
+    return rfind(c, pos);
+  }
+  size_type find_first_not_of(const CharT* s, size_type pos,
+                              size_type n) const {
+    for (; pos < len; ++pos) {
+      if (!traits::find(s, n, start[pos])) {
+        return pos;
+      }
+    }
+    return npos;
+  }
+  size_type find_first_not_of(const basic_string& x, size_type pos = 0) const {
+    return find_first_not_of(x.start, pos, x.len);
+  }
+  size_type find_first_not_of(const CharT* s, size_type pos = 0) const {
+    return find_first_not_of(s, pos, traits::length(s));
+  }
+  size_type find_first_not_of(CharT c, size_type pos = 0) const {
+    return find_first_not_of(&c, pos, 1);
+  }
+  size_type find_last_not_of(const CharT* s, size_type pos,
+                             size_type n) const {
+    if (len == 0) {
+      return npos;
+    }
+    for (pos = pos < len - 1 ? pos : len - 1;; --pos) {
+      if (!traits::find(s, n, start[pos])) {
+        return pos;
+      }
+      if (pos == 0) {
+        return npos;
+      }
+    }
+  }
+  size_type find_last_not_of(const basic_string& x,
+                             size_type pos = npos) const {
+    return find_last_not_of(x.start, pos, x.len);
+  }
+  size_type find_last_not_of(const CharT* s, size_type pos = npos) const {
+    return find_last_not_of(s, pos, traits::length(s));
+  }
+  size_type find_last_not_of(CharT c, size_type pos = npos) const {
+    return find_last_not_of(&c, pos, 1);
+  }
+
+  int compare(const basic_string& x) const {
+    return compare_aux(start, len, x.start, x.len);
+  }
+  int compare(size_type pos, size_type n, const basic_string& x) const {
+    check_pos(pos, "basic_string::compare");
+    return compare_aux(start + pos, limit(pos, n), x.start, x.len);
+  }
+  int compare(const CharT* s) const {
+    return compare_aux(start, len, s, traits::length(s));
+  }
+  int compare(size_type pos, size_type n, const CharT* s) const {
+    check_pos(pos, "basic_string::compare");
+    return compare_aux(start + pos, limit(pos, n), s, traits::length(s));
+  }
+};
+
+template <class CharT, class Alloc>
+const typename basic_string<CharT, Alloc>::size_type
+    basic_string<CharT, Alloc>::npos;
+
+typedef basic_string<char> string;
+typedef basic_string<wchar_t> wstring;
+
+template <class CharT, class Alloc>
+inline basic_string<CharT, Alloc> operator+(
+    const basic_string<CharT, Alloc>& x, const basic_string<CharT, Alloc>& y) {
+  basic_string<CharT, Alloc> result;
+  result.reserve(x.size() + y.size());
+  result.append(x);
+  result.append(y);
+  return result;
+}
+template <class CharT, class Alloc>
+inline basic_string<CharT, Alloc> operator+(basic_string<CharT, Alloc>&& x,
+                                            const basic_string<CharT, Alloc>& y) {
+  return std::move(x.append(y));
+}
+template <class CharT, class Alloc>
+inline basic_string<CharT, Alloc> operator+(const basic_string<CharT, Alloc>& x,
+                                            const CharT* s) {
+  basic_string<CharT, Alloc> result(x);
+  result.append(s);
+  return result;
+}
+template <class CharT, class Alloc>
+inline basic_string<CharT, Alloc> operator+(basic_string<CharT, Alloc>&& x,
+                                            const CharT* s) {
+  return std::move(x.append(s));
+}
+template <class CharT, class Alloc>
+inline basic_string<CharT, Alloc> operator+(const CharT* s,
+                                            const basic_string<CharT, Alloc>& y) {
+  basic_string<CharT, Alloc> result(s);
+  result.append(y);
+  return result;
+}
+template <class CharT, class Alloc>
+inline basic_string<CharT, Alloc> operator+(const basic_string<CharT, Alloc>& x,
+                                            CharT c) {
+  basic_string<CharT, Alloc> result(x);
+  result.push_back(c);
+  return result;
+}
+template <class CharT, class Alloc>
+inline basic_string<CharT, Alloc> operator+(basic_string<CharT, Alloc>&& x,
+                                            CharT c) {
+  x.push_back(c);
+  return std::move(x);
+}
+
+// 长度不同时不用比较内容
+template <class CharT, class Alloc>
+inline bool operator==(const basic_string<CharT, Alloc>& x,
+                       const basic_string<CharT, Alloc>& y) {
+  return x.size() == y.size() &&
+         __char_traits<CharT>::compare(x.data(), y.data(), x.size()) == 0;
+}
+template <class CharT, class Alloc>
+inline bool operator==(const basic_string<CharT, Alloc>& x, const CharT* s) {
+  return x.compare(s) == 0;
+}
+template <class CharT, class Alloc>
+inline bool operator==(const CharT* s, const basic_string<CharT, Alloc>& y) {
+  return y.compare(s) == 0;
+}
+template <class CharT, class Alloc>
+inline bool operator!=(const basic_string<CharT, Alloc>& x,
+                       const basic_string<CharT, Alloc>& y) {
+  return !(x == y);
+}
+template <class CharT, class Alloc>
+inline bool operator!=(const basic_string<CharT, Alloc>& x, const CharT* s) {
+  return !(x == s);
+}
+template <class CharT, class Alloc>
+inline bool operator!=(const CharT* s, const basic_string<CharT, Alloc>& y) {
+  return !(s == y);
+}
+template <class CharT, class Alloc>
+inline bool operator<(const basic_string<CharT, Alloc>& x,
+                      const basic_string<CharT, Alloc>& y) {
+  return x.compare(y) < 0;
+}
+template <class CharT, class Alloc>
+inline bool operator>(const basic_string<CharT, Alloc>& x,
+                      const basic_string<CharT, Alloc>& y) {
+  return y < x;
+}
+template <class CharT, class Alloc>
+inline bool operator<=(const basic_string<CharT, Alloc>& x,
+                       const basic_string<CharT, Alloc>& y) {
+  return !(y < x);
+}
+template <class CharT, class Alloc>
+inline bool operator>=(const basic_string<CharT, Alloc>& x,
+                       const basic_string<CharT, Alloc>& y) {
+  return !(x < y);
+}
+
+template <class CharT, class Alloc>
+inline void swap(basic_string<CharT, Alloc>& x, basic_string<CharT, Alloc>& y) {
+  x.swap(y);
+}
+
+template <class CharT, class Alloc>
+inline std::basic_ostream<CharT>& operator<<(
+    std::basic_ostream<CharT>& os, const basic_string<CharT, Alloc>& s) {
+  return os.write(s.data(), (std::streamsize)s.size());
+}
+
+}  // namespace ministl
+
+namespace std {
+// 按字节的FNV-1a, flat_hash_map会再打散一次
+template <class CharT, class Alloc>
+struct hash<ministl::basic_string<CharT, Alloc>> {
+  size_t operator()(const ministl::basic_string<CharT, Alloc>& s) const {
+    const unsigned char* p = (const unsigned char*)s.data();
+    size_t n = s.size() * sizeof(CharT);
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < n; ++i) {
+      h = (h ^ p[i]) * 1099511628211ull;
+    }
+    return (size_t)h;
+  }
+};
+}  // namespace std
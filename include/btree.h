@@ -0,0 +1,902 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+
+namespace ministl {
+
+// B树: 每个节点连续存放一批有序的元素, 节点大小取若干条cache line,
+// 查找时每一层只需要读一个节点, 相比每个元素一个节点的红黑树cache miss少得多
+// 元素既可以在叶子节点也可以在内部节点中, 内部节点多存count + 1个孩子指针
+// 除根节点外每个节点至少有N / 2个元素; 按顺序在末尾追加时节点分裂只留最后一个元素
+// 给右边, 所以有序输入逐个追加就能建成几乎全满的树, 总共O(n)
+// 插入和删除会移动元素, 所有迭代器失效(erase返回的迭代器除外)
+
+enum { __BTREE_NODE_BYTES = 256 };
+
+template <class Value>
+struct __btree_node_values {
+  enum {
+    fit = (__BTREE_NODE_BYTES - 16) / sizeof(Value),
+    value = fit < 3 ? 3 : (fit > 255 ? 255 : fit)
+  };
+};
+
+template <class Value, int N>
+struct __btree_internal_node;
+
+template <class Value, int N>
+struct __btree_node {
+  __btree_node* parent;
+  unsigned short position;  // 在父节点中是第几个孩子
+  unsigned short count;     // 元素个数
+  bool leaf;
+  typename std::aligned_storage<sizeof(Value), alignof(Value)>::type
+      storage[N];
+
+  Value* slot(int i) { return reinterpret_cast<Value*>(storage + i); }
+  Value& value(int i) { return *slot(i); }
+  __btree_node*& child(int i) {
+    return static_cast<__btree_internal_node<Value, N>*>(this)->children[i];
+  }
+};
+
+template <class Value, int N>
+struct __btree_internal_node : public __btree_node<Value, N> {
+  __btree_node<Value, N>* children[N + 1];
+};
+
+template <class Node, class Value, class Ref, class Ptr>
+class __btree_iterator {
+ public:
+  typedef bidirectional_iterator_tag iterator_category;
+  typedef Value value_type;
+  typedef ptrdiff_t difference_type;
+  typedef Ptr pointer;
+  typedef Ref reference;
+  typedef __btree_iterator<Node, Value, Value&, Value*> iterator;
+
+  Node* node;
+  int pos;
+
+  __btree_iterator() : node(0), pos(0) {}
+  __btree_iterator(Node* n, int p) : node(n), pos(p) {}
+  __btree_iterator(const __btree_iterator&) = default;
+  __btree_iterator& operator=(const __btree_iterator&) = default;
+  // iterator到const_iterator的转换, 不能反过来
+  template <class R, class P,
+            class = typename std::enable_if<std::is_same<
+                __btree_iterator<Node, Value, R, P>, iterator>::value>::type>
+  __btree_iterator(const __btree_iterator<Node, Value, R, P>& it)
+      : node(it.node), pos(it.pos) {}
+
+  reference operator*() const { return node->value(pos); }
+  pointer operator->() const { return &(operator*()); }
+
+  // 内部节点的下一个元素是右子树最左边的叶子; 叶子节点走完后回到父节点,
+  // 一直回到根节点还是走完了说明已经是最后一个元素, 停在末尾(最右叶子, count)
+  __btree_iterator& operator++() {
+    if (!node->leaf) {
+      node = node->child(pos + 1);
+      while (!node->leaf) {
+        node = node->child(0);
+      }
+      pos = 0;
+      return *this;
+    }
+    if (++pos < node->count) {
+      return *this;
+    }
+    __btree_iterator save = *this;
+    while (pos == node->count && node->parent != 0) {
+      pos = node->position;
+      node = node->parent;
+    }
+    if (pos == node->count) {
+      *this = save;
+    }
+    return *this;
+  }
+  __btree_iterator operator++(int) {
+    __btree_iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  __btree_iterator& operator--() {
+    if (!node->leaf) {
+      node = node->child(pos);
+      while (!node->leaf) {
+        node = node->child(node->count);
+      }
+      pos = node->count - 1;
+      return *this;
+    }
+    if (pos > 0) {
+      --pos;
+      return *this;
+    }
+    while (pos == 0 && node->parent != 0) {
+      pos = node->position;
+      node = node->parent;
+    }
+    --pos;
+    return *this;
+  }
+  __btree_iterator operator--(int) {
+    __btree_iterator tmp = *this;
+    --*this;
+    return tmp;
+  }
+  template <class R, class P>
+  bool operator==(const __btree_iterator<Node, Value, R, P>& x) const {
+    return node == x.node && pos == x.pos;
+  }
+  template <class R, class P>
+  bool operator!=(const __btree_iterator<Node, Value, R, P>& x) const {
+    return !(*this == x);
+  }
+};
+
+template <class K, class V>
+struct __btree_map_policy {
+  typedef K key_type;
+  typedef std::pair<const K, V> value_type;
+  static const K& key(const value_type& v) { return v.first; }
+  typedef typename __and_type<
+      typename type_traits<K>::has_trivial_destructor,
+      typename type_traits<V>::has_trivial_destructor>::type trivial_destructor;
+  typedef typename __and_type<typename is_trivially_relocatable<K>::type,
+                              typename is_trivially_relocatable<V>::type>::type
+      relocatable;
+};
+
+template <class K>
+struct __btree_set_policy {
+  typedef K key_type;
+  typedef K value_type;
+  static const K& key(const value_type& v) { return v; }
+  typedef typename type_traits<K>::has_trivial_destructor trivial_destructor;
+  typedef typename is_trivially_relocatable<K>::type relocatable;
+};
+
+template <class Policy, class Compare, class Alloc>
+class __btree {
+ public:
+  typedef typename Policy::key_type key_type;
+  typedef typename Policy::value_type value_type;
+  typedef Compare key_compare;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+
+ protected:
+  enum { N = __btree_node_values<value_type>::value, MIN = N / 2 };
+  typedef __btree_node<value_type, N> node;
+  typedef __btree_internal_node<value_type, N> internal_node;
+  typedef simple_alloc<node, Alloc> leaf_allocator;
+  typedef simple_alloc<internal_node, Alloc> internal_allocator;
+
+ public:
+  typedef __btree_iterator<node, value_type, value_type&, value_type*>
+      iterator;
+  typedef __btree_iterator<node, value_type, const value_type&,
+                           const value_type*>
+      const_iterator;
+  typedef ministl::reverse_iterator<iterator, value_type> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator, value_type,
+                                    const value_type&>
+      const_reverse_iterator;
+
+ protected:
+  node* root;
+  node* leftmost;   // 第一个元素所在的叶子
+  node* rightmost;  // 最后一个元素所在的叶子
+  size_type size_;
+  key_compare comp;
+
+  static const key_type& key(node* n, int i) {
+    return Policy::key(n->value(i));
+  }
+
+  node* new_leaf() {
+    node* n = leaf_allocator::allocate();
+    n->parent = 0;
+    n->position = 0;
+    n->count = 0;
+    n->leaf = true;
+    return n;
+  }
+  node* new_internal() {
+    internal_node* n = internal_allocator::allocate();
+    n->parent = 0;
+    n->position = 0;
+    n->count = 0;
+    n->leaf = false;
+    return n;
+  }
+  void free_node(node* n) {
+    if (n->leaf) {
+      leaf_allocator::deallocate(n);
+    } else {
+      internal_allocator::deallocate(static_cast<internal_node*>(n));
+    }
+  }
+  static void set_child(node* p, int i, node* c) {
+    p->child(i) = c;
+    c->parent = p;
+    c->position = (unsigned short)i;
+  }
+
+  // 把src从j开始的n个元素搬到dst从i开始的位置, 源位置变为未初始化, 允许重叠
+  static void transfer_n(node* dst, int i, node* src, int j, int n,
+                         _true_type) {
+    if (n > 0) {
+      memmove((void*)dst->slot(i), (const void*)src->slot(j),
+              n * sizeof(value_type));
+    }
+  }
+  static void transfer_n(node* dst, int i, node* src, int j, int n,
+                         _false_type) {
+    if (dst == src && i > j) {
+      for (int k = n - 1; k >= 0; --k) {
+        construct(dst->slot(i + k), std::move(src->value(j + k)));
+        destroy(src->slot(j + k));
+      }
+    } else {
+      for (int k = 0; k < n; ++k) {
+        construct(dst->slot(i + k), std::move(src->value(j + k)));
+        destroy(src->slot(j + k));
+      }
+    }
+  }
+  static void transfer_n(node* dst, int i, node* src, int j, int n) {
+    transfer_n(dst, i, src, j, n, typename Policy::relocatable());
+  }
+
+  void destroy_values(node*, _true_type) {}
+  void destroy_values(node* n, _false_type) {
+    for (int i = 0; i < n->count; ++i) {
+      destroy(n->slot(i));
+    }
+  }
+  void destroy_tree(node* n) {
+    if (!n->leaf) {
+      for (int i = 0; i <= n->count; ++i) {
+        destroy_tree(n->child(i));
+      }
+    }
+    destroy_values(n, typename Policy::trivial_destructor());
+    free_node(n);
+  }
+
+  // 节点内第一个不小于k的位置
+  template <class K>
+  int lower_index(node* n, const K& k) const {
+    int lo = 0, hi = n->count;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (comp(key(n, mid), k)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+  // 节点内第一个大于k的位置
+  template <class K>
+  int upper_index(node* n, const K& k) const {
+    int lo = 0, hi = n->count;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (comp(k, key(n, mid))) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    return lo;
+  }
+
+  // n已满, 分裂成两个节点, 中间的元素放到父节点; pos是即将插入的位置,
+  // 分裂后n和pos指向插入位置所在的节点. 在末尾插入时左边留满, 右边为空
+  void split(node*& n, int& pos) {
+    if (n->parent == 0) {
+      node* r = new_internal();
+      set_child(r, 0, n);
+      root = r;
+    } else if (n->parent->count == N) {
+      node* p = n->parent;
+      int ppos = n->position;
+      split(p, ppos);
+    }
+    node* right = n->leaf ? new_leaf() : new_internal();
+    int mid = pos == N ? N - 1 : N / 2;
+    transfer_n(right, 0, n, mid + 1, N - mid - 1);
+    right->count = (unsigned short)(N - mid - 1);
+    if (!n->leaf) {
+      for (int i = 0; i <= right->count; ++i) {
+        set_child(right, i, n->child(mid + 1 + i));
+      }
+    }
+    node* p = n->parent;
+    int at = n->position;
+    transfer_n(p, at + 1, p, at, p->count - at);
+    for (int i = p->count; i > at; --i) {
+      set_child(p, i + 1, p->child(i));
+    }
+    transfer_n(p, at, n, mid, 1);
+    set_child(p, at + 1, right);
+    ++p->count;
+    n->count = (unsigned short)mid;
+    if (n == rightmost) {
+      rightmost = right;
+    }
+    if (pos > mid) {
+      n = right;
+      pos -= mid + 1;
+    }
+  }
+
+  // 在叶子n的pos处构造一个元素
+  template <class... Args>
+  iterator insert_at(node* n, int pos, Args&&... args) {
+    if (n->count == N) {
+      split(n, pos);
+    }
+    transfer_n(n, pos + 1, n, pos, n->count - pos);
+    try {
+      construct(n->slot(pos), std::forward<Args>(args)...);
+    } catch (...) {
+      transfer_n(n, pos, n, pos + 1, n->count - pos);
+      throw;
+    }
+    ++n->count;
+    ++size_;
+    return iterator(n, pos);
+  }
+
+  // key应该插入的叶子位置; 已经存在时返回false和已有元素的位置
+  template <class K>
+  std::pair<iterator, bool> find_insert_position(const K& k) {
+    if (root == 0) {
+      root = leftmost = rightmost = new_leaf();
+      return std::make_pair(iterator(root, 0), true);
+    }
+    // 比最后一个元素大的key直接追加, 有序插入不用从根节点查找
+    if (rightmost->count != 0 &&
+        comp(key(rightmost, rightmost->count - 1), k)) {
+      return std::make_pair(iterator(rightmost, rightmost->count), true);
+    }
+    node* n = root;
+    for (;;) {
+      int i = lower_index(n, k);
+      if (i < n->count && !comp(k, key(n, i))) {
+        return std::make_pair(iterator(n, i), false);
+      }
+      if (n->leaf) {
+        return std::make_pair(iterator(n, i), true);
+      }
+      n = n->child(i);
+    }
+  }
+
+  template <class V>
+  std::pair<iterator, bool> insert_value(V&& v) {
+    std::pair<iterator, bool> r = find_insert_position(Policy::key(v));
+    if (!r.second) {
+      return r;
+    }
+    return std::make_pair(
+        insert_at(r.first.node, r.first.pos, std::forward<V>(v)), true);
+  }
+
+  // 删除后的再平衡, t跟踪被删除元素的下一个元素, 随元素的移动更新
+  static void track(iterator& t, node* from, int i, node* to, int j) {
+    if (t.node == from && t.pos == i) {
+      t.node = to;
+      t.pos = j;
+    }
+  }
+  // 从左兄弟l借一个元素: l的最后一个元素上移到父节点, 父节点的元素下移到x的开头
+  void rotate_right(node* l, node* x, node* p, int i, iterator& t) {
+    if (t.node == x) {
+      ++t.pos;
+    } else if (t.node == p && t.pos == i) {
+      t.node = x;
+      t.pos = 0;
+    } else {
+      track(t, l, l->count - 1, p, i);
+    }
+    transfer_n(x, 1, x, 0, x->count);
+    transfer_n(x, 0, p, i, 1);
+    transfer_n(p, i, l, l->count - 1, 1);
+    if (!x->leaf) {
+      for (int k = x->count; k >= 0; --k) {
+        set_child(x, k + 1, x->child(k));
+      }
+      set_child(x, 0, l->child(l->count));
+    }
+    --l->count;
+    ++x->count;
+  }
+  // 从右兄弟r借一个元素
+  void rotate_left(node* x, node* r, node* p, int i, iterator& t) {
+    if (t.node == r && t.pos > 0) {
+      --t.pos;
+    } else if (t.node == r) {
+      t.node = p;
+      t.pos = i;
+    } else {
+      track(t, p, i, x, x->count);
+    }
+    transfer_n(x, x->count, p, i, 1);
+    transfer_n(p, i, r, 0, 1);
+    transfer_n(r, 0, r, 1, r->count - 1);
+    if (!x->leaf) {
+      set_child(x, x->count + 1, r->child(0));
+      for (int k = 0; k < r->count; ++k) {
+        set_child(r, k, r->child(k + 1));
+      }
+    }
+    ++x->count;
+    --r->count;
+  }
+  // 父节点的第i个元素和右兄弟r并入l, 释放r
+  void merge(node* l, node* r, node* p, int i, iterator& t) {
+    int lc = l->count;
+    if (t.node == r) {
+      t.node = l;
+      t.pos = lc + 1 + t.pos;
+    } else if (t.node == p && t.pos > i) {
+      --t.pos;
+    } else {
+      track(t, p, i, l, lc);
+    }
+    transfer_n(l, lc, p, i, 1);
+    transfer_n(l, lc + 1, r, 0, r->count);
+    if (!l->leaf) {
+      for (int k = 0; k <= r->count; ++k) {
+        set_child(l, lc + 1 + k, r->child(k));
+      }
+    }
+    l->count = (unsigned short)(lc + 1 + r->count);
+    transfer_n(p, i, p, i + 1, p->count - i - 1);
+    for (int k = i + 1; k < p->count; ++k) {
+      set_child(p, k, p->child(k + 1));
+    }
+    --p->count;
+    if (r == rightmost) {
+      rightmost = l;
+    }
+    free_node(r);
+  }
+  void rebalance(node* x, iterator& t) {
+    while (x != root && x->count < MIN) {
+      node* p = x->parent;
+      int c = x->position;
+      node* l = c > 0 ? p->child(c - 1) : 0;
+      node* r = c < p->count ? p->child(c + 1) : 0;
+      if (l != 0 && l->count > MIN) {
+        rotate_right(l, x, p, c - 1, t);
+        return;
+      }
+      if (r != 0 && r->count > MIN) {
+        rotate_left(x, r, p, c, t);
+        return;
+      }
+      if (l != 0) {
+        merge(l, x, p, c - 1, t);
+      } else {
+        merge(x, r, p, c, t);
+      }
+      x = p;
+    }
+    if (root->count == 0) {
+      node* old = root;
+      if (root->leaf) {
+        root = leftmost = rightmost = 0;
+      } else {
+        root = root->child(0);
+        root->parent = 0;
+        root->position = 0;
+      }
+      free_node(old);
+    }
+  }
+
+ public:
+  explicit __btree(const key_compare& c = key_compare())
+      : root(0), leftmost(0), rightmost(0), size_(0), comp(c) {}
+  __btree(const __btree& x)
+      : root(0), leftmost(0), rightmost(0), size_(0), comp(x.comp) {
+    try {
+      insert(x.begin(), x.end());
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+  __btree(__btree&& x) noexcept
+      : root(x.root), leftmost(x.leftmost), rightmost(x.rightmost),
+        size_(x.size_), comp(x.comp) {
+    x.root = x.leftmost = x.rightmost = 0;
+    x.size_ = 0;
+  }
+  ~__btree() { clear(); }
+  __btree& operator=(const __btree& x) {
+    if (&x != this) {
+      __btree tmp(x);
+      swap(tmp);
+    }
+    return *this;
+  }
+  __btree& operator=(__btree&& x) noexcept {
+    if (&x != this) {
+      __btree tmp(std::move(x));
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  iterator begin() { return iterator(leftmost, 0); }
+  const_iterator begin() const { return const_iterator(leftmost, 0); }
+  const_iterator cbegin() const { return begin(); }
+  iterator end() {
+    return iterator(rightmost, rightmost == 0 ? 0 : rightmost->count);
+  }
+  const_iterator end() const {
+    return const_iterator(rightmost, rightmost == 0 ? 0 : rightmost->count);
+  }
+  const_iterator cend() const { return end(); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+  size_type max_size() const { return size_type(-1) / sizeof(value_type); }
+  key_compare key_comp() const { return comp; }
+  // 树高, 只有一个叶子时为1
+  size_type height() const {
+    size_type h = 0;
+    for (node* n = root; n != 0; n = n->leaf ? 0 : n->child(0)) {
+      ++h;
+    }
+    return h;
+  }
+
+  void clear() {
+    if (root != 0) {
+      destroy_tree(root);
+    }
+    root = leftmost = rightmost = 0;
+    size_ = 0;
+  }
+
+  std::pair<iterator, bool> insert(const value_type& v) {
+    return insert_value(v);
+  }
+  std::pair<iterator, bool> insert(value_type&& v) {
+    return insert_value(std::move(v));
+  }
+  iterator insert(const_iterator, const value_type& v) {
+    return insert_value(v).first;
+  }
+  iterator insert(const_iterator, value_type&& v) {
+    return insert_value(std::move(v)).first;
+  }
+  // 有序的输入每个元素都追加在末尾, 总共O(n)
+  template <class InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert_value(*first);
+    }
+  }
+  void insert(std::initializer_list<value_type> il) {
+    insert(il.begin(), il.end());
+  }
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    value_type v(std::forward<Args>(args)...);
+    return insert_value(std::move(v));
+  }
+
+  // 内部节点上的元素先与前驱(左子树最右边的元素)交换, 删除总是发生在叶子上
+  iterator erase(const_iterator position) {
+    iterator next(position.node, position.pos);
+    ++next;
+    bool last = next == end();
+    node* n = position.node;
+    int pos = position.pos;
+    destroy(n->slot(pos));
+    if (!n->leaf) {
+      node* l = n->child(pos);
+      while (!l->leaf) {
+        l = l->child(l->count);
+      }
+      transfer_n(n, pos, l, l->count - 1, 1);
+      n = l;
+      pos = l->count - 1;
+    }
+    transfer_n(n, pos, n, pos + 1, n->count - pos - 1);
+    --n->count;
+    if (next.node == n && next.pos > pos) {
+      --next.pos;
+    }
+    --size_;
+    rebalance(n, next);
+    return last ? end() : next;
+  }
+  // erase(key)是模板, 需要iterator的精确匹配版本
+  iterator erase(iterator position) {
+    return erase(const_iterator(position));
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    if (first == begin() && last == end()) {
+      clear();
+      return end();
+    }
+    size_type n = 0;
+    for (const_iterator it = first; it != last; ++it) {
+      ++n;
+    }
+    iterator it(first.node, first.pos);
+    for (; n > 0; --n) {
+      it = erase(it);
+    }
+    return it;
+  }
+  template <class K>
+  size_type erase(const K& k) {
+    iterator it = find(k);
+    if (it == end()) {
+      return 0;
+    }
+    erase(it);
+    return 1;
+  }
+
+  template <class K>
+  iterator lower_bound(const K& k) {
+    iterator r = end();
+    for (node* n = root; n != 0;) {
+      int i = lower_index(n, k);
+      if (i < n->count) {
+        r = iterator(n, i);
+      }
+      n = n->leaf ? 0 : n->child(i);
+    }
+    return r;
+  }
+  template <class K>
+  const_iterator lower_bound(const K& k) const {
+    return const_cast<__btree*>(this)->lower_bound(k);
+  }
+  template <class K>
+  iterator upper_bound(const K& k) {
+    iterator r = end();
+    for (node* n = root; n != 0;) {
+      int i = upper_index(n, k);
+      if (i < n->count) {
+        r = iterator(n, i);
+      }
+      n = n->leaf ? 0 : n->child(i);
+    }
+    return r;
+  }
+  template <class K>
+  const_iterator upper_bound(const K& k) const {
+    return const_cast<__btree*>(this)->upper_bound(k);
+  }
+  template <class K>
+  std::pair<iterator, iterator> equal_range(const K& k) {
+    return std::make_pair(lower_bound(k), upper_bound(k));
+  }
+  template <class K>
+  std::pair<const_iterator, const_iterator> equal_range(const K& k) const {
+    return std::make_pair(lower_bound(k), upper_bound(k));
+  }
+  template <class K>
+  iterator find(const K& k) {
+    for (node* n = root; n != 0;) {
+      int i = lower_index(n, k);
+      if (i < n->count && !comp(k, key(n, i))) {
+        return iterator(n, i);
+      }
+      n = n->leaf ? 0 : n->child(i);
+    }
+    return end();
+  }
+  template <class K>
+  const_iterator find(const K& k) const {
+    return const_cast<__btree*>(this)->find(k);
+  }
+  template <class K>
+  bool contains(const K& k) const {
+    return find(k) != end();
+  }
+  template <class K>
+  size_type count(const K& k) const {
+    return contains(k) ? 1 : 0;
+  }
+
+  void swap(__btree& x) noexcept {
+    std::swap(root, x.root);
+    std::swap(leftmost, x.leftmost);
+    std::swap(rightmost, x.rightmost);
+    std::swap(size_, x.size_);
+    std::swap(comp, x.comp);
+  }
+};
+
+template <class Policy, class Compare, class Alloc>
+bool operator==(const __btree<Policy, Compare, Alloc>& x,
+                const __btree<Policy, Compare, Alloc>& y) {
+  if (x.size() != y.size()) {
+    return false;
+  }
+  typename __btree<Policy, Compare, Alloc>::const_iterator i = x.begin();
+  typename __btree<Policy, Compare, Alloc>::const_iterator j = y.begin();
+  for (; i != x.end(); ++i, ++j) {
+    if (!(*i == *j)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class Policy, class Compare, class Alloc>
+bool operator!=(const __btree<Policy, Compare, Alloc>& x,
+                const __btree<Policy, Compare, Alloc>& y) {
+  return !(x == y);
+}
+
+template <class Policy, class Compare, class Alloc>
+bool operator<(const __btree<Policy, Compare, Alloc>& x,
+               const __btree<Policy, Compare, Alloc>& y) {
+  typename __btree<Policy, Compare, Alloc>::const_iterator i = x.begin();
+  typename __btree<Policy, Compare, Alloc>::const_iterator j = y.begin();
+  for (; i != x.end() && j != y.end(); ++i, ++j) {
+    if (*i < *j) {
+      return true;
+    }
+    if (*j < *i) {
+      return false;
+    }
+  }
+  return i == x.end() && j != y.end();
+}
+
+// 有序map, 接口与std::map相近; 查找函数是模板, 配合std::less<>这样的比较函数
+// 可以直接用能与key比较的类型查找
+template <class Key, class T, class Compare = std::less<Key>,
+          class Alloc = alloc>
+class btree_map
+    : public __btree<__btree_map_policy<Key, T>, Compare, Alloc> {
+  typedef __btree<__btree_map_policy<Key, T>, Compare, Alloc> base;
+
+ public:
+  typedef T mapped_type;
+  typedef typename base::key_type key_type;
+  typedef typename base::value_type value_type;
+  typedef typename base::key_compare key_compare;
+  typedef typename base::iterator iterator;
+  typedef typename base::const_iterator const_iterator;
+
+  explicit btree_map(const key_compare& c = key_compare()) : base(c) {}
+  template <class InputIterator>
+  btree_map(InputIterator first, InputIterator last,
+            const key_compare& c = key_compare())
+      : base(c) {
+    this->insert(first, last);
+  }
+  btree_map(std::initializer_list<value_type> il,
+            const key_compare& c = key_compare())
+      : base(c) {
+    this->insert(il.begin(), il.end());
+  }
+
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace(K&& k, Args&&... args) {
+    std::pair<iterator, bool> r = this->find_insert_position(k);
+    if (!r.second) {
+      return r;
+    }
+    return std::make_pair(
+        this->insert_at(r.first.node, r.first.pos, std::piecewise_construct,
+                        std::forward_as_tuple(std::forward<K>(k)),
+                        std::forward_as_tuple(std::forward<Args>(args)...)),
+        true);
+  }
+  template <class K, class M>
+  std::pair<iterator, bool> insert_or_assign(K&& k, M&& obj) {
+    std::pair<iterator, bool> r = try_emplace(std::forward<K>(k));
+    r.first->second = std::forward<M>(obj);
+    return r;
+  }
+  mapped_type& operator[](const key_type& k) {
+    return try_emplace(k).first->second;
+  }
+  mapped_type& operator[](key_type&& k) {
+    return try_emplace(std::move(k)).first->second;
+  }
+  template <class K>
+  mapped_type& at(const K& k) {
+    iterator it = this->find(k);
+    if (it == this->end()) {
+      throw std::out_of_range("btree_map::at");
+    }
+    return it->second;
+  }
+  template <class K>
+  const mapped_type& at(const K& k) const {
+    const_iterator it = this->find(k);
+    if (it == this->end()) {
+      throw std::out_of_range("btree_map::at");
+    }
+    return it->second;
+  }
+};
+
+// 有序set, 元素不能通过迭代器修改
+template <class Key, class Compare = std::less<Key>, class Alloc = alloc>
+class btree_set : public __btree<__btree_set_policy<Key>, Compare, Alloc> {
+  typedef __btree<__btree_set_policy<Key>, Compare, Alloc> base;
+
+ public:
+  typedef typename base::key_type key_type;
+  typedef typename base::value_type value_type;
+  typedef typename base::key_compare key_compare;
+  typedef typename base::const_iterator iterator;
+  typedef typename base::const_iterator const_iterator;
+
+  explicit btree_set(const key_compare& c = key_compare()) : base(c) {}
+  template <class InputIterator>
+  btree_set(InputIterator first, InputIterator last,
+            const key_compare& c = key_compare())
+      : base(c) {
+    this->insert(first, last);
+  }
+  btree_set(std::initializer_list<value_type> il,
+            const key_compare& c = key_compare())
+      : base(c) {
+    this->insert(il.begin(), il.end());
+  }
+
+  iterator begin() const { return base::begin(); }
+  iterator end() const { return base::end(); }
+  template <class K>
+  iterator find(const K& k) const {
+    return base::find(k);
+  }
+  template <class K>
+  iterator lower_bound(const K& k) const {
+    return base::lower_bound(k);
+  }
+  template <class K>
+  iterator upper_bound(const K& k) const {
+    return base::upper_bound(k);
+  }
+};
+
+}  // namespace ministl
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <new>
+#include <utility>
+
+#include "iterator.h"
+#include "type_traits.h"
+
+namespace ministl {
+
+// 在p所指的未初始化内存上构造一个对象, 参数原样转发给构造函数
+template <class T, class... Args>
+inline void construct(T* p, Args&&... args) {
+  new ((void*)p) T(std::forward<Args>(args)...);
+}
+
+// 析构一个对象, 不释放内存
+template <class T>
+inline void destroy(T* p) {
+  p->~T();
+}
+
+// 析构函数不是trivial的, 只能逐个调用
+template <class ForwardIterator>
+inline void destroy_aux(ForwardIterator first, ForwardIterator last,
+                        _false_type) {
+  for (; first != last; ++first) {
+    destroy(&*first);
+  }
+}
+
+// 析构函数是trivial的, 什么都不用做
+template <class ForwardIterator>
+inline void destroy_aux(ForwardIterator, ForwardIterator, _true_type) {}
+
+// 析构[first, last)内的所有对象, 根据type_traits决定是否需要逐个析构
+template <class ForwardIterator>
+inline void destroy(ForwardIterator first, ForwardIterator last) {
+  typedef typename iterator_traits<ForwardIterator>::value_type T;
+  destroy_aux(first, last, typename type_traits<T>::has_trivial_destructor());
+}
+
+inline void destroy(char*, char*) {}
+inline void destroy(wchar_t*, wchar_t*) {}
+
+}  // namespace ministl
@@ -0,0 +1,983 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "algobase.h"
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+#include "uninitialized.h"
+
+namespace ministl {
+
+// 双端队列: 元素放在若干段等长的缓冲区中, 一个指针数组(map)按顺序记录各段,
+// 两端插入只需要在头尾的缓冲区构造元素, 缓冲区满了再配置一段, map满了再扩展map,
+// 已有的元素不会移动. map和缓冲区都由simple_alloc<..., Alloc>配置
+// 迭代器是分段迭代器, 特化了segmented_iterator_traits, algobase.h中的算法
+// 以及uninitialized_*在deque上逐段处理, POD类型每段一次memmove/memset
+
+// 每段缓冲区的元素个数: BufSiz不为0时就是BufSiz, 否则取512字节能放下的个数
+inline size_t __deque_buf_size(size_t n, size_t sz) {
+  return n != 0 ? n : (sz < 512 ? size_t(512 / sz) : size_t(1));
+}
+
+template <class T, class Ref, class Ptr, size_t BufSiz>
+struct __deque_iterator {
+  typedef __deque_iterator<T, T&, T*, BufSiz> iterator;
+  typedef __deque_iterator<T, const T&, const T*, BufSiz> const_iterator;
+  static size_t buffer_size() { return __deque_buf_size(BufSiz, sizeof(T)); }
+
+  typedef random_access_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef Ptr pointer;
+  typedef Ref reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef T** map_pointer;
+  typedef __deque_iterator self;
+
+  T* cur;            // 当前元素
+  T* first;          // 所在缓冲区的头
+  T* last;           // 所在缓冲区的尾(含备用空间)
+  map_pointer node;  // 所在缓冲区在map中的位置
+
+  __deque_iterator() : cur(0), first(0), last(0), node(0) {}
+  __deque_iterator(T* x, map_pointer y)
+      : cur(x), first(*y), last(*y + buffer_size()), node(y) {}
+  __deque_iterator(const __deque_iterator&) = default;
+  __deque_iterator& operator=(const __deque_iterator&) = default;
+  // iterator到const_iterator的转换, 不能反过来
+  template <class R, class P,
+            class = typename std::enable_if<std::is_same<
+                __deque_iterator<T, R, P, BufSiz>, iterator>::value>::type>
+  __deque_iterator(const __deque_iterator<T, R, P, BufSiz>& x)
+      : cur(x.cur), first(x.first), last(x.last), node(x.node) {}
+
+  // 跳到另一个缓冲区, cur由调用者设置
+  void set_node(map_pointer new_node) {
+    node = new_node;
+    first = *new_node;
+    last = first + difference_type(buffer_size());
+  }
+
+  reference operator*() const { return *cur; }
+  pointer operator->() const { return cur; }
+  difference_type operator-(const self& x) const {
+    return difference_type(buffer_size()) * (node - x.node - 1) +
+           (cur - first) + (x.last - x.cur);
+  }
+  self& operator++() {
+    ++cur;
+    if (cur == last) {
+      set_node(node + 1);
+      cur = first;
+    }
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  self& operator--() {
+    if (cur == first) {
+      set_node(node - 1);
+      cur = last;
+    }
+    --cur;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+  self& operator+=(difference_type n) {
+    difference_type offset = n + (cur - first);
+    if (offset >= 0 && offset < difference_type(buffer_size())) {
+      cur += n;
+    } else {
+      difference_type node_offset =
+          offset > 0 ? offset / difference_type(buffer_size())
+                     : -difference_type((-offset - 1) / buffer_size()) - 1;
+      set_node(node + node_offset);
+      cur = first + (offset - node_offset * difference_type(buffer_size()));
+    }
+    return *this;
+  }
+  self operator+(difference_type n) const {
+    self tmp = *this;
+    return tmp += n;
+  }
+  self& operator-=(difference_type n) { return *this += -n; }
+  self operator-(difference_type n) const {
+    self tmp = *this;
+    return tmp -= n;
+  }
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  template <class R, class P>
+  bool operator==(const __deque_iterator<T, R, P, BufSiz>& x) const {
+    return cur == x.cur;
+  }
+  template <class R, class P>
+  bool operator!=(const __deque_iterator<T, R, P, BufSiz>& x) const {
+    return cur != x.cur;
+  }
+  template <class R, class P>
+  bool operator<(const __deque_iterator<T, R, P, BufSiz>& x) const {
+    return node == x.node ? cur < x.cur : node < x.node;
+  }
+  template <class R, class P>
+  bool operator>(const __deque_iterator<T, R, P, BufSiz>& x) const {
+    return x < *this;
+  }
+  template <class R, class P>
+  bool operator<=(const __deque_iterator<T, R, P, BufSiz>& x) const {
+    return !(x < *this);
+  }
+  template <class R, class P>
+  bool operator>=(const __deque_iterator<T, R, P, BufSiz>& x) const {
+    return !(*this < x);
+  }
+};
+
+template <class T, class Ref, class Ptr, size_t BufSiz>
+inline __deque_iterator<T, Ref, Ptr, BufSiz> operator+(
+    ptrdiff_t n, const __deque_iterator<T, Ref, Ptr, BufSiz>& x) {
+  return x + n;
+}
+
+// 一段就是一个缓冲区, 段迭代器是map中的位置
+template <class T, class Ref, class Ptr, size_t BufSiz>
+struct segmented_iterator_traits<__deque_iterator<T, Ref, Ptr, BufSiz>> {
+  typedef _true_type is_segmented_iterator;
+  typedef __deque_iterator<T, Ref, Ptr, BufSiz> iterator;
+  typedef T** segment_iterator;
+  typedef T* local_iterator;
+
+  static segment_iterator segment(const iterator& it) { return it.node; }
+  static local_iterator local(const iterator& it) { return it.cur; }
+  static local_iterator begin(segment_iterator s) { return *s; }
+  static local_iterator end(segment_iterator s) {
+    return *s + iterator::buffer_size();
+  }
+  static iterator compose(segment_iterator s, local_iterator l) {
+    if (l == end(s)) {
+      ++s;
+      l = *s;
+    }
+    return iterator(l, s);
+  }
+};
+
+template <class T, class Alloc = alloc, size_t BufSiz = 0>
+class deque {
+ public:
+  typedef T value_type;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef __deque_iterator<T, T&, T*, BufSiz> iterator;
+  typedef __deque_iterator<T, const T&, const T*, BufSiz> const_iterator;
+  typedef ministl::reverse_iterator<iterator, T> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator, T, const T&>
+      const_reverse_iterator;
+
+ protected:
+  typedef pointer* map_pointer;
+  typedef simple_alloc<value_type, Alloc> data_allocator;
+  typedef simple_alloc<pointer, Alloc> map_allocator;
+  enum { INITIAL_MAP_SIZE = 8 };
+
+  static size_type buffer_size() { return iterator::buffer_size(); }
+
+  iterator start;      // 第一个元素
+  iterator finish;     // 最后一个元素的下一个位置, 所在的缓冲区总是已经配置
+  map_pointer map;     // 各段缓冲区的指针
+  size_type map_size;  // map的容量
+
+  pointer allocate_node() { return data_allocator::allocate(buffer_size()); }
+  void deallocate_node(pointer p) {
+    data_allocator::deallocate(p, buffer_size());
+  }
+  void create_nodes(map_pointer nstart, map_pointer nfinish) {
+    map_pointer cur = nstart;
+    try {
+      for (; cur < nfinish; ++cur) {
+        *cur = allocate_node();
+      }
+    } catch (...) {
+      destroy_nodes(nstart, cur);
+      throw;
+    }
+  }
+  void destroy_nodes(map_pointer nstart, map_pointer nfinish) {
+    for (map_pointer n = nstart; n < nfinish; ++n) {
+      deallocate_node(*n);
+    }
+  }
+  // 配置能容纳num_elements个元素的map和缓冲区, 元素放在map的中间,
+  // 两端都留有余地
+  void initialize_map(size_type num_elements) {
+    size_type num_nodes = num_elements / buffer_size() + 1;
+    map_size = num_nodes + 2 > (size_type)INITIAL_MAP_SIZE
+                   ? num_nodes + 2
+                   : (size_type)INITIAL_MAP_SIZE;
+    map = map_allocator::allocate(map_size);
+    map_pointer nstart = map + (map_size - num_nodes) / 2;
+    map_pointer nfinish = nstart + num_nodes;
+    try {
+      create_nodes(nstart, nfinish);
+    } catch (...) {
+      map_allocator::deallocate(map, map_size);
+      map = 0;
+      map_size = 0;
+      throw;
+    }
+    start.set_node(nstart);
+    finish.set_node(nfinish - 1);
+    start.cur = start.first;
+    finish.cur = finish.first + num_elements % buffer_size();
+  }
+  void release() {
+    if (map) {
+      destroy_nodes(start.node, finish.node + 1);
+      map_allocator::deallocate(map, map_size);
+    }
+  }
+
+  // map的尾部至少还能放nodes_to_add个缓冲区
+  void reserve_map_at_back(size_type nodes_to_add = 1) {
+    if (nodes_to_add + 1 > map_size - (finish.node - map)) {
+      reallocate_map(nodes_to_add, false);
+    }
+  }
+  void reserve_map_at_front(size_type nodes_to_add = 1) {
+    if (nodes_to_add > size_type(start.node - map)) {
+      reallocate_map(nodes_to_add, true);
+    }
+  }
+  // map还很空时把已用的部分移到中间, 否则配置一个更大的map
+  void reallocate_map(size_type nodes_to_add, bool add_at_front) {
+    size_type old_num_nodes = finish.node - start.node + 1;
+    size_type new_num_nodes = old_num_nodes + nodes_to_add;
+    map_pointer new_nstart;
+    if (map_size > 2 * new_num_nodes) {
+      new_nstart = map + (map_size - new_num_nodes) / 2 +
+                   (add_at_front ? nodes_to_add : 0);
+      if (new_nstart < start.node) {
+        ministl::copy(start.node, finish.node + 1, new_nstart);
+      } else {
+        ministl::copy_backward(start.node, finish.node + 1,
+                               new_nstart + old_num_nodes);
+      }
+    } else {
+      size_type new_map_size =
+          map_size + (map_size > nodes_to_add ? map_size : nodes_to_add) + 2;
+      map_pointer new_map = map_allocator::allocate(new_map_size);
+      new_nstart = new_map + (new_map_size - new_num_nodes) / 2 +
+                   (add_at_front ? nodes_to_add : 0);
+      ministl::copy(start.node, finish.node + 1, new_nstart);
+      map_allocator::deallocate(map, map_size);
+      map = new_map;
+      map_size = new_map_size;
+    }
+    start.set_node(new_nstart);
+    finish.set_node(new_nstart + old_num_nodes - 1);
+  }
+  // 在头部准备n个未初始化的位置, 返回新的start(此时start本身还未改变)
+  iterator reserve_elements_at_front(size_type n) {
+    size_type vacancies = start.cur - start.first;
+    if (n > vacancies) {
+      new_elements_at_front(n - vacancies);
+    }
+    return start - difference_type(n);
+  }
+  iterator reserve_elements_at_back(size_type n) {
+    size_type vacancies = (finish.last - finish.cur) - 1;
+    if (n > vacancies) {
+      new_elements_at_back(n - vacancies);
+    }
+    return finish + difference_type(n);
+  }
+  void new_elements_at_front(size_type new_elements) {
+    size_type new_nodes = (new_elements + buffer_size() - 1) / buffer_size();
+    reserve_map_at_front(new_nodes);
+    size_type i = 1;
+    try {
+      for (; i <= new_nodes; ++i) {
+        *(start.node - i) = allocate_node();
+      }
+    } catch (...) {
+      for (size_type j = 1; j < i; ++j) {
+        deallocate_node(*(start.node - j));
+      }
+      throw;
+    }
+  }
+  void new_elements_at_back(size_type new_elements) {
+    size_type new_nodes = (new_elements + buffer_size() - 1) / buffer_size();
+    reserve_map_at_back(new_nodes);
+    size_type i = 1;
+    try {
+      for (; i <= new_nodes; ++i) {
+        *(finish.node + i) = allocate_node();
+      }
+    } catch (...) {
+      for (size_type j = 1; j < i; ++j) {
+        deallocate_node(*(finish.node + j));
+      }
+      throw;
+    }
+  }
+  // 插入失败时释放reserve_elements_at_*多配置的缓冲区
+  void destroy_nodes_at_front(iterator new_start) {
+    destroy_nodes(new_start.node, start.node);
+  }
+  void destroy_nodes_at_back(iterator new_finish) {
+    destroy_nodes(finish.node + 1, new_finish.node + 1);
+  }
+
+  void fill_initialize(size_type n, const value_type& value) {
+    initialize_map(n);
+    try {
+      ministl::uninitialized_fill(start, finish, value);
+    } catch (...) {
+      release();
+      throw;
+    }
+  }
+  template <class Integer>
+  void range_initialize(Integer n, Integer value, std::true_type) {
+    fill_initialize((size_type)n, (T)value);
+  }
+  template <class InputIterator>
+  void range_initialize(InputIterator first, InputIterator last,
+                        std::false_type) {
+    range_initialize_aux(first, last, iterator_category(first));
+  }
+  template <class InputIterator>
+  void range_initialize_aux(InputIterator first, InputIterator last,
+                            input_iterator_tag) {
+    initialize_map(0);
+    try {
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+    } catch (...) {
+      clear();
+      release();
+      throw;
+    }
+  }
+  template <class ForwardIterator>
+  void range_initialize_aux(ForwardIterator first, ForwardIterator last,
+                            forward_iterator_tag) {
+    size_type n = (size_type)ministl::distance(first, last);
+    initialize_map(n);
+    try {
+      ministl::uninitialized_copy(first, last, start);
+    } catch (...) {
+      release();
+      throw;
+    }
+  }
+
+  // 在两端之一腾出一个位置, 移动较少的一侧
+  template <class... Args>
+  iterator insert_aux(iterator position, Args&&... args) {
+    value_type x_copy(std::forward<Args>(args)...);
+    difference_type index = position - start;
+    if (size_type(index) < size() / 2) {
+      emplace_front(std::move(front()));
+      iterator front1 = start;
+      ++front1;
+      iterator front2 = front1;
+      ++front2;
+      position = start + index;
+      iterator pos1 = position;
+      ++pos1;
+      ministl::move(front2, pos1, front1);
+    } else {
+      emplace_back(std::move(back()));
+      iterator back1 = finish;
+      --back1;
+      iterator back2 = back1;
+      --back2;
+      position = start + index;
+      ministl::move_backward(position, back2, back1);
+    }
+    *position = std::move(x_copy);
+    return position;
+  }
+
+  // [first1, last1)移动到result, 接着在后面构造x的副本直到last2
+  static void uninitialized_move_fill(iterator first1, iterator last1,
+                                      iterator result, iterator last2,
+                                      const value_type& x) {
+    iterator mid = ministl::uninitialized_move(first1, last1, result);
+    try {
+      ministl::uninitialized_fill(mid, last2, x);
+    } catch (...) {
+      destroy(result, mid);
+      throw;
+    }
+  }
+  // [result, mid)构造x的副本, 接着把[first, last)移动到mid
+  static void uninitialized_fill_move(iterator result, iterator mid,
+                                      const value_type& x, iterator first,
+                                      iterator last) {
+    ministl::uninitialized_fill(result, mid, x);
+    try {
+      ministl::uninitialized_move(first, last, mid);
+    } catch (...) {
+      destroy(result, mid);
+      throw;
+    }
+  }
+  // [first1, last1)移动到result, 接着把[first2, last2)复制到后面
+  template <class ForwardIterator>
+  static iterator uninitialized_move_copy(iterator first1, iterator last1,
+                                          ForwardIterator first2,
+                                          ForwardIterator last2,
+                                          iterator result) {
+    iterator mid = ministl::uninitialized_move(first1, last1, result);
+    try {
+      return ministl::uninitialized_copy(first2, last2, mid);
+    } catch (...) {
+      destroy(result, mid);
+      throw;
+    }
+  }
+  template <class ForwardIterator>
+  static iterator uninitialized_copy_move(ForwardIterator first1,
+                                          ForwardIterator last1,
+                                          iterator first2, iterator last2,
+                                          iterator result) {
+    iterator mid = ministl::uninitialized_copy(first1, last1, result);
+    try {
+      return ministl::uninitialized_move(first2, last2, mid);
+    } catch (...) {
+      destroy(result, mid);
+      throw;
+    }
+  }
+
+  // 在中间插入n个x, 移动较少的一侧:
+  // 那一侧的元素先有一部分移到新位置上构造, 剩下的在已有元素上移动赋值
+  void fill_insert_aux(iterator position, size_type n, const value_type& x) {
+    difference_type elems_before = position - start;
+    size_type length = size();
+    value_type x_copy = x;
+    if (elems_before < difference_type(length / 2)) {
+      iterator new_start = reserve_elements_at_front(n);
+      iterator old_start = start;
+      position = start + elems_before;
+      try {
+        if (elems_before >= difference_type(n)) {
+          iterator start_n = start + difference_type(n);
+          ministl::uninitialized_move(start, start_n, new_start);
+          start = new_start;
+          ministl::move(start_n, position, old_start);
+          ministl::fill(position - difference_type(n), position, x_copy);
+        } else {
+          uninitialized_move_fill(start, position, new_start, start, x_copy);
+          start = new_start;
+          ministl::fill(old_start, position, x_copy);
+        }
+      } catch (...) {
+        destroy_nodes_at_front(new_start);
+        throw;
+      }
+    } else {
+      iterator new_finish = reserve_elements_at_back(n);
+      iterator old_finish = finish;
+      difference_type elems_after = difference_type(length) - elems_before;
+      position = finish - elems_after;
+      try {
+        if (elems_after > difference_type(n)) {
+          iterator finish_n = finish - difference_type(n);
+          ministl::uninitialized_move(finish_n, finish, finish);
+          finish = new_finish;
+          ministl::move_backward(position, finish_n, old_finish);
+          ministl::fill(position, position + difference_type(n), x_copy);
+        } else {
+          uninitialized_fill_move(finish, position + difference_type(n),
+                                  x_copy, position, finish);
+          finish = new_finish;
+          ministl::fill(position, old_finish, x_copy);
+        }
+      } catch (...) {
+        destroy_nodes_at_back(new_finish);
+        throw;
+      }
+    }
+  }
+  void fill_insert(iterator position, size_type n, const value_type& x) {
+    if (n == 0) {
+      return;
+    }
+    if (position.cur == start.cur) {
+      iterator new_start = reserve_elements_at_front(n);
+      try {
+        ministl::uninitialized_fill(new_start, start, x);
+        start = new_start;
+      } catch (...) {
+        destroy_nodes_at_front(new_start);
+        throw;
+      }
+    } else if (position.cur == finish.cur) {
+      iterator new_finish = reserve_elements_at_back(n);
+      try {
+        ministl::uninitialized_fill(finish, new_finish, x);
+        finish = new_finish;
+      } catch (...) {
+        destroy_nodes_at_back(new_finish);
+        throw;
+      }
+    } else {
+      fill_insert_aux(position, n, x);
+    }
+  }
+
+  // 在中间插入[first, last), 与fill_insert_aux相同
+  template <class ForwardIterator>
+  void range_insert_aux(iterator position, ForwardIterator first,
+                        ForwardIterator last, size_type n) {
+    difference_type elems_before = position - start;
+    size_type length = size();
+    if (elems_before < difference_type(length / 2)) {
+      iterator new_start = reserve_elements_at_front(n);
+      iterator old_start = start;
+      position = start + elems_before;
+      try {
+        if (elems_before >= difference_type(n)) {
+          iterator start_n = start + difference_type(n);
+          ministl::uninitialized_move(start, start_n, new_start);
+          start = new_start;
+          ministl::move(start_n, position, old_start);
+          ministl::copy(first, last, position - difference_type(n));
+        } else {
+          ForwardIterator mid = first;
+          for (difference_type i = 0; i < difference_type(n) - elems_before;
+               ++i) {
+            ++mid;
+          }
+          uninitialized_move_copy(start, position, first, mid, new_start);
+          start = new_start;
+          ministl::copy(mid, last, old_start);
+        }
+      } catch (...) {
+        destroy_nodes_at_front(new_start);
+        throw;
+      }
+    } else {
+      iterator new_finish = reserve_elements_at_back(n);
+      iterator old_finish = finish;
+      difference_type elems_after = difference_type(length) - elems_before;
+      position = finish - elems_after;
+      try {
+        if (elems_after > difference_type(n)) {
+          iterator finish_n = finish - difference_type(n);
+          ministl::uninitialized_move(finish_n, finish, finish);
+          finish = new_finish;
+          ministl::move_backward(position, finish_n, old_finish);
+          ministl::copy(first, last, position);
+        } else {
+          ForwardIterator mid = first;
+          for (difference_type i = 0; i < elems_after; ++i) {
+            ++mid;
+          }
+          uninitialized_copy_move(mid, last, position, finish, finish);
+          finish = new_finish;
+          ministl::copy(first, mid, position);
+        }
+      } catch (...) {
+        destroy_nodes_at_back(new_finish);
+        throw;
+      }
+    }
+  }
+  template <class Integer>
+  void range_insert(iterator position, Integer n, Integer x, std::true_type) {
+    fill_insert(position, (size_type)n, (T)x);
+  }
+  template <class InputIterator>
+  void range_insert(iterator position, InputIterator first, InputIterator last,
+                    std::false_type) {
+    range_insert_dispatch(position, first, last, iterator_category(first));
+  }
+  template <class InputIterator>
+  void range_insert_dispatch(iterator position, InputIterator first,
+                             InputIterator last, input_iterator_tag) {
+    // 输入迭代器只能遍历一次, 先收集起来
+    deque tmp(first, last);
+    range_insert_dispatch(position, std::make_move_iterator(tmp.begin()),
+                          std::make_move_iterator(tmp.end()),
+                          forward_iterator_tag());
+  }
+  template <class ForwardIterator>
+  void range_insert_dispatch(iterator position, ForwardIterator first,
+                             ForwardIterator last, forward_iterator_tag) {
+    size_type n = 0;
+    for (ForwardIterator it = first; it != last; ++it) {
+      ++n;
+    }
+    if (n == 0) {
+      return;
+    }
+    if (position.cur == start.cur) {
+      iterator new_start = reserve_elements_at_front(n);
+      try {
+        ministl::uninitialized_copy(first, last, new_start);
+        start = new_start;
+      } catch (...) {
+        destroy_nodes_at_front(new_start);
+        throw;
+      }
+    } else if (position.cur == finish.cur) {
+      iterator new_finish = reserve_elements_at_back(n);
+      try {
+        ministl::uninitialized_copy(first, last, finish);
+        finish = new_finish;
+      } catch (...) {
+        destroy_nodes_at_back(new_finish);
+        throw;
+      }
+    } else {
+      range_insert_aux(position, first, last, n);
+    }
+  }
+
+ public:
+  deque() : map(0), map_size(0) { initialize_map(0); }
+  explicit deque(size_type n) : map(0), map_size(0) {
+    fill_initialize(n, value_type());
+  }
+  deque(size_type n, const value_type& value) : map(0), map_size(0) {
+    fill_initialize(n, value);
+  }
+  template <class InputIterator>
+  deque(InputIterator first, InputIterator last) : map(0), map_size(0) {
+    range_initialize(first, last, std::is_integral<InputIterator>());
+  }
+  deque(std::initializer_list<T> il) : map(0), map_size(0) {
+    range_initialize_aux(il.begin(), il.end(), forward_iterator_tag());
+  }
+  deque(const deque& x) : map(0), map_size(0) {
+    range_initialize_aux(x.begin(), x.end(), forward_iterator_tag());
+  }
+  // 被移走的deque仍然有一个空的缓冲区, 可以继续使用
+  deque(deque&& x) : map(0), map_size(0) {
+    initialize_map(0);
+    swap(x);
+  }
+  ~deque() {
+    destroy(start, finish);
+    release();
+  }
+
+  deque& operator=(const deque& x) {
+    if (&x != this) {
+      deque tmp(x);
+      swap(tmp);
+    }
+    return *this;
+  }
+  deque& operator=(deque&& x) noexcept {
+    if (&x != this) {
+      clear();
+      swap(x);
+    }
+    return *this;
+  }
+  deque& operator=(std::initializer_list<T> il) {
+    assign(il.begin(), il.end());
+    return *this;
+  }
+  void assign(size_type n, const value_type& value) {
+    deque tmp(n, value);
+    swap(tmp);
+  }
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    deque tmp(first, last);
+    swap(tmp);
+  }
+  void assign(std::initializer_list<T> il) { assign(il.begin(), il.end()); }
+
+  iterator begin() { return start; }
+  const_iterator begin() const { return start; }
+  const_iterator cbegin() const { return start; }
+  iterator end() { return finish; }
+  const_iterator end() const { return finish; }
+  const_iterator cend() const { return finish; }
+  reverse_iterator rbegin() { return reverse_iterator(finish); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(finish);
+  }
+  reverse_iterator rend() { return reverse_iterator(start); }
+  const_reverse_iterator rend() const { return const_reverse_iterator(start); }
+
+  size_type size() const { return finish - start; }
+  size_type max_size() const { return size_type(-1) / sizeof(T); }
+  bool empty() const { return finish == start; }
+
+  reference operator[](size_type n) { return start[difference_type(n)]; }
+  const_reference operator[](size_type n) const {
+    return start[difference_type(n)];
+  }
+  reference at(size_type n) {
+    if (n >= size()) {
+      throw std::out_of_range("deque::at");
+    }
+    return (*this)[n];
+  }
+  const_reference at(size_type n) const {
+    if (n >= size()) {
+      throw std::out_of_range("deque::at");
+    }
+    return (*this)[n];
+  }
+  reference front() { return *start; }
+  const_reference front() const { return *start; }
+  reference back() { return *(finish - 1); }
+  const_reference back() const { return *(finish - 1); }
+
+  // 最后一个缓冲区只剩一个位置时, 先配置下一个缓冲区, 保证finish所在的缓冲区存在
+  template <class... Args>
+  reference emplace_back(Args&&... args) {
+    if (finish.cur != finish.last - 1) {
+      construct(finish.cur, std::forward<Args>(args)...);
+      ++finish.cur;
+    } else {
+      reserve_map_at_back();
+      *(finish.node + 1) = allocate_node();
+      try {
+        construct(finish.cur, std::forward<Args>(args)...);
+      } catch (...) {
+        deallocate_node(*(finish.node + 1));
+        throw;
+      }
+      finish.set_node(finish.node + 1);
+      finish.cur = finish.first;
+    }
+    return back();
+  }
+  template <class... Args>
+  reference emplace_front(Args&&... args) {
+    if (start.cur != start.first) {
+      construct(start.cur - 1, std::forward<Args>(args)...);
+      --start.cur;
+    } else {
+      reserve_map_at_front();
+      *(start.node - 1) = allocate_node();
+      try {
+        construct(*(start.node - 1) + (buffer_size() - 1),
+                  std::forward<Args>(args)...);
+      } catch (...) {
+        deallocate_node(*(start.node - 1));
+        throw;
+      }
+      start.set_node(start.node - 1);
+      start.cur = start.last - 1;
+    }
+    return front();
+  }
+  void push_back(const value_type& x) { emplace_back(x); }
+  void push_back(value_type&& x) { emplace_back(std::move(x)); }
+  void push_front(const value_type& x) { emplace_front(x); }
+  void push_front(value_type&& x) { emplace_front(std::move(x)); }
+
+  void pop_back() {
+    if (finish.cur != finish.first) {
+      --finish.cur;
+      destroy(finish.cur);
+    } else {
+      deallocate_node(finish.first);
+      finish.set_node(finish.node - 1);
+      finish.cur = finish.last - 1;
+      destroy(finish.cur);
+    }
+  }
+  void pop_front() {
+    destroy(start.cur);
+    if (start.cur != start.last - 1) {
+      ++start.cur;
+    } else {
+      deallocate_node(start.first);
+      start.set_node(start.node + 1);
+      start.cur = start.first;
+    }
+  }
+
+  template <class... Args>
+  iterator emplace(const_iterator position, Args&&... args) {
+    if (position.cur == start.cur) {
+      emplace_front(std::forward<Args>(args)...);
+      return start;
+    }
+    if (position.cur == finish.cur) {
+      emplace_back(std::forward<Args>(args)...);
+      return finish - 1;
+    }
+    return insert_aux(iterator(position.cur, position.node),
+                      std::forward<Args>(args)...);
+  }
+  iterator insert(const_iterator position, const value_type& x) {
+    return emplace(position, x);
+  }
+  iterator insert(const_iterator position, value_type&& x) {
+    return emplace(position, std::move(x));
+  }
+  iterator insert(const_iterator position, size_type n, const value_type& x) {
+    difference_type off = position - start;
+    fill_insert(start + off, n, x);
+    return start + off;
+  }
+  template <class InputIterator>
+  iterator insert(const_iterator position, InputIterator first,
+                  InputIterator last) {
+    difference_type off = position - start;
+    range_insert(start + off, first, last, std::is_integral<InputIterator>());
+    return start + off;
+  }
+  iterator insert(const_iterator position, std::initializer_list<T> il) {
+    return insert(position, il.begin(), il.end());
+  }
+
+  // 删除一个元素, 移动较少的一侧
+  iterator erase(const_iterator position) {
+    iterator pos(position.cur, position.node);
+    iterator next = pos;
+    ++next;
+    difference_type index = pos - start;
+    if (size_type(index) < size() / 2) {
+      ministl::move_backward(start, pos, next);
+      pop_front();
+    } else {
+      ministl::move(next, finish, pos);
+      pop_back();
+    }
+    return start + index;
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    if (first == last) {
+      return iterator(first.cur, first.node);
+    }
+    if (first == start && last == finish) {
+      clear();
+      return finish;
+    }
+    difference_type n = last - first;
+    difference_type elems_before = first - start;
+    iterator f(first.cur, first.node);
+    iterator l(last.cur, last.node);
+    if (elems_before < difference_type(size() - n) / 2) {
+      ministl::move_backward(start, f, l);
+      iterator new_start = start + n;
+      destroy(start, new_start);
+      destroy_nodes(start.node, new_start.node);
+      start = new_start;
+    } else {
+      ministl::move(l, finish, f);
+      iterator new_finish = finish - n;
+      destroy(new_finish, finish);
+      destroy_nodes(new_finish.node + 1, finish.node + 1);
+      finish = new_finish;
+    }
+    return start + elems_before;
+  }
+  // 析构所有元素, 只保留一个缓冲区
+  void clear() {
+    for (map_pointer node = start.node + 1; node < finish.node; ++node) {
+      destroy(*node, *node + buffer_size());
+      deallocate_node(*node);
+    }
+    if (start.node != finish.node) {
+      destroy(start.cur, start.last);
+      destroy(finish.first, finish.cur);
+      deallocate_node(finish.first);
+    } else {
+      destroy(start.cur, finish.cur);
+    }
+    finish = start;
+  }
+
+  void resize(size_type new_size, const value_type& x) {
+    size_type len = size();
+    if (new_size < len) {
+      erase(start + difference_type(new_size), finish);
+    } else {
+      fill_insert(finish, new_size - len, x);
+    }
+  }
+  void resize(size_type new_size) { resize(new_size, value_type()); }
+  // 释放两端多余的map空间, 缓冲区本来就是按需配置的, 只重新配置map
+  void shrink_to_fit() {
+    size_type num_nodes = finish.node - start.node + 1;
+    if (map_size <= num_nodes + 2 || map_size <= (size_type)INITIAL_MAP_SIZE) {
+      return;
+    }
+    size_type new_map_size = num_nodes + 2 > (size_type)INITIAL_MAP_SIZE
+                                 ? num_nodes + 2
+                                 : (size_type)INITIAL_MAP_SIZE;
+    map_pointer new_map = map_allocator::allocate(new_map_size);
+    map_pointer new_nstart = new_map + (new_map_size - num_nodes) / 2;
+    ministl::copy(start.node, finish.node + 1, new_nstart);
+    map_allocator::deallocate(map, map_size);
+    map = new_map;
+    map_size = new_map_size;
+    start.set_node(new_nstart);
+    finish.set_node(new_nstart + num_nodes - 1);
+  }
+
+  void swap(deque& x) noexcept {
+    std::swap(start, x.start);
+    std::swap(finish, x.finish);
+    std::swap(map, x.map);
+    std::swap(map_size, x.map_size);
+  }
+};
+
+template <class T, class Alloc, size_t BufSiz>
+inline bool operator==(const deque<T, Alloc, BufSiz>& x,
+                       const deque<T, Alloc, BufSiz>& y) {
+  return x.size() == y.size() && ministl::equal(x.begin(), x.end(), y.begin());
+}
+
+template <class T, class Alloc, size_t BufSiz>
+inline bool operator!=(const deque<T, Alloc, BufSiz>& x,
+                       const deque<T, Alloc, BufSiz>& y) {
+  return !(x == y);
+}
+
+template <class T, class Alloc, size_t BufSiz>
+inline bool operator<(const deque<T, Alloc, BufSiz>& x,
+                      const deque<T, Alloc, BufSiz>& y) {
+  return ministl::lexicographical_compare(x.begin(), x.end(), y.begin(),
+                                          y.end());
+}
+
+template <class T, class Alloc, size_t BufSiz>
+inline void swap(deque<T, Alloc, BufSiz>& x,
+                 deque<T, Alloc, BufSiz>& y) noexcept {
+  x.swap(y);
+}
+
+// 只保存指向堆上空间的指针, 可以按字节搬移
+template <class T, class Alloc, size_t BufSiz>
+struct is_trivially_relocatable<deque<T, Alloc, BufSiz>> {
+  typedef _true_type type;
+};
+
+}  // namespace ministl
@@ -0,0 +1,771 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MINISTL_HASH_SSE2 1
+#else
+#define MINISTL_HASH_SSE2 0
+#endif
+
+namespace ministl {
+
+// 开放寻址的哈希表(Swiss table):
+// 元素直接存放在连续的slot数组中, 另有一个同样长度的控制字节数组:
+//   空        0x80 (-128)
+//   已删除    0xFE (-2)
+//   有元素    0x00 ~ 0x7F, 即哈希值的低7位(H2)
+// 哈希值的其余部分(H1)决定探测起点, 每次取16个控制字节为一组,
+// 用SSE2一次比较出组内所有H2相同的位置, 只有这些位置才需要真正比较key;
+// 组内有空位就说明key不存在. 探测按组做三角数步进, 容量是2的幂, 可以遍历所有组
+// 控制字节数组末尾多存一份前16个字节的副本, 从任何位置开始读一组都不会越界
+// 删除时如果所在位置前后没有形成过满的一组, 任何探测都不会越过它, 直接标记为空,
+// 否则才留下墓碑(已删除)
+// 最大负载因子7/8, 墓碑过多时原地重建, 否则容量翻倍
+
+typedef signed char __ctrl_t;
+enum { __CTRL_EMPTY = -128, __CTRL_DELETED = -2, __CTRL_SENTINEL = -1 };
+enum { __GROUP_WIDTH = 16 };
+
+inline bool __ctrl_is_full(__ctrl_t c) { return c >= 0; }
+
+inline unsigned __ctz32(uint32_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_ctz(x);
+#else
+  unsigned n = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+
+// 16位掩码最高位之前的0的个数
+inline unsigned __clz16(uint32_t x) {
+  unsigned n = 0;
+  for (uint32_t bit = 0x8000; bit != 0 && (x & bit) == 0; bit >>= 1) {
+    ++n;
+  }
+  return n;
+}
+
+// 一组16个控制字节, 各match函数返回16位掩码, 第i位对应组内第i个位置
+struct __hash_group {
+#if MINISTL_HASH_SSE2
+  __m128i ctrl;
+  explicit __hash_group(const __ctrl_t* p)
+      : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+  uint32_t match(__ctrl_t h2) const {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+  }
+  uint32_t match_empty() const { return match((__ctrl_t)__CTRL_EMPTY); }
+  // 空和已删除都小于__CTRL_SENTINEL
+  uint32_t match_empty_or_deleted() const {
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_cmpgt_epi8(_mm_set1_epi8((char)__CTRL_SENTINEL), ctrl));
+  }
+#else
+  // 没有SSE2时逐字节比较
+  __ctrl_t ctrl[__GROUP_WIDTH];
+  explicit __hash_group(const __ctrl_t* p) { memcpy(ctrl, p, sizeof(ctrl)); }
+  uint32_t match(__ctrl_t h2) const {
+    uint32_t mask = 0;
+    for (int i = 0; i < __GROUP_WIDTH; ++i) {
+      mask |= (uint32_t)(ctrl[i] == h2) << i;
+    }
+    return mask;
+  }
+  uint32_t match_empty() const { return match((__ctrl_t)__CTRL_EMPTY); }
+  uint32_t match_empty_or_deleted() const {
+    uint32_t mask = 0;
+    for (int i = 0; i < __GROUP_WIDTH; ++i) {
+      mask |= (uint32_t)(ctrl[i] < __CTRL_SENTINEL) << i;
+    }
+    return mask;
+  }
+#endif
+};
+
+// std::hash对整数是恒等映射, 低位和高位都要用到, 先打散
+inline size_t __hash_mix(size_t h) {
+  uint64_t x = (uint64_t)h * 0x9E3779B97F4A7C15ULL;
+  return (size_t)(x ^ (x >> 32));
+}
+
+// Hash和KeyEqual都定义了is_transparent时, 查找函数接受任何能与key比较的类型
+template <class T>
+struct __always_void {
+  typedef void type;
+};
+template <class T, class = void>
+struct __is_transparent : std::false_type {};
+template <class T>
+struct __is_transparent<
+    T, typename __always_void<typename T::is_transparent>::type>
+    : std::true_type {};
+
+template <bool transparent>
+struct __key_arg {
+  template <class K, class Key>
+  using type = Key;
+};
+template <>
+struct __key_arg<true> {
+  template <class K, class Key>
+  using type = K;
+};
+
+// map和set的区别: 元素类型和从元素中取出key的方法
+template <class K, class V>
+struct __flat_map_policy {
+  typedef K key_type;
+  typedef std::pair<const K, V> value_type;
+  static const K& key(const value_type& v) { return v.first; }
+  // 析构函数都是trivial的, clear/rehash时不用逐个析构
+  typedef typename __and_type<
+      typename type_traits<K>::has_trivial_destructor,
+      typename type_traits<V>::has_trivial_destructor>::type trivial_destructor;
+  // 可以按字节搬移, rehash时直接memcpy
+  typedef typename __and_type<typename is_trivially_relocatable<K>::type,
+                              typename is_trivially_relocatable<V>::type>::type
+      relocatable;
+};
+
+template <class K>
+struct __flat_set_policy {
+  typedef K key_type;
+  typedef K value_type;
+  static const K& key(const value_type& v) { return v; }
+  typedef typename type_traits<K>::has_trivial_destructor trivial_destructor;
+  typedef typename is_trivially_relocatable<K>::type relocatable;
+};
+
+template <class Table, class Value>
+class __flat_hash_iterator {
+ public:
+  typedef forward_iterator_tag iterator_category;
+  typedef typename Table::value_type value_type;
+  typedef ptrdiff_t difference_type;
+  typedef Value* pointer;
+  typedef Value& reference;
+
+  __flat_hash_iterator() : ctrl(0), slot(0), ctrl_end(0) {}
+  __flat_hash_iterator(const __ctrl_t* c, Value* s, const __ctrl_t* e)
+      : ctrl(c), slot(s), ctrl_end(e) {
+    skip_empty();
+  }
+  // iterator可以转换成const_iterator
+  template <class V>
+  __flat_hash_iterator(const __flat_hash_iterator<Table, V>& other)
+      : ctrl(other.ctrl), slot(other.slot), ctrl_end(other.ctrl_end) {}
+
+  reference operator*() const { return *slot; }
+  pointer operator->() const { return slot; }
+  __flat_hash_iterator& operator++() {
+    ++ctrl;
+    ++slot;
+    skip_empty();
+    return *this;
+  }
+  __flat_hash_iterator operator++(int) {
+    __flat_hash_iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  template <class V>
+  bool operator==(const __flat_hash_iterator<Table, V>& other) const {
+    return ctrl == other.ctrl;
+  }
+  template <class V>
+  bool operator!=(const __flat_hash_iterator<Table, V>& other) const {
+    return ctrl != other.ctrl;
+  }
+
+ private:
+  template <class, class>
+  friend class __flat_hash_iterator;
+  template <class, class, class, class>
+  friend class __flat_hash_table;
+
+  const __ctrl_t* ctrl;
+  Value* slot;
+  const __ctrl_t* ctrl_end;
+
+  void skip_empty() {
+    while (ctrl != ctrl_end && !__ctrl_is_full(*ctrl)) {
+      ++ctrl;
+      ++slot;
+    }
+  }
+};
+
+template <class Policy, class Hash, class KeyEqual, class Alloc>
+class __flat_hash_table {
+ public:
+  typedef typename Policy::key_type key_type;
+  typedef typename Policy::value_type value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef __flat_hash_iterator<__flat_hash_table, value_type> iterator;
+  typedef __flat_hash_iterator<__flat_hash_table, const value_type>
+      const_iterator;
+
+ protected:
+  template <class K>
+  using key_arg = typename __key_arg<__is_transparent<Hash>::value &&
+                                     __is_transparent<KeyEqual>::value>::
+      template type<K, key_type>;
+
+  typedef simple_alloc<__ctrl_t, Alloc> ctrl_allocator;
+  typedef simple_alloc<value_type, Alloc> slot_allocator;
+  enum { MIN_CAPACITY = __GROUP_WIDTH };
+
+  __ctrl_t* ctrl;
+  value_type* slots;
+  size_type capacity_;  // 0或者不小于16的2的幂
+  size_type size_;
+  size_type growth_left;  // 达到最大负载因子之前还能占用的空位数
+  hasher hash;
+  key_equal eq;
+
+  static size_type capacity_to_growth(size_type cap) { return cap - cap / 8; }
+  template <class K>
+  size_t hash_of(const K& k) const {
+    return __hash_mix(hash(k));
+  }
+  static size_t h1(size_t h) { return h >> 7; }
+  static __ctrl_t h2(size_t h) { return (__ctrl_t)(h & 0x7F); }
+
+  // 同时更新末尾的副本
+  void set_ctrl(size_type i, __ctrl_t c) {
+    ctrl[i] = c;
+    if (i < (size_type)__GROUP_WIDTH) {
+      ctrl[capacity_ + i] = c;
+    }
+  }
+
+  // 查找key所在的位置, 没有时返回capacity_
+  template <class K>
+  size_type find_index(const K& k, size_t h) const {
+    if (capacity_ == 0) {
+      return capacity_;
+    }
+    size_type mask = capacity_ - 1;
+    size_type pos = h1(h) & mask;
+    size_type step = 0;
+    for (;;) {
+      __hash_group g(ctrl + pos);
+      for (uint32_t bits = g.match(h2(h)); bits != 0; bits &= bits - 1) {
+        size_type i = (pos + __ctz32(bits)) & mask;
+        if (eq(Policy::key(slots[i]), k)) {
+          return i;
+        }
+      }
+      if (g.match_empty() != 0) {
+        return capacity_;
+      }
+      step += __GROUP_WIDTH;
+      pos = (pos + step) & mask;
+    }
+  }
+  // 第一个空位或已删除的位置, 表中一定有
+  size_type find_first_non_full(size_t h) const {
+    size_type mask = capacity_ - 1;
+    size_type pos = h1(h) & mask;
+    size_type step = 0;
+    for (;;) {
+      uint32_t bits = __hash_group(ctrl + pos).match_empty_or_deleted();
+      if (bits != 0) {
+        return (pos + __ctz32(bits)) & mask;
+      }
+      step += __GROUP_WIDTH;
+      pos = (pos + step) & mask;
+    }
+  }
+  // 为哈希值h准备一个位置, 必要时扩容, 返回的位置还没有设置控制字节
+  size_type prepare_insert(size_t h) {
+    if (capacity_ == 0) {
+      rehash_to(MIN_CAPACITY);
+    }
+    size_type i = find_first_non_full(h);
+    if (growth_left == 0 && ctrl[i] == (__ctrl_t)__CTRL_EMPTY) {
+      grow();
+      i = find_first_non_full(h);
+    }
+    return i;
+  }
+  // 位置i上的元素已经构造好, 登记它
+  void finish_insert(size_type i, size_t h) {
+    if (ctrl[i] == (__ctrl_t)__CTRL_EMPTY) {
+      --growth_left;
+    }
+    set_ctrl(i, h2(h));
+    ++size_;
+  }
+  // 墓碑超过一半时原地重建, 否则翻倍
+  void grow() {
+    if (size_ <= capacity_to_growth(capacity_) / 2) {
+      rehash_to(capacity_);
+    } else {
+      rehash_to(capacity_ * 2);
+    }
+  }
+
+  void destroy_slots(_true_type) {}
+  void destroy_slots(_false_type) {
+    for (size_type i = 0; i < capacity_; ++i) {
+      if (__ctrl_is_full(ctrl[i])) {
+        destroy(slots + i);
+      }
+    }
+  }
+  // 把元素从old搬到新位置
+  static void relocate(value_type* to, value_type* from, _true_type) {
+    memcpy((void*)to, (const void*)from, sizeof(value_type));
+  }
+  static void relocate(value_type* to, value_type* from, _false_type) {
+    construct(to, std::move(*from));
+    destroy(from);
+  }
+  void release_storage() {
+    if (capacity_ != 0) {
+      ctrl_allocator::deallocate(ctrl, capacity_ + __GROUP_WIDTH);
+      slot_allocator::deallocate(slots, capacity_);
+    }
+  }
+  void reset_ctrl() {
+    memset(ctrl, __CTRL_EMPTY, capacity_ + __GROUP_WIDTH);
+    growth_left = capacity_to_growth(capacity_) - size_;
+  }
+  // 换成容量为new_cap的新表, 所有元素按哈希值重新放置
+  void rehash_to(size_type new_cap) {
+    __ctrl_t* old_ctrl = ctrl;
+    value_type* old_slots = slots;
+    size_type old_cap = capacity_;
+    ctrl = ctrl_allocator::allocate(new_cap + __GROUP_WIDTH);
+    try {
+      slots = slot_allocator::allocate(new_cap);
+    } catch (...) {
+      ctrl_allocator::deallocate(ctrl, new_cap + __GROUP_WIDTH);
+      ctrl = old_ctrl;
+      throw;
+    }
+    capacity_ = new_cap;
+    reset_ctrl();
+    for (size_type i = 0; i < old_cap; ++i) {
+      if (__ctrl_is_full(old_ctrl[i])) {
+        size_t h = hash_of(Policy::key(old_slots[i]));
+        size_type j = find_first_non_full(h);
+        relocate(slots + j, old_slots + i, typename Policy::relocatable());
+        set_ctrl(j, h2(h));
+      }
+    }
+    if (old_cap != 0) {
+      ctrl_allocator::deallocate(old_ctrl, old_cap + __GROUP_WIDTH);
+      slot_allocator::deallocate(old_slots, old_cap);
+    }
+  }
+  // 能容纳n个元素的最小容量
+  static size_type capacity_for(size_type n) {
+    size_type cap = MIN_CAPACITY;
+    while (capacity_to_growth(cap) < n) {
+      cap *= 2;
+    }
+    return cap;
+  }
+  void erase_index(size_type i) {
+    destroy(slots + i);
+    --size_;
+    // 前后两组中的空位说明没有探测序列越过i, 可以直接标记为空
+    size_type mask = capacity_ - 1;
+    uint32_t empty_before =
+        __hash_group(ctrl + ((i - __GROUP_WIDTH) & mask)).match_empty();
+    uint32_t empty_after = __hash_group(ctrl + i).match_empty();
+    bool was_never_full =
+        empty_before != 0 && empty_after != 0 &&
+        __ctz32(empty_after) + __clz16(empty_before) < __GROUP_WIDTH;
+    if (was_never_full) {
+      set_ctrl(i, (__ctrl_t)__CTRL_EMPTY);
+      ++growth_left;
+    } else {
+      set_ctrl(i, (__ctrl_t)__CTRL_DELETED);
+    }
+  }
+  iterator iterator_at(size_type i) {
+    return iterator(ctrl + i, slots + i, ctrl + capacity_);
+  }
+  const_iterator iterator_at(size_type i) const {
+    return const_iterator(ctrl + i, slots + i, ctrl + capacity_);
+  }
+  // 插入value_type, key已存在时返回已有的元素
+  template <class V>
+  std::pair<iterator, bool> insert_value(V&& v) {
+    size_t h = hash_of(Policy::key(v));
+    size_type i = find_index(Policy::key(v), h);
+    if (i != capacity_) {
+      return std::make_pair(iterator_at(i), false);
+    }
+    i = prepare_insert(h);
+    construct(slots + i, std::forward<V>(v));
+    finish_insert(i, h);
+    return std::make_pair(iterator_at(i), true);
+  }
+
+ public:
+  explicit __flat_hash_table(size_type bucket_count = 0,
+                             const hasher& hf = hasher(),
+                             const key_equal& ke = key_equal())
+      : ctrl(0), slots(0), capacity_(0), size_(0), growth_left(0), hash(hf),
+        eq(ke) {
+    if (bucket_count != 0) {
+      reserve(bucket_count);
+    }
+  }
+  __flat_hash_table(const __flat_hash_table& x)
+      : ctrl(0), slots(0), capacity_(0), size_(0), growth_left(0),
+        hash(x.hash), eq(x.eq) {
+    reserve(x.size());
+    for (const_iterator it = x.begin(); it != x.end(); ++it) {
+      insert_value(*it);
+    }
+  }
+  __flat_hash_table(__flat_hash_table&& x) noexcept
+      : ctrl(x.ctrl), slots(x.slots), capacity_(x.capacity_), size_(x.size_),
+        growth_left(x.growth_left), hash(x.hash), eq(x.eq) {
+    x.ctrl = 0;
+    x.slots = 0;
+    x.capacity_ = x.size_ = x.growth_left = 0;
+  }
+  ~__flat_hash_table() {
+    if (capacity_ != 0) {
+      destroy_slots(typename Policy::trivial_destructor());
+    }
+    release_storage();
+  }
+  __flat_hash_table& operator=(const __flat_hash_table& x) {
+    if (&x != this) {
+      __flat_hash_table tmp(x);
+      swap(tmp);
+    }
+    return *this;
+  }
+  __flat_hash_table& operator=(__flat_hash_table&& x) noexcept {
+    if (&x != this) {
+      __flat_hash_table tmp(std::move(x));
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  iterator begin() { return iterator_at(0); }
+  const_iterator begin() const { return iterator_at(0); }
+  const_iterator cbegin() const { return begin(); }
+  iterator end() { return iterator_at(capacity_); }
+  const_iterator end() const { return iterator_at(capacity_); }
+  const_iterator cend() const { return end(); }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+  size_type max_size() const { return size_type(-1) / sizeof(value_type); }
+  size_type capacity() const { return capacity_; }
+  float load_factor() const {
+    return capacity_ == 0 ? 0.0f : (float)size_ / capacity_;
+  }
+  hasher hash_function() const { return hash; }
+  key_equal key_eq() const { return eq; }
+
+  // 保留容量, 只析构元素
+  void clear() {
+    if (capacity_ == 0) {
+      return;
+    }
+    destroy_slots(typename Policy::trivial_destructor());
+    size_ = 0;
+    reset_ctrl();
+  }
+  // 至少能容纳n个元素而不再扩容
+  void reserve(size_type n) {
+    if (n > capacity_to_growth(capacity_) || capacity_ == 0) {
+      size_type cap = capacity_for(n);
+      if (cap > capacity_) {
+        rehash_to(cap);
+      }
+    }
+  }
+  // 容量调整为能容纳max(n, size())个元素的最小值, 同时清掉所有墓碑
+  void rehash(size_type n) {
+    size_type cap = capacity_for(n > size_ ? n : size_);
+    if (size_ == 0 && n == 0) {
+      clear();
+      return;
+    }
+    rehash_to(cap);
+  }
+
+  std::pair<iterator, bool> insert(const value_type& v) {
+    return insert_value(v);
+  }
+  std::pair<iterator, bool> insert(value_type&& v) {
+    return insert_value(std::move(v));
+  }
+  template <class InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert_value(*first);
+    }
+  }
+  void insert(std::initializer_list<value_type> il) {
+    insert(il.begin(), il.end());
+  }
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    value_type v(std::forward<Args>(args)...);
+    return insert_value(std::move(v));
+  }
+
+  template <class K = key_type>
+  iterator find(const key_arg<K>& k) {
+    return iterator_at(find_index(k, hash_of(k)));
+  }
+  template <class K = key_type>
+  const_iterator find(const key_arg<K>& k) const {
+    return iterator_at(find_index(k, hash_of(k)));
+  }
+  template <class K = key_type>
+  bool contains(const key_arg<K>& k) const {
+    return find_index(k, hash_of(k)) != capacity_;
+  }
+  template <class K = key_type>
+  size_type count(const key_arg<K>& k) const {
+    return contains(k) ? 1 : 0;
+  }
+
+  // 返回下一个元素, 删除不会移动其他元素
+  iterator erase(const_iterator position) {
+    size_type i = position.ctrl - ctrl;
+    erase_index(i);
+    return iterator_at(i + 1);
+  }
+  // 透明查找时erase(key)是模板, 需要iterator的精确匹配版本
+  iterator erase(iterator position) {
+    return erase(const_iterator(position));
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+      first = erase(first);
+    }
+    return iterator_at(last.ctrl - ctrl);
+  }
+  template <class K = key_type>
+  size_type erase(const key_arg<K>& k) {
+    size_type i = find_index(k, hash_of(k));
+    if (i == capacity_) {
+      return 0;
+    }
+    erase_index(i);
+    return 1;
+  }
+
+  void swap(__flat_hash_table& x) noexcept {
+    std::swap(ctrl, x.ctrl);
+    std::swap(slots, x.slots);
+    std::swap(capacity_, x.capacity_);
+    std::swap(size_, x.size_);
+    std::swap(growth_left, x.growth_left);
+    std::swap(hash, x.hash);
+    std::swap(eq, x.eq);
+  }
+};
+
+// 开放寻址的哈希map, 接口与std::unordered_map相近, 元素在rehash时会移动,
+// 所以插入可能让所有迭代器和引用失效
+template <class Key, class T, class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>, class Alloc = alloc>
+class flat_hash_map
+    : public __flat_hash_table<__flat_map_policy<Key, T>, Hash, KeyEqual,
+                               Alloc> {
+  typedef __flat_hash_table<__flat_map_policy<Key, T>, Hash, KeyEqual, Alloc>
+      base;
+
+ public:
+  typedef T mapped_type;
+  typedef typename base::key_type key_type;
+  typedef typename base::value_type value_type;
+  typedef typename base::size_type size_type;
+  typedef typename base::hasher hasher;
+  typedef typename base::key_equal key_equal;
+  typedef typename base::iterator iterator;
+  typedef typename base::const_iterator const_iterator;
+
+  explicit flat_hash_map(size_type bucket_count = 0,
+                         const hasher& hf = hasher(),
+                         const key_equal& ke = key_equal())
+      : base(bucket_count, hf, ke) {}
+  template <class InputIterator>
+  flat_hash_map(InputIterator first, InputIterator last,
+                size_type bucket_count = 0)
+      : base(bucket_count) {
+    this->insert(first, last);
+  }
+  flat_hash_map(std::initializer_list<value_type> il,
+                size_type bucket_count = 0)
+      : base(bucket_count) {
+    this->insert(il.begin(), il.end());
+  }
+
+  // key不存在时用args构造mapped_type, 存在时什么都不做(args不会被移走)
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace(K&& k, Args&&... args) {
+    size_t h = this->hash_of(k);
+    size_type i = this->find_index(k, h);
+    if (i != this->capacity_) {
+      return std::make_pair(this->iterator_at(i), false);
+    }
+    i = this->prepare_insert(h);
+    construct(this->slots + i, std::piecewise_construct,
+              std::forward_as_tuple(std::forward<K>(k)),
+              std::forward_as_tuple(std::forward<Args>(args)...));
+    this->finish_insert(i, h);
+    return std::make_pair(this->iterator_at(i), true);
+  }
+  template <class K, class M>
+  std::pair<iterator, bool> insert_or_assign(K&& k, M&& obj) {
+    std::pair<iterator, bool> r = try_emplace(std::forward<K>(k));
+    r.first->second = std::forward<M>(obj);
+    return r;
+  }
+  mapped_type& operator[](const key_type& k) {
+    return try_emplace(k).first->second;
+  }
+  mapped_type& operator[](key_type&& k) {
+    return try_emplace(std::move(k)).first->second;
+  }
+  template <class K = key_type>
+  mapped_type& at(const typename base::template key_arg<K>& k) {
+    iterator it = this->find(k);
+    if (it == this->end()) {
+      throw std::out_of_range("flat_hash_map::at");
+    }
+    return it->second;
+  }
+  template <class K = key_type>
+  const mapped_type& at(const typename base::template key_arg<K>& k) const {
+    const_iterator it = this->find(k);
+    if (it == this->end()) {
+      throw std::out_of_range("flat_hash_map::at");
+    }
+    return it->second;
+  }
+};
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+bool operator==(const flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& x,
+                const flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& y) {
+  if (x.size() != y.size()) {
+    return false;
+  }
+  for (typename flat_hash_map<Key, T, Hash, KeyEqual, Alloc>::const_iterator
+           it = x.begin();
+       it != x.end(); ++it) {
+    typename flat_hash_map<Key, T, Hash, KeyEqual, Alloc>::const_iterator j =
+        y.find(it->first);
+    if (j == y.end() || !(j->second == it->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+bool operator!=(const flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& x,
+                const flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& y) {
+  return !(x == y);
+}
+
+// 开放寻址的哈希set, 元素不能通过迭代器修改
+template <class Key, class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>, class Alloc = alloc>
+class flat_hash_set
+    : public __flat_hash_table<__flat_set_policy<Key>, Hash, KeyEqual, Alloc> {
+  typedef __flat_hash_table<__flat_set_policy<Key>, Hash, KeyEqual, Alloc>
+      base;
+
+ public:
+  typedef typename base::key_type key_type;
+  typedef typename base::value_type value_type;
+  typedef typename base::size_type size_type;
+  typedef typename base::hasher hasher;
+  typedef typename base::key_equal key_equal;
+  typedef typename base::const_iterator iterator;
+  typedef typename base::const_iterator const_iterator;
+
+  explicit flat_hash_set(size_type bucket_count = 0,
+                         const hasher& hf = hasher(),
+                         const key_equal& ke = key_equal())
+      : base(bucket_count, hf, ke) {}
+  template <class InputIterator>
+  flat_hash_set(InputIterator first, InputIterator last,
+                size_type bucket_count = 0)
+      : base(bucket_count) {
+    this->insert(first, last);
+  }
+  flat_hash_set(std::initializer_list<value_type> il,
+                size_type bucket_count = 0)
+      : base(bucket_count) {
+    this->insert(il.begin(), il.end());
+  }
+
+  iterator begin() const { return base::begin(); }
+  iterator end() const { return base::end(); }
+  template <class K = key_type>
+  iterator find(const typename base::template key_arg<K>& k) const {
+    return base::find(k);
+  }
+};
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+bool operator==(const flat_hash_set<Key, Hash, KeyEqual, Alloc>& x,
+                const flat_hash_set<Key, Hash, KeyEqual, Alloc>& y) {
+  if (x.size() != y.size()) {
+    return false;
+  }
+  for (typename flat_hash_set<Key, Hash, KeyEqual, Alloc>::const_iterator it =
+           x.begin();
+       it != x.end(); ++it) {
+    if (!y.contains(*it)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+bool operator!=(const flat_hash_set<Key, Hash, KeyEqual, Alloc>& x,
+                const flat_hash_set<Key, Hash, KeyEqual, Alloc>& y) {
+  return !(x == y);
+}
+
+}  // namespace ministl
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
 namespace ministl {
-  
+
 /**
 分别表示5种迭代器 category 的 struct
 Input Iterator               read only
@@ -10,12 +14,14 @@ Output Iterator              write only
 Forward Iterator             允许"写入型"算法在其指向区间进行操作
 Bidirectional Iterator       提供双向访问能力
 Random Access Iterator       支持原生指针具有的全部能力
+Contiguous Iterator          元素在内存中连续存放, 可以换成原生指针处理
 */
 struct input_iterator_tag {};
 struct output_iterator_tag {};
 struct forward_iterator_tag : public input_iterator_tag {};
 struct bidirectional_iterator_tag : public forward_iterator_tag {};
 struct random_access_iterator_tag : public bidirectional_iterator_tag {};
+struct contiguous_iterator_tag : public random_access_iterator_tag {};
 
 // 迭代器模板
 template <typename Category, typename T, typename Distance = ptrdiff_t,
@@ -28,10 +34,38 @@ struct iterator {
   typedef Reference reference;
 };
 
+// std中的迭代器(例如std::vector, std::list的迭代器)用std的tag,
+// 换成对应的ministl tag才能参与分派; ministl的tag原样使用
+template <class Category>
+struct __std_category {
+  typedef Category type;
+};
+template <>
+struct __std_category<std::input_iterator_tag> {
+  typedef input_iterator_tag type;
+};
+template <>
+struct __std_category<std::output_iterator_tag> {
+  typedef output_iterator_tag type;
+};
+template <>
+struct __std_category<std::forward_iterator_tag> {
+  typedef forward_iterator_tag type;
+};
+template <>
+struct __std_category<std::bidirectional_iterator_tag> {
+  typedef bidirectional_iterator_tag type;
+};
+template <>
+struct __std_category<std::random_access_iterator_tag> {
+  typedef random_access_iterator_tag type;
+};
+
 // 迭代器的 traits
 template <class Iterator>
 struct iterator_traits {
-  typedef typename Iterator::iterator_category iterator_category;
+  typedef typename __std_category<typename Iterator::iterator_category>::type
+      iterator_category;
   typedef typename Iterator::value_type value_type;
   typedef typename Iterator::difference_type difference_type;
   typedef typename Iterator::pointer pointer;
@@ -66,7 +100,7 @@ inline typename iterator_traits<Iterator>::iterator_category iterator_category(
 template <typename Iterator>
 inline typename iterator_traits<Iterator>::difference_type* difference_type(
     const Iterator&) {
-  return static_cast<typename iterator_traits<Iterator>::difference*>(0);
+  return static_cast<typename iterator_traits<Iterator>::difference_type*>(0);
 }
 
 template <typename Iterator>
@@ -75,6 +109,22 @@ inline typename iterator_traits<Iterator>::value_type* value_type(
   return static_cast<typename iterator_traits<Iterator>::value_type*>(0);
 }
 
+// is_contiguous: 迭代器指向的元素在内存中连续存放
+// 原生指针总是连续的; 类类型的迭代器把iterator_category定义成contiguous_iterator_tag,
+// 并且operator->()在尾后位置也返回地址(不解引用), 算法就可以换成原生指针处理
+// 原生指针的iterator_category仍然是random_access_iterator_tag, 与std一致
+template <class Iterator>
+struct is_contiguous
+    : std::is_convertible<typename iterator_traits<Iterator>::iterator_category,
+                          contiguous_iterator_tag> {};
+
+template <class T>
+struct is_contiguous<T*> : std::true_type {};
+
+template <class T>
+struct is_contiguous<const T*> : std::true_type {};
+
+// distance, advance按迭代器类型分派, 随机访问迭代器是O(1)
 template <typename InputIterator>
 inline typename iterator_traits<InputIterator>::difference_type distance_aux(
     InputIterator first, InputIterator last, input_iterator_tag) {
@@ -115,15 +165,15 @@ inline void distance(InputIterator first, InputIterator last, Distance& n) {
   distance_aux(first, last, n, iterator_category(first));
 }
 
+// 输入迭代器只能前进, n必须非负
 template <typename InputIterator, typename Distance>
-inline void advance_aux(InputIterator iter, const Distance& n,
-                        input_iterator_tag) {
-  for (; n != 0; --n, ++iter)
+inline void advance_aux(InputIterator& iter, Distance n, input_iterator_tag) {
+  for (; n > 0; --n, ++iter)
     ;
 }
 
 template <typename BidirectionIterator, typename Distance>
-inline void advance_aux(BidirectionIterator iter, const Distance& n,
+inline void advance_aux(BidirectionIterator& iter, Distance n,
                         bidirectional_iterator_tag) {
   if (n >= 0)
     for (; n != 0; --n, ++iter)
@@ -134,36 +184,76 @@ inline void advance_aux(BidirectionIterator iter, const Distance& n,
 }
 
 template <typename RandomAccessIterator, typename Distance>
-inline void advance_aux(RandomAccessIterator iter, const Distance& n,
+inline void advance_aux(RandomAccessIterator& iter, Distance n,
                         random_access_iterator_tag) {
   iter += n;
 }
 
 template <typename InputIterator, typename Distance>
-inline void advance(InputIterator iter, const Distance& n) {
+inline void advance(InputIterator& iter, Distance n) {
   advance_aux(iter, n, iterator_category(iter));
 }
 
+// next, prev: 返回前进(后退)n步的迭代器, 参数本身不变
+template <typename InputIterator>
+inline InputIterator next(
+    InputIterator iter,
+    typename iterator_traits<InputIterator>::difference_type n = 1) {
+  ministl::advance(iter, n);
+  return iter;
+}
+
+template <typename BidirectionIterator>
+inline BidirectionIterator prev(
+    BidirectionIterator iter,
+    typename iterator_traits<BidirectionIterator>::difference_type n = 1) {
+  ministl::advance(iter, -n);
+  return iter;
+}
+
+// 包装其他迭代器的适配器: 连续性不能传递(反向不连续, 移动后解引用得到右值),
+// 最多是随机访问迭代器
+template <class Category>
+struct __adaptor_category {
+  typedef Category type;
+};
+
+template <>
+struct __adaptor_category<contiguous_iterator_tag> {
+  typedef random_access_iterator_tag type;
+};
+
 // 反向迭代器的实现
-template <typename RandomAccessIterator, typename T, typename Reference = T&,
+// 类别与底层迭代器相同, 双向迭代器也可以反向, 只是不能用+, -, []和<
+template <typename Iterator, typename T, typename Reference = T&,
           typename Distance = ptrdiff_t>
 class reverse_iterator {
  protected:
-  typedef reverse_iterator<RandomAccessIterator, T, Reference, Distance> self;
-  RandomAccessIterator current;
+  typedef reverse_iterator<Iterator, T, Reference, Distance> self;
+  Iterator current;
 
  public:
-  typedef random_access_iterator_tag iterator_category;
+  typedef typename __adaptor_category<
+      typename iterator_traits<Iterator>::iterator_category>::type
+      iterator_category;
   typedef T value_type;
   typedef Distance difference_type;
-  typedef T* pointer;
+  typedef typename std::remove_reference<Reference>::type* pointer;
   typedef Reference reference;
-  reverse_iterator() {}
-  explicit reverse_iterator(RandomAccessIterator iter) : current(iter) {}
-  RandomAccessIterator base() const { return current; }
+  reverse_iterator() : current() {}
+  explicit reverse_iterator(Iterator iter) : current(iter) {}
+  // iterator到const_iterator的转换
+  template <typename Iter, typename Ref>
+  reverse_iterator(const reverse_iterator<Iter, T, Ref, Distance>& x)
+      : current(x.base()) {}
+  Iterator base() const { return current; }
   // 各种操作符重载
-  Reference operator*() const { return *(current - 1); }
-  pointer operator->() { return &(operator*()); }
+  // 只用--, 双向迭代器也可以反向
+  Reference operator*() const {
+    Iterator tmp = current;
+    return *--tmp;
+  }
+  pointer operator->() const { return &(operator*()); }
   self& operator++() {
     --current;
     return *this;
@@ -180,51 +270,201 @@ class reverse_iterator {
   self operator--(int) {
     self tmp = *this;
     ++current;
-    return *this;
+    return tmp;
   }
-  self operator+(Distance n) { return self(current - n); }
+  self operator+(Distance n) const { return self(current - n); }
   self& operator+=(Distance n) {
     current -= n;
     return *this;
   }
-  self operator-(Distance n) { return self(current + n); }
+  self operator-(Distance n) const { return self(current + n); }
   self& operator-=(Distance n) {
     current += n;
     return *this;
   }
-  Reference operator[](Distance n) const { return *(*this); }
+  Reference operator[](Distance n) const { return *(*this + n); }
 };  // end reverse_iterator
 
-template <typename RandomAccessIterator, typename T, typename Reference,
-          typename Distance>
+// 比较的是底层迭代器, 反向后大小关系颠倒
+template <typename Iterator1, typename Iterator2, typename T,
+          typename Reference1, typename Reference2, typename Distance>
 inline bool operator==(
-    reverse_iterator<RandomAccessIterator, T, Reference, Distance>& lhs,
-    reverse_iterator<RandomAccessIterator, T, Reference, Distance>& rhs) {
+    const reverse_iterator<Iterator1, T, Reference1, Distance>& lhs,
+    const reverse_iterator<Iterator2, T, Reference2, Distance>& rhs) {
   return lhs.base() == rhs.base();
 }
 
-template <typename RandomAccessIterator, typename T, typename Reference,
-          typename Distance>
+template <typename Iterator1, typename Iterator2, typename T,
+          typename Reference1, typename Reference2, typename Distance>
+inline bool operator!=(
+    const reverse_iterator<Iterator1, T, Reference1, Distance>& lhs,
+    const reverse_iterator<Iterator2, T, Reference2, Distance>& rhs) {
+  return !(lhs.base() == rhs.base());
+}
+
+template <typename Iterator1, typename Iterator2, typename T,
+          typename Reference1, typename Reference2, typename Distance>
 inline bool operator<(
-    reverse_iterator<RandomAccessIterator, T, Reference, Distance>& lhs,
-    reverse_iterator<RandomAccessIterator, T, Reference, Distance>& rhs) {
-  return lhs.base() < rhs.base();
+    const reverse_iterator<Iterator1, T, Reference1, Distance>& lhs,
+    const reverse_iterator<Iterator2, T, Reference2, Distance>& rhs) {
+  return rhs.base() < lhs.base();
+}
+
+template <typename Iterator1, typename Iterator2, typename T,
+          typename Reference1, typename Reference2, typename Distance>
+inline bool operator>(
+    const reverse_iterator<Iterator1, T, Reference1, Distance>& lhs,
+    const reverse_iterator<Iterator2, T, Reference2, Distance>& rhs) {
+  return rhs < lhs;
+}
+
+template <typename Iterator1, typename Iterator2, typename T,
+          typename Reference1, typename Reference2, typename Distance>
+inline bool operator<=(
+    const reverse_iterator<Iterator1, T, Reference1, Distance>& lhs,
+    const reverse_iterator<Iterator2, T, Reference2, Distance>& rhs) {
+  return !(rhs < lhs);
 }
 
-template <typename RandomAccessIterator, typename T, typename Reference,
-          typename Distance>
+template <typename Iterator1, typename Iterator2, typename T,
+          typename Reference1, typename Reference2, typename Distance>
+inline bool operator>=(
+    const reverse_iterator<Iterator1, T, Reference1, Distance>& lhs,
+    const reverse_iterator<Iterator2, T, Reference2, Distance>& rhs) {
+  return !(lhs < rhs);
+}
+
+template <typename Iterator1, typename Iterator2, typename T,
+          typename Reference1, typename Reference2, typename Distance>
 inline Distance operator-(
-    reverse_iterator<RandomAccessIterator, T, Reference, Distance>& lhs,
-    reverse_iterator<RandomAccessIterator, T, Reference, Distance>& rhs) {
-  return lhs.base() - rhs.base();
+    const reverse_iterator<Iterator1, T, Reference1, Distance>& lhs,
+    const reverse_iterator<Iterator2, T, Reference2, Distance>& rhs) {
+  return rhs.base() - lhs.base();
 }
 
-template <typename RandomAccessIterator, typename T, typename Reference,
-          typename Distance>
-inline reverse_iterator<RandomAccessIterator, T, Reference, Distance> operator+(
+template <typename Iterator, typename T, typename Reference, typename Distance>
+inline reverse_iterator<Iterator, T, Reference, Distance> operator+(
     Distance n,
-    reverse_iterator<RandomAccessIterator, T, Reference, Distance>& iter) {
-  return reverse_iterator<RandomAccessIterator, T, Reference, Distance>(
-      iter.base() - n);
+    const reverse_iterator<Iterator, T, Reference, Distance>& iter) {
+  return iter + n;
 }
-}  // namespace ministl
\ No newline at end of file
+
+// 移动迭代器: 解引用得到右值引用, copy和uninitialized_copy经过它就变成移动
+template <typename Iterator>
+class move_iterator {
+ protected:
+  typedef move_iterator<Iterator> self;
+  Iterator current;
+
+ public:
+  typedef Iterator iterator_type;
+  typedef typename __adaptor_category<
+      typename iterator_traits<Iterator>::iterator_category>::type
+      iterator_category;
+  typedef typename iterator_traits<Iterator>::value_type value_type;
+  typedef typename iterator_traits<Iterator>::difference_type difference_type;
+  typedef Iterator pointer;
+  // 底层解引用不是左值引用(例如代理对象)时原样返回
+  typedef typename iterator_traits<Iterator>::reference base_reference;
+  typedef typename std::conditional<
+      std::is_reference<base_reference>::value,
+      typename std::remove_reference<base_reference>::type&&,
+      base_reference>::type reference;
+
+  move_iterator() : current() {}
+  explicit move_iterator(Iterator iter) : current(iter) {}
+  template <typename Iter>
+  move_iterator(const move_iterator<Iter>& x) : current(x.base()) {}
+  Iterator base() const { return current; }
+
+  reference operator*() const { return static_cast<reference>(*current); }
+  pointer operator->() const { return current; }
+  self& operator++() {
+    ++current;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++current;
+    return tmp;
+  }
+  self& operator--() {
+    --current;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --current;
+    return tmp;
+  }
+  self operator+(difference_type n) const { return self(current + n); }
+  self& operator+=(difference_type n) {
+    current += n;
+    return *this;
+  }
+  self operator-(difference_type n) const { return self(current - n); }
+  self& operator-=(difference_type n) {
+    current -= n;
+    return *this;
+  }
+  reference operator[](difference_type n) const {
+    return static_cast<reference>(current[n]);
+  }
+};  // end move_iterator
+
+template <typename Iterator1, typename Iterator2>
+inline bool operator==(const move_iterator<Iterator1>& lhs,
+                       const move_iterator<Iterator2>& rhs) {
+  return lhs.base() == rhs.base();
+}
+
+template <typename Iterator1, typename Iterator2>
+inline bool operator!=(const move_iterator<Iterator1>& lhs,
+                       const move_iterator<Iterator2>& rhs) {
+  return !(lhs.base() == rhs.base());
+}
+
+template <typename Iterator1, typename Iterator2>
+inline bool operator<(const move_iterator<Iterator1>& lhs,
+                      const move_iterator<Iterator2>& rhs) {
+  return lhs.base() < rhs.base();
+}
+
+template <typename Iterator1, typename Iterator2>
+inline bool operator>(const move_iterator<Iterator1>& lhs,
+                      const move_iterator<Iterator2>& rhs) {
+  return rhs < lhs;
+}
+
+template <typename Iterator1, typename Iterator2>
+inline bool operator<=(const move_iterator<Iterator1>& lhs,
+                       const move_iterator<Iterator2>& rhs) {
+  return !(rhs < lhs);
+}
+
+template <typename Iterator1, typename Iterator2>
+inline bool operator>=(const move_iterator<Iterator1>& lhs,
+                       const move_iterator<Iterator2>& rhs) {
+  return !(lhs < rhs);
+}
+
+template <typename Iterator1, typename Iterator2>
+inline auto operator-(const move_iterator<Iterator1>& lhs,
+                      const move_iterator<Iterator2>& rhs)
+    -> decltype(lhs.base() - rhs.base()) {
+  return lhs.base() - rhs.base();
+}
+
+template <typename Iterator>
+inline move_iterator<Iterator> operator+(
+    typename move_iterator<Iterator>::difference_type n,
+    const move_iterator<Iterator>& iter) {
+  return iter + n;
+}
+
+template <typename Iterator>
+inline move_iterator<Iterator> make_move_iterator(Iterator iter) {
+  return move_iterator<Iterator>(iter);
+}
+
+}  // namespace ministl
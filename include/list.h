@@ -0,0 +1,587 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+#include "algobase.h"
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+
+namespace ministl {
+
+// 环状双向链表: 哨兵节点直接放在list对象里, 空链表不配置任何内存
+// 节点由simple_alloc<node, Alloc>配置, 一次插入n个元素时n个节点由allocate_batch
+// 一次取得, 成批删除时整串归还; splice/merge/sort/reverse只改指针, 不配置内存
+// size()要遍历链表, 所以任何形式的splice都是O(1)
+
+struct __list_node_base {
+  __list_node_base* prev;
+  __list_node_base* next;
+};
+
+template <class T>
+struct __list_node : __list_node_base {
+  T data;
+};
+
+// 把[first, last)移到position之前, first和last可以属于另一个链表,
+// position不能在[first, last)之内
+inline void __list_transfer(__list_node_base* position,
+                            __list_node_base* first, __list_node_base* last) {
+  if (position != last && first != last) {
+    last->prev->next = position;
+    first->prev->next = last;
+    position->prev->next = first;
+    __list_node_base* tmp = position->prev;
+    position->prev = last->prev;
+    last->prev = first->prev;
+    first->prev = tmp;
+  }
+}
+
+template <class T, class Ref, class Ptr>
+struct __list_iterator {
+  typedef __list_iterator<T, T&, T*> iterator;
+  typedef __list_iterator<T, const T&, const T*> const_iterator;
+  typedef __list_iterator self;
+
+  typedef bidirectional_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef Ptr pointer;
+  typedef Ref reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  __list_node_base* node;
+
+  __list_iterator() : node(0) {}
+  explicit __list_iterator(__list_node_base* x) : node(x) {}
+  __list_iterator(const __list_iterator&) = default;
+  __list_iterator& operator=(const __list_iterator&) = default;
+  // iterator到const_iterator的转换, 不能反过来
+  template <class R, class P,
+            class = typename std::enable_if<
+                std::is_same<__list_iterator<T, R, P>, iterator>::value>::type>
+  __list_iterator(const __list_iterator<T, R, P>& x) : node(x.node) {}
+
+  bool operator==(const self& x) const { return node == x.node; }
+  bool operator!=(const self& x) const { return node != x.node; }
+  reference operator*() const { return ((__list_node<T>*)node)->data; }
+  pointer operator->() const { return &(operator*()); }
+  self& operator++() {
+    node = node->next;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    node = node->next;
+    return tmp;
+  }
+  self& operator--() {
+    node = node->prev;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    node = node->prev;
+    return tmp;
+  }
+};
+
+template <class T, class Alloc = alloc>
+class list {
+ public:
+  typedef T value_type;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef __list_iterator<T, T&, T*> iterator;
+  typedef __list_iterator<T, const T&, const T*> const_iterator;
+  typedef ministl::reverse_iterator<iterator, T> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator, T, const T&>
+      const_reverse_iterator;
+
+ protected:
+  typedef __list_node_base node_base;
+  typedef __list_node<T> node;
+  typedef simple_alloc<node, Alloc> node_allocator;
+
+  node_base head;  // 哨兵, head.next是第一个节点, head.prev是最后一个节点
+
+  void empty_initialize() { head.next = head.prev = &head; }
+
+  template <class... Args>
+  node* create_node(Args&&... args) {
+    node* p = node_allocator::allocate();
+    try {
+      construct(&p->data, std::forward<Args>(args)...);
+    } catch (...) {
+      node_allocator::deallocate(p);
+      throw;
+    }
+    return p;
+  }
+  // 析构[first, last)上的元素, 节点串成一串整批归还, 调用者负责先摘下这一段
+  static void destroy_nodes(node_base* first, node_base* last) {
+    void* chain = 0;
+    while (first != last) {
+      node_base* next = first->next;
+      destroy(&((node*)first)->data);
+      *(void**)first = chain;
+      chain = first;
+      first = next;
+    }
+    node_allocator::deallocate_batch(chain);
+  }
+  // 一次配置n个节点, 依次用gen(p)在p上构造元素, 整段插到position之前,
+  // 返回第一个新元素. 中途异常时已构造的元素析构, 节点整批归还, 链表不变
+  template <class Generator>
+  iterator insert_batch(iterator position, size_type n, Generator gen) {
+    if (n == 0) {
+      return position;
+    }
+    void* raw = node_allocator::allocate_batch(n);
+    node_base seg;  // 新节点先挂在这个临时哨兵上
+    seg.next = seg.prev = &seg;
+    try {
+      while (raw != 0) {
+        node* p = (node*)raw;
+        raw = *(void**)raw;
+        try {
+          gen(&p->data);
+        } catch (...) {
+          *(void**)p = raw;
+          raw = p;
+          throw;
+        }
+        p->prev = seg.prev;
+        p->next = &seg;
+        seg.prev->next = p;
+        seg.prev = p;
+      }
+    } catch (...) {
+      node_allocator::deallocate_batch(raw);
+      destroy_nodes(seg.next, &seg);
+      throw;
+    }
+    iterator result(seg.next);
+    __list_transfer(position.node, seg.next, &seg);
+    return result;
+  }
+
+  void fill_insert(iterator position, size_type n, const value_type& x) {
+    insert_batch(position, n, [&x](T* p) { construct(p, x); });
+  }
+  template <class Integer>
+  iterator range_insert(iterator position, Integer n, Integer x,
+                        std::true_type) {
+    return insert_batch(position, (size_type)n,
+                        [&x](T* p) { construct(p, (T)x); });
+  }
+  template <class InputIterator>
+  iterator range_insert(iterator position, InputIterator first,
+                        InputIterator last, std::false_type) {
+    return range_insert_aux(position, first, last, iterator_category(first));
+  }
+  // 单遍迭代器不能先数个数, 先逐个插到临时链表里再整段接过来
+  template <class InputIterator>
+  iterator range_insert_aux(iterator position, InputIterator first,
+                            InputIterator last, input_iterator_tag) {
+    list tmp;
+    for (; first != last; ++first) {
+      tmp.emplace_back(*first);
+    }
+    iterator result = tmp.begin();
+    if (result == tmp.end()) {
+      return position;
+    }
+    splice(position, tmp);
+    return result;
+  }
+  template <class ForwardIterator>
+  iterator range_insert_aux(iterator position, ForwardIterator first,
+                            ForwardIterator last, forward_iterator_tag) {
+    size_type n = (size_type)ministl::distance(first, last);
+    return insert_batch(position, n, [&first](T* p) {
+      construct(p, *first);
+      ++first;
+    });
+  }
+
+ public:
+  list() { empty_initialize(); }
+  explicit list(size_type n) {
+    empty_initialize();
+    insert_batch(end(), n, [](T* p) { construct(p); });
+  }
+  list(size_type n, const value_type& value) {
+    empty_initialize();
+    fill_insert(end(), n, value);
+  }
+  template <class InputIterator>
+  list(InputIterator first, InputIterator last) {
+    empty_initialize();
+    range_insert(end(), first, last, std::is_integral<InputIterator>());
+  }
+  list(std::initializer_list<T> il) {
+    empty_initialize();
+    range_insert_aux(end(), il.begin(), il.end(), forward_iterator_tag());
+  }
+  list(const list& x) {
+    empty_initialize();
+    range_insert_aux(end(), x.begin(), x.end(), forward_iterator_tag());
+  }
+  list(list&& x) noexcept {
+    empty_initialize();
+    splice(end(), x);
+  }
+  ~list() { destroy_nodes(head.next, &head); }
+
+  // 已有的节点直接赋值, 多出来的删掉, 不够的整批配置
+  list& operator=(const list& x) {
+    if (&x != this) {
+      iterator first1 = begin();
+      const_iterator first2 = x.begin();
+      for (; first1 != end() && first2 != x.end(); ++first1, ++first2) {
+        *first1 = *first2;
+      }
+      if (first2 == x.end()) {
+        erase(first1, end());
+      } else {
+        range_insert_aux(end(), first2, x.end(), forward_iterator_tag());
+      }
+    }
+    return *this;
+  }
+  list& operator=(list&& x) noexcept {
+    if (&x != this) {
+      clear();
+      splice(end(), x);
+    }
+    return *this;
+  }
+  list& operator=(std::initializer_list<T> il) {
+    assign(il.begin(), il.end());
+    return *this;
+  }
+  void assign(size_type n, const value_type& value) {
+    iterator i = begin();
+    for (; i != end() && n > 0; ++i, --n) {
+      *i = value;
+    }
+    if (n > 0) {
+      fill_insert(end(), n, value);
+    } else {
+      erase(i, end());
+    }
+  }
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    list tmp(first, last);
+    swap(tmp);
+  }
+  void assign(std::initializer_list<T> il) { assign(il.begin(), il.end()); }
+
+  iterator begin() { return iterator(head.next); }
+  const_iterator begin() const { return const_iterator(head.next); }
+  const_iterator cbegin() const { return const_iterator(head.next); }
+  iterator end() { return iterator(&head); }
+  const_iterator end() const { return const_iterator((node_base*)&head); }
+  const_iterator cend() const { return end(); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  bool empty() const { return head.next == &head; }
+  // 要遍历整个链表
+  size_type size() const {
+    return (size_type)ministl::distance(begin(), end());
+  }
+  size_type max_size() const { return size_type(-1) / sizeof(node); }
+
+  reference front() { return *begin(); }
+  const_reference front() const { return *begin(); }
+  reference back() { return *(--end()); }
+  const_reference back() const { return *(--end()); }
+
+  template <class... Args>
+  iterator emplace(iterator position, Args&&... args) {
+    node* p = create_node(std::forward<Args>(args)...);
+    p->next = position.node;
+    p->prev = position.node->prev;
+    position.node->prev->next = p;
+    position.node->prev = p;
+    return iterator(p);
+  }
+  iterator insert(iterator position, const value_type& x) {
+    return emplace(position, x);
+  }
+  iterator insert(iterator position, value_type&& x) {
+    return emplace(position, std::move(x));
+  }
+  iterator insert(iterator position, size_type n, const value_type& x) {
+    return insert_batch(position, n, [&x](T* p) { construct(p, x); });
+  }
+  template <class InputIterator>
+  iterator insert(iterator position, InputIterator first,
+                  InputIterator last) {
+    return range_insert(position, first, last,
+                        std::is_integral<InputIterator>());
+  }
+  iterator insert(iterator position, std::initializer_list<T> il) {
+    return range_insert_aux(position, il.begin(), il.end(),
+                            forward_iterator_tag());
+  }
+  template <class... Args>
+  reference emplace_front(Args&&... args) {
+    return *emplace(begin(), std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  reference emplace_back(Args&&... args) {
+    return *emplace(end(), std::forward<Args>(args)...);
+  }
+  void push_front(const value_type& x) { emplace(begin(), x); }
+  void push_front(value_type&& x) { emplace(begin(), std::move(x)); }
+  void push_back(const value_type& x) { emplace(end(), x); }
+  void push_back(value_type&& x) { emplace(end(), std::move(x)); }
+
+  iterator erase(iterator position) {
+    node_base* next = position.node->next;
+    position.node->prev->next = next;
+    next->prev = position.node->prev;
+    destroy(&((node*)position.node)->data);
+    node_allocator::deallocate((node*)position.node);
+    return iterator(next);
+  }
+  iterator erase(iterator first, iterator last) {
+    if (first != last) {
+      first.node->prev->next = last.node;
+      last.node->prev = first.node->prev;
+      destroy_nodes(first.node, last.node);
+    }
+    return last;
+  }
+  void pop_front() { erase(begin()); }
+  void pop_back() { erase(--end()); }
+  void clear() {
+    destroy_nodes(head.next, &head);
+    empty_initialize();
+  }
+  void resize(size_type new_size) {
+    iterator i = begin();
+    for (; i != end() && new_size > 0; ++i, --new_size) {
+    }
+    if (new_size > 0) {
+      insert_batch(end(), new_size, [](T* p) { construct(p); });
+    } else {
+      erase(i, end());
+    }
+  }
+  void resize(size_type new_size, const value_type& x) {
+    iterator i = begin();
+    for (; i != end() && new_size > 0; ++i, --new_size) {
+    }
+    if (new_size > 0) {
+      fill_insert(end(), new_size, x);
+    } else {
+      erase(i, end());
+    }
+  }
+  void swap(list& x) {
+    list tmp;
+    tmp.splice(tmp.end(), x);
+    x.splice(x.end(), *this);
+    splice(end(), tmp);
+  }
+
+  // 把x的所有元素移到position之前, x不能是*this
+  void splice(iterator position, list& x) {
+    __list_transfer(position.node, x.head.next, &x.head);
+  }
+  void splice(iterator position, list&& x) { splice(position, x); }
+  // 把i所指的元素移到position之前, i可以属于*this
+  void splice(iterator position, list&, iterator i) {
+    iterator j = i;
+    ++j;
+    if (position == i || position == j) {
+      return;
+    }
+    __list_transfer(position.node, i.node, j.node);
+  }
+  void splice(iterator position, list&& x, iterator i) {
+    splice(position, x, i);
+  }
+  // 把[first, last)移到position之前, position不能在[first, last)之内
+  void splice(iterator position, list&, iterator first, iterator last) {
+    __list_transfer(position.node, first.node, last.node);
+  }
+  void splice(iterator position, list&& x, iterator first, iterator last) {
+    splice(position, x, first, last);
+  }
+
+  // 删掉的节点先收集到一个临时链表里, 最后整批归还,
+  // value引用的是链表里的元素时也不会出错
+  void remove(const value_type& value) {
+    remove_if([&value](const value_type& x) { return x == value; });
+  }
+  template <class Predicate>
+  void remove_if(Predicate pred) {
+    list deleted;
+    iterator first = begin();
+    while (first != end()) {
+      iterator next = first;
+      ++next;
+      if (pred(*first)) {
+        deleted.splice(deleted.end(), *this, first);
+      }
+      first = next;
+    }
+  }
+  void unique() {
+    unique([](const value_type& x, const value_type& y) { return x == y; });
+  }
+  // 相邻的等价元素只保留第一个
+  template <class BinaryPredicate>
+  void unique(BinaryPredicate pred) {
+    list deleted;
+    iterator first = begin();
+    if (first == end()) {
+      return;
+    }
+    iterator next = first;
+    while (++next != end()) {
+      if (pred(*first, *next)) {
+        deleted.splice(deleted.end(), *this, next);
+      } else {
+        first = next;
+      }
+      next = first;
+    }
+  }
+
+  // 两个链表都已按comp排好序, 把x合并进来, 结果稳定, x变为空
+  void merge(list& x) { merge(x, less_than()); }
+  void merge(list&& x) { merge(x); }
+  template <class Compare>
+  void merge(list& x, Compare comp) {
+    if (&x == this) {
+      return;
+    }
+    iterator first1 = begin();
+    iterator first2 = x.begin();
+    while (first1 != end() && first2 != x.end()) {
+      if (comp(*first2, *first1)) {
+        // x中连续一段都比*first1小时整段移过来
+        iterator next = first2;
+        while (++next != x.end() && comp(*next, *first1)) {
+        }
+        __list_transfer(first1.node, first2.node, next.node);
+        first2 = next;
+      } else {
+        ++first1;
+      }
+    }
+    __list_transfer(end().node, first2.node, x.end().node);
+  }
+  template <class Compare>
+  void merge(list&& x, Compare comp) {
+    merge(x, comp);
+  }
+
+  void reverse() {
+    node_base* p = &head;
+    do {
+      node_base* tmp = p->next;
+      p->next = p->prev;
+      p->prev = tmp;
+      p = tmp;
+    } while (p != &head);
+  }
+
+  // 自底向上的归并排序: counter[i]存放2^i个已排好的元素, 每取一个元素就像二进制加一
+  // 一样逐级合并, 只用splice/merge/swap, 不配置内存, 稳定
+  void sort() { sort(less_than()); }
+  template <class Compare>
+  void sort(Compare comp) {
+    if (head.next == &head || head.next->next == &head) {
+      return;
+    }
+    list carry;
+    list counter[64];
+    int fill = 0;
+    try {
+      while (!empty()) {
+        carry.splice(carry.begin(), *this, begin());
+        int i = 0;
+        while (i < fill && !counter[i].empty()) {
+          counter[i].merge(carry, comp);
+          carry.swap(counter[i++]);
+        }
+        carry.swap(counter[i]);
+        if (i == fill) {
+          ++fill;
+        }
+      }
+      for (int i = 1; i < fill; ++i) {
+        counter[i].merge(counter[i - 1], comp);
+      }
+    } catch (...) {
+      // comp抛出异常时元素都放回来, 顺序不定
+      splice(end(), carry);
+      for (int i = 0; i < fill; ++i) {
+        splice(end(), counter[i]);
+      }
+      throw;
+    }
+    splice(end(), counter[fill - 1]);
+  }
+
+ private:
+  struct less_than {
+    bool operator()(const value_type& x, const value_type& y) const {
+      return x < y;
+    }
+  };
+};
+
+template <class T, class Alloc>
+inline bool operator==(const list<T, Alloc>& x, const list<T, Alloc>& y) {
+  typename list<T, Alloc>::const_iterator first1 = x.begin();
+  typename list<T, Alloc>::const_iterator first2 = y.begin();
+  for (; first1 != x.end() && first2 != y.end(); ++first1, ++first2) {
+    if (!(*first1 == *first2)) {
+      return false;
+    }
+  }
+  return first1 == x.end() && first2 == y.end();
+}
+
+template <class T, class Alloc>
+inline bool operator!=(const list<T, Alloc>& x, const list<T, Alloc>& y) {
+  return !(x == y);
+}
+
+template <class T, class Alloc>
+inline bool operator<(const list<T, Alloc>& x, const list<T, Alloc>& y) {
+  return ministl::lexicographical_compare(x.begin(), x.end(), y.begin(),
+                                          y.end());
+}
+
+template <class T, class Alloc>
+inline void swap(list<T, Alloc>& x, list<T, Alloc>& y) {
+  x.swap(y);
+}
+
+}  // namespace ministl
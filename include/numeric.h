@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "iterator.h"
+#include "simd.h"
+#include "type_traits.h"
+
+namespace ministl {
+
+// 数值算法: accumulate, reduce, inclusive_scan
+// accumulate严格按顺序累加; reduce不保证顺序, 原生指针上的整数和浮点数向量化,
+// 整数的结果与accumulate相同, 浮点数可能有舍入上的差别
+
+template <class InputIterator, class T>
+T accumulate(InputIterator first, InputIterator last, T init) {
+  for (; first != last; ++first) {
+    init = init + *first;
+  }
+  return init;
+}
+
+template <class InputIterator, class T, class BinaryOperation>
+T accumulate(InputIterator first, InputIterator last, T init,
+             BinaryOperation op) {
+  for (; first != last; ++first) {
+    init = op(init, *first);
+  }
+  return init;
+}
+
+template <class InputIterator, class T>
+inline T reduce_leaf(InputIterator first, InputIterator last, T init) {
+  return ministl::accumulate(first, last, init);
+}
+
+template <class T>
+inline T reduce_ptr(const T* first, const T* last, T init, _true_type) {
+  return __simd_reduce(first, last, init);
+}
+
+template <class T>
+inline T reduce_ptr(const T* first, const T* last, T init, _false_type) {
+  return ministl::accumulate(first, last, init);
+}
+
+// 元素和init是同一种类型才向量化; bool相加会提升成int, 不在此列
+template <class U, class T>
+inline T reduce_leaf(U* first, U* last, T init) {
+  typedef typename std::conditional<
+      std::is_same<typename std::remove_cv<U>::type, T>::value &&
+          !std::is_same<T, bool>::value,
+      typename __simd_eligible<T>::type, _false_type>::type simd;
+  return reduce_ptr<T>(first, last, init, simd());
+}
+
+template <class InputIterator, class T>
+inline T reduce(InputIterator first, InputIterator last, T init) {
+  return reduce_leaf(first, last, init);
+}
+
+template <class InputIterator>
+inline typename iterator_traits<InputIterator>::value_type reduce(
+    InputIterator first, InputIterator last) {
+  typedef typename iterator_traits<InputIterator>::value_type T;
+  return ministl::reduce(first, last, T());
+}
+
+template <class InputIterator, class T, class BinaryOperation>
+inline T reduce(InputIterator first, InputIterator last, T init,
+                BinaryOperation op) {
+  return ministl::accumulate(first, last, init, op);
+}
+
+// inclusive_scan: result的第i个元素是前i + 1个元素的和(有init时再加上init),
+// 返回结尾
+template <class InputIterator, class OutputIterator, class BinaryOperation,
+          class T>
+OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                              OutputIterator result, BinaryOperation op,
+                              T init) {
+  for (; first != last; ++first, ++result) {
+    init = op(init, *first);
+    *result = init;
+  }
+  return result;
+}
+
+template <class InputIterator, class OutputIterator, class BinaryOperation>
+OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                              OutputIterator result, BinaryOperation op) {
+  typedef typename iterator_traits<InputIterator>::value_type T;
+  if (first == last) {
+    return result;
+  }
+  T sum = *first;
+  *result = sum;
+  return ministl::inclusive_scan(++first, last, ++result, op, sum);
+}
+
+struct __plus {
+  template <class T, class U>
+  auto operator()(const T& x, const U& y) const -> decltype(x + y) {
+    return x + y;
+  }
+};
+
+template <class InputIterator, class OutputIterator>
+inline OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                                     OutputIterator result) {
+  return ministl::inclusive_scan(first, last, result, __plus());
+}
+
+}  // namespace ministl
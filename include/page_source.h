@@ -0,0 +1,155 @@
+#pragma once
+
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <mutex>
+
+#include "alloc.h"
+
+namespace ministl {
+
+enum { __HUGE_PAGE_SIZE = 2 * 1024 * 1024 };
+
+// 基于mmap的page source, 作为__default_alloc_template的第三个模板参数使用
+// 一次保留ReserveBytes的虚拟地址(PROT_NONE, 不占物理内存), 内存块在保留区中
+// 连续地往后分配, 用到哪里才提交(改为可读写)到哪里; 归还的区间记录下来优先复用
+// huge_pages为true时按2MB对齐保留、按2MB提交: 先尝试MAP_HUGETLB的大页,
+// 系统没有预留大页时退回普通页并用madvise(MADV_HUGEPAGE)请求透明大页
+template <size_t ReserveBytes = (size_t)1 << 30, bool huge_pages = false>
+class mmap_page_source {
+ private:
+  enum { COMMIT_STEP = huge_pages ? __HUGE_PAGE_SIZE : 64 * 1024 };
+  enum { MAX_FREE_RANGES = 64 };
+  struct range {
+    char* begin;
+    size_t size;
+  };
+
+  static std::mutex mutex;
+  static char* reserve_cur;     // 下一个内存块的起始位置
+  static char* reserve_commit;  // 已经提交到的位置
+  static char* reserve_end;
+  static range free_ranges[MAX_FREE_RANGES];
+  static size_t nfree_ranges;
+  static bool hugetlb_failed;  // MAP_HUGETLB失败过一次就不再尝试
+
+  static size_t ROUND_UP(size_t bytes, size_t align) {
+    return (bytes + align - 1) & ~(align - 1);
+  }
+  // 保留一段新的虚拟地址, 上一段剩下的部分不再使用
+  static bool reserve(size_t bytes) {
+    size_t extra = huge_pages ? __HUGE_PAGE_SIZE : 0;
+    char* p = (char*)mmap(0, bytes + extra, PROT_NONE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == (char*)MAP_FAILED) {
+      return false;
+    }
+    // 大页模式下把首尾多出来的部分还掉, 使保留区按2MB对齐
+    char* aligned = (char*)ROUND_UP((size_t)p, extra == 0 ? 1 : extra);
+    if (aligned != p) {
+      munmap(p, aligned - p);
+    }
+    if (extra != (size_t)(aligned - p)) {
+      munmap(aligned + bytes, extra - (aligned - p));
+    }
+    reserve_cur = reserve_commit = aligned;
+    reserve_end = aligned + bytes;
+    return true;
+  }
+  static bool commit(char* p, size_t bytes) {
+#ifdef MAP_HUGETLB
+    if (huge_pages && !hugetlb_failed) {
+      if (mmap(p, bytes, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1,
+               0) != MAP_FAILED) {
+        return true;
+      }
+      hugetlb_failed = true;
+    }
+#endif
+    // 失败的MAP_FIXED可能已经拆掉了原来的保留映射, 此时重新映射这一段
+    if (mprotect(p, bytes, PROT_READ | PROT_WRITE) != 0 &&
+        mmap(p, bytes, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED) {
+      return false;
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge_pages) {
+      madvise(p, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    return true;
+  }
+
+ public:
+  static void* allocate(size_t bytes) {
+    bytes = ROUND_UP(bytes, __PAGE_SIZE);
+    std::lock_guard<std::mutex> guard(mutex);
+    // 先在归还的区间中找第一个够大的
+    for (size_t i = 0; i < nfree_ranges; ++i) {
+      if (free_ranges[i].size >= bytes) {
+        char* result = free_ranges[i].begin;
+        free_ranges[i].begin += bytes;
+        free_ranges[i].size -= bytes;
+        if (free_ranges[i].size == 0) {
+          free_ranges[i] = free_ranges[--nfree_ranges];
+        }
+        return result;
+      }
+    }
+    if ((size_t)(reserve_end - reserve_cur) < bytes) {
+      size_t reserve_bytes = ROUND_UP(bytes, COMMIT_STEP);
+      if (reserve_bytes < ReserveBytes) {
+        reserve_bytes = ROUND_UP(ReserveBytes, COMMIT_STEP);
+      }
+      if (!reserve(reserve_bytes)) {
+        return 0;
+      }
+    }
+    char* result = reserve_cur;
+    if (reserve_cur + bytes > reserve_commit) {
+      size_t step = ROUND_UP(reserve_cur + bytes - reserve_commit, COMMIT_STEP);
+      if (!commit(reserve_commit, step)) {
+        return 0;
+      }
+      reserve_commit += step;
+    }
+    reserve_cur += bytes;
+    return result;
+  }
+  // 物理页立即还给系统, 地址区间留待复用; 记录满了就只归还物理页
+  static void deallocate(void* p, size_t bytes) {
+    bytes = ROUND_UP(bytes, __PAGE_SIZE);
+    decommit(p, bytes);
+    std::lock_guard<std::mutex> guard(mutex);
+    if (nfree_ranges < MAX_FREE_RANGES) {
+      range r = {(char*)p, bytes};
+      free_ranges[nfree_ranges++] = r;
+    }
+  }
+  static void decommit(void* p, size_t bytes) {
+    madvise(p, bytes, MADV_DONTNEED);
+  }
+};
+
+template <size_t ReserveBytes, bool huge_pages>
+std::mutex mmap_page_source<ReserveBytes, huge_pages>::mutex;
+template <size_t ReserveBytes, bool huge_pages>
+char* mmap_page_source<ReserveBytes, huge_pages>::reserve_cur = 0;
+template <size_t ReserveBytes, bool huge_pages>
+char* mmap_page_source<ReserveBytes, huge_pages>::reserve_commit = 0;
+template <size_t ReserveBytes, bool huge_pages>
+char* mmap_page_source<ReserveBytes, huge_pages>::reserve_end = 0;
+template <size_t ReserveBytes, bool huge_pages>
+typename mmap_page_source<ReserveBytes, huge_pages>::range
+    mmap_page_source<ReserveBytes, huge_pages>::free_ranges[MAX_FREE_RANGES];
+template <size_t ReserveBytes, bool huge_pages>
+size_t mmap_page_source<ReserveBytes, huge_pages>::nfree_ranges = 0;
+template <size_t ReserveBytes, bool huge_pages>
+bool mmap_page_source<ReserveBytes, huge_pages>::hugetlb_failed = false;
+
+// 使用大页的配置
+typedef mmap_page_source<(size_t)1 << 30, true> huge_page_source;
+
+}  // namespace ministl
@@ -0,0 +1,558 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "algo.h"
+#include "algobase.h"
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "numeric.h"
+#include "thread_pool.h"
+#include "type_traits.h"
+
+namespace ministl {
+
+// 并行算法: for_each, transform, copy, reduce, inclusive_scan, sort
+// 第一个参数是执行策略, 其余与顺序版本相同
+// 策略是par或par_unseq, 所有迭代器都能随机访问, 元素足够多时, 把区间分成若干块
+// 交给thread_pool.h中的线程池; 否则直接调用顺序版本
+// 元素操作抛出的异常在所有块结束后重新抛出(只保留第一个)
+
+namespace execution {
+
+struct sequenced_policy {};
+struct parallel_policy {};
+struct parallel_unsequenced_policy {};
+
+constexpr sequenced_policy seq{};
+constexpr parallel_policy par{};
+constexpr parallel_unsequenced_policy par_unseq{};
+
+}  // namespace execution
+
+template <class T>
+struct is_execution_policy : std::false_type {};
+template <>
+struct is_execution_policy<execution::sequenced_policy> : std::true_type {};
+template <>
+struct is_execution_policy<execution::parallel_policy> : std::true_type {};
+template <>
+struct is_execution_policy<execution::parallel_unsequenced_policy>
+    : std::true_type {};
+
+// 第一个参数不是执行策略时不参与重载, 避免与顺序版本冲突
+template <class ExecutionPolicy, class T>
+using __enable_if_execution_policy = typename std::enable_if<
+    is_execution_policy<typename std::decay<ExecutionPolicy>::type>::value,
+    T>::type;
+
+template <class... Iterators>
+struct __all_random_access : std::true_type {};
+template <class Iterator, class... Rest>
+struct __all_random_access<Iterator, Rest...>
+    : std::integral_constant<bool, __is_random_access<Iterator>::value &&
+                                       __all_random_access<Rest...>::value> {};
+
+template <class ExecutionPolicy, class... Iterators>
+struct __use_parallel {
+  typedef typename std::conditional<
+      !std::is_same<typename std::decay<ExecutionPolicy>::type,
+                    execution::sequenced_policy>::value &&
+          __all_random_access<Iterators...>::value,
+      _true_type, _false_type>::type type;
+};
+
+enum {
+  __PARALLEL_GRAIN = 16384,       // 每块至少这么多元素, 不够两块时顺序执行
+  __PARALLEL_SORT_GRAIN = 32768,  // 并行排序划分到这么小就顺序排序
+  __PARALLEL_CHUNKS_PER_THREAD = 4
+};
+
+// 块数: 每块不少于grain个元素, 不超过线程数的4倍, 快的线程可以多做几块
+inline size_t __parallel_chunks(size_t n, size_t grain) {
+  size_t threads = __thread_pool::instance().size() + 1;
+  if (threads == 1 || n < 2 * grain) {
+    return 1;
+  }
+  size_t chunks = n / grain;
+  size_t limit = threads * __PARALLEL_CHUNKS_PER_THREAD;
+  return chunks < limit ? chunks : limit;
+}
+
+// 第i块的开头, 前n % chunks块各多一个元素
+inline size_t __chunk_begin(size_t n, size_t chunks, size_t i) {
+  size_t r = n % chunks;
+  return n / chunks * i + (i < r ? i : r);
+}
+
+// 分块并行执行f(b, e), [b, e)是块的下标范围
+template <class Function>
+void __parallel_chunked(size_t n, size_t chunks, Function& f) {
+  auto body = [&](size_t i) {
+    f(__chunk_begin(n, chunks, i), __chunk_begin(n, chunks, i + 1));
+  };
+  __parallel_for(chunks, body);
+}
+
+// 各块的中间结果, 只析构已经构造的
+template <class T>
+class __parallel_results {
+ public:
+  explicit __parallel_results(size_t n)
+      : n(n),
+        data(simple_alloc<T, __pool_alloc>::allocate(n)),
+        built(simple_alloc<char, __pool_alloc>::allocate(n)) {
+    memset(built, 0, n);
+  }
+
+  ~__parallel_results() {
+    for (size_t i = 0; i < n; ++i) {
+      if (built[i]) {
+        destroy(data + i);
+      }
+    }
+    simple_alloc<T, __pool_alloc>::deallocate(data, n);
+    simple_alloc<char, __pool_alloc>::deallocate(built, n);
+  }
+
+  template <class U>
+  void set(size_t i, U&& x) {
+    construct(data + i, std::forward<U>(x));
+    built[i] = 1;
+  }
+
+  T& operator[](size_t i) { return data[i]; }
+
+ private:
+  __parallel_results(const __parallel_results&) = delete;
+  __parallel_results& operator=(const __parallel_results&) = delete;
+
+  size_t n;
+  T* data;
+  char* built;
+};
+
+// for_each
+template <class RandomAccessIterator, class Function>
+void __parallel_for_each(RandomAccessIterator first, RandomAccessIterator last,
+                         Function& f, _true_type) {
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  size_t n = ministl::distance(first, last);
+  auto body = [&](size_t b, size_t e) {
+    ministl::for_each(ministl::next(first, Distance(b)),
+                      ministl::next(first, Distance(e)), std::ref(f));
+  };
+  __parallel_chunked(n, __parallel_chunks(n, __PARALLEL_GRAIN), body);
+}
+
+template <class InputIterator, class Function>
+inline void __parallel_for_each(InputIterator first, InputIterator last,
+                                Function& f, _false_type) {
+  ministl::for_each(first, last, std::ref(f));
+}
+
+// f会被多个线程同时调用
+template <class ExecutionPolicy, class ForwardIterator, class Function>
+inline __enable_if_execution_policy<ExecutionPolicy, void> for_each(
+    ExecutionPolicy&&, ForwardIterator first, ForwardIterator last,
+    Function f) {
+  __parallel_for_each(
+      first, last, f,
+      typename __use_parallel<ExecutionPolicy, ForwardIterator>::type());
+}
+
+// transform
+template <class RandomAccessIterator1, class RandomAccessIterator2,
+          class UnaryOperation>
+RandomAccessIterator2 __parallel_transform(RandomAccessIterator1 first,
+                                           RandomAccessIterator1 last,
+                                           RandomAccessIterator2 result,
+                                           UnaryOperation& op, _true_type) {
+  typedef typename iterator_traits<RandomAccessIterator1>::difference_type
+      Distance1;
+  typedef typename iterator_traits<RandomAccessIterator2>::difference_type
+      Distance2;
+  size_t n = ministl::distance(first, last);
+  auto body = [&](size_t b, size_t e) {
+    ministl::transform(ministl::next(first, Distance1(b)),
+                       ministl::next(first, Distance1(e)),
+                       ministl::next(result, Distance2(b)), op);
+  };
+  __parallel_chunked(n, __parallel_chunks(n, __PARALLEL_GRAIN), body);
+  return ministl::next(result, Distance2(n));
+}
+
+template <class InputIterator, class OutputIterator, class UnaryOperation>
+inline OutputIterator __parallel_transform(InputIterator first,
+                                           InputIterator last,
+                                           OutputIterator result,
+                                           UnaryOperation& op, _false_type) {
+  return ministl::transform(first, last, result, op);
+}
+
+template <class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2,
+          class UnaryOperation>
+inline __enable_if_execution_policy<ExecutionPolicy, ForwardIterator2>
+transform(ExecutionPolicy&&, ForwardIterator1 first, ForwardIterator1 last,
+          ForwardIterator2 result, UnaryOperation op) {
+  return __parallel_transform(
+      first, last, result, op,
+      typename __use_parallel<ExecutionPolicy, ForwardIterator1,
+                              ForwardIterator2>::type());
+}
+
+template <class RandomAccessIterator1, class RandomAccessIterator2,
+          class RandomAccessIterator3, class BinaryOperation>
+RandomAccessIterator3 __parallel_transform(
+    RandomAccessIterator1 first1, RandomAccessIterator1 last1,
+    RandomAccessIterator2 first2, RandomAccessIterator3 result,
+    BinaryOperation& op, _true_type) {
+  typedef typename iterator_traits<RandomAccessIterator1>::difference_type
+      Distance1;
+  typedef typename iterator_traits<RandomAccessIterator2>::difference_type
+      Distance2;
+  typedef typename iterator_traits<RandomAccessIterator3>::difference_type
+      Distance3;
+  size_t n = ministl::distance(first1, last1);
+  auto body = [&](size_t b, size_t e) {
+    ministl::transform(ministl::next(first1, Distance1(b)),
+                       ministl::next(first1, Distance1(e)),
+                       ministl::next(first2, Distance2(b)),
+                       ministl::next(result, Distance3(b)), op);
+  };
+  __parallel_chunked(n, __parallel_chunks(n, __PARALLEL_GRAIN), body);
+  return ministl::next(result, Distance3(n));
+}
+
+template <class InputIterator1, class InputIterator2, class OutputIterator,
+          class BinaryOperation>
+inline OutputIterator __parallel_transform(InputIterator1 first1,
+                                           InputIterator1 last1,
+                                           InputIterator2 first2,
+                                           OutputIterator result,
+                                           BinaryOperation& op, _false_type) {
+  return ministl::transform(first1, last1, first2, result, op);
+}
+
+template <class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2,
+          class ForwardIterator3, class BinaryOperation>
+inline __enable_if_execution_policy<ExecutionPolicy, ForwardIterator3>
+transform(ExecutionPolicy&&, ForwardIterator1 first1, ForwardIterator1 last1,
+          ForwardIterator2 first2, ForwardIterator3 result,
+          BinaryOperation op) {
+  return __parallel_transform(
+      first1, last1, first2, result, op,
+      typename __use_parallel<ExecutionPolicy, ForwardIterator1,
+                              ForwardIterator2, ForwardIterator3>::type());
+}
+
+// copy: 每块仍然由ministl::copy处理, POD类型是memmove
+template <class RandomAccessIterator1, class RandomAccessIterator2>
+RandomAccessIterator2 __parallel_copy(RandomAccessIterator1 first,
+                                      RandomAccessIterator1 last,
+                                      RandomAccessIterator2 result,
+                                      _true_type) {
+  typedef typename iterator_traits<RandomAccessIterator1>::difference_type
+      Distance1;
+  typedef typename iterator_traits<RandomAccessIterator2>::difference_type
+      Distance2;
+  size_t n = ministl::distance(first, last);
+  auto body = [&](size_t b, size_t e) {
+    ministl::copy(ministl::next(first, Distance1(b)),
+                  ministl::next(first, Distance1(e)),
+                  ministl::next(result, Distance2(b)));
+  };
+  __parallel_chunked(n, __parallel_chunks(n, __PARALLEL_GRAIN), body);
+  return ministl::next(result, Distance2(n));
+}
+
+template <class InputIterator, class OutputIterator>
+inline OutputIterator __parallel_copy(InputIterator first, InputIterator last,
+                                      OutputIterator result, _false_type) {
+  return ministl::copy(first, last, result);
+}
+
+template <class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2>
+inline __enable_if_execution_policy<ExecutionPolicy, ForwardIterator2> copy(
+    ExecutionPolicy&&, ForwardIterator1 first, ForwardIterator1 last,
+    ForwardIterator2 result) {
+  return __parallel_copy(first, last, result,
+                         typename __use_parallel<ExecutionPolicy,
+                                                 ForwardIterator1,
+                                                 ForwardIterator2>::type());
+}
+
+// reduce: 各块分别归约, 再按块的顺序合并; 默认的加法在每块内部用向量化的reduce
+template <class InputIterator, class T, class BinaryOperation>
+inline T __reduce_chunk(InputIterator first, InputIterator last, T init,
+                        BinaryOperation& op) {
+  return ministl::accumulate(first, last, init, op);
+}
+
+template <class InputIterator, class T>
+inline T __reduce_chunk(InputIterator first, InputIterator last, T init,
+                        __plus&) {
+  return ministl::reduce(first, last, init);
+}
+
+template <class RandomAccessIterator, class T, class BinaryOperation>
+T __parallel_reduce(RandomAccessIterator first, RandomAccessIterator last,
+                    T init, BinaryOperation& op, _true_type) {
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  size_t n = ministl::distance(first, last);
+  size_t chunks = __parallel_chunks(n, __PARALLEL_GRAIN);
+  if (chunks == 1) {
+    return __reduce_chunk(first, last, init, op);
+  }
+  __parallel_results<T> partial(chunks);
+  auto body = [&](size_t i) {
+    RandomAccessIterator b =
+        ministl::next(first, Distance(__chunk_begin(n, chunks, i)));
+    RandomAccessIterator e =
+        ministl::next(first, Distance(__chunk_begin(n, chunks, i + 1)));
+    partial.set(i, __reduce_chunk(b + 1, e, T(*b), op));
+  };
+  __parallel_for(chunks, body);
+  for (size_t i = 0; i < chunks; ++i) {
+    init = op(init, partial[i]);
+  }
+  return init;
+}
+
+template <class InputIterator, class T, class BinaryOperation>
+inline T __parallel_reduce(InputIterator first, InputIterator last, T init,
+                           BinaryOperation& op, _false_type) {
+  return __reduce_chunk(first, last, init, op);
+}
+
+// op要满足结合律和交换律
+template <class ExecutionPolicy, class ForwardIterator, class T,
+          class BinaryOperation>
+inline __enable_if_execution_policy<ExecutionPolicy, T> reduce(
+    ExecutionPolicy&&, ForwardIterator first, ForwardIterator last, T init,
+    BinaryOperation op) {
+  return __parallel_reduce(
+      first, last, init, op,
+      typename __use_parallel<ExecutionPolicy, ForwardIterator>::type());
+}
+
+template <class ExecutionPolicy, class ForwardIterator, class T>
+inline __enable_if_execution_policy<ExecutionPolicy, T> reduce(
+    ExecutionPolicy&&, ForwardIterator first, ForwardIterator last, T init) {
+  __plus op;
+  return __parallel_reduce(
+      first, last, init, op,
+      typename __use_parallel<ExecutionPolicy, ForwardIterator>::type());
+}
+
+template <class ExecutionPolicy, class ForwardIterator>
+inline __enable_if_execution_policy<
+    ExecutionPolicy, typename iterator_traits<ForwardIterator>::value_type>
+reduce(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last) {
+  typedef typename iterator_traits<ForwardIterator>::value_type T;
+  return ministl::reduce(std::forward<ExecutionPolicy>(policy), first, last,
+                         T());
+}
+
+// inclusive_scan: 第一遍并行求出每块的和, 顺序求出每块之前的前缀,
+// 第二遍各块从自己的前缀开始扫描; init为空时没有初值
+template <class RandomAccessIterator1, class RandomAccessIterator2,
+          class BinaryOperation, class T>
+RandomAccessIterator2 __parallel_inclusive_scan(RandomAccessIterator1 first,
+                                                RandomAccessIterator1 last,
+                                                RandomAccessIterator2 result,
+                                                BinaryOperation& op,
+                                                const T* init) {
+  typedef typename iterator_traits<RandomAccessIterator1>::difference_type
+      Distance1;
+  typedef typename iterator_traits<RandomAccessIterator2>::difference_type
+      Distance2;
+  size_t n = ministl::distance(first, last);
+  size_t chunks = __parallel_chunks(n, __PARALLEL_GRAIN);
+  if (chunks == 1) {
+    return init != nullptr
+               ? ministl::inclusive_scan(first, last, result, op, *init)
+               : ministl::inclusive_scan(first, last, result, op);
+  }
+  // 最后一块的和用不到
+  __parallel_results<T> partial(chunks - 1);
+  auto sum = [&](size_t i) {
+    RandomAccessIterator1 b =
+        ministl::next(first, Distance1(__chunk_begin(n, chunks, i)));
+    RandomAccessIterator1 e =
+        ministl::next(first, Distance1(__chunk_begin(n, chunks, i + 1)));
+    partial.set(i, ministl::accumulate(b + 1, e, T(*b), op));
+  };
+  __parallel_for(chunks - 1, sum);
+  // prefix[i]是第i块之前所有元素(和init)的和
+  __parallel_results<T> prefix(chunks);
+  if (init != nullptr) {
+    prefix.set(0, *init);
+    prefix.set(1, op(*init, partial[0]));
+  } else {
+    prefix.set(1, partial[0]);
+  }
+  for (size_t i = 2; i < chunks; ++i) {
+    prefix.set(i, op(prefix[i - 1], partial[i - 1]));
+  }
+  auto scan = [&](size_t i) {
+    size_t b = __chunk_begin(n, chunks, i);
+    size_t e = __chunk_begin(n, chunks, i + 1);
+    if (i == 0 && init == nullptr) {
+      ministl::inclusive_scan(first, ministl::next(first, Distance1(e)), result,
+                              op);
+    } else {
+      ministl::inclusive_scan(ministl::next(first, Distance1(b)),
+                              ministl::next(first, Distance1(e)),
+                              ministl::next(result, Distance2(b)), op,
+                              prefix[i]);
+    }
+  };
+  __parallel_for(chunks, scan);
+  return ministl::next(result, Distance2(n));
+}
+
+template <class RandomAccessIterator1, class RandomAccessIterator2,
+          class BinaryOperation, class T>
+inline RandomAccessIterator2 __parallel_inclusive_scan(
+    RandomAccessIterator1 first, RandomAccessIterator1 last,
+    RandomAccessIterator2 result, BinaryOperation& op, const T* init,
+    _true_type) {
+  return __parallel_inclusive_scan(first, last, result, op, init);
+}
+
+template <class InputIterator, class OutputIterator, class BinaryOperation,
+          class T>
+inline OutputIterator __parallel_inclusive_scan(InputIterator first,
+                                                InputIterator last,
+                                                OutputIterator result,
+                                                BinaryOperation& op,
+                                                const T* init, _false_type) {
+  return init != nullptr
+             ? ministl::inclusive_scan(first, last, result, op, *init)
+             : ministl::inclusive_scan(first, last, result, op);
+}
+
+// op要满足结合律
+template <class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2,
+          class BinaryOperation, class T>
+inline __enable_if_execution_policy<ExecutionPolicy, ForwardIterator2>
+inclusive_scan(ExecutionPolicy&&, ForwardIterator1 first,
+               ForwardIterator1 last, ForwardIterator2 result,
+               BinaryOperation op, T init) {
+  return __parallel_inclusive_scan(
+      first, last, result, op, &init,
+      typename __use_parallel<ExecutionPolicy, ForwardIterator1,
+                              ForwardIterator2>::type());
+}
+
+template <class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2,
+          class BinaryOperation>
+inline __enable_if_execution_policy<ExecutionPolicy, ForwardIterator2>
+inclusive_scan(ExecutionPolicy&&, ForwardIterator1 first,
+               ForwardIterator1 last, ForwardIterator2 result,
+               BinaryOperation op) {
+  typedef typename iterator_traits<ForwardIterator1>::value_type T;
+  return __parallel_inclusive_scan(
+      first, last, result, op, (const T*)nullptr,
+      typename __use_parallel<ExecutionPolicy, ForwardIterator1,
+                              ForwardIterator2>::type());
+}
+
+template <class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2>
+inline __enable_if_execution_policy<ExecutionPolicy, ForwardIterator2>
+inclusive_scan(ExecutionPolicy&& policy, ForwardIterator1 first,
+               ForwardIterator1 last, ForwardIterator2 result) {
+  return ministl::inclusive_scan(std::forward<ExecutionPolicy>(policy), first,
+                                 last, result, __plus());
+}
+
+// sort: 与pdqsort相同的枢轴选择和划分, 两边并行递归, 小区间和递归过深时顺序排序
+// 默认比较时叶子仍然可以用基数排序
+template <class RandomAccessIterator>
+inline void __parallel_sort_leaf(RandomAccessIterator first,
+                                 RandomAccessIterator last, __less&) {
+  ministl::sort(first, last);
+}
+
+template <class RandomAccessIterator, class Compare>
+inline void __parallel_sort_leaf(RandomAccessIterator first,
+                                 RandomAccessIterator last, Compare& comp) {
+  ministl::sort(first, last, comp);
+}
+
+template <class RandomAccessIterator, class Compare>
+void __parallel_sort_loop(RandomAccessIterator first, RandomAccessIterator last,
+                          Compare& comp, int depth, bool leftmost) {
+  typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+  typedef typename iterator_traits<RandomAccessIterator>::difference_type
+      Distance;
+  if (last - first <= (Distance)__PARALLEL_SORT_GRAIN || depth == 0) {
+    __parallel_sort_leaf(first, last, comp);
+    return;
+  }
+  ministl::__choose_pivot(first, last, comp);
+  // *(first - 1)是上一层的枢轴, 与它相等的元素都划到左边, 左边不用再排
+  if (!leftmost && !comp(*(first - 1), *first)) {
+    first = ministl::__partition_left(first, last, comp) + 1;
+    __parallel_sort_loop(first, last, comp, depth - 1, false);
+    return;
+  }
+  RandomAccessIterator pivot =
+      ministl::__partition_right_aux(
+          first, last, comp, typename __pdq_branchless<T, Compare>::type())
+          .first;
+  auto left = [&] {
+    __parallel_sort_loop(first, pivot, comp, depth - 1, leftmost);
+  };
+  auto right = [&] {
+    __parallel_sort_loop(pivot + 1, last, comp, depth - 1, false);
+  };
+  __parallel_invoke(left, right);
+}
+
+template <class RandomAccessIterator, class Compare>
+inline void __parallel_sort(RandomAccessIterator first,
+                            RandomAccessIterator last, Compare& comp,
+                            _true_type) {
+  if (__thread_pool::instance().size() == 0) {
+    __parallel_sort_leaf(first, last, comp);
+    return;
+  }
+  __parallel_sort_loop(first, last, comp, 2 * ministl::__lg(last - first),
+                       true);
+}
+
+template <class RandomAccessIterator, class Compare>
+inline void __parallel_sort(RandomAccessIterator first,
+                            RandomAccessIterator last, Compare& comp,
+                            _false_type) {
+  __parallel_sort_leaf(first, last, comp);
+}
+
+template <class ExecutionPolicy, class RandomAccessIterator, class Compare>
+inline __enable_if_execution_policy<ExecutionPolicy, void> sort(
+    ExecutionPolicy&&, RandomAccessIterator first, RandomAccessIterator last,
+    Compare comp) {
+  __parallel_sort(
+      first, last, comp,
+      typename __use_parallel<ExecutionPolicy, RandomAccessIterator>::type());
+}
+
+template <class ExecutionPolicy, class RandomAccessIterator>
+inline __enable_if_execution_policy<ExecutionPolicy, void> sort(
+    ExecutionPolicy&&, RandomAccessIterator first, RandomAccessIterator last) {
+  __less comp;
+  __parallel_sort(
+      first, last, comp,
+      typename __use_parallel<ExecutionPolicy, RandomAccessIterator>::type());
+}
+
+}  // namespace ministl
@@ -0,0 +1,622 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "type_traits.h"
+
+// x86上用GCC/Clang的target属性为SSE2和AVX2各编译一份核心循环, 运行时按CPU选择
+// 其他平台和编译器只有标量版本
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) && \
+    (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define MINISTL_SIMD_X86 1
+#else
+#define MINISTL_SIMD_X86 0
+#endif
+
+namespace ministl {
+
+// 原生指针上的POD算术类型的向量化算法:
+// find, count, equal, fill, min_element, max_element, reduce
+// algobase.h和numeric.h中的同名算法在原生指针上遇到这些类型时调用这里的__simd_*,
+// 容器的成员函数和比较运算符也就自动用上了
+// 结果与逐个比较的版本完全相同: 浮点数按==比较(-0.0等于0.0, NaN不等于任何数),
+// min_element/max_element遇到NaN时退回标量版本; 只有reduce会改变浮点加法的顺序
+
+enum { SIMD_SCALAR = 0, SIMD_SSE2 = 1, SIMD_AVX2 = 2 };
+
+inline int __simd_detect() {
+#if MINISTL_SIMD_X86
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") ? SIMD_AVX2 : SIMD_SSE2;
+#else
+  return SIMD_SCALAR;
+#endif
+}
+
+// CPU支持的最高级别
+inline int simd_supported_level() {
+  static const int level = __simd_detect();
+  return level;
+}
+
+inline std::atomic<int>& __simd_level() {
+  static std::atomic<int> level(simd_supported_level());
+  return level;
+}
+
+// 当前使用的级别
+inline int simd_level() {
+  return __simd_level().load(std::memory_order_relaxed);
+}
+
+// 限制使用的级别(测试和基准测试用), 不会超过CPU支持的级别, 返回实际的级别
+inline int simd_set_level(int level) {
+  if (level > simd_supported_level()) {
+    level = simd_supported_level();
+  }
+  if (level < SIMD_SCALAR) {
+    level = SIMD_SCALAR;
+  }
+  __simd_level().store(level, std::memory_order_relaxed);
+  return level;
+}
+
+// 可以向量化的类型: is_POD_type的整数, float和double
+template <class T>
+struct __simd_eligible {
+  typedef typename std::remove_cv<T>::type U;
+  typedef typename std::conditional<
+      std::is_same<typename type_traits<U>::is_POD_type, _true_type>::value &&
+          ((std::is_integral<U>::value && sizeof(U) <= 8) ||
+           std::is_same<U, float>::value || std::is_same<U, double>::value),
+      _true_type, _false_type>::type type;
+};
+
+template <class T>
+inline bool __simd_is_nan(T) {
+  return false;
+}
+inline bool __simd_is_nan(float x) { return x != x; }
+inline bool __simd_is_nan(double x) { return x != x; }
+
+// 标量版本, 也用来处理向量循环剩下的尾部
+namespace __simd_scalar {
+
+template <class T>
+inline const T* find(const T* first, const T* last, T value) {
+  for (; first != last; ++first) {
+    if (*first == value) {
+      return first;
+    }
+  }
+  return last;
+}
+
+template <class T>
+inline size_t count(const T* first, const T* last, T value) {
+  size_t n = 0;
+  for (; first != last; ++first) {
+    n += *first == value;
+  }
+  return n;
+}
+
+template <class T>
+inline bool equal(const T* first1, const T* last1, const T* first2) {
+  for (; first1 != last1; ++first1, ++first2) {
+    if (!(*first1 == *first2)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class T>
+inline void fill(T* first, T* last, T value) {
+  for (; first != last; ++first) {
+    *first = value;
+  }
+}
+
+// Max为true时是max_element, 都返回第一个最小(最大)的位置
+template <bool Max, class T>
+inline const T* minmax_element(const T* first, const T* last) {
+  if (first == last) {
+    return last;
+  }
+  const T* result = first;
+  while (++first != last) {
+    if (Max ? *result < *first : *first < *result) {
+      result = first;
+    }
+  }
+  return result;
+}
+
+template <class T>
+inline T reduce(const T* first, const T* last, T init) {
+  for (; first != last; ++first) {
+    init = static_cast<T>(init + *first);
+  }
+  return init;
+}
+
+}  // namespace __simd_scalar
+
+#if MINISTL_SIMD_X86
+
+#define MINISTL_SIMD_SSE2_INLINE __attribute__((always_inline))
+#define MINISTL_SIMD_AVX2_INLINE __attribute__((always_inline, target("avx2")))
+
+// 寄存器操作, 按元素大小和种类分别特化. 比较的结果是每个元素全1或全0的掩码,
+// mask取每个字节的最高位, 元素i匹配时第i * sizeof(T)位起的sizeof(T)位都是1
+// 数据在寄存器中一律是整数类型, 浮点数的操作先转换类型
+
+struct __sse2_base {
+  typedef __m128i reg;
+  enum { WIDTH = 16 };
+  static const unsigned FULL_MASK = 0xffffu;
+  MINISTL_SIMD_SSE2_INLINE static reg load(const void* p) {
+    return _mm_loadu_si128((const __m128i*)p);
+  }
+  MINISTL_SIMD_SSE2_INLINE static void store(void* p, reg x) {
+    _mm_storeu_si128((__m128i*)p, x);
+  }
+  MINISTL_SIMD_SSE2_INLINE static unsigned mask(reg x) {
+    return (unsigned)_mm_movemask_epi8(x);
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg zero() { return _mm_setzero_si128(); }
+  MINISTL_SIMD_SSE2_INLINE static reg or_(reg a, reg b) {
+    return _mm_or_si128(a, b);
+  }
+  // m为1的位取a, 否则取b
+  MINISTL_SIMD_SSE2_INLINE static reg select(reg m, reg a, reg b) {
+    return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+  }
+  // 整数没有NaN
+  MINISTL_SIMD_SSE2_INLINE static reg unord(reg) { return _mm_setzero_si128(); }
+  // 按字节减, 比较结果全1的字节就是加1
+  MINISTL_SIMD_SSE2_INLINE static reg sub_bytes(reg a, reg b) {
+    return _mm_sub_epi8(a, b);
+  }
+  MINISTL_SIMD_SSE2_INLINE static size_t sum_bytes(reg x) {
+    uint64_t sum[2];
+    _mm_storeu_si128((__m128i*)sum, _mm_sad_epu8(x, _mm_setzero_si128()));
+    return (size_t)(sum[0] + sum[1]);
+  }
+};
+
+template <size_t Size, bool Signed>
+struct __sse2_int;
+
+template <bool Signed>
+struct __sse2_int<1, Signed> : __sse2_base {
+  template <class T>
+  MINISTL_SIMD_SSE2_INLINE static reg splat(T x) {
+    uint8_t b;
+    memcpy(&b, &x, 1);
+    return _mm_set1_epi8((char)b);
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg eq(reg a, reg b) {
+    return _mm_cmpeq_epi8(a, b);
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg add(reg a, reg b) {
+    return _mm_add_epi8(a, b);
+  }
+  // 无符号数翻转最高位后按有符号数比较
+  MINISTL_SIMD_SSE2_INLINE static reg lt(reg a, reg b) {
+    if (!Signed) {
+      const reg bias = _mm_set1_epi8((char)0x80);
+      a = _mm_xor_si128(a, bias);
+      b = _mm_xor_si128(b, bias);
+    }
+    return _mm_cmplt_epi8(a, b);
+  }
+};
+
+template <bool Signed>
+struct __sse2_int<2, Signed> : __sse2_base {
+  template <class T>
+  MINISTL_SIMD_SSE2_INLINE static reg splat(T x) {
+    uint16_t b;
+    memcpy(&b, &x, 2);
+    return _mm_set1_epi16((short)b);
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg eq(reg a, reg b) {
+    return _mm_cmpeq_epi16(a, b);
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg add(reg a, reg b) {
+    return _mm_add_epi16(a, b);
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg lt(reg a, reg b) {
+    if (!Signed) {
+      const reg bias = _mm_set1_epi16((short)0x8000);
+      a = _mm_xor_si128(a, bias);
+      b = _mm_xor_si128(b, bias);
+    }
+    return _mm_cmplt_epi16(a, b);
+  }
+};
+
+template <bool Signed>
+struct __sse2_int<4, Signed> : __sse2_base {
+  template <class T>
+  MINISTL_SIMD_SSE2_INLINE static reg splat(T x) {
+    uint32_t b;
+    memcpy(&b, &x, 4);
+    return _mm_set1_epi32((int)b);
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg eq(reg a, reg b) {
+    return _mm_cmpeq_epi32(a, b);
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg add(reg a, reg b) {
+    return _mm_add_epi32(a, b);
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg lt(reg a, reg b) {
+    if (!Signed) {
+      const reg bias = _mm_set1_epi32((int)0x80000000u);
+      a = _mm_xor_si128(a, bias);
+      b = _mm_xor_si128(b, bias);
+    }
+    return _mm_cmplt_epi32(a, b);
+  }
+};
+
+// SSE2没有64位整数的比较, 用32位的比较拼出来
+template <bool Signed>
+struct __sse2_int<8, Signed> : __sse2_base {
+  template <class T>
+  MINISTL_SIMD_SSE2_INLINE static reg splat(T x) {
+    uint64_t b;
+    memcpy(&b, &x, 8);
+    return _mm_set1_epi64x((long long)b);
+  }
+  // 高低两半都相等
+  MINISTL_SIMD_SSE2_INLINE static reg eq(reg a, reg b) {
+    reg c = _mm_cmpeq_epi32(a, b);
+    return _mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1)));
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg add(reg a, reg b) {
+    return _mm_add_epi64(a, b);
+  }
+  // 高半有符号比较小于, 或者高半相等且低半无符号比较小于
+  MINISTL_SIMD_SSE2_INLINE static reg lt(reg a, reg b) {
+    if (!Signed) {
+      const reg bias = _mm_set1_epi64x((long long)0x8000000000000000ull);
+      a = _mm_xor_si128(a, bias);
+      b = _mm_xor_si128(b, bias);
+    }
+    const reg low_bias = _mm_set1_epi32((int)0x80000000u);
+    reg hi_lt = _mm_cmpgt_epi32(b, a);
+    reg hi_eq = _mm_cmpeq_epi32(a, b);
+    reg lo_lt = _mm_cmpgt_epi32(_mm_xor_si128(b, low_bias),
+                                _mm_xor_si128(a, low_bias));
+    reg r = _mm_or_si128(
+        hi_lt,
+        _mm_and_si128(hi_eq, _mm_shuffle_epi32(lo_lt, _MM_SHUFFLE(2, 2, 0, 0))));
+    return _mm_shuffle_epi32(r, _MM_SHUFFLE(3, 3, 1, 1));
+  }
+};
+
+template <size_t Size>
+struct __sse2_float;
+
+template <>
+struct __sse2_float<4> : __sse2_int<4, true> {
+  MINISTL_SIMD_SSE2_INLINE static reg eq(reg a, reg b) {
+    return _mm_castps_si128(
+        _mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg add(reg a, reg b) {
+    return _mm_castps_si128(
+        _mm_add_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg lt(reg a, reg b) {
+    return _mm_castps_si128(
+        _mm_cmplt_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg unord(reg a) {
+    return _mm_castps_si128(
+        _mm_cmpunord_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(a)));
+  }
+};
+
+template <>
+struct __sse2_float<8> : __sse2_int<8, true> {
+  MINISTL_SIMD_SSE2_INLINE static reg eq(reg a, reg b) {
+    return _mm_castpd_si128(
+        _mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg add(reg a, reg b) {
+    return _mm_castpd_si128(
+        _mm_add_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg lt(reg a, reg b) {
+    return _mm_castpd_si128(
+        _mm_cmplt_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+  }
+  MINISTL_SIMD_SSE2_INLINE static reg unord(reg a) {
+    return _mm_castpd_si128(
+        _mm_cmpunord_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(a)));
+  }
+};
+
+// AVX2: 结构与上面相同, 寄存器宽32字节
+struct __avx2_base {
+  typedef __m256i reg;
+  enum { WIDTH = 32 };
+  static const unsigned FULL_MASK = 0xffffffffu;
+  MINISTL_SIMD_AVX2_INLINE static reg load(const void* p) {
+    return _mm256_loadu_si256((const __m256i*)p);
+  }
+  MINISTL_SIMD_AVX2_INLINE static void store(void* p, reg x) {
+    _mm256_storeu_si256((__m256i*)p, x);
+  }
+  MINISTL_SIMD_AVX2_INLINE static unsigned mask(reg x) {
+    return (unsigned)_mm256_movemask_epi8(x);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg zero() { return _mm256_setzero_si256(); }
+  MINISTL_SIMD_AVX2_INLINE static reg or_(reg a, reg b) {
+    return _mm256_or_si256(a, b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg select(reg m, reg a, reg b) {
+    return _mm256_blendv_epi8(b, a, m);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg unord(reg) {
+    return _mm256_setzero_si256();
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg sub_bytes(reg a, reg b) {
+    return _mm256_sub_epi8(a, b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static size_t sum_bytes(reg x) {
+    uint64_t sum[4];
+    _mm256_storeu_si256((__m256i*)sum,
+                        _mm256_sad_epu8(x, _mm256_setzero_si256()));
+    return (size_t)(sum[0] + sum[1] + sum[2] + sum[3]);
+  }
+};
+
+template <size_t Size, bool Signed>
+struct __avx2_int;
+
+template <bool Signed>
+struct __avx2_int<1, Signed> : __avx2_base {
+  template <class T>
+  MINISTL_SIMD_AVX2_INLINE static reg splat(T x) {
+    uint8_t b;
+    memcpy(&b, &x, 1);
+    return _mm256_set1_epi8((char)b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg eq(reg a, reg b) {
+    return _mm256_cmpeq_epi8(a, b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg add(reg a, reg b) {
+    return _mm256_add_epi8(a, b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg lt(reg a, reg b) {
+    if (!Signed) {
+      const reg bias = _mm256_set1_epi8((char)0x80);
+      a = _mm256_xor_si256(a, bias);
+      b = _mm256_xor_si256(b, bias);
+    }
+    return _mm256_cmpgt_epi8(b, a);
+  }
+};
+
+template <bool Signed>
+struct __avx2_int<2, Signed> : __avx2_base {
+  template <class T>
+  MINISTL_SIMD_AVX2_INLINE static reg splat(T x) {
+    uint16_t b;
+    memcpy(&b, &x, 2);
+    return _mm256_set1_epi16((short)b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg eq(reg a, reg b) {
+    return _mm256_cmpeq_epi16(a, b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg add(reg a, reg b) {
+    return _mm256_add_epi16(a, b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg lt(reg a, reg b) {
+    if (!Signed) {
+      const reg bias = _mm256_set1_epi16((short)0x8000);
+      a = _mm256_xor_si256(a, bias);
+      b = _mm256_xor_si256(b, bias);
+    }
+    return _mm256_cmpgt_epi16(b, a);
+  }
+};
+
+template <bool Signed>
+struct __avx2_int<4, Signed> : __avx2_base {
+  template <class T>
+  MINISTL_SIMD_AVX2_INLINE static reg splat(T x) {
+    uint32_t b;
+    memcpy(&b, &x, 4);
+    return _mm256_set1_epi32((int)b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg eq(reg a, reg b) {
+    return _mm256_cmpeq_epi32(a, b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg add(reg a, reg b) {
+    return _mm256_add_epi32(a, b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg lt(reg a, reg b) {
+    if (!Signed) {
+      const reg bias = _mm256_set1_epi32((int)0x80000000u);
+      a = _mm256_xor_si256(a, bias);
+      b = _mm256_xor_si256(b, bias);
+    }
+    return _mm256_cmpgt_epi32(b, a);
+  }
+};
+
+template <bool Signed>
+struct __avx2_int<8, Signed> : __avx2_base {
+  template <class T>
+  MINISTL_SIMD_AVX2_INLINE static reg splat(T x) {
+    uint64_t b;
+    memcpy(&b, &x, 8);
+    return _mm256_set1_epi64x((long long)b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg eq(reg a, reg b) {
+    return _mm256_cmpeq_epi64(a, b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg add(reg a, reg b) {
+    return _mm256_add_epi64(a, b);
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg lt(reg a, reg b) {
+    if (!Signed) {
+      const reg bias = _mm256_set1_epi64x((long long)0x8000000000000000ull);
+      a = _mm256_xor_si256(a, bias);
+      b = _mm256_xor_si256(b, bias);
+    }
+    return _mm256_cmpgt_epi64(b, a);
+  }
+};
+
+template <size_t Size>
+struct __avx2_float;
+
+template <>
+struct __avx2_float<4> : __avx2_int<4, true> {
+  MINISTL_SIMD_AVX2_INLINE static reg eq(reg a, reg b) {
+    return _mm256_castps_si256(_mm256_cmp_ps(
+        _mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg add(reg a, reg b) {
+    return _mm256_castps_si256(
+        _mm256_add_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b)));
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg lt(reg a, reg b) {
+    return _mm256_castps_si256(_mm256_cmp_ps(
+        _mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_LT_OQ));
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg unord(reg a) {
+    return _mm256_castps_si256(_mm256_cmp_ps(
+        _mm256_castsi256_ps(a), _mm256_castsi256_ps(a), _CMP_UNORD_Q));
+  }
+};
+
+template <>
+struct __avx2_float<8> : __avx2_int<8, true> {
+  MINISTL_SIMD_AVX2_INLINE static reg eq(reg a, reg b) {
+    return _mm256_castpd_si256(_mm256_cmp_pd(
+        _mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg add(reg a, reg b) {
+    return _mm256_castpd_si256(
+        _mm256_add_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b)));
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg lt(reg a, reg b) {
+    return _mm256_castpd_si256(_mm256_cmp_pd(
+        _mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_LT_OQ));
+  }
+  MINISTL_SIMD_AVX2_INLINE static reg unord(reg a) {
+    return _mm256_castpd_si256(_mm256_cmp_pd(
+        _mm256_castsi256_pd(a), _mm256_castsi256_pd(a), _CMP_UNORD_Q));
+  }
+};
+
+// 元素类型到寄存器操作
+template <class T>
+struct __sse2_ops {
+  typedef typename std::conditional<
+      std::is_floating_point<T>::value, __sse2_float<sizeof(T)>,
+      __sse2_int<sizeof(T), std::is_signed<T>::value>>::type type;
+};
+
+template <class T>
+struct __avx2_ops {
+  typedef typename std::conditional<
+      std::is_floating_point<T>::value, __avx2_float<sizeof(T)>,
+      __avx2_int<sizeof(T), std::is_signed<T>::value>>::type type;
+};
+
+// 核心循环在simd_kernels.h中, 每种指令集各包含一次
+#define MINISTL_SIMD_NS __simd_sse2
+#define MINISTL_SIMD_TARGET
+#include "simd_kernels.h"
+#undef MINISTL_SIMD_NS
+#undef MINISTL_SIMD_TARGET
+
+#define MINISTL_SIMD_NS __simd_avx2
+#define MINISTL_SIMD_TARGET __attribute__((target("avx2")))
+#include "simd_kernels.h"
+#undef MINISTL_SIMD_NS
+#undef MINISTL_SIMD_TARGET
+
+// 按当前级别选择一份实现
+#define MINISTL_SIMD_DISPATCH(T, ...)                              \
+  do {                                                             \
+    const int level = simd_level();                                \
+    if (level == SIMD_AVX2) {                                      \
+      typedef typename __avx2_ops<T>::type Ops;                    \
+      return __simd_avx2::__VA_ARGS__;                             \
+    }                                                              \
+    if (level == SIMD_SSE2) {                                      \
+      typedef typename __sse2_ops<T>::type Ops;                    \
+      return __simd_sse2::__VA_ARGS__;                             \
+    }                                                              \
+  } while (0)
+
+#else
+
+#define MINISTL_SIMD_DISPATCH(T, ...) \
+  do {                                 \
+  } while (0)
+
+#endif  // MINISTL_SIMD_X86
+
+// 下面的T都已经去掉了const, 由__simd_eligible保证是可以向量化的类型
+
+template <class T>
+inline const T* __simd_find(const T* first, const T* last, T value) {
+  MINISTL_SIMD_DISPATCH(T, find<Ops>(first, last, value));
+  return __simd_scalar::find(first, last, value);
+}
+
+template <class T>
+inline size_t __simd_count(const T* first, const T* last, T value) {
+  MINISTL_SIMD_DISPATCH(T, count<Ops>(first, last, value));
+  return __simd_scalar::count(first, last, value);
+}
+
+template <class T>
+inline bool __simd_equal(const T* first1, const T* last1, const T* first2) {
+  MINISTL_SIMD_DISPATCH(T, equal<Ops>(first1, last1, first2));
+  return __simd_scalar::equal(first1, last1, first2);
+}
+
+template <class T>
+inline void __simd_fill(T* first, T* last, T value) {
+  MINISTL_SIMD_DISPATCH(T, fill<Ops>(first, last, value));
+  __simd_scalar::fill(first, last, value);
+}
+
+template <class T>
+inline const T* __simd_min_element(const T* first, const T* last) {
+  MINISTL_SIMD_DISPATCH(T, minmax_element<Ops, false>(first, last));
+  return __simd_scalar::minmax_element<false>(first, last);
+}
+
+template <class T>
+inline const T* __simd_max_element(const T* first, const T* last) {
+  MINISTL_SIMD_DISPATCH(T, minmax_element<Ops, true>(first, last));
+  return __simd_scalar::minmax_element<true>(first, last);
+}
+
+template <class T>
+inline T __simd_reduce(const T* first, const T* last, T init) {
+  MINISTL_SIMD_DISPATCH(T, reduce<Ops>(first, last, init));
+  return __simd_scalar::reduce(first, last, init);
+}
+
+#undef MINISTL_SIMD_DISPATCH
+
+}  // namespace ministl
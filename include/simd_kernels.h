@@ -0,0 +1,144 @@
+// 向量化算法的核心循环, 没有#pragma once: simd.h在每种指令集下各包含一次,
+// 包含前定义MINISTL_SIMD_NS(命名空间)和MINISTL_SIMD_TARGET(函数的target属性)
+// Ops是对应指令集的寄存器操作(__sse2_ops<T>::type或__avx2_ops<T>::type),
+// 寄存器操作都是always_inline, 必须在同样target的函数中才能内联
+
+namespace MINISTL_SIMD_NS {
+
+template <class Ops, class T>
+MINISTL_SIMD_TARGET const T* find(const T* first, const T* last, T value) {
+  typedef typename Ops::reg reg;
+  const ptrdiff_t N = Ops::WIDTH / sizeof(T);
+  const reg v = Ops::splat(value);
+  // 一次看两个寄存器, 合并后只判断一次
+  for (; last - first >= 2 * N; first += 2 * N) {
+    reg a = Ops::eq(Ops::load(first), v);
+    reg b = Ops::eq(Ops::load(first + N), v);
+    if (Ops::mask(Ops::or_(a, b)) != 0) {
+      unsigned m = Ops::mask(a);
+      if (m != 0) {
+        return first + __builtin_ctz(m) / sizeof(T);
+      }
+      return first + N + __builtin_ctz(Ops::mask(b)) / sizeof(T);
+    }
+  }
+  if (last - first >= N) {
+    unsigned m = Ops::mask(Ops::eq(Ops::load(first), v));
+    if (m != 0) {
+      return first + __builtin_ctz(m) / sizeof(T);
+    }
+    first += N;
+  }
+  return __simd_scalar::find(first, last, value);
+}
+
+// 每个字节一个计数器累加匹配的字节, 最多累加255次就汇总一次,
+// 匹配的字节数除以元素大小就是个数
+template <class Ops, class T>
+MINISTL_SIMD_TARGET size_t count(const T* first, const T* last, T value) {
+  typedef typename Ops::reg reg;
+  const ptrdiff_t N = Ops::WIDTH / sizeof(T);
+  const reg v = Ops::splat(value);
+  size_t bytes = 0;
+  while (last - first >= N) {
+    ptrdiff_t rounds = (last - first) / N;
+    if (rounds > 255) {
+      rounds = 255;
+    }
+    reg acc = Ops::zero();
+    for (; rounds > 0; --rounds, first += N) {
+      acc = Ops::sub_bytes(acc, Ops::eq(Ops::load(first), v));
+    }
+    bytes += Ops::sum_bytes(acc);
+  }
+  return bytes / sizeof(T) + __simd_scalar::count(first, last, value);
+}
+
+template <class Ops, class T>
+MINISTL_SIMD_TARGET bool equal(const T* first1, const T* last1,
+                               const T* first2) {
+  const ptrdiff_t N = Ops::WIDTH / sizeof(T);
+  for (; last1 - first1 >= N; first1 += N, first2 += N) {
+    if (Ops::mask(Ops::eq(Ops::load(first1), Ops::load(first2))) !=
+        Ops::FULL_MASK) {
+      return false;
+    }
+  }
+  return __simd_scalar::equal(first1, last1, first2);
+}
+
+template <class Ops, class T>
+MINISTL_SIMD_TARGET void fill(T* first, T* last, T value) {
+  typedef typename Ops::reg reg;
+  const ptrdiff_t N = Ops::WIDTH / sizeof(T);
+  const reg v = Ops::splat(value);
+  for (; last - first >= N; first += N) {
+    Ops::store(first, v);
+  }
+  __simd_scalar::fill(first, last, value);
+}
+
+// 先逐元素求出最小(最大)值, 再找它第一次出现的位置;
+// 有NaN时比较不是全序, 结果与逐个比较的顺序有关, 退回标量版本
+template <class Ops, bool Max, class T>
+MINISTL_SIMD_TARGET const T* minmax_element(const T* first, const T* last) {
+  typedef typename Ops::reg reg;
+  enum { N = Ops::WIDTH / sizeof(T) };
+  if (last - first < 2 * N) {
+    return __simd_scalar::minmax_element<Max>(first, last);
+  }
+  const T* p = first;
+  reg best = Ops::load(p);
+  reg nan = Ops::unord(best);
+  for (p += N; last - p >= N; p += N) {
+    reg x = Ops::load(p);
+    nan = Ops::or_(nan, Ops::unord(x));
+    best = Max ? Ops::select(Ops::lt(best, x), x, best)
+               : Ops::select(Ops::lt(x, best), x, best);
+  }
+  if (Ops::mask(nan) != 0) {
+    return __simd_scalar::minmax_element<Max>(first, last);
+  }
+  T lanes[N];
+  Ops::store(lanes, best);
+  T m = lanes[0];
+  for (int i = 1; i < N; ++i) {
+    if (Max ? m < lanes[i] : lanes[i] < m) {
+      m = lanes[i];
+    }
+  }
+  for (; p != last; ++p) {
+    if (__simd_is_nan(*p)) {
+      return __simd_scalar::minmax_element<Max>(first, last);
+    }
+    if (Max ? m < *p : *p < m) {
+      m = *p;
+    }
+  }
+  return find<Ops>(first, last, m);
+}
+
+// 两个寄存器交替累加, 整数按T的宽度回绕, 与逐个相加的结果相同
+template <class Ops, class T>
+MINISTL_SIMD_TARGET T reduce(const T* first, const T* last, T init) {
+  typedef typename Ops::reg reg;
+  enum { N = Ops::WIDTH / sizeof(T) };
+  reg sum0 = Ops::zero();
+  reg sum1 = Ops::zero();
+  for (; last - first >= 2 * N; first += 2 * N) {
+    sum0 = Ops::add(sum0, Ops::load(first));
+    sum1 = Ops::add(sum1, Ops::load(first + N));
+  }
+  if (last - first >= N) {
+    sum0 = Ops::add(sum0, Ops::load(first));
+    first += N;
+  }
+  T lanes[N];
+  Ops::store(lanes, Ops::add(sum0, sum1));
+  for (int i = 0; i < N; ++i) {
+    init = static_cast<T>(init + lanes[i]);
+  }
+  return __simd_scalar::reduce(first, last, init);
+}
+
+}  // namespace MINISTL_SIMD_NS
@@ -0,0 +1,583 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+#include "algobase.h"
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+
+namespace ministl {
+
+// 单向链表: 头节点直接放在slist对象里, 插入删除都在某个位置之后进行
+// 节点由simple_alloc<node, Alloc>配置, 节点的第一个字就是next, 和allocate_batch
+// 串区块的方式相同, 所以一次插入n个元素时取来的一串区块原地构造后直接接上;
+// 成批删除时整串归还. splice_after/merge/sort/reverse只改指针, 不配置内存
+
+struct __slist_node_base {
+  __slist_node_base* next;
+};
+
+template <class T>
+struct __slist_node : __slist_node_base {
+  T data;
+};
+
+// 从head开始找node的前一个节点, 找不到时返回最后一个节点
+inline __slist_node_base* __slist_previous(__slist_node_base* head,
+                                           const __slist_node_base* node) {
+  while (head && head->next != node) {
+    head = head->next;
+  }
+  return head;
+}
+
+// 把(before_first, before_last]移到pos之后
+inline void __slist_splice_after(__slist_node_base* pos,
+                                 __slist_node_base* before_first,
+                                 __slist_node_base* before_last) {
+  if (pos != before_first && pos != before_last) {
+    __slist_node_base* first = before_first->next;
+    __slist_node_base* after = pos->next;
+    before_first->next = before_last->next;
+    pos->next = first;
+    before_last->next = after;
+  }
+}
+
+// 反转以node开头的链表, 返回新的第一个节点
+inline __slist_node_base* __slist_reverse(__slist_node_base* node) {
+  __slist_node_base* result = node;
+  node = node->next;
+  result->next = 0;
+  while (node) {
+    __slist_node_base* next = node->next;
+    node->next = result;
+    result = node;
+    node = next;
+  }
+  return result;
+}
+
+template <class T, class Ref, class Ptr>
+struct __slist_iterator {
+  typedef __slist_iterator<T, T&, T*> iterator;
+  typedef __slist_iterator<T, const T&, const T*> const_iterator;
+  typedef __slist_iterator self;
+
+  typedef forward_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef Ptr pointer;
+  typedef Ref reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  __slist_node_base* node;
+
+  __slist_iterator() : node(0) {}
+  explicit __slist_iterator(__slist_node_base* x) : node(x) {}
+  __slist_iterator(const __slist_iterator&) = default;
+  __slist_iterator& operator=(const __slist_iterator&) = default;
+  // iterator到const_iterator的转换, 不能反过来
+  template <class R, class P,
+            class = typename std::enable_if<
+                std::is_same<__slist_iterator<T, R, P>, iterator>::value>::type>
+  __slist_iterator(const __slist_iterator<T, R, P>& x) : node(x.node) {}
+
+  bool operator==(const self& x) const { return node == x.node; }
+  bool operator!=(const self& x) const { return node != x.node; }
+  reference operator*() const { return ((__slist_node<T>*)node)->data; }
+  pointer operator->() const { return &(operator*()); }
+  self& operator++() {
+    node = node->next;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    node = node->next;
+    return tmp;
+  }
+};
+
+template <class T, class Alloc = alloc>
+class slist {
+ public:
+  typedef T value_type;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef __slist_iterator<T, T&, T*> iterator;
+  typedef __slist_iterator<T, const T&, const T*> const_iterator;
+
+ protected:
+  typedef __slist_node_base node_base;
+  typedef __slist_node<T> node;
+  typedef simple_alloc<node, Alloc> node_allocator;
+
+  node_base head;  // 头节点, head.next是第一个节点, 最后一个节点的next为0
+
+  template <class... Args>
+  node* create_node(Args&&... args) {
+    node* p = node_allocator::allocate();
+    try {
+      construct(&p->data, std::forward<Args>(args)...);
+    } catch (...) {
+      node_allocator::deallocate(p);
+      throw;
+    }
+    return p;
+  }
+  // 析构[first, last)上的元素, 节点原样整串归还, 调用者负责先摘下这一段
+  static void destroy_nodes(node_base* first, node_base* last) {
+    if (first == last) {
+      return;
+    }
+    node_base* p = first;
+    for (;;) {
+      destroy(&((node*)p)->data);
+      if (p->next == last) {
+        break;
+      }
+      p = p->next;
+    }
+    p->next = 0;
+    node_allocator::deallocate_batch(first);
+  }
+  // 一次配置n个节点, 依次用gen(p)构造元素, 整段接到pos之后, 返回最后一个新元素.
+  // 中途异常时已构造的元素析构, 节点整批归还, 链表不变
+  template <class Generator>
+  node_base* insert_batch_after(node_base* pos, size_type n, Generator gen) {
+    if (n == 0) {
+      return pos;
+    }
+    node_base* first = (node_base*)node_allocator::allocate_batch(n);
+    node_base* last = first;
+    try {
+      for (;;) {
+        gen(&((node*)last)->data);
+        if (last->next == 0) {
+          break;
+        }
+        last = last->next;
+      }
+    } catch (...) {
+      for (node_base* p = first; p != last; p = p->next) {
+        destroy(&((node*)p)->data);
+      }
+      node_allocator::deallocate_batch(first);
+      throw;
+    }
+    last->next = pos->next;
+    pos->next = first;
+    return last;
+  }
+
+  node_base* fill_insert_after(node_base* pos, size_type n,
+                               const value_type& x) {
+    return insert_batch_after(pos, n, [&x](T* p) { construct(p, x); });
+  }
+  template <class Integer>
+  node_base* range_insert_after(node_base* pos, Integer n, Integer x,
+                                std::true_type) {
+    return insert_batch_after(pos, (size_type)n,
+                              [&x](T* p) { construct(p, (T)x); });
+  }
+  template <class InputIterator>
+  node_base* range_insert_after(node_base* pos, InputIterator first,
+                                InputIterator last, std::false_type) {
+    return range_insert_after_aux(pos, first, last, iterator_category(first));
+  }
+  template <class InputIterator>
+  node_base* range_insert_after_aux(node_base* pos, InputIterator first,
+                                    InputIterator last, input_iterator_tag) {
+    for (; first != last; ++first) {
+      node* p = create_node(*first);
+      p->next = pos->next;
+      pos->next = p;
+      pos = p;
+    }
+    return pos;
+  }
+  template <class ForwardIterator>
+  node_base* range_insert_after_aux(node_base* pos, ForwardIterator first,
+                                    ForwardIterator last,
+                                    forward_iterator_tag) {
+    size_type n = (size_type)ministl::distance(first, last);
+    return insert_batch_after(pos, n, [&first](T* p) {
+      construct(p, *first);
+      ++first;
+    });
+  }
+
+ public:
+  slist() { head.next = 0; }
+  explicit slist(size_type n) {
+    head.next = 0;
+    insert_batch_after(&head, n, [](T* p) { construct(p); });
+  }
+  slist(size_type n, const value_type& value) {
+    head.next = 0;
+    fill_insert_after(&head, n, value);
+  }
+  template <class InputIterator>
+  slist(InputIterator first, InputIterator last) {
+    head.next = 0;
+    try {
+      range_insert_after(&head, first, last,
+                         std::is_integral<InputIterator>());
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+  slist(std::initializer_list<T> il) {
+    head.next = 0;
+    range_insert_after_aux(&head, il.begin(), il.end(),
+                           forward_iterator_tag());
+  }
+  slist(const slist& x) {
+    head.next = 0;
+    range_insert_after_aux(&head, x.begin(), x.end(), forward_iterator_tag());
+  }
+  slist(slist&& x) noexcept {
+    head.next = x.head.next;
+    x.head.next = 0;
+  }
+  ~slist() { destroy_nodes(head.next, 0); }
+
+  // 已有的节点直接赋值, 多出来的删掉, 不够的整批配置
+  slist& operator=(const slist& x) {
+    if (&x != this) {
+      node_base* p1 = &head;
+      const node_base* p2 = x.head.next;
+      for (; p1->next && p2; p1 = p1->next, p2 = p2->next) {
+        ((node*)p1->next)->data = ((const node*)p2)->data;
+      }
+      if (p2 == 0) {
+        erase_after(iterator(p1), end());
+      } else {
+        range_insert_after_aux(p1, const_iterator((node_base*)p2), x.end(),
+                               forward_iterator_tag());
+      }
+    }
+    return *this;
+  }
+  slist& operator=(slist&& x) noexcept {
+    if (&x != this) {
+      clear();
+      swap(x);
+    }
+    return *this;
+  }
+  slist& operator=(std::initializer_list<T> il) {
+    assign(il.begin(), il.end());
+    return *this;
+  }
+  void assign(size_type n, const value_type& value) {
+    slist tmp(n, value);
+    swap(tmp);
+  }
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    slist tmp(first, last);
+    swap(tmp);
+  }
+  void assign(std::initializer_list<T> il) { assign(il.begin(), il.end()); }
+
+  iterator before_begin() { return iterator(&head); }
+  const_iterator before_begin() const {
+    return const_iterator((node_base*)&head);
+  }
+  iterator begin() { return iterator(head.next); }
+  const_iterator begin() const { return const_iterator(head.next); }
+  const_iterator cbegin() const { return const_iterator(head.next); }
+  iterator end() { return iterator(0); }
+  const_iterator end() const { return const_iterator(0); }
+  const_iterator cend() const { return const_iterator(0); }
+
+  bool empty() const { return head.next == 0; }
+  // 要遍历整个链表
+  size_type size() const {
+    return (size_type)ministl::distance(begin(), end());
+  }
+  size_type max_size() const { return size_type(-1) / sizeof(node); }
+  void swap(slist& x) {
+    node_base* tmp = head.next;
+    head.next = x.head.next;
+    x.head.next = tmp;
+  }
+
+  reference front() { return ((node*)head.next)->data; }
+  const_reference front() const { return ((node*)head.next)->data; }
+  template <class... Args>
+  reference emplace_front(Args&&... args) {
+    return *emplace_after(before_begin(), std::forward<Args>(args)...);
+  }
+  void push_front(const value_type& x) { emplace_after(before_begin(), x); }
+  void push_front(value_type&& x) {
+    emplace_after(before_begin(), std::move(x));
+  }
+  void pop_front() { erase_after(before_begin()); }
+
+  // pos的前一个位置, 要从头遍历
+  iterator previous(const_iterator pos) {
+    return iterator(__slist_previous(&head, pos.node));
+  }
+  const_iterator previous(const_iterator pos) const {
+    return const_iterator(__slist_previous((node_base*)&head, pos.node));
+  }
+
+  template <class... Args>
+  iterator emplace_after(iterator pos, Args&&... args) {
+    node* p = create_node(std::forward<Args>(args)...);
+    p->next = pos.node->next;
+    pos.node->next = p;
+    return iterator(p);
+  }
+  iterator insert_after(iterator pos, const value_type& x) {
+    return emplace_after(pos, x);
+  }
+  iterator insert_after(iterator pos, value_type&& x) {
+    return emplace_after(pos, std::move(x));
+  }
+  // 以下几个返回最后一个插入的元素, 没有插入时返回pos
+  iterator insert_after(iterator pos, size_type n, const value_type& x) {
+    return iterator(fill_insert_after(pos.node, n, x));
+  }
+  template <class InputIterator>
+  iterator insert_after(iterator pos, InputIterator first,
+                        InputIterator last) {
+    return iterator(range_insert_after(pos.node, first, last,
+                                       std::is_integral<InputIterator>()));
+  }
+  iterator insert_after(iterator pos, std::initializer_list<T> il) {
+    return iterator(range_insert_after_aux(pos.node, il.begin(), il.end(),
+                                           forward_iterator_tag()));
+  }
+
+  // 删除pos之后的一个元素, 返回被删元素的下一个位置
+  iterator erase_after(iterator pos) {
+    node_base* p = pos.node->next;
+    pos.node->next = p->next;
+    destroy(&((node*)p)->data);
+    node_allocator::deallocate((node*)p);
+    return iterator(pos.node->next);
+  }
+  // 删除(before_first, last)
+  iterator erase_after(iterator before_first, iterator last) {
+    node_base* first = before_first.node->next;
+    if (first != last.node) {
+      before_first.node->next = last.node;
+      destroy_nodes(first, last.node);
+    }
+    return last;
+  }
+  void clear() {
+    destroy_nodes(head.next, 0);
+    head.next = 0;
+  }
+  void resize(size_type new_size) {
+    node_base* p = &head;
+    for (; p->next && new_size > 0; p = p->next, --new_size) {
+    }
+    if (new_size > 0) {
+      insert_batch_after(p, new_size, [](T* q) { construct(q); });
+    } else {
+      erase_after(iterator(p), end());
+    }
+  }
+  void resize(size_type new_size, const value_type& x) {
+    node_base* p = &head;
+    for (; p->next && new_size > 0; p = p->next, --new_size) {
+    }
+    if (new_size > 0) {
+      fill_insert_after(p, new_size, x);
+    } else {
+      erase_after(iterator(p), end());
+    }
+  }
+
+  // 把x的所有元素移到pos之后, 要找x的最后一个节点, 与x的长度成正比
+  void splice_after(iterator pos, slist& x) {
+    if (x.head.next) {
+      __slist_splice_after(pos.node, &x.head, __slist_previous(&x.head, 0));
+    }
+  }
+  void splice_after(iterator pos, slist&& x) { splice_after(pos, x); }
+  // 把prev之后的一个元素移到pos之后
+  void splice_after(iterator pos, slist&, iterator prev) {
+    if (prev.node->next) {
+      __slist_splice_after(pos.node, prev.node, prev.node->next);
+    }
+  }
+  void splice_after(iterator pos, slist&& x, iterator prev) {
+    splice_after(pos, x, prev);
+  }
+  // 把(before_first, before_last]移到pos之后, O(1)
+  void splice_after(iterator pos, iterator before_first,
+                    iterator before_last) {
+    if (before_first != before_last) {
+      __slist_splice_after(pos.node, before_first.node, before_last.node);
+    }
+  }
+
+  // 删掉的节点先收集到一个临时链表里, 最后整批归还,
+  // value引用的是链表里的元素时也不会出错
+  void remove(const value_type& value) {
+    remove_if([&value](const value_type& x) { return x == value; });
+  }
+  template <class Predicate>
+  void remove_if(Predicate pred) {
+    slist deleted;
+    node_base* tail = &deleted.head;
+    node_base* p = &head;
+    while (p->next) {
+      if (pred(((node*)p->next)->data)) {
+        __slist_splice_after(tail, p, p->next);
+        tail = tail->next;
+      } else {
+        p = p->next;
+      }
+    }
+  }
+  void unique() {
+    unique([](const value_type& x, const value_type& y) { return x == y; });
+  }
+  // 相邻的等价元素只保留第一个
+  template <class BinaryPredicate>
+  void unique(BinaryPredicate pred) {
+    slist deleted;
+    node_base* tail = &deleted.head;
+    node_base* p = head.next;
+    if (p == 0) {
+      return;
+    }
+    while (p->next) {
+      if (pred(((node*)p)->data, ((node*)p->next)->data)) {
+        __slist_splice_after(tail, p, p->next);
+        tail = tail->next;
+      } else {
+        p = p->next;
+      }
+    }
+  }
+
+  // 两个链表都已按comp排好序, 把x合并进来, 结果稳定, x变为空
+  void merge(slist& x) { merge(x, less_than()); }
+  void merge(slist&& x) { merge(x); }
+  template <class Compare>
+  void merge(slist& x, Compare comp) {
+    if (&x == this) {
+      return;
+    }
+    node_base* n1 = &head;
+    while (n1->next && x.head.next) {
+      if (comp(((node*)x.head.next)->data, ((node*)n1->next)->data)) {
+        // x开头连续一段都比n1->next小时整段移过来
+        node_base* last = x.head.next;
+        while (last->next &&
+               comp(((node*)last->next)->data, ((node*)n1->next)->data)) {
+          last = last->next;
+        }
+        __slist_splice_after(n1, &x.head, last);
+        n1 = last;
+      }
+      n1 = n1->next;
+    }
+    if (x.head.next) {
+      n1->next = x.head.next;
+      x.head.next = 0;
+    }
+  }
+  template <class Compare>
+  void merge(slist&& x, Compare comp) {
+    merge(x, comp);
+  }
+
+  void reverse() {
+    if (head.next) {
+      head.next = __slist_reverse(head.next);
+    }
+  }
+
+  // 与list::sort相同的自底向上归并排序, 不配置内存, 稳定
+  void sort() { sort(less_than()); }
+  template <class Compare>
+  void sort(Compare comp) {
+    if (head.next == 0 || head.next->next == 0) {
+      return;
+    }
+    slist carry;
+    slist counter[64];
+    int fill = 0;
+    try {
+      while (!empty()) {
+        __slist_splice_after(&carry.head, &head, head.next);
+        int i = 0;
+        while (i < fill && !counter[i].empty()) {
+          counter[i].merge(carry, comp);
+          carry.swap(counter[i++]);
+        }
+        carry.swap(counter[i]);
+        if (i == fill) {
+          ++fill;
+        }
+      }
+      for (int i = 1; i < fill; ++i) {
+        counter[i].merge(counter[i - 1], comp);
+      }
+    } catch (...) {
+      // comp抛出异常时元素都放回来, 顺序不定
+      splice_after(before_begin(), carry);
+      for (int i = 0; i < fill; ++i) {
+        splice_after(before_begin(), counter[i]);
+      }
+      throw;
+    }
+    swap(counter[fill - 1]);
+  }
+
+ private:
+  struct less_than {
+    bool operator()(const value_type& x, const value_type& y) const {
+      return x < y;
+    }
+  };
+};
+
+template <class T, class Alloc>
+inline bool operator==(const slist<T, Alloc>& x, const slist<T, Alloc>& y) {
+  typename slist<T, Alloc>::const_iterator first1 = x.begin();
+  typename slist<T, Alloc>::const_iterator first2 = y.begin();
+  for (; first1 != x.end() && first2 != y.end(); ++first1, ++first2) {
+    if (!(*first1 == *first2)) {
+      return false;
+    }
+  }
+  return first1 == x.end() && first2 == y.end();
+}
+
+template <class T, class Alloc>
+inline bool operator!=(const slist<T, Alloc>& x, const slist<T, Alloc>& y) {
+  return !(x == y);
+}
+
+template <class T, class Alloc>
+inline bool operator<(const slist<T, Alloc>& x, const slist<T, Alloc>& y) {
+  return ministl::lexicographical_compare(x.begin(), x.end(), y.begin(),
+                                          y.end());
+}
+
+template <class T, class Alloc>
+inline void swap(slist<T, Alloc>& x, slist<T, Alloc>& y) {
+  x.swap(y);
+}
+
+}  // namespace ministl
@@ -0,0 +1,462 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+#include "uninitialized.h"
+
+namespace ministl {
+
+// 带内联缓冲区的动态数组, 接口与vector相同
+// 不超过N个元素时放在对象内部的缓冲区中, 完全不访问配置器;
+// 超过N个时才向simple_alloc<T, Alloc>要空间, 之后的行为与vector一致
+// 在堆上时移动是O(1)的(直接接管指针), 在缓冲区中时只能逐个移动元素
+// 中间插入先在尾部构造再用rotate移到位置上, 短序列上比分段搬移更简单也足够快
+template <class T, size_t N = 8, class Alloc = alloc>
+class small_vector {
+  static_assert(N > 0, "small_vector needs at least one inline element");
+
+ public:
+  typedef T value_type;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef value_type* iterator;
+  typedef const value_type* const_iterator;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef ministl::reverse_iterator<iterator, T> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator, T, const T&>
+      const_reverse_iterator;
+
+ protected:
+  typedef simple_alloc<value_type, Alloc> data_allocator;
+  // 在堆上扩容时能否直接reallocate, 与vector相同
+  typedef typename std::conditional<
+      (alignof(T) <= (size_t)__ALIGN),
+      typename is_trivially_relocatable<T>::type, _false_type>::type
+      relocatable;
+
+  iterator start;
+  iterator finish;
+  iterator end_of_storage;
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer[N];
+
+  iterator inline_data() { return reinterpret_cast<iterator>(buffer); }
+  void init_inline() {
+    start = finish = inline_data();
+    end_of_storage = start + N;
+  }
+  void deallocate() {
+    if (!is_inline()) {
+      data_allocator::deallocate(start, end_of_storage - start);
+    }
+  }
+  size_type next_capacity(size_type n) const {
+    size_type old_size = size();
+    if (max_size() - old_size < n) {
+      throw std::length_error("small_vector");
+    }
+    size_type len = old_size + (old_size > n ? old_size : n);
+    return (len < old_size || len > max_size()) ? max_size() : len;
+  }
+  // 把容量改成new_cap(大于N), 元素搬到堆上的新空间
+  void reallocate_storage(size_type new_cap) {
+    if (!is_inline()) {
+      reallocate_storage_aux(new_cap, relocatable());
+    } else {
+      reallocate_storage_aux(new_cap, _false_type());
+    }
+  }
+  void reallocate_storage_aux(size_type new_cap, _true_type) {
+    size_type n = size();
+    start = data_allocator::reallocate(start, capacity(), new_cap);
+    finish = start + n;
+    end_of_storage = start + new_cap;
+  }
+  void reallocate_storage_aux(size_type new_cap, _false_type) {
+    iterator new_start = data_allocator::allocate(new_cap);
+    iterator new_finish;
+    try {
+      new_finish = uninitialized_relocate(start, finish, new_start);
+    } catch (...) {
+      data_allocator::deallocate(new_start, new_cap);
+      throw;
+    }
+    deallocate();
+    start = new_start;
+    finish = new_finish;
+    end_of_storage = new_start + new_cap;
+  }
+  // 从另一个small_vector接管元素: 在堆上时直接接管指针, 否则逐个移动
+  void steal(small_vector& x) {
+    if (x.is_inline()) {
+      init_inline();
+      finish = uninitialized_move(x.start, x.finish, start);
+      destroy(x.start, x.finish);
+      x.finish = x.start;
+    } else {
+      start = x.start;
+      finish = x.finish;
+      end_of_storage = x.end_of_storage;
+      x.init_inline();
+    }
+  }
+  bool in_storage(const T* p) const {
+    return !std::less<const T*>()(p, start) && std::less<const T*>()(p, finish);
+  }
+  template <class U>
+  bool in_storage(const U*) const {
+    return false;
+  }
+  template <class Integer>
+  void range_append(Integer n, Integer x, std::true_type) {
+    append_n((size_type)n, (T)x);
+  }
+  template <class InputIterator>
+  void range_append(InputIterator first, InputIterator last,
+                    std::false_type) {
+    range_append_aux(first, last, iterator_category(first));
+  }
+  template <class InputIterator>
+  void range_append_aux(InputIterator first, InputIterator last,
+                        input_iterator_tag) {
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  }
+  template <class ForwardIterator>
+  void range_append_aux(ForwardIterator first, ForwardIterator last,
+                        forward_iterator_tag) {
+    if (first != last && in_storage(&*first)) {
+      // 区间在本容器内, 扩容会让它失效, 先复制一份
+      small_vector tmp(first, last);
+      if (size_type(end_of_storage - finish) < tmp.size()) {
+        reallocate_storage(next_capacity(tmp.size()));
+      }
+      finish = uninitialized_move(tmp.begin(), tmp.end(), finish);
+    } else {
+      append(first, last);
+    }
+  }
+  // 在尾部追加n个x
+  void append_n(size_type n, const T& x) {
+    if (size_type(end_of_storage - finish) < n) {
+      value_type x_copy(x);
+      reallocate_storage(next_capacity(n));
+      finish = uninitialized_fill_n(finish, n, x_copy);
+    } else {
+      finish = uninitialized_fill_n(finish, n, x);
+    }
+  }
+  // 追加n个值初始化的元素, 就地构造
+  void append_value_n(size_type n) {
+    if (size_type(end_of_storage - finish) < n) {
+      reallocate_storage(next_capacity(n));
+    }
+    finish = uninitialized_value_construct_n(finish, n);
+  }
+
+ public:
+  small_vector() { init_inline(); }
+  small_vector(size_type n, const T& value) {
+    init_inline();
+    try {
+      append_n(n, value);
+    } catch (...) {
+      deallocate();
+      throw;
+    }
+  }
+  explicit small_vector(size_type n) {
+    init_inline();
+    try {
+      append_value_n(n);
+    } catch (...) {
+      deallocate();
+      throw;
+    }
+  }
+  template <class InputIterator>
+  small_vector(InputIterator first, InputIterator last) {
+    init_inline();
+    try {
+      range_append(first, last, std::is_integral<InputIterator>());
+    } catch (...) {
+      clear();
+      deallocate();
+      throw;
+    }
+  }
+  small_vector(std::initializer_list<T> il)
+      : small_vector(il.begin(), il.end()) {}
+  small_vector(const small_vector& x) : small_vector(x.begin(), x.end()) {}
+  small_vector(small_vector&& x) noexcept(
+      std::is_nothrow_move_constructible<T>::value) {
+    steal(x);
+  }
+  ~small_vector() {
+    destroy(start, finish);
+    deallocate();
+  }
+
+  small_vector& operator=(const small_vector& x) {
+    if (&x != this) {
+      clear();
+      append(x.begin(), x.end());
+    }
+    return *this;
+  }
+  small_vector& operator=(small_vector&& x) noexcept(
+      std::is_nothrow_move_constructible<T>::value) {
+    if (&x != this) {
+      clear();
+      deallocate();
+      steal(x);
+    }
+    return *this;
+  }
+  small_vector& operator=(std::initializer_list<T> il) {
+    assign(il.begin(), il.end());
+    return *this;
+  }
+
+  iterator begin() { return start; }
+  const_iterator begin() const { return start; }
+  const_iterator cbegin() const { return start; }
+  iterator end() { return finish; }
+  const_iterator end() const { return finish; }
+  const_iterator cend() const { return finish; }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  size_type size() const { return size_type(finish - start); }
+  size_type max_size() const { return size_type(-1) / sizeof(T); }
+  size_type capacity() const { return size_type(end_of_storage - start); }
+  bool empty() const { return start == finish; }
+  // 内联缓冲区能放下的元素个数
+  static constexpr size_type inline_capacity() { return N; }
+  // 元素是否还在内联缓冲区中
+  bool is_inline() const {
+    return start == reinterpret_cast<const_iterator>(buffer);
+  }
+
+  reference operator[](size_type n) { return start[n]; }
+  const_reference operator[](size_type n) const { return start[n]; }
+  reference at(size_type n) {
+    if (n >= size()) {
+      throw std::out_of_range("small_vector");
+    }
+    return start[n];
+  }
+  const_reference at(size_type n) const {
+    if (n >= size()) {
+      throw std::out_of_range("small_vector");
+    }
+    return start[n];
+  }
+  reference front() { return *start; }
+  const_reference front() const { return *start; }
+  reference back() { return *(finish - 1); }
+  const_reference back() const { return *(finish - 1); }
+  T* data() { return start; }
+  const T* data() const { return start; }
+
+  void reserve(size_type n) {
+    if (n > max_size()) {
+      throw std::length_error("small_vector");
+    }
+    if (capacity() < n) {
+      reallocate_storage(n);
+    }
+  }
+  // 元素放得进内联缓冲区时搬回去并释放堆上的空间, 否则把容量缩小到size()
+  void shrink_to_fit() {
+    if (is_inline() || finish == end_of_storage) {
+      return;
+    }
+    if (size() <= N) {
+      iterator old_start = start;
+      iterator old_finish = finish;
+      size_type old_cap = capacity();
+      iterator new_finish = uninitialized_move(old_start, old_finish,
+                                               inline_data());
+      destroy(old_start, old_finish);
+      data_allocator::deallocate(old_start, old_cap);
+      start = inline_data();
+      finish = new_finish;
+      end_of_storage = start + N;
+      return;
+    }
+    reallocate_storage(size());
+  }
+
+  template <class... Args>
+  reference emplace_back(Args&&... args) {
+    if (finish == end_of_storage) {
+      // 参数可能引用本容器中的元素, 先构造出来
+      value_type tmp(std::forward<Args>(args)...);
+      reallocate_storage(next_capacity(1));
+      construct(finish, std::move(tmp));
+    } else {
+      construct(finish, std::forward<Args>(args)...);
+    }
+    ++finish;
+    return back();
+  }
+  void push_back(const T& x) { emplace_back(x); }
+  void push_back(T&& x) { emplace_back(std::move(x)); }
+  void pop_back() {
+    --finish;
+    destroy(finish);
+  }
+
+  // 在尾部追加[first, last), 与vector::append相同, 区间不能在本容器内
+  template <class ForwardIterator>
+  void append(ForwardIterator first, ForwardIterator last) {
+    size_type n = (size_type)ministl::distance(first, last);
+    if (size_type(end_of_storage - finish) < n) {
+      reallocate_storage(next_capacity(n));
+    }
+    finish = ministl::uninitialized_copy(first, last, finish);
+  }
+
+  template <class... Args>
+  iterator emplace(const_iterator position, Args&&... args) {
+    size_type off = position - start;
+    emplace_back(std::forward<Args>(args)...);
+    std::rotate(start + off, finish - 1, finish);
+    return start + off;
+  }
+  iterator insert(const_iterator position, const T& x) {
+    return emplace(position, x);
+  }
+  iterator insert(const_iterator position, T&& x) {
+    return emplace(position, std::move(x));
+  }
+  iterator insert(const_iterator position, size_type n, const T& x) {
+    size_type off = position - start;
+    size_type old_size = size();
+    append_n(n, x);
+    std::rotate(start + off, start + old_size, finish);
+    return start + off;
+  }
+  template <class InputIterator>
+  iterator insert(const_iterator position, InputIterator first,
+                  InputIterator last) {
+    size_type off = position - start;
+    size_type old_size = size();
+    range_append(first, last, std::is_integral<InputIterator>());
+    std::rotate(start + off, start + old_size, finish);
+    return start + off;
+  }
+  iterator insert(const_iterator position, std::initializer_list<T> il) {
+    return insert(position, il.begin(), il.end());
+  }
+
+  iterator erase(const_iterator position) {
+    iterator pos = start + (position - start);
+    if (pos + 1 != finish) {
+      ministl::move(pos + 1, finish, pos);
+    }
+    pop_back();
+    return pos;
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    iterator f = start + (first - start);
+    // 空区间什么也不做, 否则后面的元素会移动赋值给自己
+    if (first == last) {
+      return f;
+    }
+    iterator l = start + (last - start);
+    iterator i = ministl::move(l, finish, f);
+    destroy(i, finish);
+    finish = i;
+    return f;
+  }
+  void clear() { erase(begin(), end()); }
+
+  void resize(size_type new_size, const T& x) {
+    if (new_size < size()) {
+      erase(begin() + new_size, end());
+    } else {
+      append_n(new_size - size(), x);
+    }
+  }
+  void resize(size_type new_size) {
+    if (new_size < size()) {
+      erase(begin() + new_size, end());
+    } else {
+      append_value_n(new_size - size());
+    }
+  }
+
+  void assign(size_type n, const T& value) {
+    small_vector tmp(n, value);
+    swap(tmp);
+  }
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    small_vector tmp(first, last);
+    swap(tmp);
+  }
+  void assign(std::initializer_list<T> il) { assign(il.begin(), il.end()); }
+
+  // 两边都在堆上时交换指针, 否则借助一个临时对象逐个移动
+  void swap(small_vector& x) {
+    if (&x == this) {
+      return;
+    }
+    if (!is_inline() && !x.is_inline()) {
+      std::swap(start, x.start);
+      std::swap(finish, x.finish);
+      std::swap(end_of_storage, x.end_of_storage);
+      return;
+    }
+    small_vector tmp(std::move(x));
+    x = std::move(*this);
+    *this = std::move(tmp);
+  }
+};
+
+template <class T, size_t N, class Alloc>
+inline bool operator==(const small_vector<T, N, Alloc>& x,
+                       const small_vector<T, N, Alloc>& y) {
+  return x.size() == y.size() &&
+         ministl::equal(x.begin(), x.end(), y.begin());
+}
+
+template <class T, size_t N, class Alloc>
+inline bool operator!=(const small_vector<T, N, Alloc>& x,
+                       const small_vector<T, N, Alloc>& y) {
+  return !(x == y);
+}
+
+template <class T, size_t N, class Alloc>
+inline bool operator<(const small_vector<T, N, Alloc>& x,
+                      const small_vector<T, N, Alloc>& y) {
+  return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+}
+
+template <class T, size_t N, class Alloc>
+inline void swap(small_vector<T, N, Alloc>& x, small_vector<T, N, Alloc>& y) {
+  x.swap(y);
+}
+
+}  // namespace ministl
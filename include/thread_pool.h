@@ -0,0 +1,316 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "alloc.h"
+#include "deque.h"
+
+namespace ministl {
+
+// 工作窃取线程池, 供parallel.h中的并行算法使用
+// 每个工作线程有自己的任务队列: 自己从队尾取(后进先出, 刚拆出来的任务数据还在缓存里),
+// 空闲时从别的队列的队头偷(先进先出, 偷到的通常是拆分层次较高, 较大的任务)
+// 不是工作线程的线程提交的任务放进一个公共队列
+// 等待任务组的线程不睡眠, 而是一起执行队列中的任务, 嵌套的并行调用不会死锁
+// 工作线程数是硬件线程数减1, 调用并行算法的线程本身也参与计算;
+// 环境变量MINISTL_POOL_THREADS可以在线程池创建前指定工作线程数
+
+class __task_group;
+
+// 任务队列和任务数组在多个线程中配置和归还, 不能用单线程的alloc
+typedef __default_alloc_template<true, 0> __pool_alloc;
+
+// 任务由提交者在自己的栈上或缓冲区中构造, 执行完之前提交者一直在等待, 不会失效
+struct __pool_task {
+  void (*run)(__pool_task*);
+  __task_group* group;
+};
+
+class __thread_pool {
+ public:
+  static __thread_pool& instance() {
+    static __thread_pool pool;
+    return pool;
+  }
+
+  // 工作线程数
+  size_t size() const { return nworkers; }
+
+  // 放进当前线程的队列
+  void push(__pool_task* task) {
+    queue& q = queues[self()];
+    {
+      std::lock_guard<std::mutex> guard(q.lock);
+      q.tasks.push_back(task);
+    }
+    queued.fetch_add(1, std::memory_order_release);
+    { std::lock_guard<std::mutex> guard(sleep_lock); }
+    wake.notify_one();
+  }
+
+  // 先取自己队列的队尾, 再依次偷别的队列的队头, 都没有时返回nullptr
+  __pool_task* take() {
+    if (queued.load(std::memory_order_acquire) == 0) {
+      return nullptr;
+    }
+    size_t me = self();
+    __pool_task* task = pop(queues[me], true);
+    for (size_t i = 1; task == nullptr && i < nqueues; ++i) {
+      task = pop(queues[(me + i) % nqueues], false);
+    }
+    return task;
+  }
+
+ private:
+  struct queue {
+    std::mutex lock;
+    deque<__pool_task*, __pool_alloc> tasks;
+  };
+
+  __thread_pool() : queued(0), stop(false) {
+    unsigned hw = std::thread::hardware_concurrency();
+    nworkers = hw > 1 ? hw - 1 : 0;
+    const char* env = getenv("MINISTL_POOL_THREADS");
+    if (env != nullptr && *env != '\0') {
+      nworkers = (size_t)strtoul(env, nullptr, 10);
+    }
+    nqueues = nworkers + 1;
+    queues = new queue[nqueues];
+    workers = new std::thread[nworkers];
+    for (size_t i = 0; i < nworkers; ++i) {
+      workers[i] = std::thread(&__thread_pool::worker_loop, this, i);
+    }
+  }
+
+  ~__thread_pool() {
+    {
+      std::lock_guard<std::mutex> guard(sleep_lock);
+      stop = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < nworkers; ++i) {
+      workers[i].join();
+    }
+    delete[] workers;
+    delete[] queues;
+  }
+
+  __thread_pool(const __thread_pool&) = delete;
+  __thread_pool& operator=(const __thread_pool&) = delete;
+
+  // 当前线程的队列下标, 不是工作线程时是最后一个(公共队列)
+  static size_t& index() {
+    static thread_local size_t i = size_t(-1);
+    return i;
+  }
+  size_t self() const {
+    size_t i = index();
+    return i < nworkers ? i : nworkers;
+  }
+
+  __pool_task* pop(queue& q, bool back) {
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.tasks.empty()) {
+      return nullptr;
+    }
+    __pool_task* task;
+    if (back) {
+      task = q.tasks.back();
+      q.tasks.pop_back();
+    } else {
+      task = q.tasks.front();
+      q.tasks.pop_front();
+    }
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+  }
+
+  void worker_loop(size_t i) {
+    index() = i;
+    for (;;) {
+      __pool_task* task = take();
+      if (task != nullptr) {
+        task->run(task);
+        continue;
+      }
+      // 定时醒来再看一次, 与alloc.h中整理线程的等待方式相同
+      std::unique_lock<std::mutex> guard(sleep_lock);
+      wake.wait_for(guard, std::chrono::milliseconds(100), [this] {
+        return stop || queued.load(std::memory_order_acquire) != 0;
+      });
+      if (stop && queued.load(std::memory_order_acquire) == 0) {
+        return;
+      }
+    }
+  }
+
+  size_t nworkers;
+  size_t nqueues;
+  queue* queues;
+  std::thread* workers;
+  std::atomic<size_t> queued;  // 所有队列中的任务数, 空闲时不用逐个加锁查看
+  std::mutex sleep_lock;
+  std::condition_variable wake;
+  bool stop;
+};
+
+// 一组任务: 记录还没完成的任务数和第一个异常
+class __task_group {
+ public:
+  __task_group() : pending(0) {}
+
+  // 构造好的任务交给线程池; 放进队列时配置内存失败, 任务没有交出去, 计数要退回
+  void spawn(__pool_task* task) {
+    task->group = this;
+    pending.fetch_add(1, std::memory_order_relaxed);
+    try {
+      __thread_pool::instance().push(task);
+    } catch (...) {
+      pending.fetch_sub(1, std::memory_order_relaxed);
+      throw;
+    }
+  }
+
+  // 在当前线程执行f, 异常记录下来, 等wait之后再抛出
+  template <class Function>
+  void run_here(Function& f) {
+    try {
+      f();
+    } catch (...) {
+      set_error(std::current_exception());
+    }
+  }
+
+  // 等待所有任务完成, 期间执行线程池中的任务; 之后重新抛出第一个异常
+  void wait() {
+    __thread_pool& pool = __thread_pool::instance();
+    while (pending.load(std::memory_order_acquire) != 0) {
+      __pool_task* task = pool.take();
+      if (task != nullptr) {
+        task->run(task);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    if (error) {
+      std::exception_ptr e = error;
+      error = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+
+  // 任务执行结束时调用, 之后任务和任务组都可能已经失效
+  void finish() { pending.fetch_sub(1, std::memory_order_acq_rel); }
+
+  void set_error(std::exception_ptr e) {
+    std::lock_guard<std::mutex> guard(error_lock);
+    if (!error) {
+      error = e;
+    }
+  }
+
+ private:
+  __task_group(const __task_group&) = delete;
+  __task_group& operator=(const __task_group&) = delete;
+
+  std::atomic<size_t> pending;
+  std::mutex error_lock;
+  std::exception_ptr error;
+};
+
+// 执行一个函数对象的任务
+template <class Function>
+struct __function_task : __pool_task {
+  Function* f;
+
+  explicit __function_task(Function& fn) : f(&fn) { run = &invoke; }
+
+  static void invoke(__pool_task* t) {
+    __function_task* self = static_cast<__function_task*>(t);
+    __task_group* group = self->group;
+    group->run_here(*self->f);
+    group->finish();
+  }
+};
+
+// 执行f(i)的任务
+template <class Function>
+struct __index_task : __pool_task {
+  Function* f;
+  size_t i;
+
+  static void invoke(__pool_task* t) {
+    __index_task* self = static_cast<__index_task*>(t);
+    __task_group* group = self->group;
+    try {
+      (*self->f)(self->i);
+    } catch (...) {
+      group->set_error(std::current_exception());
+    }
+    group->finish();
+  }
+};
+
+// 并行执行f1和f2, 都完成后返回; f1交给线程池, f2在当前线程执行
+template <class Function1, class Function2>
+void __parallel_invoke(Function1& f1, Function2& f2) {
+  __task_group group;
+  __function_task<Function1> task(f1);
+  group.spawn(&task);
+  group.run_here(f2);
+  group.wait();
+}
+
+// 并行执行f(0), f(1), ..., f(n - 1), f(0)在当前线程执行
+template <class Function>
+void __parallel_for(size_t n, Function& f) {
+  if (n == 0) {
+    return;
+  }
+  typedef __index_task<Function> task_type;
+  typedef simple_alloc<task_type, __pool_alloc> task_allocator;
+  __task_group group;
+  task_type* tasks = n > 1 ? task_allocator::allocate(n - 1) : nullptr;
+  bool spawned = true;
+  try {
+    for (size_t i = n - 1; i > 0; --i) {
+      task_type* t = tasks + (i - 1);
+      t->run = &task_type::invoke;
+      t->f = &f;
+      t->i = i;
+      group.spawn(t);
+    }
+  } catch (...) {
+    // 已经交出去的任务还引用着group和tasks, 记下异常, 等它们结束后再抛出
+    group.set_error(std::current_exception());
+    spawned = false;
+  }
+  if (spawned) {
+    try {
+      f(0);
+    } catch (...) {
+      group.set_error(std::current_exception());
+    }
+  }
+  try {
+    group.wait();
+  } catch (...) {
+    if (tasks != nullptr) {
+      task_allocator::deallocate(tasks, n - 1);
+    }
+    throw;
+  }
+  if (tasks != nullptr) {
+    task_allocator::deallocate(tasks, n - 1);
+  }
+}
+
+}  // namespace ministl
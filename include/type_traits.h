@@ -1,5 +1,8 @@
 #pragma once
 
+#include <type_traits>
+#include <utility>
+
 namespace ministl {
 
 // 两个不包含任何成员的类，用于辅助实现type_traits模板
@@ -7,13 +10,37 @@ namespace ministl {
 struct _true_type {};
 struct _false_type {};
 
+template <bool B>
+struct __bool_type {
+  typedef _false_type type;
+};
+
+template <>
+struct __bool_type<true> {
+  typedef _true_type type;
+};
+
+// 一般的类型由编译器判断(<type_traits>背后是__is_trivially_copyable等内建函数),
+// 普通的结构体也能走memmove/memset的路径
+// is_POD_type: trivial(默认构造, 复制, 移动, 析构都是trivial的)且可以赋值,
+// 可以把未初始化的内存当作已构造的对象直接赋值或按字节复制
 template <typename type>
 struct type_traits {
-  typedef _false_type has_trivial_default_constructor;
-  typedef _false_type has_trivial_copy_constructtor;
-  typedef _false_type has_trivial_assignment_operator;
-  typedef _false_type has_trivial_destructor;
-  typedef _false_type is_POD_type;
+  typedef typename __bool_type<
+      std::is_trivially_default_constructible<type>::value>::type
+      has_trivial_default_constructor;
+  typedef typename __bool_type<
+      std::is_trivially_copy_constructible<type>::value>::type
+      has_trivial_copy_constructtor;
+  typedef typename __bool_type<
+      std::is_trivially_copy_assignable<type>::value &&
+      std::is_trivially_move_assignable<type>::value>::type
+      has_trivial_assignment_operator;
+  typedef typename __bool_type<
+      std::is_trivially_destructible<type>::value>::type has_trivial_destructor;
+  typedef typename __bool_type<std::is_trivial<type>::value &&
+                               std::is_copy_assignable<type>::value>::type
+      is_POD_type;
 };
 
 // 针对各种算术整型的特化版本
@@ -171,6 +198,39 @@ struct type_traits<type*> {
   typedef _true_type is_POD_type;
 };
 
+// 两个type_traits结果都是_true_type时才是_true_type, 用于pair一类的组合类型
+template <typename A, typename B>
+struct __and_type {
+  typedef _false_type type;
+};
+
+template <>
+struct __and_type<_true_type, _true_type> {
+  typedef _true_type type;
+};
+
+// 可以按字节搬移: 移动构造到新地址再析构原对象, 等同于memcpy到新地址后忘掉原对象
+// 默认是trivial复制且trivial析构的类型; 其他类型只要不保存指向自身的指针
+// (例如只持有堆指针的句柄, vector, deque), 可以特化成_true_type自行声明.
+// vector, small_vector扩容时用Alloc::reallocate或memcpy整块搬移,
+// flat_hash_map在rehash, btree在节点分裂合并时用memcpy/memmove搬移
+template <typename T>
+struct is_trivially_relocatable {
+  typedef typename __bool_type<std::is_trivially_copyable<T>::value &&
+                               std::is_trivially_destructible<T>::value>::type
+      type;
+};
+
+template <typename T>
+struct is_trivially_relocatable<const T> : is_trivially_relocatable<T> {};
+
+template <typename A, typename B>
+struct is_trivially_relocatable<std::pair<A, B>> {
+  typedef typename __and_type<typename is_trivially_relocatable<A>::type,
+                              typename is_trivially_relocatable<B>::type>::type
+      type;
+};
+
 // 一个辅助实现 true_type 和 false_type 的类
 template <typename T, T v>
 struct intergral_constant {
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "algobase.h"
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+
+namespace ministl {
+
+// 在未初始化的内存上批量构造对象, 根据type_traits分派:
+// POD类型直接赋值(交给algobase.h中的copy/fill, deque这样的分段迭代器逐段处理),
+// 原生指针上的POD类型进一步退化成memmove/memset;
+// 其他类型逐个构造, 任何一个构造函数抛出异常时析构已经构造好的对象再重新抛出
+// (commit or rollback)
+
+// uninitialized_copy: 把[first, last)复制到从result开始的未初始化内存, 返回结尾
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator uninitialized_copy_aux(InputIterator first,
+                                              InputIterator last,
+                                              ForwardIterator result,
+                                              _true_type) {
+  return ministl::copy(first, last, result);
+}
+
+template <class InputIterator, class ForwardIterator>
+ForwardIterator uninitialized_copy_aux(InputIterator first, InputIterator last,
+                                       ForwardIterator result, _false_type) {
+  ForwardIterator cur = result;
+  try {
+    for (; first != last; ++first, ++cur) {
+      construct(&*cur, *first);
+    }
+    return cur;
+  } catch (...) {
+    destroy(result, cur);
+    throw;
+  }
+}
+
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator uninitialized_copy(InputIterator first,
+                                          InputIterator last,
+                                          ForwardIterator result) {
+  typedef typename iterator_traits<ForwardIterator>::value_type T;
+  return uninitialized_copy_aux(first, last, result,
+                                typename type_traits<T>::is_POD_type());
+}
+
+// 连续内存上的POD类型, 整块memmove
+template <class T>
+inline T* uninitialized_copy_ptr(const T* first, const T* last, T* result,
+                                 _true_type) {
+  size_t n = last - first;
+  if (n != 0) {
+    memmove(result, first, n * sizeof(T));
+  }
+  return result + n;
+}
+
+template <class T>
+inline T* uninitialized_copy_ptr(const T* first, const T* last, T* result,
+                                 _false_type) {
+  return uninitialized_copy_aux(first, last, result, _false_type());
+}
+
+template <class T>
+inline T* uninitialized_copy(const T* first, const T* last, T* result) {
+  return uninitialized_copy_ptr(first, last, result,
+                                typename type_traits<T>::is_POD_type());
+}
+
+template <class T>
+inline T* uninitialized_copy(T* first, T* last, T* result) {
+  return uninitialized_copy_ptr((const T*)first, (const T*)last, result,
+                                typename type_traits<T>::is_POD_type());
+}
+
+// uninitialized_move: 与uninitialized_copy相同, 但以移动构造代替复制构造
+// 出现异常时已经被移走的源对象不会恢复
+template <class InputIterator, class ForwardIterator>
+ForwardIterator uninitialized_move_aux(InputIterator first, InputIterator last,
+                                       ForwardIterator result, _false_type) {
+  ForwardIterator cur = result;
+  try {
+    for (; first != last; ++first, ++cur) {
+      construct(&*cur, std::move(*first));
+    }
+    return cur;
+  } catch (...) {
+    destroy(result, cur);
+    throw;
+  }
+}
+
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator uninitialized_move_aux(InputIterator first,
+                                              InputIterator last,
+                                              ForwardIterator result,
+                                              _true_type) {
+  return uninitialized_copy_aux(first, last, result, _true_type());
+}
+
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator uninitialized_move(InputIterator first,
+                                          InputIterator last,
+                                          ForwardIterator result) {
+  typedef typename iterator_traits<ForwardIterator>::value_type T;
+  return uninitialized_move_aux(first, last, result,
+                                typename type_traits<T>::is_POD_type());
+}
+
+template <class T>
+inline T* uninitialized_move_ptr(T* first, T* last, T* result, _true_type) {
+  return uninitialized_copy_ptr((const T*)first, (const T*)last, result,
+                                _true_type());
+}
+
+template <class T>
+inline T* uninitialized_move_ptr(T* first, T* last, T* result, _false_type) {
+  return uninitialized_move_aux(first, last, result, _false_type());
+}
+
+template <class T>
+inline T* uninitialized_move(T* first, T* last, T* result) {
+  return uninitialized_move_ptr(first, last, result,
+                                typename type_traits<T>::is_POD_type());
+}
+
+// 经过move_iterator的uninitialized_copy就是uninitialized_move,
+// 底层是原生指针时仍然走上面的memmove
+template <class Iterator, class ForwardIterator>
+inline ForwardIterator uninitialized_copy(move_iterator<Iterator> first,
+                                          move_iterator<Iterator> last,
+                                          ForwardIterator result) {
+  return ministl::uninitialized_move(first.base(), last.base(), result);
+}
+
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator uninitialized_move_if_noexcept_aux(
+    InputIterator first, InputIterator last, ForwardIterator result,
+    std::true_type) {
+  return uninitialized_move(first, last, result);
+}
+
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator uninitialized_move_if_noexcept_aux(
+    InputIterator first, InputIterator last, ForwardIterator result,
+    std::false_type) {
+  return uninitialized_copy(first, last, result);
+}
+
+// uninitialized_move_if_noexcept: 移动构造不会抛出异常(或者不能复制)时移动, 否则复制,
+// 扩容时用它搬移元素, 出现异常时原来的元素完好无损
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator uninitialized_move_if_noexcept(InputIterator first,
+                                                      InputIterator last,
+                                                      ForwardIterator result) {
+  typedef typename iterator_traits<InputIterator>::value_type T;
+  typedef std::integral_constant<bool,
+                                 std::is_nothrow_move_constructible<T>::value ||
+                                     !std::is_copy_constructible<T>::value>
+      use_move;
+  return uninitialized_move_if_noexcept_aux(first, last, result, use_move());
+}
+
+// uninitialized_relocate: 把[first, last)搬到从result开始的未初始化内存,
+// 之后原来的位置是未初始化的内存, 返回结尾
+// is_trivially_relocatable的类型整块memcpy; 其他类型用uninitialized_move_if_noexcept
+// 搬过去之后再析构原来的元素, 出现异常时原来的元素完好无损
+template <class T>
+inline T* uninitialized_relocate_ptr(T* first, T* last, T* result,
+                                     _true_type) {
+  size_t n = last - first;
+  if (n != 0) {
+    memcpy((void*)result, (const void*)first, n * sizeof(T));
+  }
+  return result + n;
+}
+
+template <class T>
+inline T* uninitialized_relocate_ptr(T* first, T* last, T* result,
+                                     _false_type) {
+  T* new_finish = uninitialized_move_if_noexcept(first, last, result);
+  destroy(first, last);
+  return new_finish;
+}
+
+template <class T>
+inline T* uninitialized_relocate(T* first, T* last, T* result) {
+  return uninitialized_relocate_ptr(
+      first, last, result, typename is_trivially_relocatable<T>::type());
+}
+
+// uninitialized_value_construct_n: 从first开始值初始化(T())n个对象, 返回结尾
+// 每个对象就地构造, 不复制临时对象, 只能移动的类型也可以; POD类型交给fill_n
+template <class ForwardIterator, class Size>
+inline ForwardIterator uninitialized_value_construct_n_aux(
+    ForwardIterator first, Size n, _true_type) {
+  typedef typename iterator_traits<ForwardIterator>::value_type T;
+  return ministl::fill_n(first, n, T());
+}
+
+template <class ForwardIterator, class Size>
+ForwardIterator uninitialized_value_construct_n_aux(ForwardIterator first,
+                                                    Size n, _false_type) {
+  ForwardIterator cur = first;
+  try {
+    for (; n > 0; --n, ++cur) {
+      construct(&*cur);
+    }
+    return cur;
+  } catch (...) {
+    destroy(first, cur);
+    throw;
+  }
+}
+
+template <class ForwardIterator, class Size>
+inline ForwardIterator uninitialized_value_construct_n(ForwardIterator first,
+                                                       Size n) {
+  typedef typename iterator_traits<ForwardIterator>::value_type T;
+  return uninitialized_value_construct_n_aux(
+      first, n, typename type_traits<T>::is_POD_type());
+}
+
+// uninitialized_fill_n: 从first开始构造n个x的副本, 返回结尾
+template <class ForwardIterator, class Size, class T>
+inline ForwardIterator uninitialized_fill_n_aux(ForwardIterator first, Size n,
+                                                const T& x, _true_type) {
+  return ministl::fill_n(first, n, x);
+}
+
+template <class ForwardIterator, class Size, class T>
+ForwardIterator uninitialized_fill_n_aux(ForwardIterator first, Size n,
+                                         const T& x, _false_type) {
+  ForwardIterator cur = first;
+  try {
+    for (; n > 0; --n, ++cur) {
+      construct(&*cur, x);
+    }
+    return cur;
+  } catch (...) {
+    destroy(first, cur);
+    throw;
+  }
+}
+
+template <class ForwardIterator, class Size, class T>
+inline ForwardIterator uninitialized_fill_n(ForwardIterator first, Size n,
+                                            const T& x) {
+  typedef typename iterator_traits<ForwardIterator>::value_type value_type;
+  typedef typename type_traits<value_type>::is_POD_type is_POD;
+  return uninitialized_fill_n_aux(first, n, x, is_POD());
+}
+
+// 连续内存上的POD类型: 单字节类型或全0的值用memset, 其余的逐个赋值
+template <class T, class Size>
+inline T* uninitialized_fill_n_ptr(T* first, Size n, const T& x, _true_type) {
+  if (n <= 0) {
+    return first;
+  }
+  if (sizeof(T) == 1) {
+    memset(first, *(const unsigned char*)&x, (size_t)n);
+  } else if (is_zero_bytes(x)) {
+    memset(first, 0, (size_t)n * sizeof(T));
+  } else {
+    for (Size i = 0; i < n; ++i) {
+      first[i] = x;
+    }
+  }
+  return first + n;
+}
+
+template <class T, class Size>
+inline T* uninitialized_fill_n_ptr(T* first, Size n, const T& x,
+                                   _false_type) {
+  return uninitialized_fill_n_aux(first, n, x, _false_type());
+}
+
+template <class T, class Size, class U>
+inline T* uninitialized_fill_n(T* first, Size n, const U& x) {
+  const T value(x);
+  return uninitialized_fill_n_ptr(first, n, value,
+                                  typename type_traits<T>::is_POD_type());
+}
+
+// uninitialized_fill: 在[first, last)上构造x的副本
+template <class ForwardIterator, class T>
+inline void uninitialized_fill_aux(ForwardIterator first, ForwardIterator last,
+                                   const T& x, _true_type) {
+  ministl::fill(first, last, x);
+}
+
+template <class ForwardIterator, class T>
+void uninitialized_fill_aux(ForwardIterator first, ForwardIterator last,
+                            const T& x, _false_type) {
+  ForwardIterator cur = first;
+  try {
+    for (; cur != last; ++cur) {
+      construct(&*cur, x);
+    }
+  } catch (...) {
+    destroy(first, cur);
+    throw;
+  }
+}
+
+template <class ForwardIterator, class T>
+inline void uninitialized_fill(ForwardIterator first, ForwardIterator last,
+                               const T& x) {
+  typedef typename iterator_traits<ForwardIterator>::value_type value_type;
+  uninitialized_fill_aux(first, last, x,
+                         typename type_traits<value_type>::is_POD_type());
+}
+
+template <class T, class U>
+inline void uninitialized_fill(T* first, T* last, const U& x) {
+  uninitialized_fill_n(first, last - first, x);
+}
+
+}  // namespace ministl
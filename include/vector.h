@@ -0,0 +1,609 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+#include "uninitialized.h"
+
+namespace ministl {
+
+// 连续存储的动态数组, 空间由simple_alloc<T, Alloc>配置
+// 扩容时按元素能否按字节搬移分派:
+// 可以的(is_trivially_relocatable, 且alignof(T)不超过__ALIGN)直接调用Alloc::reallocate,
+// 同一等级内原地扩展, 大块内存用mremap, 都不需要逐个移动和析构;
+// 其余的在新空间中逐个移动构造(移动可能抛出异常时复制), 再析构旧元素,
+// 只是对齐要求高的is_trivially_relocatable类型仍然整块memcpy
+// 使用可以按字节搬移的T时, Alloc必须提供reallocate
+template <class T, class Alloc = alloc>
+class vector {
+ public:
+  typedef T value_type;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+  typedef value_type* iterator;
+  typedef const value_type* const_iterator;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef ministl::reverse_iterator<iterator, T> reverse_iterator;
+  typedef ministl::reverse_iterator<const_iterator, T, const T&>
+      const_reverse_iterator;
+
+ protected:
+  typedef simple_alloc<value_type, Alloc> data_allocator;
+  // 扩容时能否直接reallocate
+  typedef typename std::conditional<
+      (alignof(T) <= (size_t)__ALIGN),
+      typename is_trivially_relocatable<T>::type, _false_type>::type
+      relocatable;
+
+  iterator start;           // 已使用空间的头
+  iterator finish;          // 已使用空间的尾
+  iterator end_of_storage;  // 可用空间的尾
+
+  void deallocate() {
+    if (start) {
+      data_allocator::deallocate(start, end_of_storage - start);
+    }
+  }
+  // 再插入n个元素时新的容量: 至少翻倍
+  size_type next_capacity(size_type n) const {
+    size_type old_size = size();
+    if (max_size() - old_size < n) {
+      throw std::length_error("vector");
+    }
+    size_type len = old_size + (old_size > n ? old_size : n);
+    return (len < old_size || len > max_size()) ? max_size() : len;
+  }
+  // 把容量改成new_cap(不小于size()), 元素搬到新的空间
+  void reallocate_storage(size_type new_cap) {
+    reallocate_storage_aux(new_cap, relocatable());
+  }
+  void reallocate_storage_aux(size_type new_cap, _true_type) {
+    size_type n = size();
+    if (start == 0) {
+      start = data_allocator::allocate(new_cap);
+    } else {
+      start = data_allocator::reallocate(start, capacity(), new_cap);
+    }
+    finish = start + n;
+    end_of_storage = start + new_cap;
+  }
+  void reallocate_storage_aux(size_type new_cap, _false_type) {
+    iterator new_start = data_allocator::allocate(new_cap);
+    iterator new_finish;
+    try {
+      new_finish = uninitialized_relocate(start, finish, new_start);
+    } catch (...) {
+      data_allocator::deallocate(new_start, new_cap);
+      throw;
+    }
+    deallocate();
+    start = new_start;
+    finish = new_finish;
+    end_of_storage = new_start + new_cap;
+  }
+  // 空间已满时在尾部构造新元素, 参数可能引用本容器中的元素, 所以先构造再搬移旧元素
+  template <class... Args>
+  void emplace_back_aux(_true_type, Args&&... args) {
+    value_type tmp(std::forward<Args>(args)...);
+    reallocate_storage(next_capacity(1));
+    construct(finish, std::move(tmp));
+    ++finish;
+  }
+  template <class... Args>
+  void emplace_back_aux(_false_type, Args&&... args) {
+    size_type len = next_capacity(1);
+    iterator new_start = data_allocator::allocate(len);
+    try {
+      construct(new_start + size(), std::forward<Args>(args)...);
+    } catch (...) {
+      data_allocator::deallocate(new_start, len);
+      throw;
+    }
+    relocate_around(finish, 1, new_start, len);
+  }
+  // 分配n个元素的空间并用[first, last)初始化
+  template <class ForwardIterator>
+  iterator allocate_and_copy(size_type n, ForwardIterator first,
+                             ForwardIterator last) {
+    iterator result = data_allocator::allocate(n);
+    try {
+      ministl::uninitialized_copy(first, last, result);
+      return result;
+    } catch (...) {
+      data_allocator::deallocate(result, n);
+      throw;
+    }
+  }
+  void fill_initialize(size_type n, const T& value) {
+    start = data_allocator::allocate(n);
+    try {
+      finish = uninitialized_fill_n(start, n, value);
+    } catch (...) {
+      data_allocator::deallocate(start, n);
+      throw;
+    }
+    end_of_storage = finish;
+  }
+  // n个值初始化的元素, 就地构造
+  void value_initialize(size_type n) {
+    start = data_allocator::allocate(n);
+    try {
+      finish = uninitialized_value_construct_n(start, n);
+    } catch (...) {
+      data_allocator::deallocate(start, n);
+      throw;
+    }
+    end_of_storage = finish;
+  }
+  // vector(first, last)的两个参数都是整数时, 当作vector(n, value)
+  template <class Integer>
+  void range_initialize(Integer n, Integer value, std::true_type) {
+    fill_initialize((size_type)n, (T)value);
+  }
+  template <class InputIterator>
+  void range_initialize(InputIterator first, InputIterator last,
+                        std::false_type) {
+    range_initialize_aux(first, last, iterator_category(first));
+  }
+  template <class InputIterator>
+  void range_initialize_aux(InputIterator first, InputIterator last,
+                            input_iterator_tag) {
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  }
+  template <class ForwardIterator>
+  void range_initialize_aux(ForwardIterator first, ForwardIterator last,
+                            forward_iterator_tag) {
+    size_type n = (size_type)ministl::distance(first, last);
+    start = allocate_and_copy(n, first, last);
+    finish = start + n;
+    end_of_storage = finish;
+  }
+
+ public:
+  vector() : start(0), finish(0), end_of_storage(0) {}
+  vector(size_type n, const T& value) { fill_initialize(n, value); }
+  explicit vector(size_type n) { value_initialize(n); }
+  template <class InputIterator>
+  vector(InputIterator first, InputIterator last)
+      : start(0), finish(0), end_of_storage(0) {
+    range_initialize(first, last, std::is_integral<InputIterator>());
+  }
+  vector(std::initializer_list<T> il) : start(0), finish(0), end_of_storage(0) {
+    range_initialize_aux(il.begin(), il.end(), forward_iterator_tag());
+  }
+  vector(const vector& x) : start(0), finish(0), end_of_storage(0) {
+    range_initialize_aux(x.begin(), x.end(), forward_iterator_tag());
+  }
+  vector(vector&& x) noexcept
+      : start(x.start), finish(x.finish), end_of_storage(x.end_of_storage) {
+    x.start = x.finish = x.end_of_storage = 0;
+  }
+  ~vector() {
+    destroy(start, finish);
+    deallocate();
+  }
+
+  vector& operator=(const vector& x) {
+    if (&x != this) {
+      assign(x.begin(), x.end());
+    }
+    return *this;
+  }
+  vector& operator=(vector&& x) noexcept {
+    if (&x != this) {
+      destroy(start, finish);
+      deallocate();
+      start = x.start;
+      finish = x.finish;
+      end_of_storage = x.end_of_storage;
+      x.start = x.finish = x.end_of_storage = 0;
+    }
+    return *this;
+  }
+  vector& operator=(std::initializer_list<T> il) {
+    assign(il.begin(), il.end());
+    return *this;
+  }
+
+  iterator begin() { return start; }
+  const_iterator begin() const { return start; }
+  const_iterator cbegin() const { return start; }
+  iterator end() { return finish; }
+  const_iterator end() const { return finish; }
+  const_iterator cend() const { return finish; }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  size_type size() const { return size_type(finish - start); }
+  size_type max_size() const { return size_type(-1) / sizeof(T); }
+  size_type capacity() const { return size_type(end_of_storage - start); }
+  bool empty() const { return start == finish; }
+
+  reference operator[](size_type n) { return start[n]; }
+  const_reference operator[](size_type n) const { return start[n]; }
+  reference at(size_type n) {
+    if (n >= size()) {
+      throw std::out_of_range("vector");
+    }
+    return start[n];
+  }
+  const_reference at(size_type n) const {
+    if (n >= size()) {
+      throw std::out_of_range("vector");
+    }
+    return start[n];
+  }
+  reference front() { return *start; }
+  const_reference front() const { return *start; }
+  reference back() { return *(finish - 1); }
+  const_reference back() const { return *(finish - 1); }
+  T* data() { return start; }
+  const T* data() const { return start; }
+
+  // 预留至少n个元素的空间
+  void reserve(size_type n) {
+    if (n > max_size()) {
+      throw std::length_error("vector");
+    }
+    if (capacity() < n) {
+      reallocate_storage(n);
+    }
+  }
+  // 把容量缩小到size(), 空容器释放全部空间
+  void shrink_to_fit() {
+    if (finish == end_of_storage) {
+      return;
+    }
+    if (start == finish) {
+      deallocate();
+      start = finish = end_of_storage = 0;
+      return;
+    }
+    reallocate_storage(size());
+  }
+
+  template <class... Args>
+  reference emplace_back(Args&&... args) {
+    if (finish != end_of_storage) {
+      construct(finish, std::forward<Args>(args)...);
+      ++finish;
+    } else {
+      emplace_back_aux(relocatable(), std::forward<Args>(args)...);
+    }
+    return back();
+  }
+  void push_back(const T& x) { emplace_back(x); }
+  void push_back(T&& x) { emplace_back(std::move(x)); }
+  void pop_back() {
+    --finish;
+    destroy(finish);
+  }
+
+  // 在尾部追加[first, last), 先用distance算出个数, 只扩容一次,
+  // 之后不再逐个检查容量; 要求是前向迭代器, 且区间不在本容器内
+  template <class ForwardIterator>
+  void append(ForwardIterator first, ForwardIterator last) {
+    size_type n = (size_type)ministl::distance(first, last);
+    if (size_type(end_of_storage - finish) < n) {
+      reallocate_storage(next_capacity(n));
+    }
+    finish = ministl::uninitialized_copy(first, last, finish);
+  }
+
+  template <class... Args>
+  iterator emplace(const_iterator position, Args&&... args) {
+    size_type off = position - start;
+    if (position == finish) {
+      emplace_back(std::forward<Args>(args)...);
+    } else if (finish != end_of_storage) {
+      value_type tmp(std::forward<Args>(args)...);
+      construct(finish, std::move(*(finish - 1)));
+      ++finish;
+      ministl::move_backward(start + off, finish - 2, finish - 1);
+      start[off] = std::move(tmp);
+    } else {
+      value_type tmp(std::forward<Args>(args)...);
+      insert_aux(start + off, size_type(1), ministl::make_move_iterator(&tmp),
+                 std::true_type());
+    }
+    return start + off;
+  }
+  iterator insert(const_iterator position, const T& x) {
+    return emplace(position, x);
+  }
+  iterator insert(const_iterator position, T&& x) {
+    return emplace(position, std::move(x));
+  }
+  iterator insert(const_iterator position, size_type n, const T& x) {
+    size_type off = position - start;
+    fill_insert(start + off, n, x);
+    return start + off;
+  }
+  template <class InputIterator>
+  iterator insert(const_iterator position, InputIterator first,
+                  InputIterator last) {
+    size_type off = position - start;
+    range_insert(start + off, first, last, std::is_integral<InputIterator>());
+    return start + off;
+  }
+  iterator insert(const_iterator position, std::initializer_list<T> il) {
+    return insert(position, il.begin(), il.end());
+  }
+
+  iterator erase(const_iterator position) {
+    iterator pos = start + (position - start);
+    if (pos + 1 != finish) {
+      ministl::move(pos + 1, finish, pos);
+    }
+    pop_back();
+    return pos;
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    iterator f = start + (first - start);
+    // 空区间什么也不做, 否则后面的元素会移动赋值给自己
+    if (first == last) {
+      return f;
+    }
+    iterator l = start + (last - start);
+    iterator i = ministl::move(l, finish, f);
+    destroy(i, finish);
+    finish = i;
+    return f;
+  }
+  void clear() { erase(begin(), end()); }
+
+  void resize(size_type new_size, const T& x) {
+    if (new_size < size()) {
+      erase(begin() + new_size, end());
+    } else {
+      fill_insert(end(), new_size - size(), x);
+    }
+  }
+  // 新增的元素值初始化, 就地构造
+  void resize(size_type new_size) {
+    if (new_size < size()) {
+      erase(begin() + new_size, end());
+    } else if (new_size > size()) {
+      if (new_size > capacity()) {
+        reallocate_storage(next_capacity(new_size - size()));
+      }
+      finish = uninitialized_value_construct_n(finish, new_size - size());
+    }
+  }
+
+  void assign(size_type n, const T& value) {
+    vector tmp(n, value);
+    swap(tmp);
+  }
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    vector tmp(first, last);
+    swap(tmp);
+  }
+  void assign(std::initializer_list<T> il) { assign(il.begin(), il.end()); }
+
+  void swap(vector& x) noexcept {
+    std::swap(start, x.start);
+    std::swap(finish, x.finish);
+    std::swap(end_of_storage, x.end_of_storage);
+  }
+
+ protected:
+  // 在position插入n个x
+  void fill_insert(iterator position, size_type n, const T& x) {
+    if (n == 0) {
+      return;
+    }
+    if (size_type(end_of_storage - finish) >= n) {
+      // 空间足够, x可能引用本容器中的元素, 先复制一份
+      value_type x_copy(x);
+      const size_type elems_after = finish - position;
+      iterator old_finish = finish;
+      if (elems_after > n) {
+        uninitialized_move(finish - n, finish, finish);
+        finish += n;
+        ministl::move_backward(position, old_finish - n, old_finish);
+        ministl::fill(position, position + n, x_copy);
+      } else {
+        finish = uninitialized_fill_n(finish, n - elems_after, x_copy);
+        uninitialized_move(position, old_finish, finish);
+        finish += elems_after;
+        ministl::fill(position, old_finish, x_copy);
+      }
+    } else {
+      size_type len = next_capacity(n);
+      iterator new_start = data_allocator::allocate(len);
+      try {
+        uninitialized_fill_n(new_start + (position - start), n, x);
+      } catch (...) {
+        data_allocator::deallocate(new_start, len);
+        throw;
+      }
+      relocate_around(position, n, new_start, len);
+    }
+  }
+  // 在position插入[first, first + n), 区间不在本容器内
+  template <class ForwardIterator>
+  void insert_aux(iterator position, size_type n, ForwardIterator first,
+                  std::true_type) {
+    if (n == 0) {
+      return;
+    }
+    if (size_type(end_of_storage - finish) >= n) {
+      const size_type elems_after = finish - position;
+      iterator old_finish = finish;
+      if (elems_after > n) {
+        uninitialized_move(finish - n, finish, finish);
+        finish += n;
+        ministl::move_backward(position, old_finish - n, old_finish);
+        ForwardIterator last = first;
+        for (size_type i = 0; i < n; ++i) {
+          ++last;
+        }
+        ministl::copy(first, last, position);
+      } else {
+        ForwardIterator mid = first;
+        for (size_type i = 0; i < elems_after; ++i) {
+          ++mid;
+        }
+        finish = uninitialized_copy_n_aux(mid, n - elems_after, finish);
+        uninitialized_move(position, old_finish, finish);
+        finish += elems_after;
+        ministl::copy(first, mid, position);
+      }
+    } else {
+      size_type len = next_capacity(n);
+      iterator new_start = data_allocator::allocate(len);
+      try {
+        uninitialized_copy_n_aux(first, n, new_start + (position - start));
+      } catch (...) {
+        data_allocator::deallocate(new_start, len);
+        throw;
+      }
+      relocate_around(position, n, new_start, len);
+    }
+  }
+  // 扩容插入的后一半: 新空间中[position对应的位置, +n)已经构造好,
+  // 把原来的元素搬到它的两侧, 然后换上新空间
+  void relocate_around(iterator position, size_type n, iterator new_start,
+                       size_type len) {
+    relocate_around_aux(position, n, new_start, len,
+                        typename is_trivially_relocatable<T>::type());
+  }
+  void relocate_around_aux(iterator position, size_type n, iterator new_start,
+                           size_type len, _true_type) {
+    iterator mid = new_start + (position - start);
+    uninitialized_relocate(start, position, new_start);
+    iterator new_finish = uninitialized_relocate(position, finish, mid + n);
+    deallocate();
+    start = new_start;
+    finish = new_finish;
+    end_of_storage = new_start + len;
+  }
+  void relocate_around_aux(iterator position, size_type n, iterator new_start,
+                           size_type len, _false_type) {
+    iterator mid = new_start + (position - start);
+    iterator new_finish = mid + n;
+    try {
+      uninitialized_move_if_noexcept(start, position, new_start);
+    } catch (...) {
+      destroy(mid, mid + n);
+      data_allocator::deallocate(new_start, len);
+      throw;
+    }
+    try {
+      new_finish = uninitialized_move_if_noexcept(position, finish, new_finish);
+    } catch (...) {
+      destroy(new_start, mid + n);
+      data_allocator::deallocate(new_start, len);
+      throw;
+    }
+    destroy(start, finish);
+    deallocate();
+    start = new_start;
+    finish = new_finish;
+    end_of_storage = new_start + len;
+  }
+  template <class ForwardIterator>
+  static iterator uninitialized_copy_n_aux(ForwardIterator first, size_type n,
+                                           iterator result) {
+    iterator cur = result;
+    try {
+      for (; n > 0; --n, ++first, ++cur) {
+        construct(cur, *first);
+      }
+      return cur;
+    } catch (...) {
+      destroy(result, cur);
+      throw;
+    }
+  }
+  // p是否指向本容器中的元素
+  bool in_storage(const T* p) const {
+    return !std::less<const T*>()(p, start) && std::less<const T*>()(p, finish);
+  }
+  template <class U>
+  bool in_storage(const U*) const {
+    return false;
+  }
+  template <class Integer>
+  void range_insert(iterator position, Integer n, Integer x, std::true_type) {
+    fill_insert(position, (size_type)n, (T)x);
+  }
+  template <class InputIterator>
+  void range_insert(iterator position, InputIterator first, InputIterator last,
+                    std::false_type) {
+    range_insert_aux(position, first, last, iterator_category(first));
+  }
+  template <class InputIterator>
+  void range_insert_aux(iterator position, InputIterator first,
+                        InputIterator last, input_iterator_tag) {
+    // 输入迭代器只能遍历一次, 先收集起来
+    vector tmp(first, last);
+    insert_aux(position, tmp.size(), ministl::make_move_iterator(tmp.begin()),
+               std::true_type());
+  }
+  template <class ForwardIterator>
+  void range_insert_aux(iterator position, ForwardIterator first,
+                        ForwardIterator last, forward_iterator_tag) {
+    size_type n = (size_type)ministl::distance(first, last);
+    if (first == last || !in_storage(&*first)) {
+      insert_aux(position, n, first, std::true_type());
+    } else {
+      // 区间在本容器内, 插入会移动它, 先复制一份
+      vector tmp(first, last);
+      insert_aux(position, n, tmp.begin(), std::true_type());
+    }
+  }
+};
+
+template <class T, class Alloc>
+inline bool operator==(const vector<T, Alloc>& x, const vector<T, Alloc>& y) {
+  return x.size() == y.size() &&
+         ministl::equal(x.begin(), x.end(), y.begin());
+}
+
+template <class T, class Alloc>
+inline bool operator!=(const vector<T, Alloc>& x, const vector<T, Alloc>& y) {
+  return !(x == y);
+}
+
+template <class T, class Alloc>
+inline bool operator<(const vector<T, Alloc>& x, const vector<T, Alloc>& y) {
+  return ministl::lexicographical_compare(x.begin(), x.end(), y.begin(),
+                                          y.end());
+}
+
+template <class T, class Alloc>
+inline void swap(vector<T, Alloc>& x, vector<T, Alloc>& y) noexcept {
+  x.swap(y);
+}
+
+// 只保存指向堆上空间的指针, 可以按字节搬移
+template <class T, class Alloc>
+struct is_trivially_relocatable<vector<T, Alloc>> {
+  typedef _true_type type;
+};
+
+}  // namespace ministl
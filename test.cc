@@ -1,8 +1,47 @@
+// 打开内存池统计和分配跟踪, 让其他测试同时检验计数器和跟踪记录;
+// test_default目标把两者定义为0, 检验默认配置, 依赖它们的检查不编译
+#ifndef MINISTL_ALLOC_STATS
+#define MINISTL_ALLOC_STATS 1
+#endif
+#ifndef MINISTL_ALLOC_TRACE
+#define MINISTL_ALLOC_TRACE 1
+#endif
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <map>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "include/algo.h"
 #include "include/alloc.h"
 #include "include/allocator.h"
+#include "include/arena.h"
+#include "include/basic_string.h"
+#include "include/btree.h"
+#include "include/deque.h"
+#include "include/flat_hash_map.h"
+#include "include/list.h"
+#include "include/numeric.h"
+#include "include/page_source.h"
+#include "include/parallel.h"
+#include "include/slist.h"
+#include "include/uninitialized.h"
+#include "include/small_vector.h"
+#include "include/vector.h"
 
 using namespace ministl;
 
@@ -13,5 +52,2011 @@ TEST(test1, allocator_test) {
   alloc.construct(p++, "construct");
   EXPECT_EQ(str_ve[0], "construct");
   alloc.destroy(--p);
-  alloc.deallocate(str_ve);
+  alloc.deallocate(str_ve, 4);
+}
+
+TEST(test2, mt_alloc_test) {
+  typedef __default_alloc_template<true, 0> mt_alloc;
+  const int nthreads = 4;
+  const int nobjs = 1000;
+  // 每个线程分配的区块交给下一个线程释放, 覆盖跨线程回收
+  std::vector<std::vector<void*>> blocks(nthreads);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < nthreads; ++t) {
+    workers.emplace_back([&blocks, t]() {
+      for (int i = 0; i < nobjs; ++i) {
+        size_t n = (i % 16 + 1) * 8;
+        char* p = (char*)mt_alloc::allocate(n);
+        memset(p, t, n);
+        blocks[t].push_back(p);
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+  workers.clear();
+  for (int t = 0; t < nthreads; ++t) {
+    for (int i = 0; i < nobjs; ++i) {
+      size_t n = (i % 16 + 1) * 8;
+      char* p = (char*)blocks[t][i];
+      for (size_t j = 0; j < n; ++j) EXPECT_EQ(p[j], (char)t);
+    }
+  }
+  for (int t = 0; t < nthreads; ++t) {
+    workers.emplace_back([&blocks, t]() {
+      std::vector<void*>& mine = blocks[(t + 1) % nthreads];
+      for (int i = 0; i < nobjs; ++i) {
+        mt_alloc::deallocate(mine[i], (i % 16 + 1) * 8);
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+}
+
+TEST(test3, mt_alloc_producer_consumer_test) {
+  typedef __default_alloc_template<true, 1> mt_alloc;
+  const int nrounds = 200;
+  const int nobjs = 64;
+  // 生产者分配, 消费者释放, 所有回收都跨线程进行
+  std::atomic<void**> mailbox(nullptr);
+  std::thread producer([&mailbox]() {
+    for (int r = 0; r < nrounds; ++r) {
+      void** ptrs = new void*[nobjs];
+      for (int i = 0; i < nobjs; ++i) {
+        ptrs[i] = mt_alloc::allocate(24);
+        memset(ptrs[i], r & 0xff, 24);
+      }
+      void** expected = nullptr;
+      while (!mailbox.compare_exchange_weak(expected, ptrs)) {
+        expected = nullptr;
+        std::this_thread::yield();
+      }
+    }
+  });
+  std::thread consumer([&mailbox]() {
+    for (int r = 0; r < nrounds; ++r) {
+      void** ptrs;
+      while ((ptrs = mailbox.exchange(nullptr)) == nullptr) {
+        std::this_thread::yield();
+      }
+      for (int i = 0; i < nobjs; ++i) {
+        EXPECT_EQ(((unsigned char*)ptrs[i])[23], r & 0xff);
+        mt_alloc::deallocate(ptrs[i], 24);
+      }
+      delete[] ptrs;
+    }
+  });
+  producer.join();
+  consumer.join();
+}
+
+TEST(test4, size_class_test) {
+  const __size_class_map& map = __size_classes();
+  for (size_t n = 1; n <= __MAX_BYTES; ++n) {
+    size_t index = n <= 1024 ? map.small_index[(n + 7) >> 3]
+                             : map.large_index[(n + 127) >> 7];
+    size_t size = map.class_size[index];
+    ASSERT_GE(size, n);
+    if (index > 0) {
+      ASSERT_LT(map.class_size[index - 1], n);
+    }
+    // 128字节以上内部碎片不超过12.5%
+    if (n > __SMALL_BYTES) {
+      ASSERT_LE((size - n) * 8, n);
+    }
+  }
+  // slab中的大区块按页对齐切出, 写满整个区块不会越界
+  std::vector<std::pair<char*, size_t>> blocks;
+  for (size_t n = 129; n <= __MAX_BYTES; n = n * 5 / 4) {
+    for (int i = 0; i < 10; ++i) {
+      char* p = (char*)alloc::allocate(n);
+      memset(p, (int)(n & 0xff), n);
+      blocks.emplace_back(p, n);
+    }
+  }
+  for (auto& b : blocks) {
+    EXPECT_EQ((unsigned char)b.first[b.second - 1], b.second & 0xff);
+    alloc::deallocate(b.first, b.second);
+  }
+}
+
+TEST(test5, alloc_trim_test) {
+  typedef __default_alloc_template<false, 2> pool;
+  // 一次流量高峰: 大量小区块和slab区块, 之后全部释放
+  std::vector<void*> smalls, larges;
+  for (int i = 0; i < 20000; ++i) smalls.push_back(pool::allocate(64));
+  for (int i = 0; i < 500; ++i) larges.push_back(pool::allocate(2000));
+  void* survivor = pool::allocate(2000);
+  for (void* p : smalls) pool::deallocate(p, 64);
+  for (void* p : larges) pool::deallocate(p, 2000);
+  size_t released = pool::trim();
+  EXPECT_GT(released, 20000u * 64);
+  // 第二次没有可以归还的内存
+  EXPECT_EQ(pool::trim(), 0u);
+  // 归还之后照常分配, 仍在使用的区块不受影响
+  memset(survivor, 1, 2000);
+  for (int i = 0; i < 1000; ++i) {
+    char* p = (char*)pool::allocate(2000);
+    memset(p, 2, 2000);
+    smalls[i] = p;
+  }
+  EXPECT_EQ(((char*)survivor)[1999], 1);
+  for (int i = 0; i < 1000; ++i) pool::deallocate(smalls[i], 2000);
+  pool::deallocate(survivor, 2000);
+}
+
+TEST(test5, alloc_trim_tail_test) {
+  typedef __default_alloc_template<false, 13> pool;
+  // 区块大小不整除slab时, slab末尾的零头不影响归还
+  const size_t sizes[] = {144, 200, 1300};
+  for (size_t n : sizes) {
+    const __size_class_map& map = __size_classes();
+    size_t index = n <= 1024 ? map.small_index[(n + 7) >> 3]
+                             : map.large_index[(n + 127) >> 7];
+    ASSERT_NE(map.slab_bytes[index] % map.class_size[index], 0u);
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 2000; ++i) ptrs.push_back(pool::allocate(n));
+    for (void* p : ptrs) pool::deallocate(p, n);
+    EXPECT_GE(pool::trim(), 2000 * n);
+    EXPECT_EQ(pool::trim(), 0u);
+  }
+}
+
+TEST(test6, mt_alloc_background_trim_test) {
+  typedef __default_alloc_template<true, 3> mt_alloc;
+  mt_alloc::start_background_trim(1);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 4; ++t) {
+    workers.emplace_back([]() {
+      for (int r = 0; r < 20; ++r) {
+        std::vector<char*> ptrs;
+        for (int i = 0; i < 500; ++i) {
+          size_t n = 16 + (i % 40) * 100;
+          char* p = (char*)mt_alloc::allocate(n);
+          memset(p, i & 0xff, n);
+          ptrs.push_back(p);
+        }
+        for (int i = 0; i < 500; ++i) {
+          size_t n = 16 + (i % 40) * 100;
+          EXPECT_EQ(ptrs[i][n - 1], (char)(i & 0xff));
+          mt_alloc::deallocate(ptrs[i], n);
+        }
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+  mt_alloc::stop_background_trim();
+  // 所有线程都已退出, 它们的缓存已经归还, 内存可以全部还给系统
+  mt_alloc::trim();
+  EXPECT_EQ(mt_alloc::trim(), 0u);
+}
+
+TEST(test7, alloc_stats_test) {
+  typedef __default_alloc_template<false, 4> pool;
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) ptrs.push_back(pool::allocate(20));
+  void* large = pool::allocate(__MAX_BYTES + 1);
+  alloc_stats s = pool::get_stats();
+#if MINISTL_ALLOC_STATS
+  ASSERT_TRUE(s.enabled);
+  const alloc_class_stats& c = s.classes[2];  // 24字节的等级
+  EXPECT_EQ(c.size, 24u);
+  EXPECT_EQ(c.allocs, 100u);
+  EXPECT_EQ(c.in_use_objs, 100u);
+  EXPECT_EQ(c.misses + c.hits, 100u);
+  EXPECT_EQ(c.refills, c.misses);
+  EXPECT_EQ(s.in_use_bytes, 100u * 24);
+  EXPECT_EQ(s.requested_bytes, 100u * 20);
+  EXPECT_EQ(s.cached_bytes, c.cached_objs * 24);
+  EXPECT_EQ(s.large_allocs, 1u);
+  EXPECT_GE(s.heap_size, s.in_use_bytes + s.cached_bytes);
+  EXPECT_GT(s.internal_fragmentation(), 0.0);
+#else
+  // 没有编入计数器, 只有heap_size和内存块数有效
+  EXPECT_FALSE(s.enabled);
+  EXPECT_GT(s.heap_size, 0u);
+  EXPECT_GT(s.nchunks, 0u);
+#endif
+  for (void* p : ptrs) pool::deallocate(p, 20);
+  pool::deallocate(large, __MAX_BYTES + 1);
+  s = pool::get_stats();
+#if MINISTL_ALLOC_STATS
+  EXPECT_EQ(s.classes[2].frees, 100u);
+  EXPECT_EQ(s.in_use_bytes, 0u);
+  EXPECT_EQ(s.peak_in_use_bytes, 100u * 24);
+  EXPECT_EQ(s.large_in_use_bytes, 0u);
+  std::ostringstream text, json;
+  s.dump(text);
+  s.dump_json(json);
+  EXPECT_NE(text.str().find("peak 2400"), std::string::npos);
+  EXPECT_NE(json.str().find("\"peak_in_use_bytes\":2400"), std::string::npos);
+#else
+  std::ostringstream text;
+  s.dump(text);
+  EXPECT_NE(text.str().find("counters disabled"), std::string::npos);
+#endif
+}
+
+TEST(test8, mmap_page_source_test) {
+  typedef __default_alloc_template<false, 5, mmap_page_source<> > pool;
+  typedef __default_alloc_template<true, 5, huge_page_source> huge_pool;
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 5000; ++i) {
+    size_t n = 8 + (i % 64) * 200;
+    char* p = (char*)pool::allocate(n);
+    memset(p, 3, n);
+    ptrs.push_back(p);
+    // 系统没有预留大页时退回普通页
+    char* q = (char*)huge_pool::allocate(n);
+    memset(q, 4, n);
+    ptrs.push_back(q);
+  }
+  for (int i = 0; i < 5000; ++i) {
+    size_t n = 8 + (i % 64) * 200;
+    EXPECT_EQ(((char*)ptrs[2 * i])[n - 1], 3);
+    EXPECT_EQ(((char*)ptrs[2 * i + 1])[n - 1], 4);
+    pool::deallocate(ptrs[2 * i], n);
+    huge_pool::deallocate(ptrs[2 * i + 1], n);
+  }
+  EXPECT_GT(pool::trim(), 0u);
+  EXPECT_GT(huge_pool::trim(), 0u);
+  // 归还的地址区间可以再次使用
+  char* p = (char*)pool::allocate(100);
+  memset(p, 5, 100);
+  pool::deallocate(p, 100);
+}
+
+TEST(test9, arena_test) {
+  char buffer[256];
+  arena a(buffer, sizeof(buffer), 1024);
+  // 先用调用者提供的缓冲区
+  int* p = (int*)a.allocate(16 * sizeof(int));
+  EXPECT_TRUE((char*)p >= buffer && (char*)p < buffer + sizeof(buffer));
+  EXPECT_EQ(a.bytes_reserved(), 0u);
+  // 最近一次分配可以立即收回
+  a.deallocate(p, 16 * sizeof(int));
+  EXPECT_EQ(a.allocate(16 * sizeof(int)), (void*)p);
+  // 缓冲区用完后向系统要内存块, 大请求也能满足
+  for (int i = 0; i < 100; ++i) {
+    char* q = (char*)a.allocate(100);
+    memset(q, i, 100);
+  }
+  char* big = (char*)a.allocate(100000, 64);
+  EXPECT_EQ((size_t)big % 64, 0u);
+  memset(big, 1, 100000);
+  EXPECT_GT(a.bytes_reserved(), 100000u);
+  a.reset();
+  EXPECT_EQ(a.bytes_used(), 0u);
+  EXPECT_GT(a.bytes_reserved(), 0u);
+  a.release();
+  EXPECT_EQ(a.bytes_reserved(), 0u);
+  EXPECT_EQ(a.allocate(8), (void*)buffer);
+
+  // 通过simple_alloc使用当前线程绑定的arena
+  arena request_arena;
+  {
+    arena_alloc::scope s(request_arena);
+    typedef simple_alloc<int, arena_alloc> data_allocator;
+    int* data = data_allocator::allocate(1000);
+    for (int i = 0; i < 1000; ++i) data[i] = i;
+    EXPECT_EQ(data[999], 999);
+    EXPECT_GE(request_arena.bytes_used(), 1000 * sizeof(int));
+    data_allocator::deallocate(data, 1000);
+  }
+  // 换了绑定之后才回收: 不是当前arena分配的区块被忽略, 计数不会下溢
+  typedef simple_alloc<int, arena_alloc> int_allocator;
+  int* kept;
+  {
+    arena_alloc::scope s(request_arena);
+    kept = int_allocator::allocate(10);
+  }
+  size_t before = request_arena.bytes_used();
+  arena other;
+  {
+    arena_alloc::scope s(other);
+    other.allocate(16);
+    int_allocator::deallocate(kept, 10);
+  }
+  EXPECT_EQ(other.bytes_used(), 16u);
+  EXPECT_EQ(request_arena.bytes_used(), before);
+  request_arena.release();
+
+  // 绑定到arena的allocator也可以给标准容器用
+  arena vec_arena;
+  std::vector<double, arena_allocator<double>> v{
+      arena_allocator<double>(vec_arena)};
+  for (int i = 0; i < 1000; ++i) v.push_back(i * 0.5);
+  EXPECT_EQ(v[999], 499.5);
+  EXPECT_GT(vec_arena.bytes_reserved(), 1000 * sizeof(double));
+  // construct完美转发参数, 只能移动的类型也可以放进去
+  std::vector<std::unique_ptr<int>, arena_allocator<std::unique_ptr<int>>> u{
+      arena_allocator<std::unique_ptr<int>>(vec_arena)};
+  for (int i = 0; i < 100; ++i) u.push_back(std::unique_ptr<int>(new int(i)));
+  u.emplace_back(new int(100));
+  EXPECT_EQ(*u[100], 100);
+  EXPECT_EQ(*u[50], 50);
+}
+
+TEST(test10, allocator_cxx11_test) {
+  typedef std::allocator_traits<allocator<std::string>> traits;
+  static_assert(traits::is_always_equal::value, "stateless allocator");
+  static_assert(traits::propagate_on_container_move_assignment::value,
+                "move assignment steals storage");
+  static_assert(std::is_same<traits::rebind_alloc<int>, allocator<int>>::value,
+                "rebind");
+  // construct完美转发参数, 只能移动的类型也可以构造
+  allocator<std::unique_ptr<int>> a;
+  std::unique_ptr<int>* p = a.allocate(2);
+  a.construct(p, new int(7));
+  a.construct(p + 1, std::move(p[0]));
+  EXPECT_EQ(p[0], nullptr);
+  EXPECT_EQ(*p[1], 7);
+  a.destroy(p);
+  a.destroy(p + 1);
+  a.deallocate(p, 2);
+  // 字节数溢出时抛出异常, 不会回绕成一个小区块
+  EXPECT_THROW(a.allocate(a.max_size() + 1), std::bad_array_new_length);
+  EXPECT_THROW(allocator<double>().allocate(size_t(-1) / 4),
+               std::bad_array_new_length);
+  // 标准容器经由allocator_traits使用, 小的节点来自内存池
+  std::vector<std::string, allocator<std::string>> v;
+  for (int i = 0; i < 100; ++i) v.emplace_back(20, (char)('a' + i % 26));
+  std::vector<std::string, allocator<std::string>> w(std::move(v));
+  EXPECT_TRUE(v.empty());
+  EXPECT_EQ(w[25], std::string(20, 'z'));
+  std::map<int, int, std::less<int>, allocator<std::pair<const int, int>>> m;
+  for (int i = 0; i < 1000; ++i) m[i] = i * i;
+  EXPECT_EQ(m[999], 999 * 999);
+  // 和operator new一样可以在多个线程中同时配置和归还, 也可以跨线程归还
+  std::vector<std::vector<int, allocator<int>>> handoff(4);
+  std::atomic<int> bad(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < 2000; ++round) {
+        std::vector<int, allocator<int>> x(1 + round % 30, t);
+        std::map<int, int, std::less<int>,
+                 allocator<std::pair<const int, int>>>
+            y;
+        for (int i = 0; i < 8; ++i) y[i] = t;
+        if (x.back() != t || y[7] != t) bad.fetch_add(1);
+      }
+      handoff[t].assign(20, t);
+    });
+  }
+  for (auto& x : threads) x.join();
+  for (int t = 0; t < 4; ++t) EXPECT_EQ(handoff[t][19], t);
+  handoff.clear();
+  EXPECT_EQ(bad.load(), 0);
+}
+
+struct alignas(64) cache_line_counter {
+  long value;
+};
+
+TEST(test11, aligned_alloc_test) {
+  typedef __default_alloc_template<false, 6> pool;
+  const size_t aligns[] = {16, 32, 64, 128, 4096};
+  const size_t sizes[] = {1, 24, 100, 1000, 5000, 40000};
+  std::vector<std::pair<void*, std::pair<size_t, size_t>>> blocks;
+  for (size_t a : aligns) {
+    for (size_t n : sizes) {
+      for (int k = 0; k < 3; ++k) {
+        void* p = pool::allocate(n, a);
+        ASSERT_EQ((size_t)p % a, 0u) << "n=" << n << " align=" << a;
+        memset(p, 0x5a, n);
+        blocks.push_back(std::make_pair(p, std::make_pair(n, a)));
+      }
+    }
+  }
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    pool::deallocate(blocks[i].first, blocks[i].second.first,
+                     blocks[i].second.second);
+  }
+#if MINISTL_ALLOC_STATS
+  // 统计记录请求的字节数, 不是按对齐选出的等级的区块大小
+  void* r = pool::allocate(24, 64);
+  alloc_stats st = pool::get_stats();
+  EXPECT_EQ(st.requested_bytes, 24u);
+  EXPECT_EQ(st.in_use_bytes, 64u);
+  EXPECT_DOUBLE_EQ(st.internal_fragmentation(), 1.0 - 24.0 / 64);
+  pool::deallocate(r, 24, 64);
+  EXPECT_EQ(pool::get_stats().requested_bytes, 0u);
+#endif
+  // 按缓存行对齐的区块彼此不共享缓存行
+  void* prev = pool::allocate(64, 64);
+  for (int i = 0; i < 100; ++i) {
+    void* p = pool::allocate(64, 64);
+    EXPECT_EQ((size_t)p % 64, 0u);
+    size_t d = (char*)p > (char*)prev ? (char*)p - (char*)prev
+                                      : (char*)prev - (char*)p;
+    EXPECT_GE(d, 64u);
+    prev = p;
+  }
+  // 过度对齐的类型经由simple_alloc/allocator自动得到对齐
+  typedef simple_alloc<cache_line_counter, pool> counter_alloc;
+  cache_line_counter* c = counter_alloc::allocate(3);
+  EXPECT_EQ((size_t)c % 64, 0u);
+  counter_alloc::deallocate(c, 3);
+  std::vector<cache_line_counter, allocator<cache_line_counter>> v(17);
+  EXPECT_EQ((size_t)v.data() % 64, 0u);
+  arena ar;
+  arena_alloc::scope s(ar);
+  void* q = arena_alloc::allocate(10, 256);
+  EXPECT_EQ((size_t)q % 256, 0u);
+  arena_alloc::deallocate(q, 10, 256);
+}
+
+TEST(test12, reallocate_test) {
+  typedef __default_alloc_template<false, 7> pool;
+  // 同一个等级内原地伸缩
+  char* p = (char*)pool::allocate(20);
+  strcpy(p, "hello, ministl");
+  EXPECT_EQ(pool::reallocate(p, 20, 24), p);
+  EXPECT_EQ(pool::reallocate(p, 24, 17), p);
+  // 跨等级时复制内容
+  char* q = (char*)pool::reallocate(p, 17, 1000);
+  EXPECT_STREQ(q, "hello, ministl");
+  q = (char*)pool::reallocate(q, 1000, 100 * 1024);
+  EXPECT_STREQ(q, "hello, ministl");
+  // mmap得到的大区块经由mremap增长, 内容不变
+  size_t size = 100 * 1024;
+  for (size_t next = 512 * 1024; next <= 64 * 1024 * 1024; next *= 4) {
+    q = (char*)pool::reallocate(q, size, next);
+    EXPECT_EQ((size_t)q % __PAGE_SIZE, 0u);
+    q[next - 1] = 'x';
+    size = next;
+  }
+  EXPECT_STREQ(q, "hello, ministl");
+  EXPECT_EQ(q[size - 1], 'x');
+#if MINISTL_ALLOC_STATS
+  EXPECT_EQ(pool::get_stats().large_in_use_bytes, size);
+#endif
+  q = (char*)pool::reallocate(q, size, 64);
+  EXPECT_STREQ(q, "hello, ministl");
+#if MINISTL_ALLOC_STATS
+  EXPECT_EQ(pool::get_stats().large_in_use_bytes, 0u);
+#endif
+  pool::deallocate(q, 64);
+  // 多线程版本同样适用
+  typedef __default_alloc_template<true, 7> mt_pool;
+  int* v = (int*)mt_pool::allocate(sizeof(int));
+  size_t n = 1;
+  v[0] = 0;
+  while (n < 1000000) {
+    v = (int*)mt_pool::reallocate(v, n * sizeof(int), 2 * n * sizeof(int));
+    for (size_t i = n; i < 2 * n; ++i) v[i] = (int)i;
+    n *= 2;
+  }
+  for (size_t i = 0; i < n; i += 4099) EXPECT_EQ(v[i], (int)i);
+  mt_pool::deallocate(v, n * sizeof(int));
+}
+
+TEST(test13, alloc_trace_test) {
+  typedef __default_alloc_template<true, 8> pool;
+  std::string path = ::testing::TempDir() + "ministl_alloc_trace_test.bin";
+  ASSERT_TRUE(alloc_trace_open(path.c_str()));
+  std::vector<void*> blocks;
+  for (size_t i = 0; i < 3000; ++i) {
+    blocks.push_back(pool::allocate(i % 200 + 1));
+  }
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    pool::deallocate(blocks[i], i % 200 + 1);
+  }
+  // 其他线程的记录在线程退出时写出
+  std::thread t([] {
+    void* p = pool::allocate(100000);
+    pool::deallocate(p, 100000);
+  });
+  t.join();
+  alloc_trace_close();
+  std::vector<alloc_trace_event> events;
+  ASSERT_TRUE(alloc_trace_read(path.c_str(), events));
+#if MINISTL_ALLOC_TRACE
+  size_t allocs = 0, frees = 0, large = 0;
+  for (size_t i = 0; i < events.size(); ++i) {
+    if (events[i].inst != 8) continue;
+    if (events[i].op == alloc_trace_event::ALLOCATE) ++allocs;
+    if (events[i].op == alloc_trace_event::DEALLOCATE) ++frees;
+    if (events[i].size == 100000) ++large;
+  }
+  EXPECT_EQ(allocs, 3001u);
+  EXPECT_EQ(frees, 3001u);
+  EXPECT_EQ(large, 2u);
+  EXPECT_EQ(events[0].addr, (uint64_t)(uintptr_t)blocks[0]);
+  EXPECT_EQ(events[0].size, 1u);
+  // 关闭之后不再记录
+  pool::deallocate(pool::allocate(8), 8);
+  std::vector<alloc_trace_event> again;
+  ASSERT_TRUE(alloc_trace_read(path.c_str(), again));
+  EXPECT_EQ(again.size(), events.size());
+#else
+  // 没有编入跟踪, 文件里只有文件头
+  EXPECT_TRUE(events.empty());
+#endif
+  std::remove(path.c_str());
+}
+
+// 第throw_at次复制时抛出异常, 用live统计存活的对象
+struct fragile {
+  static int live;
+  static int copies;
+  static int throw_at;
+  int value;
+  explicit fragile(int v = 0) : value(v) { ++live; }
+  fragile(const fragile& other) : value(other.value) {
+    if (++copies == throw_at) throw std::runtime_error("copy");
+    ++live;
+  }
+  ~fragile() { --live; }
+};
+int fragile::live = 0;
+int fragile::copies = 0;
+int fragile::throw_at = -1;
+
+TEST(test14, uninitialized_test) {
+  // POD类型走memmove/memset
+  int src[100];
+  for (int i = 0; i < 100; ++i) src[i] = i;
+  int dst[100];
+  EXPECT_EQ(uninitialized_copy(src, src + 100, dst), dst + 100);
+  EXPECT_EQ(std::vector<int>(dst, dst + 100), std::vector<int>(src, src + 100));
+  const int* csrc = src;
+  EXPECT_EQ(uninitialized_copy(csrc, csrc + 10, dst + 50), dst + 60);
+  EXPECT_EQ(uninitialized_move(src, src + 10, dst), dst + 10);
+  EXPECT_EQ(uninitialized_fill_n(dst, 100, 0), dst + 100);
+  EXPECT_EQ(std::count(dst, dst + 100, 0), 100);
+  uninitialized_fill(dst, dst + 50, 7);
+  EXPECT_EQ(std::count(dst, dst + 100, 7), 50);
+  char buf[16];
+  uninitialized_fill_n(buf, 16, 'x');
+  EXPECT_EQ(std::string(buf, 16), std::string(16, 'x'));
+  // 非指针迭代器上的POD路径, std的迭代器会经ADL找到std::uninitialized_copy, 需要限定名字
+  std::vector<double> dv(10, 1.5);
+  std::list<double> dl(dv.begin(), dv.end());
+  double dd[10];
+  ministl::uninitialized_copy(dl.begin(), dl.end(), dd);
+  EXPECT_EQ(dd[9], 1.5);
+
+  // 非POD类型逐个构造/移动/析构
+  typedef simple_alloc<std::string, alloc> string_alloc;
+  std::string* strs = string_alloc::allocate(8);
+  uninitialized_fill_n(strs, 4, std::string(40, 'a'));
+  std::string* moved = string_alloc::allocate(4);
+  uninitialized_move(strs, strs + 4, moved);
+  EXPECT_EQ(moved[3], std::string(40, 'a'));
+  EXPECT_TRUE(strs[3].empty());
+  uninitialized_copy(moved, moved + 4, strs + 4);
+  EXPECT_EQ(strs[7], std::string(40, 'a'));
+  destroy(strs, strs + 8);
+  destroy(moved, moved + 4);
+  string_alloc::deallocate(strs, 8);
+  string_alloc::deallocate(moved, 4);
+
+  // 构造到一半抛出异常时, 已经构造的对象全部析构
+  fragile proto(3);
+  std::allocator<fragile> fa;
+  fragile* f = fa.allocate(10);
+  fragile::copies = 0;
+  fragile::throw_at = 6;
+  EXPECT_THROW(uninitialized_fill_n(f, 10, proto), std::runtime_error);
+  EXPECT_EQ(fragile::live, 1);
+  std::vector<fragile> many(8);
+  fragile::copies = 0;
+  fragile::throw_at = 4;
+  EXPECT_THROW(ministl::uninitialized_copy(many.begin(), many.end(), f),
+               std::runtime_error);
+  EXPECT_EQ(fragile::live, 9);
+  fragile::throw_at = -1;
+  fa.deallocate(f, 10);
+}
+
+TEST(test15, vector_test) {
+  // POD类型: 扩容经由reallocate
+  vector<int> v;
+  for (int i = 0; i < 100000; ++i) v.push_back(i);
+  EXPECT_EQ(v.size(), 100000u);
+  EXPECT_GE(v.capacity(), v.size());
+  for (int i = 0; i < 100000; i += 997) EXPECT_EQ(v[i], i);
+  // 参数引用容器自己的元素
+  vector<int> w(1, 42);
+  for (int i = 0; i < 10; ++i) w.push_back(w[0]);
+  EXPECT_EQ(std::count(w.begin(), w.end(), 42), 11);
+  w.insert(w.begin() + 1, 3, w.back());
+  EXPECT_EQ(w.size(), 14u);
+  w.insert(w.begin(), w.begin(), w.begin() + 2);
+  EXPECT_EQ(w.size(), 16u);
+  // reserve/shrink_to_fit
+  vector<double> d;
+  d.reserve(1000);
+  EXPECT_EQ(d.capacity(), 1000u);
+  d.assign(10, 2.5);
+  EXPECT_EQ(d.size(), 10u);
+  d.reserve(5000);
+  d.shrink_to_fit();
+  EXPECT_EQ(d.capacity(), 10u);
+  EXPECT_EQ(d.back(), 2.5);
+  // append只扩容一次
+  int raw[300];
+  for (int i = 0; i < 300; ++i) raw[i] = i;
+  vector<int> a{1, 2, 3};
+  a.append(raw, raw + 300);
+  EXPECT_EQ(a.size(), 303u);
+  EXPECT_EQ(a[302], 299);
+  vector<int> b(a.begin(), a.end());
+  EXPECT_TRUE(a == b);
+  b.erase(b.begin(), b.begin() + 3);
+  EXPECT_EQ(b.front(), 0);
+  b.erase(b.begin() + 10);
+  EXPECT_EQ(b[10], 11);
+  EXPECT_TRUE(a != b);
+  EXPECT_THROW(b.at(1000), std::out_of_range);
+  vector<int> five(5, 5);
+  EXPECT_EQ(five.size(), 5u);
+  EXPECT_EQ(five[4], 5);
+
+  // 非POD类型: 逐个移动
+  vector<std::string> s;
+  for (int i = 0; i < 1000; ++i) s.emplace_back(30, (char)('a' + i % 26));
+  s.insert(s.begin(), "front");
+  s.emplace(s.begin() + 2, 3, 'x');
+  EXPECT_EQ(s[0], "front");
+  EXPECT_EQ(s[2], "xxx");
+  EXPECT_EQ(s.back(), std::string(30, 'a' + 999 % 26));
+  s.resize(10);
+  s.resize(20, "y");
+  EXPECT_EQ(s[19], "y");
+  // 空区间的erase什么也不做, 元素不能移动给自己
+  vector<std::string> before(s);
+  EXPECT_TRUE(s.erase(s.begin() + 2, s.begin() + 2) == s.begin() + 2);
+  EXPECT_TRUE(s == before);
+  vector<std::string> t(std::move(s));
+  EXPECT_TRUE(s.empty());
+  EXPECT_EQ(t.size(), 20u);
+  s = t;
+  EXPECT_TRUE(s == t);
+  s.clear();
+  EXPECT_TRUE(s.empty());
+  s.shrink_to_fit();
+  EXPECT_EQ(s.capacity(), 0u);
+  // 只能移动的类型
+  vector<std::unique_ptr<int>> u;
+  for (int i = 0; i < 100; ++i) u.emplace_back(new int(i));
+  u.erase(u.begin() + 50);
+  EXPECT_EQ(*u[50], 51);
+  vector<std::unique_ptr<int>> nulls(10);
+  nulls.resize(100);
+  EXPECT_EQ(nulls.size(), 100u);
+  EXPECT_TRUE(nulls[99] == nullptr);
+  nulls.resize(5);
+  EXPECT_EQ(nulls.size(), 5u);
+  // vector(n)和resize(n)就地值初始化, 不复制临时对象
+  fragile::copies = 0;
+  {
+    vector<fragile> g(10);
+    EXPECT_EQ(fragile::copies, 0);
+    g.reserve(40);
+    fragile::copies = 0;
+    g.resize(30);
+    EXPECT_EQ(g[29].value, 0);
+    EXPECT_EQ(fragile::copies, 0);
+  }
+  vector<int> zeros(100, 7);
+  zeros.resize(10);
+  zeros.resize(1000);
+  EXPECT_EQ(zeros[9], 7);
+  EXPECT_EQ(zeros[999], 0);
+  // 复制可能抛出异常时, 扩容失败不影响原来的元素
+  fragile::live = 0;
+  {
+    vector<fragile> f;
+    f.reserve(4);
+    for (int i = 0; i < 4; ++i) f.emplace_back(i);
+    fragile::copies = 0;
+    fragile::throw_at = 3;
+    EXPECT_THROW(f.emplace_back(9), std::runtime_error);
+    fragile::throw_at = -1;
+    EXPECT_EQ(f.size(), 4u);
+    EXPECT_EQ(f[3].value, 3);
+    EXPECT_EQ(fragile::live, 4);
+  }
+  EXPECT_EQ(fragile::live, 0);
+}
+
+TEST(test16, small_vector_test) {
+  typedef __default_alloc_template<false, 9> pool;
+  // 不超过N个元素时不访问配置器
+  small_vector<int, 8, pool> v;
+  for (int i = 0; i < 8; ++i) v.push_back(i);
+  EXPECT_TRUE(v.is_inline());
+  EXPECT_EQ(v.capacity(), 8u);
+#if MINISTL_ALLOC_STATS
+  EXPECT_EQ(pool::get_stats().in_use_bytes, 0u);
+#endif
+  v.push_back(8);
+  EXPECT_FALSE(v.is_inline());
+#if MINISTL_ALLOC_STATS
+  EXPECT_GT(pool::get_stats().in_use_bytes, 0u);
+#endif
+  for (int i = 9; i < 1000; ++i) v.push_back(i);
+  for (int i = 0; i < 1000; i += 37) EXPECT_EQ(v[i], i);
+  // 在堆上时移动是O(1)的
+  const int* data = v.data();
+  small_vector<int, 8, pool> m(std::move(v));
+  EXPECT_EQ(m.data(), data);
+  EXPECT_TRUE(v.empty());
+  EXPECT_TRUE(v.is_inline());
+  m.erase(m.begin() + 4, m.end());
+  m.shrink_to_fit();
+  EXPECT_TRUE(m.is_inline());
+#if MINISTL_ALLOC_STATS
+  EXPECT_EQ(pool::get_stats().in_use_bytes, 0u);
+#endif
+  EXPECT_TRUE(m == (small_vector<int, 8, pool>{0, 1, 2, 3}));
+  m.insert(m.begin() + 1, 3, m[3]);
+  EXPECT_TRUE(m == (small_vector<int, 8, pool>{0, 3, 3, 3, 1, 2, 3}));
+  m.insert(m.begin(), m.begin(), m.end());
+  EXPECT_EQ(m.size(), 14u);
+  EXPECT_EQ(m[7], 0);
+  m.emplace(m.end() - 1, 42);
+  EXPECT_EQ(m[13], 42);
+  EXPECT_EQ(m.back(), 3);
+
+  // 非POD类型, 内联和堆上互相交换
+  small_vector<std::string, 4> a{"a", "b"};
+  small_vector<std::string, 4> b;
+  for (int i = 0; i < 10; ++i) b.emplace_back(20, (char)('a' + i));
+  a.swap(b);
+  EXPECT_EQ(a.size(), 10u);
+  EXPECT_EQ(b.size(), 2u);
+  EXPECT_TRUE(b.is_inline());
+  EXPECT_EQ(b[1], "b");
+  EXPECT_EQ(a[9], std::string(20, 'j'));
+  small_vector<std::string, 4> c(b);
+  c = std::move(b);
+  EXPECT_EQ(c[0], "a");
+  c.resize(6, "z");
+  EXPECT_EQ(c[5], "z");
+  c.insert(c.begin(), {"x", "y"});
+  EXPECT_EQ(c[0], "x");
+  EXPECT_EQ(c[2], "a");
+  // 空区间的erase什么也不做, 元素不能移动给自己
+  small_vector<std::string, 4> before(c);
+  EXPECT_TRUE(c.erase(c.begin() + 2, c.begin() + 2) == c.begin() + 2);
+  EXPECT_TRUE(c == before);
+  small_vector<std::unique_ptr<int>, 2> u;
+  for (int i = 0; i < 5; ++i) u.emplace_back(new int(i));
+  small_vector<std::unique_ptr<int>, 2> w(std::move(u));
+  EXPECT_EQ(*w[4], 4);
+  // small_vector(n)和resize(n)就地值初始化, 只能移动的类型也可以
+  small_vector<std::unique_ptr<int>, 4> up(3);
+  EXPECT_TRUE(up[2] == nullptr);
+  up.resize(50);
+  up[49].reset(new int(49));
+  EXPECT_EQ(*up[49], 49);
+  up.resize(2);
+  EXPECT_EQ(up.size(), 2u);
+}
+
+// 按C字符串查找std::string键, 不构造临时的std::string
+static int str_hash_cstr_calls = 0;
+struct str_hash {
+  typedef void is_transparent;
+  size_t operator()(const std::string& s) const {
+    return std::hash<std::string>()(s);
+  }
+  size_t operator()(const char* s) const {
+    ++str_hash_cstr_calls;
+    return std::hash<std::string>()(std::string(s));
+  }
+};
+struct str_eq {
+  typedef void is_transparent;
+  bool operator()(const std::string& a, const std::string& b) const {
+    return a == b;
+  }
+  bool operator()(const std::string& a, const char* b) const {
+    return a == b;
+  }
+};
+
+TEST(test17, flat_hash_map_test) {
+  using namespace ministl;
+  flat_hash_map<int, int> m;
+  EXPECT_TRUE(m.empty());
+  EXPECT_TRUE(m.find(1) == m.end());
+  EXPECT_EQ(m.erase(1), 0u);
+  std::unordered_map<int, int> ref;
+  unsigned seed = 1;
+  for (int i = 0; i < 200000; ++i) {
+    seed = seed * 1103515245 + 12345;
+    int k = (int)(seed >> 16) % 5000;
+    if (seed & 1) {
+      m[k] = i;
+      ref[k] = i;
+    } else {
+      EXPECT_EQ(m.erase(k), ref.erase(k));
+    }
+  }
+  // 大量删除后墓碑不会让表无限增长
+  EXPECT_LE(m.capacity(), 16384u);
+  EXPECT_EQ(m.size(), ref.size());
+  size_t n = 0;
+  for (flat_hash_map<int, int>::iterator it = m.begin(); it != m.end(); ++it) {
+    EXPECT_EQ(ref[it->first], it->second);
+    ++n;
+  }
+  EXPECT_EQ(n, ref.size());
+  for (auto& kv : ref) {
+    EXPECT_EQ(m.at(kv.first), kv.second);
+  }
+  EXPECT_THROW(m.at(-1), std::out_of_range);
+
+  flat_hash_map<int, int> c(m);
+  EXPECT_TRUE(c == m);
+  c[-1] = 1;
+  EXPECT_TRUE(c != m);
+  c.clear();
+  EXPECT_TRUE(c.empty());
+  EXPECT_TRUE(c.begin() == c.end());
+  c = std::move(m);
+  EXPECT_EQ(c.size(), ref.size());
+  c.rehash(0);
+  EXPECT_EQ(c.size(), ref.size());
+  c.reserve(100000);
+  size_t cap = c.capacity();
+  for (int i = 0; i < 100000; ++i) c.insert({i, i});
+  EXPECT_EQ(c.capacity(), cap);
+
+  // 非POD的键和值, 迭代中删除
+  flat_hash_map<std::string, std::string, str_hash, str_eq> s{
+      {"one", "1"}, {"two", "2"}, {"three", "3"}};
+  EXPECT_FALSE(s.emplace("one", "x").second);
+  EXPECT_TRUE(s.try_emplace("four", 4, '4').second);
+  EXPECT_EQ(s["four"], "4444");
+  EXPECT_FALSE(s.insert_or_assign("two", "22").second);
+  EXPECT_TRUE(s.contains("two"));
+  int calls = str_hash_cstr_calls;
+  EXPECT_EQ(s.find("two")->second, "22");
+  EXPECT_EQ(str_hash_cstr_calls, calls + 1);
+  EXPECT_EQ(s.count(std::string("three")), 1u);
+  EXPECT_EQ(s.erase("three"), 1u);
+  for (int i = 0; i < 100; ++i) s[std::to_string(i)] = std::string(30, 'v');
+  for (auto it = s.begin(); it != s.end();) {
+    if (it->second.size() == 30) {
+      it = s.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  EXPECT_EQ(s.size(), 3u);
+  EXPECT_EQ(s.at("one"), "1");
+
+  flat_hash_set<int> a{1, 2, 3};
+  flat_hash_set<int> b;
+  for (int i = 3; i > 0; --i) b.insert(i);
+  EXPECT_TRUE(a == b);
+  EXPECT_FALSE(a.insert(2).second);
+  EXPECT_EQ(*a.find(2), 2);
+  a.erase(a.find(2));
+  EXPECT_FALSE(a.contains(2));
+  EXPECT_TRUE(a != b);
+  flat_hash_set<std::string> strs;
+  for (int i = 0; i < 1000; ++i) strs.emplace(std::to_string(i % 100));
+  EXPECT_EQ(strs.size(), 100u);
+}
+
+TEST(test18, btree_test) {
+  using namespace ministl;
+  btree_map<int, int> m;
+  EXPECT_TRUE(m.begin() == m.end());
+  EXPECT_EQ(m.erase(1), 0u);
+  std::map<int, int> ref;
+  unsigned seed = 7;
+  for (int i = 0; i < 300000; ++i) {
+    seed = seed * 1103515245 + 12345;
+    int k = (int)(seed >> 16) % 20000;
+    if (seed & 3) {
+      m[k] = i;
+      ref[k] = i;
+    } else {
+      EXPECT_EQ(m.erase(k), ref.erase(k));
+    }
+  }
+  ASSERT_EQ(m.size(), ref.size());
+  EXPECT_TRUE(std::equal(ref.begin(), ref.end(), m.begin()));
+  // 反向遍历
+  auto r = ref.rbegin();
+  for (auto it = m.end(); it != m.begin();) {
+    --it;
+    EXPECT_EQ(it->first, r->first);
+    ++r;
+  }
+  EXPECT_EQ(m.lower_bound(-1)->first, ref.begin()->first);
+  EXPECT_TRUE(m.upper_bound(20000) == m.end());
+  for (int k = 0; k < 20000; k += 97) {
+    auto a = ref.lower_bound(k);
+    auto b = m.lower_bound(k);
+    EXPECT_EQ(a == ref.end(), b == m.end());
+    if (a != ref.end()) {
+      EXPECT_EQ(a->first, b->first);
+    }
+    a = ref.upper_bound(k);
+    b = m.upper_bound(k);
+    if (a != ref.end()) {
+      EXPECT_EQ(a->first, b->first);
+    }
+  }
+  // erase返回下一个元素, 删掉所有奇数键
+  for (auto it = m.begin(); it != m.end();) {
+    if (it->first & 1) {
+      int k = it->first;
+      it = m.erase(it);
+      auto next = ref.upper_bound(k);
+      if (next == ref.end()) {
+        EXPECT_TRUE(it == m.end());
+      } else {
+        EXPECT_EQ(it->first, next->first);
+      }
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = ref.begin(); it != ref.end();) {
+    it = (it->first & 1) ? ref.erase(it) : std::next(it);
+  }
+  ASSERT_EQ(m.size(), ref.size());
+  EXPECT_TRUE(std::equal(ref.begin(), ref.end(), m.begin()));
+  EXPECT_THROW(m.at(1), std::out_of_range);
+  btree_map<int, int> c(m);
+  EXPECT_TRUE(c == m);
+  c.erase(c.begin(), c.end());
+  EXPECT_TRUE(c.empty());
+  EXPECT_TRUE(c < m);
+
+  // 有序输入追加建树, 叶子几乎全满, 树高最小
+  std::vector<int> sorted(100000);
+  for (int i = 0; i < 100000; ++i) sorted[i] = i * 2;
+  btree_set<int> s(sorted.begin(), sorted.end());
+  EXPECT_EQ(s.size(), sorted.size());
+  EXPECT_EQ(s.height(), 3u);
+  EXPECT_TRUE(std::equal(sorted.begin(), sorted.end(), s.begin()));
+  EXPECT_EQ(*s.find(5000), 5000);
+  EXPECT_TRUE(s.find(5001) == s.end());
+  EXPECT_EQ(*s.lower_bound(5001), 5002);
+  while (s.size() > 10) s.erase(s.begin());
+  EXPECT_EQ(*s.begin(), 199980);
+  EXPECT_EQ(s.height(), 1u);
+
+  // 非POD元素, 每个节点只能放几个, 树很深
+  btree_map<std::string, std::string, std::less<>> t;
+  std::map<std::string, std::string> tr;
+  for (int i = 0; i < 5000; ++i) {
+    std::string k = std::to_string(i * 7919 % 5000);
+    t.try_emplace(k, 20, 'x');
+    tr.emplace(k, std::string(20, 'x'));
+  }
+  EXPECT_GT(t.height(), 3u);
+  EXPECT_FALSE(t.insert_or_assign("42", "y").second);
+  tr["42"] = "y";
+  EXPECT_EQ(t.at("42"), "y");
+  for (int i = 0; i < 5000; i += 3) {
+    EXPECT_EQ(t.erase(std::to_string(i)), tr.erase(std::to_string(i)));
+  }
+  ASSERT_EQ(t.size(), tr.size());
+  EXPECT_TRUE(std::equal(tr.begin(), tr.end(), t.begin()));
+  btree_map<std::string, std::string, std::less<>> u(std::move(t));
+  EXPECT_TRUE(t.empty());
+  EXPECT_EQ(u.size(), tr.size());
+  // iterator可以赋值给const_iterator, 反过来不行
+  btree_map<int, int> bm{{1, 1}, {2, 4}};
+  btree_map<int, int>::const_iterator bc = bm.begin();
+  bc = bm.find(2);
+  EXPECT_EQ(bc->second, 4);
+  static_assert(!std::is_convertible<btree_map<int, int>::const_iterator,
+                                     btree_map<int, int>::iterator>::value,
+                "");
+}
+
+TEST(test19, deque_test) {
+  using namespace ministl;
+  // 小缓冲区, 让每个操作都跨越多段
+  typedef deque<int, alloc, 8> small_deque;
+  small_deque d;
+  std::deque<int> ref;
+  unsigned seed = 3;
+  for (int i = 0; i < 20000; ++i) {
+    seed = seed * 1103515245 + 12345;
+    unsigned op = (seed >> 16) % 8;
+    size_t pos = ref.empty() ? 0 : (seed >> 8) % (ref.size() + 1);
+    switch (op) {
+      case 0: d.push_back(i); ref.push_back(i); break;
+      case 1: d.push_front(i); ref.push_front(i); break;
+      case 2:
+        if (!ref.empty()) { d.pop_back(); ref.pop_back(); }
+        break;
+      case 3:
+        if (!ref.empty()) { d.pop_front(); ref.pop_front(); }
+        break;
+      case 4:
+        EXPECT_EQ(*d.insert(d.begin() + pos, i), i);
+        ref.insert(ref.begin() + pos, i);
+        break;
+      case 5: {
+        size_t n = (seed >> 4) % 20;
+        d.insert(d.begin() + pos, n, i);
+        ref.insert(ref.begin() + pos, n, i);
+        break;
+      }
+      case 6: {
+        int src[13];
+        for (int k = 0; k < 13; ++k) src[k] = i + k;
+        size_t n = (seed >> 4) % 13;
+        d.insert(d.begin() + pos, src, src + n);
+        ref.insert(ref.begin() + pos, src, src + n);
+        break;
+      }
+      case 7:
+        if (pos < ref.size()) {
+          size_t n = std::min<size_t>((seed >> 4) % 10, ref.size() - pos);
+          d.erase(d.begin() + pos, d.begin() + pos + n);
+          ref.erase(ref.begin() + pos, ref.begin() + pos + n);
+        }
+        break;
+    }
+    ASSERT_EQ(d.size(), ref.size());
+  }
+  EXPECT_TRUE(std::equal(ref.begin(), ref.end(), d.begin()));
+  for (size_t i = 0; i < ref.size(); i += 37) EXPECT_EQ(d[i], ref[i]);
+  EXPECT_THROW(d.at(d.size()), std::out_of_range);
+
+  // 分段算法: 跨段的copy/move/fill, 结果迭代器规范化
+  small_deque a(100, 0);
+  std::vector<int> v(100);
+  for (int i = 0; i < 100; ++i) v[i] = i;
+  small_deque::iterator e = ministl::copy(v.data() + 3, v.data() + 43,
+                                          a.begin() + 5);
+  EXPECT_TRUE(e == a.begin() + 45);
+  EXPECT_EQ(a[5], 3);
+  EXPECT_EQ(a[44], 42);
+  EXPECT_EQ(a[45], 0);
+  e = ministl::copy(v.data(), v.data() + 11, a.begin() + 5);
+  EXPECT_TRUE(e == a.begin() + 16);
+  ministl::copy_backward(a.begin(), a.begin() + 50, a.begin() + 60);
+  EXPECT_EQ(a[15], 0);
+  EXPECT_EQ(a[25], 10);
+  EXPECT_EQ(a[26], 14);
+  EXPECT_EQ(a[54], 42);
+  ministl::fill(a.begin() + 1, a.begin() + 99, 7);
+  EXPECT_EQ(a[0], 0);
+  EXPECT_EQ(a[98], 7);
+  EXPECT_EQ(a[99], 0);
+  EXPECT_TRUE(ministl::fill_n(a.begin() + 3, 21, 9) == a.begin() + 24);
+  int sum = 0;
+  ministl::for_each(a.begin(), a.end(), [&](int x) { sum += x; });
+  EXPECT_EQ(sum, 21 * 9 + 77 * 7);
+  std::vector<int> out(100);
+  EXPECT_EQ(ministl::copy(a.begin(), a.end(), out.data()), out.data() + 100);
+  EXPECT_TRUE(std::equal(out.begin(), out.end(), a.begin()));
+  small_deque b(a);
+  EXPECT_TRUE(a == b);
+  b.back() = 1;
+  EXPECT_TRUE(a < b);
+
+  // 非POD元素, 默认缓冲区大小
+  deque<std::string> s;
+  for (int i = 0; i < 100; ++i) s.push_back(std::to_string(i));
+  for (int i = 0; i < 100; ++i) s.emplace_front(20, 'a');
+  s.insert(s.begin() + 150, 30, std::string(40, 'b'));
+  s.erase(s.begin() + 10, s.begin() + 120);
+  EXPECT_EQ(s.size(), 120u);
+  EXPECT_EQ(s[40], std::string(40, 'b'));
+  EXPECT_EQ(s[70], "50");
+  EXPECT_EQ(s.back(), "99");
+  deque<std::string> t(std::move(s));
+  EXPECT_TRUE(s.empty());
+  s.push_back("x");
+  EXPECT_EQ(s.front(), "x");
+  t.resize(3);
+  t.shrink_to_fit();
+  EXPECT_EQ(t[2], std::string(20, 'a'));
+  s = std::move(t);
+  EXPECT_EQ(s.size(), 3u);
+  deque<std::unique_ptr<int>> u;
+  for (int i = 0; i < 300; ++i) u.emplace_back(new int(i));
+  u.erase(u.begin() + 100);
+  EXPECT_EQ(*u[100], 101);
+  // 空区间的指针是空指针, fill不能调用memset
+  vector<int> none;
+  ministl::fill(none.begin(), none.end(), 0);
+  ministl::fill((char*)0, (char*)0, 'x');
+  // iterator可以赋值给const_iterator, 反过来不行
+  deque<int> dc(5, 1);
+  deque<int>::const_iterator ci = dc.begin();
+  ci = dc.end();
+  EXPECT_TRUE(ci == dc.cend());
+  static_assert(!std::is_convertible<deque<int>::const_iterator,
+                                     deque<int>::iterator>::value,
+                "");
+}
+
+TEST(test20, list_test) {
+  // n个节点一次从free-list/chunk_alloc取得, 不逐个refill
+  auto nth = [](auto it, int n) {
+    while (n-- > 0) ++it;
+    return it;
+  };
+  typedef __default_alloc_template<false, 10> pool;
+  list<int, pool> a(1000, 7);
+  alloc_stats s = pool::get_stats();
+#if MINISTL_ALLOC_STATS
+  const alloc_class_stats& c = s.classes[2];  // 24字节的节点
+  EXPECT_EQ(c.allocs, 1000u);
+  EXPECT_EQ(c.refills, 1u);
+  EXPECT_EQ(c.in_use_objs, 1000u);
+  EXPECT_EQ(c.hits, 0u);
+  uint64_t misses = c.misses;
+#endif
+  a.clear();
+  list<int, pool> b(800, 1);
+#if MINISTL_ALLOC_STATS
+  // 整段从free-list摘下的区块每个都算一次命中
+  s = pool::get_stats();
+  EXPECT_EQ(s.classes[2].refills, 1u);
+  EXPECT_EQ(s.classes[2].hits, 800u);
+  EXPECT_EQ(s.classes[2].misses, misses);
+#endif
+  // free-list上剩下的200个整段摘下, 其余600个一次chunk_alloc
+  a.insert(a.end(), b.begin(), b.end());
+#if MINISTL_ALLOC_STATS
+  s = pool::get_stats();
+  EXPECT_EQ(s.classes[2].refills, 2u);
+  EXPECT_EQ(s.classes[2].in_use_objs, 1600u);
+  EXPECT_EQ(s.classes[2].hits, 1000u);
+#endif
+  EXPECT_EQ(a.size(), 800u);
+
+  // splice/merge/sort/reverse不配置内存
+  list<int, pool> x, y;
+  for (int i = 0; i < 1000; ++i) x.push_back((i * 7919) % 1000);
+  for (int i = 0; i < 10; ++i) y.push_back(i * 3);
+  s = pool::get_stats();
+  x.sort();
+  for (int i = 0; i < 1000; ++i) EXPECT_EQ(*nth(x.begin(), i), i);
+  x.merge(y);
+  EXPECT_TRUE(y.empty());
+  EXPECT_EQ(x.size(), 1010u);
+  EXPECT_TRUE(std::is_sorted(x.begin(), x.end()));
+  x.unique();
+  EXPECT_EQ(x.size(), 1000u);
+  x.reverse();
+  EXPECT_EQ(x.front(), 999);
+  EXPECT_EQ(x.back(), 0);
+  list<int, pool>::iterator mid = x.begin();
+  for (int i = 0; i < 500; ++i) ++mid;
+  y.splice(y.begin(), x, mid, x.end());
+  EXPECT_EQ(y.front(), 499);
+  y.splice(y.end(), x);
+  EXPECT_TRUE(x.empty());
+  EXPECT_EQ(y.back(), 500);
+  y.remove_if([](int v) { return v % 2 == 0; });
+  EXPECT_EQ(y.size(), 500u);
+#if MINISTL_ALLOC_STATS
+  EXPECT_EQ(pool::get_stats().classes[2].allocs, s.classes[2].allocs);
+#endif
+  EXPECT_EQ(*y.rbegin(), 501);
+
+  // 非POD元素, 拷贝赋值复用节点, 稳定排序
+  list<std::pair<int, std::string>> p;
+  for (int i = 0; i < 200; ++i) p.emplace_back(i % 10, std::to_string(i));
+  p.sort([](const std::pair<int, std::string>& l,
+            const std::pair<int, std::string>& r) { return l.first < r.first; });
+  EXPECT_EQ(p.front().second, "0");
+  EXPECT_EQ(nth(p.begin(), 1)->second, "10");
+  EXPECT_EQ(p.back().second, "199");
+  list<std::pair<int, std::string>> q(3, std::make_pair(1, std::string("q")));
+  q = p;
+  EXPECT_TRUE(q == p);
+  q.resize(5);
+  EXPECT_EQ(q.size(), 5u);
+  list<std::pair<int, std::string>> r(std::move(q));
+  EXPECT_TRUE(q.empty());
+  EXPECT_EQ(r.back().second, "40");
+  list<std::unique_ptr<int>> u;
+  for (int i = 0; i < 10; ++i) u.emplace_back(new int(i));
+  u.erase(u.begin());
+  EXPECT_EQ(*u.front(), 1);
+  list<int, __default_alloc_template<true, 10>> mt({3, 1, 2});
+  mt.sort();
+  EXPECT_EQ(mt.front(), 1);
+  EXPECT_EQ(mt.back(), 3);
+
+  // slist: 一串区块原地构造后直接接上
+  typedef __default_alloc_template<false, 11> spool;
+  slist<int, spool> sl(500, 3);
+#if MINISTL_ALLOC_STATS
+  s = spool::get_stats();
+  EXPECT_EQ(s.classes[1].allocs, 500u);  // 16字节的节点
+  EXPECT_EQ(s.classes[1].refills, 1u);
+#endif
+  EXPECT_EQ(sl.size(), 500u);
+  slist<int, spool> sx;
+  for (int i = 0; i < 300; ++i) sx.push_front((i * 31) % 300);
+  sx.sort();
+  EXPECT_TRUE(std::is_sorted(sx.begin(), sx.end()));
+  EXPECT_EQ(sx.front(), 0);
+  slist<int, spool> sy{-1, 5, 500};
+  sx.merge(sy);
+  EXPECT_TRUE(sy.empty());
+  EXPECT_EQ(sx.size(), 303u);
+  EXPECT_EQ(sx.front(), -1);
+  sx.reverse();
+  EXPECT_EQ(sx.front(), 500);
+  sx.remove(5);
+  EXPECT_EQ(sx.size(), 301u);
+  slist<int, spool>::iterator it = sx.insert_after(sx.before_begin(), 3, 42);
+  EXPECT_EQ(*it, 42);
+  EXPECT_EQ(*++it, 500);
+  sx.unique();
+  EXPECT_EQ(sx.front(), 42);
+  EXPECT_EQ(*++sx.begin(), 500);
+  sx.erase_after(sx.begin(), sx.end());
+  EXPECT_EQ(sx.size(), 1u);
+  sx.splice_after(sx.begin(), sl);
+  EXPECT_TRUE(sl.empty());
+  EXPECT_EQ(sx.size(), 501u);
+  slist<std::string> ss{"b", "a", "c"};
+  slist<std::string> st(ss);
+  st.sort();
+  EXPECT_EQ(st.front(), "a");
+  EXPECT_TRUE(ss != st);
+  ss = st;
+  EXPECT_TRUE(ss == st);
+}
+
+TEST(test21, basic_string_test) {
+  // 短字符串放在对象内部, 不配置内存
+  typedef __default_alloc_template<false, 12> pool;
+  typedef basic_string<char, pool> pstring;
+  pstring a("short key");
+  pstring b(15, 'x');
+  EXPECT_EQ(a.capacity(), 15u);
+#if MINISTL_ALLOC_STATS
+  EXPECT_EQ(pool::get_stats().in_use_bytes, 0u);
+#endif
+  b += 'y';
+  EXPECT_EQ(b.size(), 16u);
+  EXPECT_EQ(b.capacity(), 30u);
+#if MINISTL_ALLOC_STATS
+  EXPECT_EQ(pool::get_stats().in_use_bytes, 32u);
+#endif
+  for (int i = 0; i < 100; ++i) b.append("0123456789", 10);
+  EXPECT_EQ(b.size(), 1016u);
+  EXPECT_GE(b.capacity(), b.size());
+  EXPECT_EQ(std::strlen(b.c_str()), 1016u);
+  EXPECT_EQ(b.substr(16, 10), "0123456789");
+  b.shrink_to_fit();
+  EXPECT_EQ(b.capacity(), 1016u);
+  b.resize(10);
+  b.shrink_to_fit();
+  EXPECT_EQ(b.capacity(), 15u);
+#if MINISTL_ALLOC_STATS
+  EXPECT_EQ(pool::get_stats().in_use_bytes, 0u);
+#endif
+  pstring c(std::move(a));
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(c, "short key");
+
+  // 增删改, 参数指向自身
+  string s = "hello world";
+  s.insert(5, ",");
+  s.replace(7, 5, "there");
+  EXPECT_EQ(s, "hello, there");
+  s.append(s);
+  EXPECT_EQ(s, "hello, therehello, there");
+  s.insert(0, s.c_str() + 7, 5);
+  EXPECT_EQ(s.size(), 29u);
+  EXPECT_EQ(s.substr(0, 10), "therehello");
+  s.erase(0, 5);
+  s.erase(s.begin() + 5, s.begin() + 7);
+  EXPECT_EQ(s, "hellotherehello, there");
+  s.replace(0, 5, 3, 'z');
+  EXPECT_EQ(s.substr(0, 4), "zzzt");
+  s.assign(40, 'q');
+  EXPECT_EQ(s.size(), 40u);
+  s = "x";
+  EXPECT_EQ(s + "y" + string("z") + 'w', "xyzw");
+  EXPECT_THROW(s.at(1), std::out_of_range);
+  EXPECT_THROW(s.substr(2), std::out_of_range);
+
+  // 查找和比较, 与std::string对照
+  std::string ref;
+  for (int i = 0; i < 300; ++i) ref += (char)('a' + (i * 7) % 5);
+  ref += "needle";
+  for (int i = 0; i < 50; ++i) ref += (char)('a' + i % 3);
+  string t(ref.data(), ref.size());
+  const char* pats[] = {"needle", "ab", "eca", "e", "aaa", "bca", "", "ne"};
+  for (const char* p : pats) {
+    for (size_t pos = 0; pos < ref.size(); pos += 13) {
+      EXPECT_EQ(t.find(p, pos), ref.find(p, pos)) << p << ' ' << pos;
+      EXPECT_EQ(t.rfind(p, pos), ref.rfind(p, pos)) << p << ' ' << pos;
+      EXPECT_EQ(t.find_first_of(p, pos), ref.find_first_of(p, pos));
+      EXPECT_EQ(t.find_last_not_of(p, pos), ref.find_last_not_of(p, pos));
+    }
+  }
+  EXPECT_EQ(t.find("needle"), 300u);
+  EXPECT_EQ(t.find('z'), string::npos);
+  EXPECT_EQ(t.find_last_of("n"), 300u);
+  EXPECT_EQ(t.find_first_not_of("abcde"), 300u);
+  EXPECT_LT(string("abc").compare("abd"), 0);
+  EXPECT_GT(string("abcd").compare("abc"), 0);
+  EXPECT_EQ(string("abc").compare(1, 2, "bc"), 0);
+  EXPECT_TRUE(string("abc") < string("abd"));
+  EXPECT_TRUE(string("ab") <= string("ab"));
+  std::ostringstream os;
+  os << t.substr(300, 6);
+  EXPECT_EQ(os.str(), "needle");
+
+  // 作为flat_hash_map的key
+  flat_hash_map<string, int> m;
+  for (int i = 0; i < 1000; ++i) m[string(std::to_string(i).c_str())] = i;
+  EXPECT_EQ(m.size(), 1000u);
+  EXPECT_EQ(m.at(string("777")), 777);
+  wstring w(L"wide string");
+  w += L" text";
+  EXPECT_EQ(w.find(L"text"), 12u);
+  EXPECT_EQ(w.size(), 16u);
+  string r(t.end() - 56, t.end() - 50);
+  EXPECT_EQ(r, "needle");
+}
+
+TEST(test22, sort_test) {
+  // 各种分布都与std::sort比较: 随机, 有序, 逆序, 大量重复, 锯齿
+  std::mt19937 gen(22);
+  for (int n : {0, 1, 2, 23, 24, 100, 1023, 1024, 5000, 40000}) {
+    for (int dist = 0; dist < 5; ++dist) {
+      std::vector<int> ref(n);
+      for (int i = 0; i < n; ++i) {
+        switch (dist) {
+          case 0: ref[i] = (int)gen(); break;
+          case 1: ref[i] = i; break;
+          case 2: ref[i] = n - i; break;
+          case 3: ref[i] = (int)(gen() % 4) - 2; break;
+          default: ref[i] = i % 37; break;
+        }
+      }
+      std::vector<int> a(ref);
+      vector<int> v(ref.data(), ref.data() + n);
+      deque<int> d(ref.data(), ref.data() + n);
+      std::vector<int> g(ref);
+      std::sort(ref.begin(), ref.end());
+      ministl::sort(a.data(), a.data() + n);
+      ministl::sort(v.begin(), v.end());
+      ministl::sort(d.begin(), d.end());
+      ministl::sort(g.data(), g.data() + n, std::greater<int>());
+      EXPECT_TRUE(std::equal(ref.begin(), ref.end(), a.begin()));
+      EXPECT_TRUE(std::equal(ref.begin(), ref.end(), v.begin()));
+      EXPECT_TRUE(std::equal(ref.begin(), ref.end(), d.begin()));
+      EXPECT_TRUE(std::equal(ref.rbegin(), ref.rend(), g.begin()));
+    }
+  }
+
+  // 基数排序: 有符号数, 浮点数, 64位
+  std::vector<double> f(5000);
+  for (auto& x : f) x = std::uniform_real_distribution<double>(-1e6, 1e6)(gen);
+  f[7] = -0.0;
+  f[8] = 0.0;
+  std::vector<double> fr(f);
+  std::sort(fr.begin(), fr.end());
+  ministl::sort(f.data(), f.data() + f.size());
+  EXPECT_TRUE(std::equal(fr.begin(), fr.end(), f.begin()));
+  std::vector<float> ff(3000);
+  for (auto& x : ff) x = std::uniform_real_distribution<float>(-10, 10)(gen);
+  std::vector<float> ffr(ff);
+  std::sort(ffr.begin(), ffr.end());
+  ministl::sort(ff.data(), ff.data() + ff.size());
+  EXPECT_TRUE(std::equal(ffr.begin(), ffr.end(), ff.begin()));
+  std::vector<long long> ll(3000);
+  for (auto& x : ll) x = (long long)(((uint64_t)gen() << 32) | gen());
+  std::vector<long long> llr(ll);
+  std::sort(llr.begin(), llr.end());
+  ministl::sort(ll.data(), ll.data() + ll.size());
+  EXPECT_TRUE(std::equal(llr.begin(), llr.end(), ll.begin()));
+  vector<short> sv;
+  for (int i = 0; i < 2000; ++i) sv.push_back((short)(gen() % 2000 - 1000));
+  ministl::stable_sort(sv.begin(), sv.end());
+  EXPECT_TRUE(std::is_sorted(sv.begin(), sv.end()));
+
+  // 非POD类型
+  std::vector<std::string> s;
+  for (int i = 0; i < 2000; ++i) s.push_back(std::to_string(gen() % 500));
+  std::vector<std::string> sr(s);
+  std::sort(sr.begin(), sr.end());
+  ministl::sort(s.data(), s.data() + s.size());
+  EXPECT_EQ(s, sr);
+
+  // 稳定排序: 只按first比较, second记录原来的顺序
+  typedef std::pair<int, int> P;
+  auto by_first = [](const P& x, const P& y) { return x.first < y.first; };
+  for (int n : {10, 100, 3000}) {
+    std::vector<P> p;
+    for (int i = 0; i < n; ++i) p.push_back(P((int)(gen() % 50), i));
+    std::vector<P> pr(p);
+    std::stable_sort(pr.begin(), pr.end(), by_first);
+    deque<P> pd(p.data(), p.data() + n);
+    ministl::stable_sort(p.data(), p.data() + n, by_first);
+    ministl::stable_sort(pd.begin(), pd.end(), by_first);
+    EXPECT_EQ(p, pr);
+    EXPECT_TRUE(std::equal(pr.begin(), pr.end(), pd.begin()));
+  }
+  std::vector<std::string> ss(s.rbegin(), s.rend());
+  ministl::stable_sort(ss.data(), ss.data() + ss.size());
+  EXPECT_EQ(ss, sr);
+
+  // partial_sort, nth_element
+  std::vector<int> r(10000);
+  for (auto& x : r) x = (int)(gen() % 100000);
+  std::vector<int> rs(r);
+  std::sort(rs.begin(), rs.end());
+  std::vector<int> ps(r);
+  ministl::partial_sort(ps.data(), ps.data() + 100, ps.data() + ps.size());
+  EXPECT_TRUE(std::equal(rs.begin(), rs.begin() + 100, ps.begin()));
+  for (int k : {0, 1, 4999, 9998, 9999}) {
+    std::vector<int> ne(r);
+    ministl::nth_element(ne.data(), ne.data() + k, ne.data() + ne.size());
+    EXPECT_EQ(ne[k], rs[k]);
+    EXPECT_TRUE(std::all_of(ne.begin(), ne.begin() + k,
+                            [&](int x) { return x <= ne[k]; }));
+    EXPECT_TRUE(std::all_of(ne.begin() + k, ne.end(),
+                            [&](int x) { return x >= ne[k]; }));
+  }
+  std::vector<int> h(r.begin(), r.begin() + 1000);
+  ministl::make_heap(h.data(), h.data() + h.size());
+  EXPECT_TRUE(std::is_heap(h.begin(), h.end()));
+  h.push_back(1 << 30);
+  ministl::push_heap(h.data(), h.data() + h.size());
+  EXPECT_EQ(h[0], 1 << 30);
+  ministl::pop_heap(h.data(), h.data() + h.size());
+  EXPECT_EQ(h.back(), 1 << 30);
+  h.pop_back();
+  ministl::sort_heap(h.data(), h.data() + h.size());
+  EXPECT_TRUE(std::is_sorted(h.begin(), h.end()));
+}
+
+// 对每种类型在各个指令集下与逐个比较的结果对照, 起点取不同的偏移覆盖不对齐的情况
+template <class T>
+void simd_check(std::mt19937& gen, T lo, T hi) {
+  for (int n : {0, 1, 7, 16, 33, 64, 100, 257}) {
+    for (int offset = 0; offset < 3; ++offset) {
+      std::vector<T> buf(n + offset);
+      for (auto& x : buf) {
+        // 在double中算区间长度, hi - lo对有符号数会溢出
+        x = (T)(lo + ((double)hi - (double)lo) * ((double)gen() / gen.max()));
+      }
+      T* first = buf.data() + offset;
+      T* last = first + n;
+      const T* cfirst = first;
+      T value = n > 0 ? first[gen() % n] : lo;
+      EXPECT_EQ(ministl::find(first, last, value),
+                std::find(first, last, value));
+      EXPECT_EQ(ministl::find(cfirst, cfirst + n, hi),
+                std::find(first, last, hi));
+      EXPECT_EQ(ministl::count(first, last, value),
+                std::count(first, last, value));
+      EXPECT_EQ(ministl::min_element(first, last),
+                std::min_element(first, last));
+      EXPECT_EQ(ministl::max_element(cfirst, cfirst + n),
+                std::max_element(first, last));
+      std::vector<T> copy(first, last);
+      EXPECT_TRUE(ministl::equal(first, last, copy.data()));
+      if (n > 0) {
+        copy[gen() % n] = (T)(hi + 1);
+        EXPECT_EQ(ministl::equal(first, last, copy.data()),
+                  std::equal(first, last, copy.data()));
+      }
+      ministl::fill(first, last, value);
+      EXPECT_EQ(std::count(first, last, value), n);
+      // 有符号整数求和溢出是未定义行为, 缩小元素使n个相加不会溢出
+      if (std::is_integral<T>::value && std::is_signed<T>::value) {
+        ministl::fill(first, last, (T)(value / 512));
+      }
+      // 浮点数的reduce改变了加法顺序, 只能近似相等
+      double sum = (double)std::accumulate(first, last, T());
+      EXPECT_NEAR((double)ministl::reduce(first, last, T()), sum,
+                  std::is_floating_point<T>::value ? 1e-4 * std::fabs(sum) : 0);
+    }
+  }
+}
+
+TEST(test23, simd_test) {
+  std::mt19937 gen(23);
+  const int supported = simd_supported_level();
+  for (int level = SIMD_SCALAR; level <= supported; ++level) {
+    EXPECT_EQ(simd_set_level(level), level);
+    EXPECT_EQ(simd_level(), level);
+    simd_check<signed char>(gen, -100, 100);
+    simd_check<unsigned char>(gen, 0, 200);
+    simd_check<short>(gen, -30000, 30000);
+    simd_check<unsigned short>(gen, 0, 60000);
+    simd_check<int>(gen, -2000000000, 2000000000);
+    simd_check<unsigned>(gen, 0, 4000000000u);
+    simd_check<long long>(gen, -(1ll << 62), 1ll << 62);
+    simd_check<unsigned long long>(gen, 0, 1ull << 63);
+    simd_check<int>(gen, 0, 3);
+    simd_check<float>(gen, -1000, 1000);
+    simd_check<double>(gen, -1e9, 1e9);
+
+    // 浮点数: -0.0等于0.0, NaN不等于任何数, 有NaN时min/max与逐个比较相同
+    std::vector<double> d(100, 1.0);
+    d[40] = -0.0;
+    d[70] = 0.0;
+    d[90] = -5.0;
+    EXPECT_EQ(ministl::find(d.data(), d.data() + 100, 0.0), d.data() + 40);
+    EXPECT_EQ(ministl::count(d.data(), d.data() + 100, -0.0), 2);
+    d[10] = std::nan("");
+    EXPECT_EQ(ministl::min_element(d.data(), d.data() + 100),
+              std::min_element(d.begin(), d.end()).operator->());
+    EXPECT_EQ(ministl::max_element(d.data(), d.data() + 100),
+              std::max_element(d.begin(), d.end()).operator->());
+    EXPECT_EQ(ministl::find(d.data(), d.data() + 100, d[10]), d.data() + 100);
+    std::vector<double> e(d);
+    EXPECT_FALSE(ministl::equal(d.data(), d.data() + 100, e.data()));
+    std::vector<float> f(1000);
+    for (auto& x : f) x = (float)(gen() % 1000) / 8;
+    EXPECT_EQ(ministl::reduce(f.data(), f.data() + f.size(), 0.0f),
+              std::accumulate(f.begin(), f.end(), 0.0f));
+
+    // value与元素类型不同的整数
+    std::vector<unsigned> u(50, 7);
+    u[20] = 0xffffffffu;
+    EXPECT_EQ(ministl::find(u.data(), u.data() + 50, -1), u.data() + 20);
+    std::vector<unsigned char> uc(50, 1);
+    EXPECT_EQ(ministl::find(uc.data(), uc.data() + 50, 257), uc.data() + 50);
+    EXPECT_EQ(ministl::count(uc.data(), uc.data() + 50, 1L), 50);
+
+    // 容器: vector的==, deque逐段查找和计数
+    vector<int> v1(1000, 3), v2(1000, 3);
+    EXPECT_TRUE(v1 == v2);
+    v2[999] = 4;
+    EXPECT_FALSE(v1 == v2);
+    deque<int> dq;
+    for (int i = 0; i < 5000; ++i) dq.push_back(i % 100);
+    EXPECT_EQ(ministl::find(dq.begin(), dq.end(), 42) - dq.begin(), 42);
+    EXPECT_EQ(ministl::find(dq.begin() + 4900, dq.end(), 42) - dq.begin(),
+              4942);
+    EXPECT_TRUE(ministl::find(dq.begin(), dq.end(), 100) == dq.end());
+    EXPECT_EQ(ministl::count(dq.begin() + 3, dq.end() - 3, 99), 49);
+    EXPECT_EQ(ministl::count(dq.begin() + 3, dq.end(), 99), 50);
+    EXPECT_EQ(*ministl::max_element(dq.begin(), dq.end()), 99);
+  }
+  simd_set_level(supported);
+}
+
+TEST(test24, parallel_test) {
+  // 单核机器上也要用到工作线程, 线程池在第一次并行调用时创建
+  setenv("MINISTL_POOL_THREADS", "3", 0);
+  EXPECT_GT(__thread_pool::instance().size(), 0u);
+  const int n = 300000;
+  std::mt19937 gen(24);
+  vector<int> v(n);
+  for (int i = 0; i < n; ++i) v[i] = i;
+
+  // for_each, transform, copy
+  std::atomic<long long> visited(0);
+  ministl::for_each(execution::par, v.begin(), v.end(),
+                    [&](int& x) { x *= 2; visited.fetch_add(1); });
+  EXPECT_EQ(visited.load(), n);
+  EXPECT_EQ(v[n - 1], 2 * (n - 1));
+  vector<long long> w(n);
+  ministl::transform(execution::par, v.begin(), v.end(), w.begin(),
+                     [](int x) { return (long long)x * x; });
+  EXPECT_EQ(w[1000], 4000000ll);
+  ministl::transform(execution::par_unseq, v.begin(), v.end(), w.begin(),
+                     w.begin(), [](int x, long long y) { return x + y; });
+  EXPECT_EQ(w[10], 420ll);
+  deque<int> d(n, 0);
+  EXPECT_TRUE(ministl::copy(execution::par, v.begin(), v.end(), d.begin()) ==
+              d.end());
+  EXPECT_TRUE(ministl::equal(v.begin(), v.end(), d.begin()));
+
+  // reduce: 默认加法, 自定义操作, deque迭代器
+  long long expect = (long long)n * (n - 1);
+  EXPECT_EQ(ministl::reduce(execution::par, w.begin(), w.end(), 0ll),
+            std::accumulate(w.begin(), w.end(), 0ll));
+  EXPECT_EQ(ministl::reduce(execution::par, d.begin(), d.end(), 0ll), expect);
+  EXPECT_EQ(ministl::reduce(execution::par, v.begin(), v.end(), 0,
+                            [](int a, int b) { return a > b ? a : b; }),
+            2 * (n - 1));
+  EXPECT_EQ(ministl::reduce(execution::seq, v.begin(), v.begin() + 4), 12);
+
+  // inclusive_scan, 包括原地扫描和初值
+  vector<long long> s(n), ref(n);
+  std::partial_sum(w.begin(), w.end(), ref.begin());
+  ministl::inclusive_scan(execution::par, w.begin(), w.end(), s.begin());
+  EXPECT_TRUE(ministl::equal(s.begin(), s.end(), ref.begin()));
+  ministl::inclusive_scan(execution::par, w.begin(), w.end(), s.begin(),
+                          __plus(), 5ll);
+  EXPECT_EQ(s[n - 1], ref[n - 1] + 5);
+  EXPECT_EQ(s[0], w[0] + 5);
+  vector<long long> inplace(w);
+  ministl::inclusive_scan(execution::par, inplace.begin(), inplace.end(),
+                          inplace.begin());
+  EXPECT_TRUE(ministl::equal(inplace.begin(), inplace.end(), ref.begin()));
+
+  // sort: 随机, 大量重复, 自定义比较, 非算术类型
+  for (int dist = 0; dist < 3; ++dist) {
+    std::vector<int> r(n);
+    for (auto& x : r) x = dist == 0 ? (int)gen() : (int)(gen() % 3);
+    if (dist == 2) std::sort(r.begin(), r.end());
+    vector<int> a(r.data(), r.data() + n);
+    std::sort(r.begin(), r.end());
+    ministl::sort(execution::par, a.begin(), a.end());
+    EXPECT_TRUE(ministl::equal(a.begin(), a.end(), r.data()));
+    ministl::sort(execution::par, a.begin(), a.end(), std::greater<int>());
+    EXPECT_TRUE(std::equal(r.rbegin(), r.rend(), a.begin()));
+  }
+  std::vector<std::string> strs(100000);
+  for (auto& x : strs) x = std::to_string(gen());
+  std::vector<std::string> sorted(strs);
+  std::sort(sorted.begin(), sorted.end());
+  ministl::sort(execution::par, strs.data(), strs.data() + strs.size());
+  EXPECT_EQ(strs, sorted);
+
+  // 异常在所有块结束后抛出
+  EXPECT_THROW(ministl::for_each(execution::par, v.begin(), v.end(),
+                                 [](int x) {
+                                   if (x == 2 * 150000) throw std::runtime_error("");
+                                 }),
+               std::runtime_error);
+
+  // 嵌套的并行调用
+  vector<vector<int>> nested(8);
+  for (auto& x : nested) {
+    x.resize(50000);
+    for (auto& y : x) y = (int)gen();
+  }
+  ministl::for_each(execution::par, nested.begin(), nested.end(),
+                    [](vector<int>& x) {
+                      ministl::sort(execution::par, x.begin(), x.end());
+                    });
+  for (auto& x : nested) EXPECT_TRUE(std::is_sorted(x.begin(), x.end()));
+
+  // 不能随机访问的迭代器顺序执行
+  list<int> l(v.begin(), v.begin() + 100);
+  int sum = 0;
+  ministl::for_each(execution::par, l.begin(), l.end(),
+                    [&](int x) { sum += x; });
+  EXPECT_EQ(sum, 9900);
+}
+
+// 几个用户线程同时调用并行算法, 工作线程和用户线程一起配置和归还内部的缓冲区
+TEST(test24, parallel_stress_test) {
+  setenv("MINISTL_POOL_THREADS", "4", 0);
+  EXPECT_GT(__thread_pool::instance().size(), 0u);
+  std::atomic<int> failures(0);
+  auto work = [&](unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    for (int round = 0; round < 4; ++round) {
+      std::vector<double> a(200000);
+      for (auto& x : a) x = real(gen);
+      std::vector<double> r(a);
+      std::sort(r.begin(), r.end());
+      ministl::sort(execution::par, a.data(), a.data() + a.size());
+      if (a != r) failures.fetch_add(1);
+      std::vector<long long> w(200000);
+      for (auto& x : w) x = gen() % 1000;
+      if (ministl::reduce(execution::par, w.data(), w.data() + w.size(),
+                          0ll) != std::accumulate(w.begin(), w.end(), 0ll)) {
+        failures.fetch_add(1);
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < 4; ++i) threads.emplace_back(work, 100 + i);
+  for (auto& t : threads) t.join();
+  EXPECT_EQ(failures.load(), 0);
+}
+
+// 类类型的连续迭代器, 检验算法把它换成原生指针处理
+template <class T>
+struct contiguous_iter {
+  typedef contiguous_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef ptrdiff_t difference_type;
+  typedef T* pointer;
+  typedef T& reference;
+  T* p;
+  explicit contiguous_iter(T* x = nullptr) : p(x) {}
+  T& operator*() const { return *p; }
+  T* operator->() const { return p; }
+  contiguous_iter& operator++() {
+    ++p;
+    return *this;
+  }
+  contiguous_iter& operator--() {
+    --p;
+    return *this;
+  }
+  contiguous_iter operator+(ptrdiff_t n) const {
+    return contiguous_iter(p + n);
+  }
+  contiguous_iter& operator+=(ptrdiff_t n) {
+    p += n;
+    return *this;
+  }
+  ptrdiff_t operator-(const contiguous_iter& x) const { return p - x.p; }
+  bool operator==(const contiguous_iter& x) const { return p == x.p; }
+  bool operator!=(const contiguous_iter& x) const { return p != x.p; }
+};
+
+TEST(test25, iterator_test) {
+  // advance修改参数本身, 双向迭代器可以后退
+  ministl::list<int> l;
+  for (int i = 0; i < 10; ++i) l.push_back(i);
+  auto it = l.begin();
+  ministl::advance(it, 7);
+  EXPECT_EQ(*it, 7);
+  ministl::advance(it, -3);
+  EXPECT_EQ(*it, 4);
+  EXPECT_EQ(*ministl::next(l.begin(), 5), 5);
+  EXPECT_EQ(*ministl::prev(l.end()), 9);
+  EXPECT_EQ(ministl::distance(l.begin(), l.end()), 10);
+  int a[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  int* p = a;
+  ministl::advance(p, 6);
+  EXPECT_EQ(p, a + 6);
+  EXPECT_EQ(ministl::prev(p, 2), a + 4);
+
+  // 反向迭代器
+  ministl::vector<int> v(a, a + 10);
+  auto r = v.rbegin();
+  EXPECT_EQ(r[2], 7);
+  EXPECT_EQ(*(r + 3), 6);
+  EXPECT_EQ(v.rend() - v.rbegin(), 10);
+  EXPECT_TRUE(v.rbegin() < v.rend());
+  EXPECT_TRUE(v.rbegin() != v.rend());
+  EXPECT_FALSE(v.rend() <= v.rbegin());
+  auto r2 = r++;
+  EXPECT_EQ(*r2, 9);
+  r2 = r--;
+  EXPECT_EQ(*r2, 8);
+  EXPECT_EQ(*r, 9);
+  ministl::vector<int>::const_reverse_iterator cr = v.rbegin();
+  EXPECT_TRUE(cr == v.rbegin());
+  ministl::vector<int> back(l.rbegin(), l.rend());
+  EXPECT_EQ(back.front(), 9);
+  EXPECT_EQ(back.back(), 0);
+
+  // 连续性
+  static_assert(is_contiguous<int*>::value, "");
+  static_assert(is_contiguous<const char*>::value, "");
+  static_assert(is_contiguous<contiguous_iter<int>>::value, "");
+  static_assert(!is_contiguous<ministl::deque<int>::iterator>::value, "");
+  static_assert(!is_contiguous<ministl::vector<int>::reverse_iterator>::value,
+                "");
+  static_assert(
+      std::is_same<ministl::list<int>::reverse_iterator::iterator_category,
+                   bidirectional_iterator_tag>::value,
+      "");
+  std::vector<int> data(1000);
+  std::iota(data.begin(), data.end(), 0);
+  contiguous_iter<int> first(data.data()), last(data.data() + 1000);
+  EXPECT_EQ(ministl::find(first, last, 742).p, data.data() + 742);
+  EXPECT_EQ(ministl::count(first, last, 5), 1);
+  EXPECT_EQ(ministl::max_element(first, last).p, data.data() + 999);
+  EXPECT_EQ(ministl::min_element(first, last).p, data.data());
+  std::vector<int> out(1000);
+  contiguous_iter<int> ofirst(out.data());
+  EXPECT_EQ(ministl::copy(first, last, ofirst).p, out.data() + 1000);
+  EXPECT_TRUE(ministl::equal(first, last, ofirst));
+  EXPECT_EQ(ministl::copy_backward(first, first + 10, ofirst + 20).p,
+            out.data() + 10);
+  EXPECT_EQ(out[10], 0);
+  EXPECT_EQ(out[19], 9);
+  ministl::fill(ofirst, ofirst + 1000, 3);
+  EXPECT_EQ(ministl::count(ofirst, ofirst + 1000, 3), 1000);
+
+  // 移动迭代器: copy和uninitialized_copy经过它变成移动
+  std::vector<std::string> src(20, std::string(40, 'x'));
+  std::vector<std::string> dst(20);
+  ministl::copy(ministl::make_move_iterator(src.data()),
+                ministl::make_move_iterator(src.data() + 20), dst.data());
+  EXPECT_EQ(dst[19], std::string(40, 'x'));
+  EXPECT_TRUE(src[0].empty());
+  ministl::vector<std::string> moved(
+      ministl::make_move_iterator(dst.data()),
+      ministl::make_move_iterator(dst.data() + 20));
+  EXPECT_EQ(moved.size(), 20u);
+  EXPECT_EQ(moved[0], std::string(40, 'x'));
+  EXPECT_TRUE(dst[5].empty());
+  ministl::deque<int> dq(a, a + 10);
+  ministl::vector<int> vi(ministl::make_move_iterator(dq.begin()),
+                          ministl::make_move_iterator(dq.end()));
+  EXPECT_TRUE(ministl::equal(vi.begin(), vi.end(), a));
+  auto mi = ministl::make_move_iterator(v.begin());
+  EXPECT_EQ(mi[3], 3);
+  EXPECT_EQ(ministl::make_move_iterator(v.end()) - mi, 10);
+}
+
+// std容器的迭代器: std的tag换成ministl的tag后参与分派
+TEST(test25, std_iterator_test) {
+  static_assert(
+      std::is_same<iterator_traits<std::vector<int>::iterator>::
+                       iterator_category,
+                   random_access_iterator_tag>::value,
+      "");
+  static_assert(
+      std::is_same<iterator_traits<std::list<int>::iterator>::
+                       iterator_category,
+                   bidirectional_iterator_tag>::value,
+      "");
+  static_assert(
+      std::is_same<__use_parallel<execution::parallel_policy,
+                                  std::vector<int>::iterator>::type,
+                   _true_type>::value,
+      "");
+  static_assert(
+      std::is_same<__use_parallel<execution::parallel_policy,
+                                  std::list<int>::iterator>::type,
+                   _false_type>::value,
+      "");
+
+  std::vector<int> sv = {5, 3, 8, 1, 9, 2, 7};
+  std::list<int> sl(sv.begin(), sv.end());
+  std::string ss = "hello";
+
+  // 区间构造和插入
+  ministl::vector<int> v(sv.begin(), sv.end());
+  v.insert(v.begin() + 2, sl.begin(), sl.end());
+  EXPECT_EQ(v.size(), 14u);
+  EXPECT_TRUE(std::equal(sv.begin(), sv.end(), v.begin() + 2));
+  ministl::deque<int> d(sl.begin(), sl.end());
+  d.insert(d.begin() + 1, sv.begin(), sv.end());
+  EXPECT_EQ(d.size(), 14u);
+  EXPECT_EQ(d[1], 5);
+  ministl::list<int> l(sv.begin(), sv.end());
+  l.insert(l.end(), sl.begin(), sl.end());
+  EXPECT_EQ(l.size(), 14u);
+  ministl::slist<int> sll(sl.begin(), sl.end());
+  EXPECT_EQ(ministl::distance(sll.begin(), sll.end()), 7);
+  ministl::small_vector<int, 4> sm(sv.begin(), sv.end());
+  sm.insert(sm.end(), sl.begin(), sl.end());
+  EXPECT_EQ(sm.size(), 14u);
+  ministl::string str(ss.begin(), ss.end());
+  str.append(ss.begin(), ss.end());
+  EXPECT_EQ(str, "hellohello");
+
+  // advance, distance, sort
+  auto it = sl.begin();
+  ministl::advance(it, 3);
+  EXPECT_EQ(*it, 1);
+  ministl::advance(it, -2);
+  EXPECT_EQ(*it, 3);
+  EXPECT_EQ(ministl::distance(sl.begin(), sl.end()), 7);
+  EXPECT_EQ(ministl::distance(sv.begin(), sv.end()), 7);
+  ministl::sort(sv.begin(), sv.end());
+  EXPECT_TRUE(std::is_sorted(sv.begin(), sv.end()));
+  std::vector<int> big(100000);
+  for (size_t i = 0; i < big.size(); ++i) big[i] = (int)(big.size() - i);
+  ministl::sort(execution::par, big.begin(), big.end());
+  EXPECT_TRUE(std::is_sorted(big.begin(), big.end()));
+  EXPECT_EQ(ministl::reduce(execution::par, big.begin(), big.end(), 0ll),
+            100000ll * 100001 / 2);
+}
+
+struct plain_point {
+  int x;
+  double y;
+};
+
+struct with_dtor {
+  int x;
+  ~with_dtor() {}
+};
+
+// 持有堆上的对象, 声明自己可以按字节搬移; live统计还活着的对象数
+struct reloc_handle {
+  static int live;
+  int* p;
+  explicit reloc_handle(int x = 0) : p(new int(x)) { ++live; }
+  reloc_handle(const reloc_handle& h) : p(new int(*h.p)) { ++live; }
+  reloc_handle(reloc_handle&& h) : p(h.p) {
+    h.p = nullptr;
+    ++live;
+  }
+  reloc_handle& operator=(reloc_handle h) {
+    std::swap(p, h.p);
+    return *this;
+  }
+  ~reloc_handle() {
+    delete p;
+    --live;
+  }
+};
+int reloc_handle::live = 0;
+
+namespace ministl {
+template <>
+struct is_trivially_relocatable<reloc_handle> {
+  typedef _true_type type;
+};
+}  // namespace ministl
+
+TEST(test26, type_traits_test) {
+  // 普通的结构体由编译器判断
+  static_assert(std::is_same<type_traits<plain_point>::is_POD_type,
+                             _true_type>::value,
+                "");
+  static_assert(std::is_same<type_traits<with_dtor>::has_trivial_destructor,
+                             _false_type>::value,
+                "");
+  static_assert(std::is_same<type_traits<std::string>::is_POD_type,
+                             _false_type>::value,
+                "");
+  static_assert(std::is_same<type_traits<int*>::is_POD_type, _true_type>::value,
+                "");
+  static_assert(std::is_same<is_trivially_relocatable<plain_point>::type,
+                             _true_type>::value,
+                "");
+  static_assert(std::is_same<is_trivially_relocatable<std::string>::type,
+                             _false_type>::value,
+                "");
+  static_assert(
+      std::is_same<is_trivially_relocatable<std::pair<const int, double>>::type,
+                   _true_type>::value,
+      "");
+  static_assert(std::is_same<is_trivially_relocatable<
+                                 ministl::vector<std::string>>::type,
+                             _true_type>::value,
+                "");
+
+  // 结构体走memset/memmove的路径
+  ministl::vector<plain_point> pts(100, plain_point{0, 0.0});
+  EXPECT_EQ(pts[99].x, 0);
+  ministl::fill(pts.begin(), pts.end(), plain_point{3, 1.5});
+  ministl::vector<plain_point> pts2(pts);
+  EXPECT_EQ(pts2[50].x, 3);
+  EXPECT_EQ(pts2[50].y, 1.5);
+
+  // 按字节搬移: 扩容和插入时旧对象不析构, 元素仍然完好
+  {
+    ministl::vector<reloc_handle> v;
+    for (int i = 0; i < 1000; ++i) {
+      v.emplace_back(i);
+    }
+    EXPECT_EQ(reloc_handle::live, 1000);
+    v.insert(v.begin() + 10, 5, reloc_handle(-1));
+    EXPECT_EQ(*v[9].p, 9);
+    EXPECT_EQ(*v[12].p, -1);
+    EXPECT_EQ(*v[15].p, 10);
+    EXPECT_EQ(*v.back().p, 999);
+    v.shrink_to_fit();
+    EXPECT_EQ(*v[1004].p, 999);
+    EXPECT_EQ(reloc_handle::live, 1005);
+
+    small_vector<reloc_handle, 4> s;
+    for (int i = 0; i < 100; ++i) {
+      s.emplace_back(i);
+    }
+    EXPECT_EQ(*s[3].p, 3);
+    EXPECT_EQ(*s[99].p, 99);
+
+    flat_hash_map<int, reloc_handle> m;
+    for (int i = 0; i < 1000; ++i) {
+      m[i] = reloc_handle(i * 2);
+    }
+    EXPECT_EQ(*m[777].p, 1554);
+    EXPECT_EQ(reloc_handle::live, 1005 + 100 + 1000);
+  }
+  EXPECT_EQ(reloc_handle::live, 0);
+
+  // 嵌套的vector扩容时整块搬移
+  ministl::vector<ministl::vector<int>> vv;
+  for (int i = 0; i < 200; ++i) {
+    vv.push_back(ministl::vector<int>(i, i));
+  }
+  vv.insert(vv.begin(), ministl::vector<int>(3, 7));
+  EXPECT_EQ(vv[0].size(), 3u);
+  EXPECT_EQ(vv[200].size(), 199u);
+  EXPECT_EQ(vv[200][198], 199);
 }